@@ -0,0 +1,110 @@
+#include <time.h>
+#include "cnwn/hash.h"
+#include "cnwn/string.h"
+
+typedef struct {
+    const char * name;
+    int bits;
+    uint64_t (*function)(const void * data, uint64_t length);
+} Hash;
+
+static uint64_t hash_murmur3(const void * data, uint64_t length) { return cnwn_hash32_murmur3(data, (uint32_t)length); }
+static uint64_t hash_crc32(const void * data, uint64_t length) { return cnwn_hash32_crc32_update(0, data, length); }
+static uint64_t hash_fnv1a(const void * data, uint64_t length) { return cnwn_hash32_fnv1a(data, (uint32_t)length); }
+static uint64_t hash_djb2(const void * data, uint64_t length) { return cnwn_hash32_djb2(data, (uint32_t)length); }
+static uint64_t hash_murmur3_128(const void * data, uint64_t length) { return cnwn_hash128_murmur3(data, length).low; }
+
+static const Hash HASHES[] = {
+    {"murmur3", 32, &hash_murmur3},
+    {"crc32", 32, &hash_crc32},
+    {"fnv1a", 32, &hash_fnv1a},
+    {"djb2", 32, &hash_djb2},
+    {"xxh64", 64, &cnwn_hash64_xxh64},
+    {"wyhash", 64, &cnwn_hash64_wyhash},
+    {"fnv1a64", 64, &cnwn_hash64_fnv1a},
+    {"murmur3-128", 128, &hash_murmur3_128},
+    {NULL}
+};
+
+static const int64_t SIZES[] = {8, 16, 64, 256, 1024, 4096, 65536, 1 << 20, 64 << 20, 0};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: bench-hash [-b MEGABYTES_PER_TEST] [HASH...]\n");
+}
+
+int main(int argc, char * argv[])
+{
+    int64_t budget = 256 << 20;
+    const char * only[16];
+    int num_only = 0;
+    for (int i = 1; i < argc; i++) {
+        if (cnwn_strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            int megabytes = atoi(argv[++i]);
+            budget = (int64_t)CNWN_MAX(1, megabytes) << 20;
+        } else if (argv[i][0] != '-' && num_only < 16)
+            only[num_only++] = argv[i];
+        else {
+            usage();
+            return 1;
+        }
+    }
+    int64_t max_size = 0;
+    for (int i = 0; SIZES[i] > 0; i++)
+        max_size = CNWN_MAX(max_size, SIZES[i]);
+    uint8_t * data = malloc(max_size);
+    uint64_t x = 0x9e3779b97f4a7c15ULL;
+    for (int64_t i = 0; i < max_size; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        data[i] = (uint8_t)x;
+    }
+
+    printf("%-12s %4s", "hash", "bits");
+    for (int i = 0; SIZES[i] > 0; i++) {
+        char tmps[32];
+        if (SIZES[i] >= (1 << 20))
+            snprintf(tmps, sizeof(tmps), "%"PRId64"M", SIZES[i] >> 20);
+        else if (SIZES[i] >= 1024)
+            snprintf(tmps, sizeof(tmps), "%"PRId64"K", SIZES[i] >> 10);
+        else
+            snprintf(tmps, sizeof(tmps), "%"PRId64"", SIZES[i]);
+        printf(" %8s", tmps);
+    }
+    printf("   (MB/s)\n");
+    uint64_t sink = 0;
+    for (int h = 0; HASHES[h].name != NULL; h++) {
+        bool skip = (num_only > 0);
+        for (int i = 0; i < num_only; i++)
+            if (cnwn_strcmp(only[i], HASHES[h].name) == 0)
+                skip = false;
+        if (skip)
+            continue;
+        printf("%-12s %4d", HASHES[h].name, HASHES[h].bits);
+        fflush(stdout);
+        for (int i = 0; SIZES[i] > 0; i++) {
+            int64_t size = SIZES[i];
+            int64_t iterations = CNWN_MAX(1, budget / size);
+            // Walk the offset through the buffer so short inputs are not always the same bytes.
+            int64_t span = CNWN_MAX(1, CNWN_MIN(max_size - size, 1 << 16));
+            double start = now();
+            for (int64_t j = 0; j < iterations; j++)
+                sink += HASHES[h].function(data + (j * 8) % span, size);
+            double seconds = now() - start;
+            printf(" %8.0f", (double)(iterations * size) / CNWN_MAX(seconds, 1e-9) / 1e6);
+            fflush(stdout);
+        }
+        printf("\n");
+    }
+    printf("(%"PRIx64")\n", sink);
+    free(data);
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include <time.h>
+#include "cnwn/erf.h"
+#include "cnwn/ncs_vm.h"
+
+typedef struct {
+    char name[64];
+    int num_instructions;
+    int64_t executed;
+    double seconds;
+    cnwn_NcsVmStatus status;
+    char error[256];
+} Result;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int compare_results(const void * a, const void * b)
+{
+    double sa = ((const Result *)a)->seconds;
+    double sb = ((const Result *)b)->seconds;
+    return (sa < sb) - (sa > sb);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: bench-ncs [-a nwscript.nss] [-n RUNS] [-l MAX_INSTRUCTIONS] MODULE\n");
+}
+
+int main(int argc, char * argv[])
+{
+    const char * nss_path = NULL;
+    const char * path = NULL;
+    int runs = 100;
+    int64_t max_instructions = CNWN_NCS_VM_DEFAULT_MAX_INSTRUCTIONS;
+    for (int i = 1; i < argc; i++) {
+        if (cnwn_strcmp(argv[i], "-a") == 0 && i + 1 < argc)
+            nss_path = argv[++i];
+        else if (cnwn_strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+            runs = CNWN_MAX(1, runs);
+        } else if (cnwn_strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            max_instructions = atoll(argv[++i]);
+            max_instructions = CNWN_MAX(1, max_instructions);
+        } else if (path == NULL && argv[i][0] != '-')
+            path = argv[i];
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (path == NULL)
+        path = "../tests/test.mod";
+
+    cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_ERF, &CNWN_RESOURCE_HANDLER_ERF);
+    cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_MOD, &CNWN_RESOURCE_HANDLER_ERF);
+    cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_HAK, &CNWN_RESOURCE_HANDLER_ERF);
+    cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_NWM, &CNWN_RESOURCE_HANDLER_ERF);
+
+    cnwn_NcsActions actions;
+    if (nss_path != NULL && cnwn_ncs_actions_init_from_path(&actions, nss_path) < 0) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        return 1;
+    }
+    cnwn_File * f = cnwn_file_open(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        return 1;
+    }
+    cnwn_Resource resource;
+    int64_t size = cnwn_file_size(f);
+    if (size < 0 || cnwn_resource_init_from_file(&resource, cnwn_resource_type_from_path(path), "module", 0, size, NULL, f) < 0) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        cnwn_file_close(f);
+        return 1;
+    }
+    int num_resources = cnwn_resource_get_num_resources(&resource);
+    Result * results = malloc(sizeof(Result) * CNWN_MAX(1, num_resources));
+    int num_results = 0;
+    int64_t total_executed = 0;
+    double total_seconds = 0;
+    double decode_seconds = 0;
+    for (int i = 0; i < num_resources; i++) {
+        cnwn_Resource view;
+        const cnwn_Resource * child = cnwn_resource_get_resource(&resource, i, &view);
+        if (child->type != CNWN_RESOURCE_TYPE_NCS)
+            continue;
+        Result * result = results + num_results++;
+        memset(result, 0, sizeof(Result));
+        cnwn_strcpy(result->name, sizeof(result->name), cnwn_resource_get_name(child), -1);
+        cnwn_Ncs ncs;
+        cnwn_NcsVm vm;
+        double start = now();
+        if (cnwn_ncs_init_from_file(&ncs, f, child->offset, child->size) < 0) {
+            result->status = CNWN_NCS_VM_STATUS_ERROR;
+            cnwn_strcpy(result->error, sizeof(result->error), cnwn_get_error(), -1);
+            continue;
+        }
+        if (cnwn_ncs_vm_init(&vm, &ncs, (nss_path != NULL ? &actions : NULL), NULL, NULL) < 0) {
+            result->status = CNWN_NCS_VM_STATUS_ERROR;
+            cnwn_strcpy(result->error, sizeof(result->error), cnwn_get_error(), -1);
+            cnwn_ncs_deinit(&ncs);
+            continue;
+        }
+        decode_seconds += now() - start;
+        result->num_instructions = ncs.num_instructions;
+        vm.max_instructions = max_instructions;
+        start = now();
+        for (int run = 0; run < runs; run++) {
+            if (cnwn_ncs_vm_run(&vm) < 0) {
+                cnwn_strcpy(result->error, sizeof(result->error), cnwn_get_error(), -1);
+                result->executed += vm.num_instructions;
+                break;
+            }
+            result->executed += vm.num_instructions;
+        }
+        result->seconds = now() - start;
+        result->status = vm.status;
+        total_executed += result->executed;
+        total_seconds += result->seconds;
+        cnwn_ncs_vm_deinit(&vm);
+        cnwn_ncs_deinit(&ncs);
+    }
+    qsort(results, num_results, sizeof(Result), compare_results);
+    printf("%-16s %8s %12s %12s %12s  %s\n", "script", "size", "instr/run", "usec/run", "Minstr/s", "status");
+    for (int i = 0; i < num_results; i++) {
+        const Result * result = results + i;
+        int used_runs = (result->status == CNWN_NCS_VM_STATUS_OK ? runs : 1);
+        printf("%-16s %8d %12"PRId64" %12.3f %12.2f  %s%s%s\n", result->name, result->num_instructions,
+               result->executed / used_runs, result->seconds * 1e6 / used_runs,
+               (result->seconds > 0 ? (double)result->executed / result->seconds * 1e-6 : 0.0),
+               cnwn_ncs_vm_status_name(result->status), (result->error[0] ? ": " : ""), result->error);
+    }
+    printf("Scripts: %d, runs: %d, decode: %.3f ms\n", num_results, runs, decode_seconds * 1e3);
+    printf("Executed %"PRId64" instructions in %.3f ms (%.2f Minstr/s, %s dispatch)\n", total_executed, total_seconds * 1e3,
+           (total_seconds > 0 ? (double)total_executed / total_seconds * 1e-6 : 0.0),
+#ifdef CNWN_NCS_VM_COMPUTED_GOTO
+           "computed goto"
+#else
+           "switch"
+#endif
+           );
+    free(results);
+    cnwn_resource_deinit(&resource);
+    cnwn_file_close(f);
+    if (nss_path != NULL)
+        cnwn_ncs_actions_deinit(&actions);
+    return 0;
+}
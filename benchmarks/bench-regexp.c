@@ -0,0 +1,82 @@
+#include <time.h>
+#include "cnwn/regexp.h"
+
+#define NUM_PATHS 100000
+#define NUM_PATTERNS 50
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t next_random(uint64_t * x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+int main(int argc, char * argv[])
+{
+    const char * extensions[] = {"2da", "dds", "tga", "mdl", "utc", "uti", "utp", "nss", "ncs", "wav"};
+    const char * prefixes[] = {"plc_", "it_", "c_", "tn_", "ttr01_", "x2_", "vfx_", "as_"};
+    uint64_t x = 0x9e3779b97f4a7c15ULL;
+    static char paths[NUM_PATHS][40];
+    for (int i = 0; i < NUM_PATHS; i++) {
+        char name[17];
+        int length = 4 + (int)(next_random(&x) % 9);
+        for (int j = 0; j < length; j++)
+            name[j] = "abcdefghijklmnopqrstuvwxyz0123456789"[next_random(&x) % 36];
+        name[length] = 0;
+        snprintf(paths[i], sizeof(paths[i]), "%s%s.%s", prefixes[next_random(&x) % 8], name, extensions[next_random(&x) % 10]);
+    }
+    // Filters that mostly miss, so every pattern has to be tried.
+    char patterns[NUM_PATTERNS][64];
+    const char * pattern_ptrs[NUM_PATTERNS];
+    for (int i = 0; i < NUM_PATTERNS; i++) {
+        switch (i % 5) {
+        case 0: snprintf(patterns[i], sizeof(patterns[i]), "\\.x%02d$", i); break;
+        case 1: snprintf(patterns[i], sizeof(patterns[i]), "^pfx%02d_", i); break;
+        case 2: snprintf(patterns[i], sizeof(patterns[i]), "it_.*_%02d[0-9]\\.uti$", i); break;
+        case 3: snprintf(patterns[i], sizeof(patterns[i]), "lit%02dq", i); break;
+        default: snprintf(patterns[i], sizeof(patterns[i]), "\\(zz%02d\\|yy%02d\\)_[a-z]*\\.nss", i, i); break;
+        }
+        pattern_ptrs[i] = patterns[i];
+    }
+    cnwn_RegexpArray * regexp_array = cnwn_regexp_array_new(NUM_PATTERNS, pattern_ptrs);
+    if (regexp_array == NULL) {
+        printf("ERROR: %s\n", cnwn_get_error());
+        return 1;
+    }
+    // One array per pattern, cnwn_regexp_array_match_all() on each is one regexec() like before.
+    cnwn_RegexpArray * singles[NUM_PATTERNS];
+    for (int i = 0; i < NUM_PATTERNS; i++)
+        singles[i] = cnwn_regexp_array_new(1, pattern_ptrs + i);
+
+    int num_matches = 0;
+    double start = now();
+    for (int i = 0; i < NUM_PATHS; i++) {
+        for (int j = 0; j < NUM_PATTERNS; j++) {
+            if (cnwn_regexp_array_match_all(singles[j], paths[i])) {
+                num_matches++;
+                break;
+            }
+        }
+    }
+    double seconds = now() - start;
+    printf("regexec per pattern: %d matches, %.3f s (%.1f ns/path)\n", num_matches, seconds, seconds * 1e9 / NUM_PATHS);
+    num_matches = 0;
+    start = now();
+    for (int i = 0; i < NUM_PATHS; i++)
+        if (cnwn_regexp_array_match_any(regexp_array, paths[i]))
+            num_matches++;
+    seconds = now() - start;
+    printf("cnwn_regexp_array_match_any: %d matches, %.3f s (%.1f ns/path)\n", num_matches, seconds, seconds * 1e9 / NUM_PATHS);
+    for (int i = 0; i < NUM_PATTERNS; i++)
+        cnwn_regexp_array_free(singles[i]);
+    cnwn_regexp_array_free(regexp_array);
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <time.h>
+#include "cnwn/resref.h"
+#include "cnwn/containers.h"
+
+#define NUM_NAMES 4096
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t next_random(uint64_t * x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}
+
+static void report(const char * name, int64_t operations, double seconds)
+{
+    printf("%-28s %10.2f ns/op\n", name, seconds * 1e9 / CNWN_MAX((double)operations, 1.0));
+}
+
+static uint32_t hash_lower_murmur3(const char * s)
+{
+    char tmps[CNWN_RESREF_MAX_LENGTH + 1];
+    int length = cnwn_strlower(tmps, sizeof(tmps), s);
+    return CNWN_DICT_DEFAULT_HASH(tmps, length);
+}
+
+int main(int argc, char * argv[])
+{
+    int64_t iterations = (argc > 1 ? CNWN_MAX(1, atoi(argv[1])) : 4) * (int64_t)1000000;
+    static char names[NUM_NAMES][17];
+    static char upper_names[NUM_NAMES][17];
+    static cnwn_ResRef resrefs[NUM_NAMES];
+    uint64_t x = 0x9e3779b97f4a7c15ULL;
+    for (int i = 0; i < NUM_NAMES; i++) {
+        // A shared prefix like most haks have ("plc_", "it_"...) makes the byte loops work for it.
+        int length = 8 + (int)(next_random(&x) % 9);
+        memcpy(names[i], "plc_", 4);
+        for (int j = 4; j < length; j++)
+            names[i][j] = "abcdefghijklmnopqrstuvwxyz0123456789_"[next_random(&x) % 37];
+        names[i][length] = 0;
+        cnwn_strupper(upper_names[i], sizeof(upper_names[i]), names[i]);
+        cnwn_resref_init(resrefs + i, names[i]);
+    }
+    int features = cnwn_cpu_features();
+    printf("CPU features 0x%x (%s)\n", features, (features & CNWN_CPU_FEATURE_AVX2 ? "avx2" : (features & CNWN_CPU_FEATURE_SSE2 ? "sse2" : "scalar")));
+    uint64_t sink = 0;
+
+    double start = now();
+    for (int64_t i = 0; i < iterations; i++)
+        sink += cnwn_strcmpi(names[i % NUM_NAMES], upper_names[(i * 7) % NUM_NAMES]);
+    report("cnwn_strcmpi", iterations, now() - start);
+    start = now();
+    for (int64_t i = 0; i < iterations; i++)
+        sink += cnwn_resref_strcmpi(names[i % NUM_NAMES], upper_names[(i * 7) % NUM_NAMES]);
+    report("cnwn_resref_strcmpi", iterations, now() - start);
+    start = now();
+    for (int64_t i = 0; i < iterations; i++)
+        sink += cnwn_resref_compare(resrefs + i % NUM_NAMES, resrefs + (i * 7) % NUM_NAMES);
+    report("cnwn_resref_compare", iterations, now() - start);
+    start = now();
+    for (int64_t i = 0; i < iterations; i++)
+        sink += cnwn_resref_equal(resrefs + i % NUM_NAMES, resrefs + (i * 7) % NUM_NAMES);
+    report("cnwn_resref_equal", iterations, now() - start);
+
+    start = now();
+    for (int64_t i = 0; i < iterations; i++)
+        sink += hash_lower_murmur3(upper_names[i % NUM_NAMES]);
+    report("cnwn_strlower + murmur3", iterations, now() - start);
+    start = now();
+    for (int64_t i = 0; i < iterations; i++)
+        sink += cnwn_resref_strhashi(upper_names[i % NUM_NAMES]);
+    report("cnwn_resref_strhashi", iterations, now() - start);
+    start = now();
+    for (int64_t i = 0; i < iterations; i++)
+        sink += cnwn_resref_hash(resrefs + i % NUM_NAMES);
+    report("cnwn_resref_hash", iterations, now() - start);
+
+    // Lookups among all names, each one scans half of the array on average.
+    int64_t lookups = CNWN_MAX(1, iterations / NUM_NAMES);
+    start = now();
+    for (int64_t i = 0; i < lookups; i++) {
+        const char * name = upper_names[(i * 7919) % NUM_NAMES];
+        for (int j = 0; j < NUM_NAMES; j++) {
+            if (cnwn_strcmpi(names[j], name) == 0) {
+                sink += j;
+                break;
+            }
+        }
+    }
+    report("find cnwn_strcmpi (per key)", lookups * NUM_NAMES / 2, now() - start);
+    start = now();
+    for (int64_t i = 0; i < lookups; i++) {
+        cnwn_ResRef resref;
+        cnwn_resref_init(&resref, upper_names[(i * 7919) % NUM_NAMES]);
+        sink += cnwn_resref_find(resrefs, 0, NUM_NAMES, &resref);
+    }
+    report("find cnwn_resref (per key)", lookups * NUM_NAMES / 2, now() - start);
+    printf("(%"PRIx64")\n", sink);
+    return 0;
+}
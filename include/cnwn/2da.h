@@ -0,0 +1,373 @@
+/**
+ * @file 2da.h
+ * Part of cnwn: Small C99 library and tools for Neverwinter Nights.
+ */
+#ifndef CNWN_2DA_H
+#define CNWN_2DA_H
+
+#include "cnwn/file_system.h"
+#include "cnwn/string.h"
+#include "cnwn/hash.h"
+
+/**
+ * The value used for empty (null) cells.
+ */
+#define CNWN_2DA_NULL_VALUE "****"
+
+/**
+ * The magic (type and version) of a binary 2DA cache file.
+ */
+#define CNWN_2DA_CACHE_MAGIC "2DC V1.1"
+
+/**
+ * The filename extension of binary 2DA cache files.
+ */
+#define CNWN_2DA_CACHE_EXTENSION "2dc"
+
+/**
+ * The size of a binary 2DA cache header (in bytes).
+ */
+#define CNWN_2DA_CACHE_HEADER_SIZE 64
+
+/**
+ * The size of a column entry in a binary 2DA cache file (in bytes).
+ */
+#define CNWN_2DA_CACHE_COLUMN_SIZE 32
+
+/**
+ * Check if a bit is set in a bitmap.
+ * @param bitmap The bitmap.
+ * @param index The bit index.
+ * @returns True if the bit is set, false if not.
+ */
+#define CNWN_2DA_BIT(bitmap, index) (((bitmap)[(index) >> 3] >> ((index) & 7)) & 1)
+
+/**
+ * @see struct cnwn_2DA_s
+ */
+typedef struct cnwn_2DA_s cnwn_2DA;
+
+/**
+ * @see struct cnwn_2DAColumn_s
+ */
+typedef struct cnwn_2DAColumn_s cnwn_2DAColumn;
+
+/**
+ * A column in a 2DA table.
+ *
+ * The int and float arrays are converted from the strings the first time they are requested.
+ */
+struct cnwn_2DAColumn_s {
+
+    /**
+     * The column name.
+     */
+    const char * name;
+
+    /**
+     * The string pool offsets of the cells, one per row.
+     */
+    uint32_t * offsets;
+
+    /**
+     * Null bitmap, one bit per row set for "****" and missing cells.
+     */
+    uint8_t * nulls;
+
+    /**
+     * The cells converted to ints, NULL if not converted yet.
+     */
+    int32_t * ints;
+
+    /**
+     * Bitmap with one bit per row set if the cell is a valid int, NULL if not converted yet.
+     */
+    uint8_t * ints_valid;
+
+    /**
+     * The cells converted to floats, NULL if not converted yet.
+     */
+    float * floats;
+
+    /**
+     * Bitmap with one bit per row set if the cell is a valid float, NULL if not converted yet.
+     */
+    uint8_t * floats_valid;
+};
+
+/**
+ * A 2DA V2.0 table stored in columns.
+ *
+ * All strings (column names, row labels and cells) are zero terminated strings in a single string pool,
+ * each column keeps an array of pool offsets.
+ *
+ * A table can also be loaded from a binary cache file, a little endian memory image of the table:
+ * a header, a column directory, the string pool, the row labels and for each column the pool offsets,
+ * the null bitmap and the int/float arrays with their validity bitmaps. The file is mapped and the
+ * columns point directly into the mapped data.
+ */
+struct cnwn_2DA_s {
+
+    /**
+     * The mapped cache file, empty if the table was parsed from text.
+     */
+    cnwn_FileMap map;
+
+    /**
+     * The string pool.
+     */
+    char * pool;
+
+    /**
+     * The size of the string pool (in bytes).
+     */
+    int64_t pool_size;
+
+    /**
+     * The xxh64 hash of the 2DA text the table was parsed from (stored in cache files).
+     */
+    uint64_t source_hash;
+
+    /**
+     * The size of the 2DA text the table was parsed from (in bytes, stored in cache files).
+     */
+    int64_t source_size;
+
+    /**
+     * The default value or NULL if none was specified.
+     */
+    const char * default_value;
+
+    /**
+     * The number of rows.
+     */
+    int num_rows;
+
+    /**
+     * The number of columns.
+     */
+    int num_columns;
+
+    /**
+     * The string pool offsets of the row labels.
+     */
+    uint32_t * row_labels;
+
+    /**
+     * The columns.
+     */
+    cnwn_2DAColumn * columns;
+
+    /**
+     * Hash table (open addressing) for case-insensitive column name lookups, column index + 1 or zero for empty buckets.
+     */
+    int * column_buckets;
+
+    /**
+     * The number of column buckets (a power of two).
+     */
+    int num_column_buckets;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initialize a 2DA table from a memory buffer.
+ * @param tda The 2DA table to initialize.
+ * @param data The 2DA file data (it will be copied).
+ * @param size The size of @p data (in bytes).
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_2da_init_from_buffer(cnwn_2DA * tda, const void * data, int64_t size);
+
+/**
+ * Initialize a 2DA table from a file.
+ * @param tda The 2DA table to initialize.
+ * @param f The file to read from.
+ * @param offset The offset of the 2DA data in @p f.
+ * @param size The size of the 2DA data (in bytes).
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_2da_init_from_file(cnwn_2DA * tda, cnwn_File * f, int64_t offset, int64_t size);
+
+/**
+ * Initialize a 2DA table from a path.
+ * @param tda The 2DA table to initialize.
+ * @param path The path to the 2DA file.
+ * @returns Zero on success or a negative value on error.
+ * @note If there is a cache file next to @p path (see cnwn_2da_cache_path()) that was built from a file with
+ * the same size and content hash it is loaded instead, @p path is then only read to hash it. A path ending
+ * with .2dc is always loaded as a cache file.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_2da_init_from_path(cnwn_2DA * tda, const char * path);
+
+/**
+ * Initialize a 2DA table from a binary cache file.
+ * @param tda The 2DA table to initialize.
+ * @param path The path to the cache file.
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_2da_init_from_cache(cnwn_2DA * tda, const char * path);
+
+/**
+ * Get the cache path for a 2DA path (the .2da extension replaced by .2dc).
+ * @param[out] r Return the cache path here, NULL to get the required length.
+ * @param max_size The maximum size of the return string (including zero terminator).
+ * @param path The path to the 2DA file.
+ * @returns The length of the cache path (excluding zero terminator).
+ */
+extern CNWN_PUBLIC int cnwn_2da_cache_path(char * r, int max_size, const char * path);
+
+/**
+ * Write a 2DA table as a binary cache file.
+ * @param tda The 2DA table, all columns will be converted to ints and floats.
+ * @param f The file to write to.
+ * @returns The number of written bytes or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note The size and hash of the text @p tda was parsed from are stored in the cache header, so
+ * cnwn_2da_init_from_path() only uses the cache while the text is unchanged.
+ */
+extern CNWN_PUBLIC int64_t cnwn_2da_write_cache(cnwn_2DA * tda, cnwn_File * f);
+
+/**
+ * Deinitialize a 2DA table.
+ * @param tda The 2DA table to deinitialize.
+ */
+extern CNWN_PUBLIC void cnwn_2da_deinit(cnwn_2DA * tda);
+
+/**
+ * Get the number of rows.
+ * @param tda The 2DA table.
+ * @returns The number of rows.
+ */
+extern CNWN_PUBLIC int cnwn_2da_get_num_rows(const cnwn_2DA * tda);
+
+/**
+ * Get the number of columns.
+ * @param tda The 2DA table.
+ * @returns The number of columns.
+ */
+extern CNWN_PUBLIC int cnwn_2da_get_num_columns(const cnwn_2DA * tda);
+
+/**
+ * Get a column name.
+ * @param tda The 2DA table.
+ * @param column The column index.
+ * @returns The column name or NULL if @p column is out of range.
+ */
+extern CNWN_PUBLIC const char * cnwn_2da_get_column_name(const cnwn_2DA * tda, int column);
+
+/**
+ * Find a column by name (ASCII case-insensitive).
+ * @param tda The 2DA table.
+ * @param name The column name.
+ * @returns The column index or a negative value if there is no such column.
+ */
+extern CNWN_PUBLIC int cnwn_2da_find_column(const cnwn_2DA * tda, const char * name);
+
+/**
+ * Get a row label.
+ * @param tda The 2DA table.
+ * @param row The row index.
+ * @returns The row label or NULL if @p row is out of range.
+ */
+extern CNWN_PUBLIC const char * cnwn_2da_get_row_label(const cnwn_2DA * tda, int row);
+
+/**
+ * Check if a cell is null ("****" or missing).
+ * @param tda The 2DA table.
+ * @param row The row index.
+ * @param column The column index.
+ * @returns True if the cell is null or out of range, false if not.
+ */
+extern CNWN_PUBLIC bool cnwn_2da_is_null(const cnwn_2DA * tda, int row, int column);
+
+/**
+ * Get the string in a cell.
+ * @param tda The 2DA table.
+ * @param row The row index.
+ * @param column The column index.
+ * @returns The string, NULL if the cell is null or the default value (may be NULL) if @p row is out of range.
+ */
+extern CNWN_PUBLIC const char * cnwn_2da_get_string(const cnwn_2DA * tda, int row, int column);
+
+/**
+ * Get the string in a cell using a column name.
+ * @param tda The 2DA table.
+ * @param row The row index.
+ * @param column_name The column name.
+ * @returns The string, NULL if the cell is null or the default value (may be NULL) if @p row is out of range.
+ */
+extern CNWN_PUBLIC const char * cnwn_2da_get_string2(const cnwn_2DA * tda, int row, const char * column_name);
+
+/**
+ * Get a column converted to ints.
+ * @param tda The 2DA table.
+ * @param column The column index.
+ * @param[out] ret_valid Return a bitmap with one bit per row set if the cell is a valid int, pass NULL to ignore.
+ * @returns An array with one int per row (zero for invalid cells) or NULL if @p column is out of range.
+ * @note The column is converted the first time it is requested, the arrays are owned by @p tda.
+ */
+extern CNWN_PUBLIC const int32_t * cnwn_2da_get_int_column(cnwn_2DA * tda, int column, const uint8_t ** ret_valid);
+
+/**
+ * Get a column converted to floats.
+ * @param tda The 2DA table.
+ * @param column The column index.
+ * @param[out] ret_valid Return a bitmap with one bit per row set if the cell is a valid float, pass NULL to ignore.
+ * @returns An array with one float per row (zero for invalid cells) or NULL if @p column is out of range.
+ * @note The column is converted the first time it is requested, the arrays are owned by @p tda.
+ */
+extern CNWN_PUBLIC const float * cnwn_2da_get_float_column(cnwn_2DA * tda, int column, const uint8_t ** ret_valid);
+
+/**
+ * Get the int in a cell.
+ * @param tda The 2DA table.
+ * @param row The row index.
+ * @param column The column index.
+ * @param[out] ret_value Return the value, pass NULL to ignore.
+ * @returns True if the cell has a valid int, false if not.
+ */
+extern CNWN_PUBLIC bool cnwn_2da_get_int(cnwn_2DA * tda, int row, int column, int32_t * ret_value);
+
+/**
+ * Get the int in a cell using a column name.
+ * @param tda The 2DA table.
+ * @param row The row index.
+ * @param column_name The column name.
+ * @param[out] ret_value Return the value, pass NULL to ignore.
+ * @returns True if the cell has a valid int, false if not.
+ */
+extern CNWN_PUBLIC bool cnwn_2da_get_int2(cnwn_2DA * tda, int row, const char * column_name, int32_t * ret_value);
+
+/**
+ * Get the float in a cell.
+ * @param tda The 2DA table.
+ * @param row The row index.
+ * @param column The column index.
+ * @param[out] ret_value Return the value, pass NULL to ignore.
+ * @returns True if the cell has a valid float, false if not.
+ */
+extern CNWN_PUBLIC bool cnwn_2da_get_float(cnwn_2DA * tda, int row, int column, float * ret_value);
+
+/**
+ * Get the float in a cell using a column name.
+ * @param tda The 2DA table.
+ * @param row The row index.
+ * @param column_name The column name.
+ * @param[out] ret_value Return the value, pass NULL to ignore.
+ * @returns True if the cell has a valid float, false if not.
+ */
+extern CNWN_PUBLIC bool cnwn_2da_get_float2(cnwn_2DA * tda, int row, const char * column_name, float * ret_value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
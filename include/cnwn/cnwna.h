@@ -8,7 +8,55 @@
 #include "cnwn/options.h"
 #include "cnwn/containers.h"
 #include "cnwn/regexp.h"
+#include "cnwn/filter.h"
 #include "cnwn/resource.h"
+#include "cnwn/tlk.h"
+#include "cnwn/2da.h"
+#include "cnwn/texture.h"
+#include "cnwn/erf.h"
+#include "cnwn/hash.h"
+#include "cnwn/nwsync.h"
+
+/**
+ * Output formats for the list command.
+ */
+enum cnwn_CNWNAFormat_e {
+
+    /**
+     * Human readable text, one line per resource.
+     */
+    CNWN_CNWNA_FORMAT_TEXT = 0,
+
+    /**
+     * One JSON array with an object per resource.
+     */
+    CNWN_CNWNA_FORMAT_JSON = 1,
+
+    /**
+     * One JSON object per line.
+     */
+    CNWN_CNWNA_FORMAT_JSONL = 2,
+
+    /**
+     * Tab separated values with a header line.
+     */
+    CNWN_CNWNA_FORMAT_TSV = 3,
+
+    /**
+     * No output, the archives are still read.
+     */
+    CNWN_CNWNA_FORMAT_NULL = 4,
+
+    /**
+     * Upper bound.
+     */
+    CNWN_CNWNA_MAX_FORMAT
+};
+
+/**
+ * @see enum cnwn_CNWNAFormat_e
+ */
+typedef enum cnwn_CNWNAFormat_e cnwn_CNWNAFormat;
 
 /**
  * @see struct cnwn_CNWNASettings_s
@@ -55,6 +103,11 @@ struct cnwn_CNWNASettings_s {
      */
     bool verbose;
     
+    /**
+     * Print totals.
+     */
+    bool totals;
+
     /**
      * Recursion depth.
      */
@@ -64,6 +117,46 @@ struct cnwn_CNWNASettings_s {
      * Output path.
      */
     char * output_path;
+
+    /**
+     * Treat a TLK as a base TLK (strrefs without the custom bit).
+     */
+    bool tlk_base;
+
+    /**
+     * Number of worker threads, zero for one per CPU.
+     */
+    int jobs;
+
+    /**
+     * Write binary output.
+     */
+    bool binary;
+
+    /**
+     * Content store path.
+     */
+    char * store_path;
+
+    /**
+     * Filter expression for list and extract.
+     */
+    char * filter;
+
+    /**
+     * Compression codec.
+     */
+    int compression;
+
+    /**
+     * Output format.
+     */
+    int format;
+
+    /**
+     * List directories as archives instead of searching them for archives.
+     */
+    bool directories;
 };
 
 #ifdef __cplusplus
@@ -85,6 +178,41 @@ extern CNWN_PUBLIC const cnwn_Option CNWN_CNWNA_OPTIONS_EXTRACT[];
  */
 extern CNWN_PUBLIC const cnwn_Option CNWN_CNWNA_OPTIONS_CREATE[];
 
+/**
+ * TLK compact command options.
+ */
+extern CNWN_PUBLIC const cnwn_Option CNWN_CNWNA_OPTIONS_TLK_COMPACT[];
+
+/**
+ * 2DA cache command options.
+ */
+extern CNWN_PUBLIC const cnwn_Option CNWN_CNWNA_OPTIONS_2DA_CACHE[];
+
+/**
+ * Dedupe command options.
+ */
+extern CNWN_PUBLIC const cnwn_Option CNWN_CNWNA_OPTIONS_DEDUPE[];
+
+/**
+ * Manifest command options.
+ */
+extern CNWN_PUBLIC const cnwn_Option CNWN_CNWNA_OPTIONS_MANIFEST[];
+
+/**
+ * ERF compress command options.
+ */
+extern CNWN_PUBLIC const cnwn_Option CNWN_CNWNA_OPTIONS_ERF_COMPRESS[];
+
+/**
+ * NWSync verify command options.
+ */
+extern CNWN_PUBLIC const cnwn_Option CNWN_CNWNA_OPTIONS_NWSYNC_VERIFY[];
+
+/**
+ * NWSync diff command options.
+ */
+extern CNWN_PUBLIC const cnwn_Option CNWN_CNWNA_OPTIONS_NWSYNC_DIFF[];
+
 /**
  * Check if the help option is in any of the arguments.
  * @param argc The number of arguments.
@@ -141,10 +269,17 @@ extern CNWN_PUBLIC int cnwn_cnwna_print_version(void);
  */
 extern CNWN_PUBLIC int cnwn_cnwna_execute(const cnwn_CNWNASettings * settings);
 
+/**
+ * Get a list output format from its name.
+ * @param name The name of the format, "text", "json", "jsonl", "tsv" or "null" (case insensitive).
+ * @returns The format or a negative value if @p name is not a format.
+ */
+extern CNWN_PUBLIC int cnwn_cnwna_format_from_name(const char * name);
+
 /**
  * Execute the list command (the command in settings will be ignored).
  * @param path The path to the file to list from.
- * @param verbose True for verbose stdout output.
+ * @param verbose True for verbose stdout output, texture headers (DDS, TGA, PLT and TEX) are probed for dimensions, format and VRAM size.
  * @param depth The number of levels to recurse listion, a negative value will disable the limit.
  * @param regexps Regular expressions to filter what will be listed, NULL for no filter.
  * @returns The number of listed items or a negative value on error.
@@ -152,9 +287,29 @@ extern CNWN_PUBLIC int cnwn_cnwna_execute(const cnwn_CNWNASettings * settings);
  */
 extern CNWN_PUBLIC int cnwn_cnwna_execute_list(const char * path, bool verbose, int depth, const cnwn_RegexpArray * regexps);
 
+/**
+ * Execute the list command for several archives, the archives are read in parallel and listed in input order.
+ * @param path The path to the first archive or a directory of archives.
+ * @param paths More archives or directories, NULL for none.
+ * @param verbose True for verbose stdout output.
+ * @param totals True to print totals and the number of resources per type.
+ * @param depth The number of levels to recurse listion, a negative value will disable the limit.
+ * @param jobs The number of threads reading archives, zero for one per CPU.
+ * @param regexps Regular expressions to filter what will be listed, NULL for no filter.
+ * @param filter A filter expression on resource metadata to filter what will be listed, NULL for no filter.
+ * @param format The output format.
+ * @param directories True to list directories as archives of the files in them.
+ * @returns The number of listed items or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note Directories are searched recursively for haks, modules and ERFs unless @p directories. Each archive gets a
+ * header line unless @p path is the only archive. Other formats than CNWN_CNWNA_FORMAT_TEXT have no header lines or
+ * totals, every resource and meta file is a record with the archive, path, type and size (and more with @p verbose).
+ */
+extern CNWN_PUBLIC int cnwn_cnwna_execute_list2(const char * path, const cnwn_StringArray * paths, bool verbose, bool totals, int depth, int jobs, const cnwn_RegexpArray * regexps, const cnwn_Filter * filter, cnwn_CNWNAFormat format, bool directories);
+
 /**
  * Execute the extract command (the command in settings will be ignored).
- * @param path The path to the file to extract from.
+ * @param path The path to the file (or directory) to extract from.
  * @param quiet True for no stdout output.
  * @param depth The number of levels to recurse extraction, a negative value will disable the limit.
  * @param regexps Regular expressions to filter what will be extracted, NULL for no filter.
@@ -164,6 +319,19 @@ extern CNWN_PUBLIC int cnwn_cnwna_execute_list(const char * path, bool verbose,
  */
 extern CNWN_PUBLIC int cnwn_cnwna_execute_extract(const char * path, bool quiet, int depth, const cnwn_RegexpArray * regexps, const char * output_path);
 
+/**
+ * Execute the extract command with a filter expression (the command in settings will be ignored).
+ * @param path The path to the file (or directory) to extract from.
+ * @param quiet True for no stdout output.
+ * @param depth The number of levels to recurse extraction, a negative value will disable the limit.
+ * @param regexps Regular expressions to filter what will be extracted, NULL for no filter.
+ * @param filter A filter expression on resource metadata to filter what will be extracted, NULL for no filter.
+ * @param output_path The path to output the extracted files and directories.
+ * @returns The number of extracted items or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_cnwna_execute_extract2(const char * path, bool quiet, int depth, const cnwn_RegexpArray * regexps, const cnwn_Filter * filter, const char * output_path);
+
 /**
  * Execute the create command (the command in settings will be ignored).
  * @param path The path to the file to create.
@@ -174,6 +342,93 @@ extern CNWN_PUBLIC int cnwn_cnwna_execute_extract(const char * path, bool quiet,
  */
 extern CNWN_PUBLIC int cnwn_cnwna_execute_create(const char * path, bool quiet, int depth, const cnwn_StringArray * paths);
 
+/**
+ * Execute the TLK compact command (the command in settings will be ignored).
+ * @param path The path to the TLK file to compact.
+ * @param quiet True for no stdout output.
+ * @param base True if the TLK is a base TLK, false if it is a custom TLK (strrefs with CNWN_TLK_STRREF_CUSTOM set).
+ * @param paths Modules, haks and 2DA files to scan for used strrefs, NULL or empty to keep all entries.
+ * @param output_path The path to write the compacted TLK to.
+ * @returns The number of entries in the compacted TLK or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note Identical strings are always deduplicated, entries that are not referenced are cleared.
+ */
+extern CNWN_PUBLIC int cnwn_cnwna_execute_tlk_compact(const char * path, bool quiet, bool base, const cnwn_StringArray * paths, const char * output_path);
+
+/**
+ * Execute the 2DA cache command (the command in settings will be ignored).
+ * @param path A 2DA file, hak/module or directory (e.g. override) to build 2DA cache files for.
+ * @param quiet True for no stdout output.
+ * @param paths More 2DA files, haks/modules and directories, NULL or empty for none.
+ * @param output_path The directory to write the cache files to, NULL to write them next to each 2DA file or hak.
+ * @returns The number of written cache files or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note Cache files are written in argument order, a 2DA in a later path replaces the cache of an earlier one.
+ */
+extern CNWN_PUBLIC int cnwn_cnwna_execute_2da_cache(const char * path, bool quiet, const cnwn_StringArray * paths, const char * output_path);
+
+/**
+ * Execute the dedupe command (the command in settings will be ignored).
+ * @param path The first hak/module (highest priority).
+ * @param quiet True for no stdout output.
+ * @param paths More haks/modules in priority order, NULL or empty for none.
+ * @param output_path The directory to write haks without shadowed resources to, NULL to only report.
+ * @returns The number of shadowed resources and redundant duplicate copies or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note A resource is shadowed when an earlier archive has a resource with the same name and type, the game never
+ * loads it. Duplicates are resources with identical content (size and xxHash64), only resources with a size shared
+ * by another resource are hashed. Payloads are read in chunks so memory use does not depend on the archive sizes.
+ */
+extern CNWN_PUBLIC int cnwn_cnwna_execute_dedupe(const char * path, bool quiet, const cnwn_StringArray * paths, const char * output_path);
+
+/**
+ * Execute the manifest command (the command in settings will be ignored).
+ * @param path The first hak/module or directory of loose resources (highest priority).
+ * @param quiet True for no summary on stdout.
+ * @param paths More haks/modules and directories in priority order, NULL or empty for none.
+ * @param output_path The file to write the manifest to, NULL for stdout.
+ * @param jobs The number of threads hashing resources, zero for one per CPU.
+ * @param binary True to write a binary NWSync manifest (NSYC) instead of text.
+ * @param store_path The content store to copy the resources into, NULL for none.
+ * @returns The number of manifest entries or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note Each line is "sha1 resref type size" sorted by resref and type, a resource shadowed by an earlier path is left out.
+ * A binary manifest without @p output_path is written to the store as manifests/<sha1 of the manifest>.
+ */
+extern CNWN_PUBLIC int cnwn_cnwna_execute_manifest(const char * path, bool quiet, const cnwn_StringArray * paths, const char * output_path, int jobs, bool binary, const char * store_path);
+
+/**
+ * Execute the ERF compress command (the command in settings will be ignored).
+ * @param path The hak or module.
+ * @param quiet True for no stdout output.
+ * @param compression The codec for the resources, CNWN_COMPRESSION_NONE to decompress them.
+ * @param output_path The file to write the new hak or module to.
+ * @returns The number of resources or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_cnwna_execute_erf_compress(const char * path, bool quiet, cnwn_Compression compression, const char * output_path);
+
+/**
+ * Execute the NWSync verify command (the command in settings will be ignored).
+ * @param path The content store.
+ * @param quiet True to only print the summary.
+ * @param manifest_path The NSYC manifest to verify the store against.
+ * @returns The number of verified entries or a negative value on error (or if any content is missing or broken).
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_cnwna_execute_nwsync_verify(const char * path, bool quiet, const char * manifest_path);
+
+/**
+ * Execute the NWSync diff command (the command in settings will be ignored).
+ * @param path The old NSYC manifest (what a client has).
+ * @param quiet True for no summary on stdout.
+ * @param other_path The new NSYC manifest (what a client wants).
+ * @param store_path The content store of the client, content in it is not listed as needed. NULL for none.
+ * @returns The number of added, changed and removed entries or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note Added or changed entries are printed as "+ sha1 resref.type size", removed entries as "- resref.type".
+ */
+extern CNWN_PUBLIC int cnwn_cnwna_execute_nwsync_diff(const char * path, bool quiet, const char * other_path, const char * store_path);
 
 
 #ifdef __cplusplus
@@ -81,10 +81,49 @@
 #define CNWN_MINMAX(x_, a_, b_) ((a_) < (b_) ? CNWN_MIN(b_, CNWN_MAX(x_, a_)) : CNWN_MIN(a_, CNWN_MAX(x_, b_)))
 #endif
 
+#ifndef CNWN_THREAD_LOCAL
+#if defined(__GNUC__)
+#define CNWN_THREAD_LOCAL __thread
+#else
+#define CNWN_THREAD_LOCAL
+#endif
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#ifndef CNWN_X86
+#define CNWN_X86
+#endif
+#endif
+
 /**
  * @endcond
  */
 
+/**
+ * CPU feature: SSE2.
+ */
+#define CNWN_CPU_FEATURE_SSE2 0x1
+
+/**
+ * CPU feature: SSE4.2.
+ */
+#define CNWN_CPU_FEATURE_SSE42 0x2
+
+/**
+ * CPU feature: AVX2 (CPU and OS support).
+ */
+#define CNWN_CPU_FEATURE_AVX2 0x4
+
+/**
+ * CPU feature: carry-less multiplication (PCLMULQDQ).
+ */
+#define CNWN_CPU_FEATURE_PCLMUL 0x8
+
+/**
+ * CPU feature: SHA extensions.
+ */
+#define CNWN_CPU_FEATURE_SHA 0x10
+
 /**
  * @see struct cnwn_Version_e
  */
@@ -113,6 +152,7 @@ extern "C" {
 /**
  * Get the last error message.
  * @returns A pointer to the last error message, never NULL.
+ * @note The error message is per thread when the compiler supports thread local storage.
  */
 extern CNWN_PUBLIC const char * cnwn_get_error(void);
 
@@ -129,6 +169,13 @@ extern CNWN_PUBLIC void cnwn_set_error_va(const char * format, va_list args);
  */
 extern CNWN_PUBLIC void cnwn_set_error(const char * format, ...) CNWN_PRINTF(1, 2);
 
+/**
+ * Get the features supported by the CPU.
+ * @returns A combination of CNWN_CPU_FEATURE_SSE2 and friends, zero on non-x86 platforms.
+ * @note The features can be limited by setting the CNWN_CPU_FEATURES environment variable to a mask (e.g. 0 to disable all SIMD code).
+ */
+extern CNWN_PUBLIC int cnwn_cpu_features(void);
+
 #ifdef __cplusplus
 }
 #endif
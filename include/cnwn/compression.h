@@ -0,0 +1,132 @@
+/**
+ * @file compression.h
+ * Part of cnwn: Small C99 library and tools for Neverwinter Nights.
+ */
+#ifndef CNWN_COMPRESSION_H
+#define CNWN_COMPRESSION_H
+
+#include "cnwn/file_system.h"
+
+/**
+ * The magic at the start of compressed data.
+ */
+#define CNWN_COMPRESSION_MAGIC "CNWC"
+
+/**
+ * The size of the header in front of compressed data (in bytes).
+ *
+ * Magic, header version, codec and uncompressed size (all 32-bit little endian after the magic) followed by
+ * four reserved bytes.
+ */
+#define CNWN_COMPRESSION_HEADER_SIZE 20
+
+/**
+ * The header version.
+ */
+#define CNWN_COMPRESSION_HEADER_VERSION 1
+
+/**
+ * Compression codecs.
+ */
+enum cnwn_Compression_e {
+
+    /**
+     * Not compressed.
+     */
+    CNWN_COMPRESSION_NONE = 0,
+
+    /**
+     * zlib (deflate).
+     */
+    CNWN_COMPRESSION_ZLIB = 1,
+
+    /**
+     * Zstandard, recognized but only supported if the library was built with it.
+     */
+    CNWN_COMPRESSION_ZSTD = 2,
+
+    /**
+     * Upper bound.
+     */
+    CNWN_MAX_COMPRESSION
+};
+
+/**
+ * @see enum cnwn_Compression_e
+ */
+typedef enum cnwn_Compression_e cnwn_Compression;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Get the name of a codec.
+ * @param compression The codec.
+ * @returns The name of the codec ("none", "zlib" or "zstd"), an empty string for invalid values.
+ */
+extern CNWN_PUBLIC const char * cnwn_compression_name(cnwn_Compression compression);
+
+/**
+ * Get a codec from its name.
+ * @param name The name of the codec (case insensitive).
+ * @returns The codec or a negative value if @p name is not a codec.
+ */
+extern CNWN_PUBLIC int cnwn_compression_from_name(const char * name);
+
+/**
+ * Check if a codec is supported by this build.
+ * @param compression The codec.
+ * @returns True if data can be compressed and decompressed with @p compression.
+ */
+extern CNWN_PUBLIC bool cnwn_compression_supported(cnwn_Compression compression);
+
+/**
+ * Parse the header in front of compressed data.
+ * @param data The data (at least CNWN_COMPRESSION_HEADER_SIZE bytes).
+ * @param size The size of @p data (in bytes).
+ * @param[out] ret_compression Return the codec, pass NULL to ignore.
+ * @param[out] ret_uncompressed_size Return the uncompressed size (in bytes), pass NULL to ignore.
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_compression_read_header(const void * data, int64_t size, cnwn_Compression * ret_compression, int64_t * ret_uncompressed_size);
+
+/**
+ * Compress a buffer, the result starts with a header.
+ * @param compression The codec.
+ * @param data The data to compress.
+ * @param size The size of @p data (in bytes).
+ * @param[out] ret_data Return the compressed data here.
+ * @param max_size The size of @p ret_data (in bytes).
+ * @returns The size of the compressed data (header included), zero if it does not fit in @p max_size or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int64_t cnwn_compression_compress(cnwn_Compression compression, const void * data, int64_t size, void * ret_data, int64_t max_size);
+
+/**
+ * Decompress a buffer.
+ * @param data The compressed data (header included).
+ * @param size The size of @p data (in bytes).
+ * @param[out] ret_data Return the decompressed data here.
+ * @param max_size The size of @p ret_data (in bytes), must fit the uncompressed size from the header.
+ * @returns The size of the decompressed data or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int64_t cnwn_compression_decompress(const void * data, int64_t size, void * ret_data, int64_t max_size);
+
+/**
+ * Decompress from a file to a file in chunks, memory use does not depend on the data size.
+ * @param input_f The file to read the compressed data (header included) from, from the current position.
+ * @param size The size of the compressed data (in bytes).
+ * @param output_f The file to write the decompressed data to.
+ * @returns The number of bytes written to @p output_f or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int64_t cnwn_compression_decompress_file(cnwn_File * input_f, int64_t size, cnwn_File * output_f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
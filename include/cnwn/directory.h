@@ -0,0 +1,40 @@
+/**
+ * @file directory.h
+ * Part of cnwn: Small C99 library and tools for Neverwinter Nights.
+ */
+#ifndef CNWN_DIRECTORY_H
+#define CNWN_DIRECTORY_H
+
+#include "cnwn/file_system.h"
+#include "cnwn/resource.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Directory resource handler, set it for CNWN_RESOURCE_TYPE_DIRECTORY to open override and development directories
+ * with cnwn_resource_init_from_path() like archives.
+ */
+extern CNWN_PUBLIC const cnwn_ResourceHandler CNWN_RESOURCE_HANDLER_DIRECTORY;
+
+/**
+ * Default handler for directories, adds the files in the directory as child resources sorted by filename.
+ * @param resource The resource struct to initialize.
+ * @param path The path to the directory, a path that is not a directory (a res file) adds nothing.
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note Subdirectories and files without a resource name and type (name.ext, one dot) are skipped, of files that only
+ * differ in case the first in byte order is used. Each child resource is read from its own file, archives in the
+ * directory are initialized as nested containers.
+ *
+ * The directory is read in one pass with getdents64() where available and classified by the entry type it returns,
+ * only the files that are kept are stat'ed (for the size). Other systems use readdir().
+ */
+extern CNWN_PUBLIC int cnwn_resource_init_from_path_directory(cnwn_Resource * resource, const char * path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
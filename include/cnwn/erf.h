@@ -67,6 +67,34 @@ extern CNWN_PUBLIC int cnwn_resource_get_meta_file_erf(const cnwn_Resource * res
  */
 extern CNWN_PUBLIC int64_t cnwn_resource_meta_file_extract_erf(const cnwn_Resource * resource, int index, cnwn_File * input_f, cnwn_File * output_f);
 
+/**
+ * Write a copy of an ERF with a subset of its resources, resource data is copied from @p input_f in chunks.
+ * @param resource The ERF resource.
+ * @param input_f The file to read the ERF from.
+ * @param keep One flag per subresource, true to keep the subresource, NULL to keep all.
+ * @param output_f The file to write the new ERF to.
+ * @returns The number of bytes written to @p output_f or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note The header fields (type, version, localized strings, build date and description) are copied as is.
+ */
+extern CNWN_PUBLIC int64_t cnwn_erf_write_subset(const cnwn_Resource * resource, cnwn_File * input_f, const bool * keep, cnwn_File * output_f);
+
+/**
+ * Write a copy of an ERF with a subset of its resources and (re)compress the resources.
+ * @param resource The ERF resource.
+ * @param input_f The file to read the ERF from.
+ * @param keep One flag per subresource, true to keep the subresource, NULL to keep all.
+ * @param compression The codec for the written resources, a negative value to copy each resource as stored.
+ * @param output_f The file to write the new ERF to.
+ * @returns The number of bytes written to @p output_f or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note Each resource is compressed on its own so random access still works, a resource that does not get smaller
+ * is stored uncompressed. The codec is stored in the reserved field of the key, which other tools ignore. A reserved
+ * field with an unknown codec or without a matching compression header is read as an uncompressed resource.
+ * Resources that are (re)compressed are read into memory one at a time.
+ */
+extern CNWN_PUBLIC int64_t cnwn_erf_write_subset2(const cnwn_Resource * resource, cnwn_File * input_f, const bool * keep, int compression, cnwn_File * output_f);
+
 #ifdef __cplusplus
 }
 #endif
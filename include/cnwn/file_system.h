@@ -23,6 +23,37 @@
  */
 typedef struct cnwn_File_s cnwn_File;
 
+/**
+ * @see struct cnwn_FileMap_s
+ */
+typedef struct cnwn_FileMap_s cnwn_FileMap;
+
+/**
+ * A read only memory mapped view of (a part of) a file.
+ */
+struct cnwn_FileMap_s {
+
+    /**
+     * The mapped bytes, NULL if the view is empty.
+     */
+    const uint8_t * data;
+
+    /**
+     * The number of mapped bytes.
+     */
+    int64_t size;
+
+    /**
+     * The page aligned base of the mapping (internal).
+     */
+    void * base;
+
+    /**
+     * The size of the mapping from base (internal).
+     */
+    int64_t base_size;
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -127,6 +158,14 @@ extern CNWN_PUBLIC int cnwn_file_system_isfile(const char * path);
  */
 extern CNWN_PUBLIC int cnwn_file_system_isdirectory(const char * path);
 
+/**
+ * Get the modification time of a path.
+ * @param path The path.
+ * @returns The modification time (seconds since the epoch) or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int64_t cnwn_file_system_mtime(const char * path);
+
 /**
  * Open a file.
  * @param path The path to the file.
@@ -368,6 +407,33 @@ extern CNWN_PUBLIC int64_t cnwn_file_size(cnwn_File * f);
  */
 extern CNWN_PUBLIC int64_t cnwn_file_copy(cnwn_File * f, int64_t size, cnwn_File * output_f);
 
+/**
+ * Map a part of a file into memory (read only).
+ * @param f The file to map.
+ * @param offset The offset in the file where the view starts, does not have to be page aligned.
+ * @param size The number of bytes to map, a negative value will map everything from @p offset to the end of the file.
+ * @param[out] ret_map Return the mapped view.
+ * @returns The number of mapped bytes or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note The mapping stays valid after @p f is closed, release it with cnwn_file_unmap().
+ */
+extern CNWN_PUBLIC int64_t cnwn_file_map(cnwn_File * f, int64_t offset, int64_t size, cnwn_FileMap * ret_map);
+
+/**
+ * Map a whole file into memory (read only).
+ * @param path The path to the file.
+ * @param[out] ret_map Return the mapped view.
+ * @returns The number of mapped bytes or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int64_t cnwn_file_map_path(const char * path, cnwn_FileMap * ret_map);
+
+/**
+ * Release a memory mapped view.
+ * @param map The mapped view to release, will be zeroed.
+ */
+extern CNWN_PUBLIC void cnwn_file_unmap(cnwn_FileMap * map);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,77 @@
+/**
+ * @file filter.h
+ * Part of cnwn: Small C99 library and tools for Neverwinter Nights.
+ */
+#ifndef CNWN_FILTER_H
+#define CNWN_FILTER_H
+
+#include "cnwn/common.h"
+#include "cnwn/string.h"
+#include "cnwn/hash.h"
+#include "cnwn/resource.h"
+
+/**
+ * @see struct cnwn_Filter_s
+ */
+typedef struct cnwn_Filter_s cnwn_Filter;
+
+/**
+ * A filter expression over resource metadata, compiled to a flat program.
+ *
+ * An expression compares fields with values and combines the comparisons with and, or, not and parentheses, for
+ * example "type in (dds, tga) and size > 1M". The fields are:
+ * - type: the resource type (extension), compared with =, != or [not] in (...).
+ * - name: the resource name, compared with =, != or [not] in (...).
+ * - size: the size in the archive, compared with =, !=, <, <=, > or >=, the value may end with K, M or G.
+ * - archive: the archive holding the resource (name with or without extension), compared with =, != or [not] in (...).
+ * - hash: the SHA1 of the resource content (decompressed if it is compressed in the archive), compared with =, != or
+ *   [not] in (...) to hex digests or prefixes.
+ *
+ * All fields but hash come from the entry table of the archive. Comparisons with hash are moved after the others
+ * and only read the resource data when the rest of the expression can't decide.
+ */
+struct cnwn_Filter_s {
+
+    /** @cond */
+    int num_instructions;
+    struct cnwn_FilterInstruction_s * instructions;
+    int num_values;
+    struct cnwn_FilterValue_s * values;
+    /** @endcond */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initialize (and compile) a filter expression.
+ * @param filter The filter to initialize.
+ * @param expression The filter expression, blank matches everything.
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_filter_init(cnwn_Filter * filter, const char * expression);
+
+/**
+ * Deinitialize a filter.
+ * @param filter The filter to deinitialize.
+ */
+extern CNWN_PUBLIC void cnwn_filter_deinit(cnwn_Filter * filter);
+
+/**
+ * Match a child resource of an archive against the filter.
+ * @param filter The filter.
+ * @param resource The archive.
+ * @param index The index of the child resource.
+ * @param input_f The file to read the child resource from, only used for hash comparisons.
+ * @returns One if the resource matches, zero if it doesn't or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_filter_match(const cnwn_Filter * filter, const cnwn_Resource * resource, int index, cnwn_File * input_f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
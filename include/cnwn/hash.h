@@ -16,6 +16,82 @@
  */
 typedef uint32_t (*cnwn_HashFunction32)(const void * data, uint32_t length);
 
+/**
+ * 64-bit hash function.
+ * @param data The data to get the hash for.
+ * @param length The length of the data to hash.
+ * @returns A 64-bit hash.
+ * @note Implementations should return zero if @p data is NULL or @p length is 0.
+ */
+typedef uint64_t (*cnwn_HashFunction64)(const void * data, uint64_t length);
+
+/**
+ * @see struct cnwn_Hash128_s
+ */
+typedef struct cnwn_Hash128_s cnwn_Hash128;
+
+/**
+ * A 128-bit hash.
+ */
+struct cnwn_Hash128_s {
+
+    /**
+     * The low 64 bits.
+     */
+    uint64_t low;
+
+    /**
+     * The high 64 bits.
+     */
+    uint64_t high;
+};
+
+/**
+ * The size of a SHA-1 digest (in bytes).
+ */
+#define CNWN_SHA1_SIZE 20
+
+/**
+ * The size of a SHA-1 digest as a hexadecimal string (including zero terminator).
+ */
+#define CNWN_SHA1_STRING_SIZE 41
+
+/**
+ * @see struct cnwn_Hash64State_s
+ */
+typedef struct cnwn_Hash64State_s cnwn_Hash64State;
+
+/**
+ * State for hashing data in chunks with xxHash64, the result is the same as hashing all data at once.
+ */
+struct cnwn_Hash64State_s {
+
+    /** @cond */
+    uint64_t v[4];
+    uint64_t total_length;
+    uint8_t buffer[32];
+    int buffer_size;
+    /** @endcond */
+};
+
+
+/**
+ * @see struct cnwn_Sha1State_s
+ */
+typedef struct cnwn_Sha1State_s cnwn_Sha1State;
+
+/**
+ * State for SHA-1 hashing data in chunks.
+ */
+struct cnwn_Sha1State_s {
+
+    /** @cond */
+    uint32_t h[5];
+    uint64_t total_length;
+    uint8_t buffer[64];
+    int buffer_size;
+    /** @endcond */
+};
 
 #ifdef __cplusplus
 extern "C" {
@@ -37,6 +113,15 @@ extern CNWN_PUBLIC uint32_t cnwn_hash32_murmur3(const void * data, uint32_t leng
  */
 extern CNWN_PUBLIC uint32_t cnwn_hash32_crc32(const void * data, uint32_t length);
 
+/**
+ * Update a CRC32 with more data, uses carry-less multiplication (PCLMULQDQ) when available and slicing-by-16 tables otherwise.
+ * @param crc The CRC32 of the data so far, zero to start.
+ * @param data The data to add.
+ * @param length The length (number of bytes) of the data.
+ * @returns The CRC32 of all data so far, the same as cnwn_hash32_crc32() on all data at once.
+ */
+extern CNWN_PUBLIC uint32_t cnwn_hash32_crc32_update(uint32_t crc, const void * data, uint64_t length);
+
 /**
  * Get a 32-bit hash from data using FNV-1a.
  * @param data The data to get the hash for.
@@ -53,6 +138,99 @@ extern CNWN_PUBLIC uint32_t cnwn_hash32_fnv1a(const void * data, uint32_t length
  */
 extern CNWN_PUBLIC uint32_t cnwn_hash32_djb2(const void * data, uint32_t length);
 
+/**
+ * Get a 64-bit hash from data using xxHash64 (seed zero).
+ * @param data The data to get the hash for.
+ * @param length The length (number of bytes) of the data.
+ * @returns A 64-bit hash for the provided data, NULL data or a zero @p length hash as empty input
+ * (0xef46db3751d8e999 like the reference implementation).
+ */
+extern CNWN_PUBLIC uint64_t cnwn_hash64_xxh64(const void * data, uint64_t length);
+
+/**
+ * Get a 64-bit hash from data, based on wyhash (final version 4, seed zero).
+ * @param data The data to get the hash for.
+ * @param length The length (number of bytes) of the data.
+ * @returns A 64-bit hash for the provided data, zero if @p data is NULL or @p length is 0.
+ * @note The fastest hash here for keys and small buffers, there is no chunked version (use xxHash64 for that).
+ */
+extern CNWN_PUBLIC uint64_t cnwn_hash64_wyhash(const void * data, uint64_t length);
+
+/**
+ * Get a 64-bit hash from data using FNV-1a.
+ * @param data The data to get the hash for.
+ * @param length The length (number of bytes) of the data.
+ * @returns A 64-bit hash for the provided data, zero if @p data is NULL or @p length is 0.
+ */
+extern CNWN_PUBLIC uint64_t cnwn_hash64_fnv1a(const void * data, uint64_t length);
+
+/**
+ * Get a 128-bit hash from data using murmur3 (x64 variant, seed zero).
+ * @param data The data to get the hash for.
+ * @param length The length (number of bytes) of the data.
+ * @returns A 128-bit hash for the provided data, zero if @p data is NULL or @p length is 0.
+ */
+extern CNWN_PUBLIC cnwn_Hash128 cnwn_hash128_murmur3(const void * data, uint64_t length);
+
+/**
+ * Initialize a state for hashing data in chunks with xxHash64.
+ * @param state The state to initialize.
+ */
+extern CNWN_PUBLIC void cnwn_hash64_xxh64_init(cnwn_Hash64State * state);
+
+/**
+ * Add data to a xxHash64 state.
+ * @param state The state.
+ * @param data The data to add.
+ * @param length The length (number of bytes) of the data.
+ */
+extern CNWN_PUBLIC void cnwn_hash64_xxh64_update(cnwn_Hash64State * state, const void * data, uint64_t length);
+
+/**
+ * Get the hash for all data added to a xxHash64 state.
+ * @param state The state, can be updated further after this call.
+ * @returns A 64-bit hash, the hash of empty input if no data has been added.
+ */
+extern CNWN_PUBLIC uint64_t cnwn_hash64_xxh64_final(const cnwn_Hash64State * state);
+
+
+/**
+ * Get the SHA-1 digest of data, uses the SHA extensions (SHA-NI) when available.
+ * @param data The data to get the digest for.
+ * @param length The length (number of bytes) of the data.
+ * @param[out] ret_digest Return the CNWN_SHA1_SIZE bytes of the digest here.
+ */
+extern CNWN_PUBLIC void cnwn_hash_sha1(const void * data, uint64_t length, uint8_t * ret_digest);
+
+/**
+ * Initialize a state for SHA-1 hashing data in chunks.
+ * @param state The state to initialize.
+ */
+extern CNWN_PUBLIC void cnwn_hash_sha1_init(cnwn_Sha1State * state);
+
+/**
+ * Add data to a SHA-1 state.
+ * @param state The state.
+ * @param data The data to add.
+ * @param length The length (number of bytes) of the data.
+ */
+extern CNWN_PUBLIC void cnwn_hash_sha1_update(cnwn_Sha1State * state, const void * data, uint64_t length);
+
+/**
+ * Get the SHA-1 digest of all data added to a state.
+ * @param state The state, can be updated further after this call.
+ * @param[out] ret_digest Return the CNWN_SHA1_SIZE bytes of the digest here.
+ */
+extern CNWN_PUBLIC void cnwn_hash_sha1_final(const cnwn_Sha1State * state, uint8_t * ret_digest);
+
+/**
+ * Get a SHA-1 digest as a lower case hexadecimal string.
+ * @param digest The CNWN_SHA1_SIZE bytes of the digest.
+ * @param[out] r Return the string here, NULL to get the required length.
+ * @param max_size The maximum size of the return string (including zero terminator), CNWN_SHA1_STRING_SIZE is enough.
+ * @returns The length of the string (excluding zero terminator).
+ */
+extern CNWN_PUBLIC int cnwn_hash_sha1_to_string(const uint8_t * digest, char * r, int max_size);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,550 @@
+/**
+ * @file ncs.h
+ * Part of cnwn: Small C99 library and tools for Neverwinter Nights.
+ */
+#ifndef CNWN_NCS_H
+#define CNWN_NCS_H
+
+#include "cnwn/file_system.h"
+#include "cnwn/endian.h"
+
+/**
+ * The size of the NCS header ("NCS V1.0" and the T instruction with the program size).
+ */
+#define CNWN_NCS_HEADER_SIZE 13
+
+/**
+ * NCS opcodes.
+ */
+enum cnwn_NcsOpcode_e {
+
+    /**
+     * Copy the top of the stack down to a stack pointer relative location.
+     */
+    CNWN_NCS_OPCODE_CPDOWNSP = 0x01,
+
+    /**
+     * Reserve space on the stack for a value of the type.
+     */
+    CNWN_NCS_OPCODE_RSADD = 0x02,
+
+    /**
+     * Copy a stack pointer relative location to the top of the stack.
+     */
+    CNWN_NCS_OPCODE_CPTOPSP = 0x03,
+
+    /**
+     * Push a constant.
+     */
+    CNWN_NCS_OPCODE_CONST = 0x04,
+
+    /**
+     * Call an engine routine (action).
+     */
+    CNWN_NCS_OPCODE_ACTION = 0x05,
+
+    /**
+     * Logical and.
+     */
+    CNWN_NCS_OPCODE_LOGAND = 0x06,
+
+    /**
+     * Logical or.
+     */
+    CNWN_NCS_OPCODE_LOGOR = 0x07,
+
+    /**
+     * Bitwise inclusive or.
+     */
+    CNWN_NCS_OPCODE_INCOR = 0x08,
+
+    /**
+     * Bitwise exclusive or.
+     */
+    CNWN_NCS_OPCODE_EXCOR = 0x09,
+
+    /**
+     * Bitwise and.
+     */
+    CNWN_NCS_OPCODE_BOOLAND = 0x0a,
+
+    /**
+     * Equal.
+     */
+    CNWN_NCS_OPCODE_EQUAL = 0x0b,
+
+    /**
+     * Not equal.
+     */
+    CNWN_NCS_OPCODE_NEQUAL = 0x0c,
+
+    /**
+     * Greater or equal.
+     */
+    CNWN_NCS_OPCODE_GEQ = 0x0d,
+
+    /**
+     * Greater than.
+     */
+    CNWN_NCS_OPCODE_GT = 0x0e,
+
+    /**
+     * Less than.
+     */
+    CNWN_NCS_OPCODE_LT = 0x0f,
+
+    /**
+     * Less or equal.
+     */
+    CNWN_NCS_OPCODE_LEQ = 0x10,
+
+    /**
+     * Shift left.
+     */
+    CNWN_NCS_OPCODE_SHLEFT = 0x11,
+
+    /**
+     * Shift right.
+     */
+    CNWN_NCS_OPCODE_SHRIGHT = 0x12,
+
+    /**
+     * Unsigned shift right.
+     */
+    CNWN_NCS_OPCODE_USHRIGHT = 0x13,
+
+    /**
+     * Add.
+     */
+    CNWN_NCS_OPCODE_ADD = 0x14,
+
+    /**
+     * Subtract.
+     */
+    CNWN_NCS_OPCODE_SUB = 0x15,
+
+    /**
+     * Multiply.
+     */
+    CNWN_NCS_OPCODE_MUL = 0x16,
+
+    /**
+     * Divide.
+     */
+    CNWN_NCS_OPCODE_DIV = 0x17,
+
+    /**
+     * Modulo.
+     */
+    CNWN_NCS_OPCODE_MOD = 0x18,
+
+    /**
+     * Negate.
+     */
+    CNWN_NCS_OPCODE_NEG = 0x19,
+
+    /**
+     * Ones complement.
+     */
+    CNWN_NCS_OPCODE_COMP = 0x1a,
+
+    /**
+     * Move the stack pointer.
+     */
+    CNWN_NCS_OPCODE_MOVSP = 0x1b,
+
+    /**
+     * Store state (obsolete).
+     */
+    CNWN_NCS_OPCODE_STORE_STATEALL = 0x1c,
+
+    /**
+     * Jump.
+     */
+    CNWN_NCS_OPCODE_JMP = 0x1d,
+
+    /**
+     * Jump to subroutine.
+     */
+    CNWN_NCS_OPCODE_JSR = 0x1e,
+
+    /**
+     * Jump if zero.
+     */
+    CNWN_NCS_OPCODE_JZ = 0x1f,
+
+    /**
+     * Return from subroutine.
+     */
+    CNWN_NCS_OPCODE_RETN = 0x20,
+
+    /**
+     * Remove elements from the stack, keeping a part of them.
+     */
+    CNWN_NCS_OPCODE_DESTRUCT = 0x21,
+
+    /**
+     * Logical not.
+     */
+    CNWN_NCS_OPCODE_NOT = 0x22,
+
+    /**
+     * Decrement an int at a stack pointer relative location.
+     */
+    CNWN_NCS_OPCODE_DECSP = 0x23,
+
+    /**
+     * Increment an int at a stack pointer relative location.
+     */
+    CNWN_NCS_OPCODE_INCSP = 0x24,
+
+    /**
+     * Jump if not zero.
+     */
+    CNWN_NCS_OPCODE_JNZ = 0x25,
+
+    /**
+     * Copy the top of the stack down to a base pointer relative location.
+     */
+    CNWN_NCS_OPCODE_CPDOWNBP = 0x26,
+
+    /**
+     * Copy a base pointer relative location to the top of the stack.
+     */
+    CNWN_NCS_OPCODE_CPTOPBP = 0x27,
+
+    /**
+     * Decrement an int at a base pointer relative location.
+     */
+    CNWN_NCS_OPCODE_DECBP = 0x28,
+
+    /**
+     * Increment an int at a base pointer relative location.
+     */
+    CNWN_NCS_OPCODE_INCBP = 0x29,
+
+    /**
+     * Save the base pointer.
+     */
+    CNWN_NCS_OPCODE_SAVEBP = 0x2a,
+
+    /**
+     * Restore the base pointer.
+     */
+    CNWN_NCS_OPCODE_RESTOREBP = 0x2b,
+
+    /**
+     * Store the state for a deferred action.
+     */
+    CNWN_NCS_OPCODE_STORE_STATE = 0x2c,
+
+    /**
+     * No operation.
+     */
+    CNWN_NCS_OPCODE_NOP = 0x2d,
+
+    /**
+     * Program size (only in the header).
+     */
+    CNWN_NCS_OPCODE_T = 0x42
+};
+
+/**
+ * @see enum cnwn_NcsOpcode_e
+ */
+typedef enum cnwn_NcsOpcode_e cnwn_NcsOpcode;
+
+/**
+ * NCS instruction types (operand types).
+ */
+enum cnwn_NcsType_e {
+
+    /**
+     * No type.
+     */
+    CNWN_NCS_TYPE_NONE = 0x00,
+
+    /**
+     * Stack operation.
+     */
+    CNWN_NCS_TYPE_STACK = 0x01,
+
+    /**
+     * Int.
+     */
+    CNWN_NCS_TYPE_INT = 0x03,
+
+    /**
+     * Float.
+     */
+    CNWN_NCS_TYPE_FLOAT = 0x04,
+
+    /**
+     * String.
+     */
+    CNWN_NCS_TYPE_STRING = 0x05,
+
+    /**
+     * Object.
+     */
+    CNWN_NCS_TYPE_OBJECT = 0x06,
+
+    /**
+     * First engine structure (effect).
+     */
+    CNWN_NCS_TYPE_ENGINE_0 = 0x10,
+
+    /**
+     * Last engine structure.
+     */
+    CNWN_NCS_TYPE_ENGINE_9 = 0x19,
+
+    /**
+     * Int, int.
+     */
+    CNWN_NCS_TYPE_INT_INT = 0x20,
+
+    /**
+     * Float, float.
+     */
+    CNWN_NCS_TYPE_FLOAT_FLOAT = 0x21,
+
+    /**
+     * Object, object.
+     */
+    CNWN_NCS_TYPE_OBJECT_OBJECT = 0x22,
+
+    /**
+     * String, string.
+     */
+    CNWN_NCS_TYPE_STRING_STRING = 0x23,
+
+    /**
+     * Struct, struct (followed by the struct size).
+     */
+    CNWN_NCS_TYPE_STRUCT_STRUCT = 0x24,
+
+    /**
+     * Int, float.
+     */
+    CNWN_NCS_TYPE_INT_FLOAT = 0x25,
+
+    /**
+     * Float, int.
+     */
+    CNWN_NCS_TYPE_FLOAT_INT = 0x26,
+
+    /**
+     * First engine structure pair.
+     */
+    CNWN_NCS_TYPE_ENGINE_ENGINE_0 = 0x30,
+
+    /**
+     * Last engine structure pair.
+     */
+    CNWN_NCS_TYPE_ENGINE_ENGINE_9 = 0x39,
+
+    /**
+     * Vector, vector.
+     */
+    CNWN_NCS_TYPE_VECTOR_VECTOR = 0x3a,
+
+    /**
+     * Vector, float.
+     */
+    CNWN_NCS_TYPE_VECTOR_FLOAT = 0x3b,
+
+    /**
+     * Float, vector.
+     */
+    CNWN_NCS_TYPE_FLOAT_VECTOR = 0x3c
+};
+
+/**
+ * @see enum cnwn_NcsType_e
+ */
+typedef enum cnwn_NcsType_e cnwn_NcsType;
+
+/**
+ * @see struct cnwn_NcsInstruction_s
+ */
+typedef struct cnwn_NcsInstruction_s cnwn_NcsInstruction;
+
+/**
+ * @see struct cnwn_Ncs_s
+ */
+typedef struct cnwn_Ncs_s cnwn_Ncs;
+
+/**
+ * A decoded instruction (fixed width).
+ */
+struct cnwn_NcsInstruction_s {
+
+    /**
+     * The offset of the instruction in the NCS data.
+     */
+    uint32_t offset;
+
+    /**
+     * The opcode.
+     */
+    uint8_t opcode;
+
+    /**
+     * The type.
+     */
+    uint8_t type;
+
+    /**
+     * The total length of the instruction (in bytes), the operands start at offset + 2.
+     */
+    uint16_t length;
+};
+
+/**
+ * A compiled NWScript program.
+ */
+struct cnwn_Ncs_s {
+
+    /**
+     * The mapped file, will be empty if not initialized from a path.
+     */
+    cnwn_FileMap map;
+
+    /**
+     * A buffer owned by the program if initialized from a file, NULL if not.
+     */
+    uint8_t * buffer;
+
+    /**
+     * The NCS data (header included).
+     */
+    const uint8_t * data;
+
+    /**
+     * The size of the NCS data (in bytes).
+     */
+    int64_t size;
+
+    /**
+     * The number of instructions.
+     */
+    int num_instructions;
+
+    /**
+     * The instructions in program order.
+     */
+    cnwn_NcsInstruction * instructions;
+
+    /**
+     * The target instruction index for each instruction (JMP, JSR, JZ and JNZ, STORE_STATE targets the resumed code), -1 for other instructions.
+     */
+    int32_t * jump_targets;
+
+    /**
+     * The number of subroutines.
+     */
+    int num_subroutines;
+
+    /**
+     * The first instruction index of each subroutine (sorted), the entry point is always the first subroutine.
+     */
+    int32_t * subroutines;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Get the name of an opcode.
+ * @param opcode The opcode.
+ * @returns The opcode name, "???" if the opcode is not known.
+ */
+extern CNWN_PUBLIC const char * cnwn_ncs_opcode_name(uint8_t opcode);
+
+/**
+ * Initialize a program from a memory buffer.
+ * @param ncs The program to initialize.
+ * @param data The NCS data, must stay valid until the program is deinitialized.
+ * @param size The size of @p data (in bytes).
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_ncs_init_from_buffer(cnwn_Ncs * ncs, const void * data, int64_t size);
+
+/**
+ * Initialize a program from a file.
+ * @param ncs The program to initialize.
+ * @param f The file to read from.
+ * @param offset The offset of the NCS data in @p f.
+ * @param size The size of the NCS data (in bytes).
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_ncs_init_from_file(cnwn_Ncs * ncs, cnwn_File * f, int64_t offset, int64_t size);
+
+/**
+ * Initialize a program by memory mapping a file.
+ * @param ncs The program to initialize.
+ * @param path The path to the NCS file.
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_ncs_init_from_path(cnwn_Ncs * ncs, const char * path);
+
+/**
+ * Deinitialize a program.
+ * @param ncs The program to deinitialize.
+ */
+extern CNWN_PUBLIC void cnwn_ncs_deinit(cnwn_Ncs * ncs);
+
+/**
+ * Find the instruction at an offset.
+ * @param ncs The program.
+ * @param offset The offset in the NCS data.
+ * @returns The instruction index or a negative value if no instruction starts at @p offset.
+ */
+extern CNWN_PUBLIC int cnwn_ncs_find_instruction(const cnwn_Ncs * ncs, uint32_t offset);
+
+/**
+ * Find the subroutine an instruction belongs to.
+ * @param ncs The program.
+ * @param index The instruction index.
+ * @returns The subroutine index (in cnwn_Ncs::subroutines) or a negative value if @p index is out of range.
+ */
+extern CNWN_PUBLIC int cnwn_ncs_find_subroutine(const cnwn_Ncs * ncs, int index);
+
+/**
+ * Read a big endian 32-bit operand.
+ * @param ncs The program.
+ * @param instruction The instruction.
+ * @param offset The offset of the operand relative to the operands.
+ * @returns The operand.
+ */
+extern CNWN_PUBLIC int32_t cnwn_ncs_operand32(const cnwn_Ncs * ncs, const cnwn_NcsInstruction * instruction, int offset);
+
+/**
+ * Read a big endian 16-bit operand.
+ * @param ncs The program.
+ * @param instruction The instruction.
+ * @param offset The offset of the operand relative to the operands.
+ * @returns The operand.
+ */
+extern CNWN_PUBLIC int16_t cnwn_ncs_operand16(const cnwn_Ncs * ncs, const cnwn_NcsInstruction * instruction, int offset);
+
+/**
+ * Get a string representation of an instruction.
+ * @param ncs The program.
+ * @param index The instruction index.
+ * @param[out] r Return the string here, NULL to get the required length.
+ * @param max_size The maximum size of the return string (including zero terminator).
+ * @returns The length of the string (excluding zero terminator).
+ */
+extern CNWN_PUBLIC int cnwn_ncs_instruction_to_string(const cnwn_Ncs * ncs, int index, char * r, int max_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,498 @@
+/**
+ * @file ncs_vm.h
+ * Part of cnwn: Small C99 library and tools for Neverwinter Nights.
+ */
+#ifndef CNWN_NCS_VM_H
+#define CNWN_NCS_VM_H
+
+#include "cnwn/ncs.h"
+
+/**
+ * The default maximum number of executed instructions for a single run.
+ */
+#define CNWN_NCS_VM_DEFAULT_MAX_INSTRUCTIONS 524288
+
+/**
+ * The default stack size (in 4 byte cells).
+ */
+#define CNWN_NCS_VM_DEFAULT_MAX_STACK 8192
+
+/**
+ * The default maximum subroutine call depth.
+ */
+#define CNWN_NCS_VM_DEFAULT_MAX_CALLS 1024
+
+/**
+ * The default maximum number of bytes allocated for strings created during a single run.
+ */
+#define CNWN_NCS_VM_DEFAULT_MAX_STRING_BYTES (16 * 1024 * 1024)
+
+/**
+ * The object value of OBJECT_INVALID.
+ */
+#define CNWN_NCS_OBJECT_INVALID 0x7f000000
+
+/**
+ * The object value of OBJECT_SELF.
+ */
+#define CNWN_NCS_OBJECT_SELF 0x00000000
+
+/**
+ * Will be defined if the interpreter was built with computed goto dispatch.
+ */
+#if defined(__GNUC__) && !defined(CNWN_NCS_VM_NO_COMPUTED_GOTO)
+#define CNWN_NCS_VM_COMPUTED_GOTO
+#endif
+
+/**
+ * Interpreter run status.
+ */
+enum cnwn_NcsVmStatus_e {
+
+    /**
+     * The script has not been run or ran to completion.
+     */
+    CNWN_NCS_VM_STATUS_OK = 0,
+
+    /**
+     * The instruction limit was reached.
+     */
+    CNWN_NCS_VM_STATUS_INSTRUCTION_LIMIT,
+
+    /**
+     * The stack limit was reached.
+     */
+    CNWN_NCS_VM_STATUS_STACK_LIMIT,
+
+    /**
+     * The subroutine call depth limit was reached.
+     */
+    CNWN_NCS_VM_STATUS_CALL_LIMIT,
+
+    /**
+     * The string memory limit was reached.
+     */
+    CNWN_NCS_VM_STATUS_STRING_LIMIT,
+
+    /**
+     * The script did something invalid (stack underflow, bad operand, division by zero and so on).
+     */
+    CNWN_NCS_VM_STATUS_ERROR
+};
+
+/**
+ * @see enum cnwn_NcsVmStatus_e
+ */
+typedef enum cnwn_NcsVmStatus_e cnwn_NcsVmStatus;
+
+/**
+ * @see struct cnwn_NcsString_s
+ */
+typedef struct cnwn_NcsString_s cnwn_NcsString;
+
+/**
+ * @see struct cnwn_NcsValue_s
+ */
+typedef struct cnwn_NcsValue_s cnwn_NcsValue;
+
+/**
+ * @see struct cnwn_NcsAction_s
+ */
+typedef struct cnwn_NcsAction_s cnwn_NcsAction;
+
+/**
+ * @see struct cnwn_NcsActions_s
+ */
+typedef struct cnwn_NcsActions_s cnwn_NcsActions;
+
+/**
+ * @see struct cnwn_NcsVmOp_s
+ */
+typedef struct cnwn_NcsVmOp_s cnwn_NcsVmOp;
+
+/**
+ * @see struct cnwn_NcsVm_s
+ */
+typedef struct cnwn_NcsVm_s cnwn_NcsVm;
+
+/**
+ * Callback for engine actions (the ACTION instruction).
+ * @param vm The interpreter, arguments are popped and return values pushed on its stack.
+ * @param action The action index.
+ * @param num_arguments The number of arguments.
+ * @param user_data The user data passed to cnwn_ncs_vm_init().
+ * @returns Zero on success and a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+typedef int (*cnwn_NcsActionFunction)(cnwn_NcsVm * vm, int action, int num_arguments, void * user_data);
+
+/**
+ * An immutable string value.
+ */
+struct cnwn_NcsString_s {
+
+    /**
+     * The length of the string (in bytes).
+     */
+    int length;
+
+    /**
+     * The string data (zero terminated).
+     */
+    char data[];
+};
+
+/**
+ * A stack cell.
+ */
+struct cnwn_NcsValue_s {
+
+    /**
+     * The type (CNWN_NCS_TYPE_INT, CNWN_NCS_TYPE_FLOAT, CNWN_NCS_TYPE_STRING, CNWN_NCS_TYPE_OBJECT or an engine structure type).
+     */
+    uint8_t type;
+
+    /**
+     * The value.
+     */
+    union {
+
+        /**
+         * Int value.
+         */
+        int32_t i;
+
+        /**
+         * Float value.
+         */
+        float f;
+
+        /**
+         * Object value.
+         */
+        uint32_t o;
+
+        /**
+         * String value.
+         */
+        const cnwn_NcsString * s;
+
+        /**
+         * Engine structure handle.
+         */
+        int32_t e;
+    } v;
+};
+
+/**
+ * The signature of an engine action.
+ */
+struct cnwn_NcsAction_s {
+
+    /**
+     * The action name.
+     */
+    char * name;
+
+    /**
+     * The return type, CNWN_NCS_TYPE_NONE for void and CNWN_NCS_TYPE_FLOAT for vectors.
+     */
+    uint8_t return_type;
+
+    /**
+     * The number of stack cells returned (zero, one or three for vectors).
+     */
+    int return_cells;
+
+    /**
+     * The number of arguments.
+     */
+    int num_arguments;
+
+    /**
+     * The number of stack cells used by each argument (zero for action arguments, three for vectors).
+     */
+    uint8_t * argument_cells;
+};
+
+/**
+ * A table of engine action signatures.
+ */
+struct cnwn_NcsActions_s {
+
+    /**
+     * The number of actions.
+     */
+    int num_actions;
+
+    /**
+     * The actions in action index order.
+     */
+    cnwn_NcsAction * actions;
+};
+
+/**
+ * A predecoded instruction, operands are converted to stack cells and jump targets to instruction indices.
+ */
+struct cnwn_NcsVmOp_s {
+
+    /**
+     * The interpreter handler (opcode and type combined).
+     */
+    int32_t handler;
+
+    /**
+     * First operand.
+     */
+    int32_t a;
+
+    /**
+     * Second operand.
+     */
+    int32_t b;
+
+    /**
+     * Third operand.
+     */
+    int32_t c;
+};
+
+/**
+ * A minimal NCS stack machine interpreter.
+ *
+ * Engine actions are forwarded to an action function, by default they are stubbed: the arguments are
+ * popped and a default value of the return type is pushed. Deferred actions (STORE_STATE) are never run.
+ */
+struct cnwn_NcsVm_s {
+
+    /**
+     * The program.
+     */
+    const cnwn_Ncs * ncs;
+
+    /**
+     * The action signatures, NULL if not available.
+     */
+    const cnwn_NcsActions * actions;
+
+    /**
+     * The action function.
+     */
+    cnwn_NcsActionFunction action_function;
+
+    /**
+     * User data for the action function.
+     */
+    void * action_data;
+
+    /**
+     * The predecoded instructions, one per program instruction.
+     */
+    cnwn_NcsVmOp * ops;
+
+    /**
+     * The string constants.
+     */
+    cnwn_NcsString ** constants;
+
+    /**
+     * The number of string constants.
+     */
+    int num_constants;
+
+    /**
+     * The stack.
+     */
+    cnwn_NcsValue * stack;
+
+    /**
+     * The stack pointer (in cells).
+     */
+    int sp;
+
+    /**
+     * The base pointer (in cells).
+     */
+    int bp;
+
+    /**
+     * The maximum stack size (in cells), may be changed before cnwn_ncs_vm_run().
+     */
+    int max_stack;
+
+    /**
+     * The return instruction indices of the active subroutine calls.
+     */
+    int32_t * calls;
+
+    /**
+     * The number of active subroutine calls.
+     */
+    int num_calls;
+
+    /**
+     * The maximum subroutine call depth, may be changed before cnwn_ncs_vm_run().
+     */
+    int max_calls;
+
+    /**
+     * The maximum number of executed instructions, may be changed before cnwn_ncs_vm_run().
+     */
+    int64_t max_instructions;
+
+    /**
+     * The number of instructions executed by the last run.
+     */
+    int64_t num_instructions;
+
+    /**
+     * The strings created during the current run.
+     */
+    cnwn_NcsString ** strings;
+
+    /**
+     * The number of strings created during the current run.
+     */
+    int num_strings;
+
+    /**
+     * The capacity of the strings array.
+     */
+    int strings_capacity;
+
+    /**
+     * The number of bytes allocated for strings during the current run.
+     */
+    int64_t string_bytes;
+
+    /**
+     * The maximum number of string bytes, may be changed before cnwn_ncs_vm_run().
+     */
+    int64_t max_string_bytes;
+
+    /**
+     * The status of the last run.
+     */
+    cnwn_NcsVmStatus status;
+
+    /**
+     * @cond
+     */
+    int stack_capacity;
+    int calls_capacity;
+    /**
+     * @endcond
+     */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initialize action signatures by parsing the function prototypes of nwscript.nss.
+ * @param actions The action signatures to initialize.
+ * @param data The nwscript.nss data.
+ * @param size The size of @p data (in bytes).
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_ncs_actions_init_from_buffer(cnwn_NcsActions * actions, const char * data, int64_t size);
+
+/**
+ * Initialize action signatures from a nwscript.nss file.
+ * @param actions The action signatures to initialize.
+ * @param path The path to nwscript.nss.
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_ncs_actions_init_from_path(cnwn_NcsActions * actions, const char * path);
+
+/**
+ * Deinitialize action signatures.
+ * @param actions The action signatures to deinitialize.
+ */
+extern CNWN_PUBLIC void cnwn_ncs_actions_deinit(cnwn_NcsActions * actions);
+
+/**
+ * Initialize an interpreter for a program.
+ * @param vm The interpreter to initialize.
+ * @param ncs The program, must stay valid until the interpreter is deinitialized.
+ * @param actions The action signatures used by the stub action function, NULL if not available (the stub will
+ * only pop the arguments, assuming one cell per argument and no return value).
+ * @param action_function The action function, NULL to use cnwn_ncs_vm_stub_action().
+ * @param action_data User data for @p action_function.
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_ncs_vm_init(cnwn_NcsVm * vm, const cnwn_Ncs * ncs, const cnwn_NcsActions * actions, cnwn_NcsActionFunction action_function, void * action_data);
+
+/**
+ * Deinitialize an interpreter.
+ * @param vm The interpreter to deinitialize.
+ */
+extern CNWN_PUBLIC void cnwn_ncs_vm_deinit(cnwn_NcsVm * vm);
+
+/**
+ * Run the program from its entry point until it returns.
+ * @param vm The interpreter.
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note The stack and the strings of the previous run are reset, cnwn_NcsVm::status and
+ * cnwn_NcsVm::num_instructions are updated even if an error occurs.
+ */
+extern CNWN_PUBLIC int cnwn_ncs_vm_run(cnwn_NcsVm * vm);
+
+/**
+ * The default action function, pops the arguments and pushes a default value of the return type.
+ * @param vm The interpreter.
+ * @param action The action index.
+ * @param num_arguments The number of arguments.
+ * @param user_data Ignored.
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_ncs_vm_stub_action(cnwn_NcsVm * vm, int action, int num_arguments, void * user_data);
+
+/**
+ * Create a string that lives until the next run.
+ * @param vm The interpreter.
+ * @param s The string data.
+ * @param length The length of @p s, a negative value to use the zero terminated length.
+ * @returns The string or NULL if the string memory limit was reached.
+ * @see cnwn_get_error() if this function returns NULL.
+ */
+extern CNWN_PUBLIC const cnwn_NcsString * cnwn_ncs_vm_new_string(cnwn_NcsVm * vm, const char * s, int length);
+
+/**
+ * Push values on the stack.
+ * @param vm The interpreter.
+ * @param num_values The number of values (cells).
+ * @param values The values.
+ * @returns Zero on success or a negative value if the stack limit was reached.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_ncs_vm_push(cnwn_NcsVm * vm, int num_values, const cnwn_NcsValue * values);
+
+/**
+ * Pop values from the stack.
+ * @param vm The interpreter.
+ * @param num_values The number of values (cells).
+ * @param[out] ret_values Return the values here (bottom first), pass NULL to discard them.
+ * @returns Zero on success or a negative value if there are not enough values on the stack.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_ncs_vm_pop(cnwn_NcsVm * vm, int num_values, cnwn_NcsValue * ret_values);
+
+/**
+ * Get the name of an interpreter status.
+ * @param status The status.
+ * @returns The name of the status.
+ */
+extern CNWN_PUBLIC const char * cnwn_ncs_vm_status_name(cnwn_NcsVmStatus status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,252 @@
+/**
+ * @file nwsync.h
+ * Part of cnwn: Small C99 library and tools for Neverwinter Nights.
+ */
+#ifndef CNWN_NWSYNC_H
+#define CNWN_NWSYNC_H
+
+#include "cnwn/file_system.h"
+#include "cnwn/containers.h"
+#include "cnwn/resource_type.h"
+#include "cnwn/hash.h"
+#include "cnwn/resref.h"
+
+/**
+ * The supported NWSync manifest version.
+ */
+#define CNWN_NWSYNC_MANIFEST_VERSION 3
+
+/**
+ * The size of a NWSync manifest header (in bytes).
+ */
+#define CNWN_NWSYNC_MANIFEST_HEADER_SIZE 16
+
+/**
+ * The size of a NWSync manifest entry (in bytes).
+ */
+#define CNWN_NWSYNC_MANIFEST_ENTRY_SIZE 42
+
+/**
+ * The size of a NWSync manifest mapping (in bytes).
+ */
+#define CNWN_NWSYNC_MANIFEST_MAPPING_SIZE 22
+
+/**
+ * The maximum length of a resref in a NWSync manifest.
+ */
+#define CNWN_NWSYNC_RESREF_SIZE 16
+
+/**
+ * Content store status of a manifest entry.
+ */
+enum cnwn_NWSyncStatus_e {
+
+    /**
+     * The content is in the store and matches the hash.
+     */
+    CNWN_NWSYNC_STATUS_OK = 0,
+
+    /**
+     * The content is not in the store.
+     */
+    CNWN_NWSYNC_STATUS_MISSING,
+
+    /**
+     * The content in the store has the wrong size.
+     */
+    CNWN_NWSYNC_STATUS_SIZE_MISMATCH,
+
+    /**
+     * The content in the store has the wrong hash.
+     */
+    CNWN_NWSYNC_STATUS_HASH_MISMATCH
+};
+
+/**
+ * @see enum cnwn_NWSyncStatus_e
+ */
+typedef enum cnwn_NWSyncStatus_e cnwn_NWSyncStatus;
+
+/**
+ * @see struct cnwn_NWSyncEntry_s
+ */
+typedef struct cnwn_NWSyncEntry_s cnwn_NWSyncEntry;
+
+/**
+ * @see struct cnwn_NWSyncManifest_s
+ */
+typedef struct cnwn_NWSyncManifest_s cnwn_NWSyncManifest;
+
+/**
+ * A resource in a NWSync manifest.
+ */
+struct cnwn_NWSyncEntry_s {
+
+    /**
+     * The SHA-1 digest of the resource content.
+     */
+    uint8_t sha1[CNWN_SHA1_SIZE];
+
+    /**
+     * The size of the resource (in bytes).
+     */
+    uint32_t size;
+
+    /**
+     * The resref (at most CNWN_NWSYNC_RESREF_SIZE characters).
+     */
+    cnwn_ResRef resref;
+
+    /**
+     * The resource type.
+     */
+    cnwn_ResourceType type;
+};
+
+/**
+ * A NWSync manifest (NSYC version 3).
+ *
+ * In the file each unique content hash is stored once as an entry, additional resrefs with the same
+ * content are stored as mappings to that entry. In memory every resref is a separate entry.
+ */
+struct cnwn_NWSyncManifest_s {
+
+    /** @cond */
+    cnwn_Array entries;
+    /** @endcond */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initialize an empty manifest.
+ * @param manifest The manifest to initialize.
+ */
+extern CNWN_PUBLIC void cnwn_nwsync_manifest_init(cnwn_NWSyncManifest * manifest);
+
+/**
+ * Initialize a manifest by reading a NSYC file.
+ * @param manifest The manifest to initialize.
+ * @param path The path to the manifest file.
+ * @returns The number of entries or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_nwsync_manifest_init_from_path(cnwn_NWSyncManifest * manifest, const char * path);
+
+/**
+ * Initialize a manifest from a NSYC buffer.
+ * @param manifest The manifest to initialize.
+ * @param data The manifest data.
+ * @param size The size of @p data (in bytes).
+ * @returns The number of entries or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_nwsync_manifest_init_from_buffer(cnwn_NWSyncManifest * manifest, const void * data, int64_t size);
+
+/**
+ * Deinitialize a manifest.
+ * @param manifest The manifest to deinitialize.
+ */
+extern CNWN_PUBLIC void cnwn_nwsync_manifest_deinit(cnwn_NWSyncManifest * manifest);
+
+/**
+ * Add an entry to a manifest.
+ * @param manifest The manifest.
+ * @param sha1 The SHA-1 digest of the content.
+ * @param size The size of the content (in bytes).
+ * @param resref The resref, will be lowercased.
+ * @param type The resource type.
+ * @returns The index of the new entry or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_nwsync_manifest_add(cnwn_NWSyncManifest * manifest, const uint8_t * sha1, int64_t size, const char * resref, cnwn_ResourceType type);
+
+/**
+ * Get the number of entries in a manifest.
+ * @param manifest The manifest.
+ * @returns The number of entries.
+ */
+extern CNWN_PUBLIC int cnwn_nwsync_manifest_get_num_entries(const cnwn_NWSyncManifest * manifest);
+
+/**
+ * Get an entry from a manifest.
+ * @param manifest The manifest.
+ * @param index The index of the entry, negative values count from the end.
+ * @returns The entry or NULL if @p index is out of range.
+ */
+extern CNWN_PUBLIC const cnwn_NWSyncEntry * cnwn_nwsync_manifest_get_entry(const cnwn_NWSyncManifest * manifest, int index);
+
+/**
+ * Sort the entries of a manifest by resref and type.
+ * @param manifest The manifest.
+ */
+extern CNWN_PUBLIC void cnwn_nwsync_manifest_sort(cnwn_NWSyncManifest * manifest);
+
+/**
+ * Write a manifest in the NSYC format.
+ * @param manifest The manifest.
+ * @param f The file to write to.
+ * @param[out] ret_sha1 Return the SHA-1 digest of the written manifest (used to name it in a store), pass NULL to ignore.
+ * @returns The number of written bytes or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int64_t cnwn_nwsync_manifest_write(const cnwn_NWSyncManifest * manifest, cnwn_File * f, uint8_t * ret_sha1);
+
+/**
+ * Diff two manifests, this is what a client has to do to update from one manifest to another.
+ * @param manifest The old manifest.
+ * @param other The new manifest.
+ * @param[out] ret_added Return the entries in @p other that are new or have changed content, pass NULL to ignore.
+ * @param[out] ret_removed Return the entries in @p manifest that are not in @p other, pass NULL to ignore.
+ * @returns The number of added and removed entries.
+ * @note @p ret_added and @p ret_removed must be initialized, entries will be appended.
+ */
+extern CNWN_PUBLIC int cnwn_nwsync_manifest_diff(const cnwn_NWSyncManifest * manifest, const cnwn_NWSyncManifest * other, cnwn_NWSyncManifest * ret_added, cnwn_NWSyncManifest * ret_removed);
+
+/**
+ * Get the path to some content in a store, the store is laid out by hash prefix (data/sha1/ab/cd/abcd...).
+ * @param store_path The root directory of the store.
+ * @param sha1 The SHA-1 digest of the content.
+ * @param[out] r Return the path here, NULL to get the required length.
+ * @param max_size The maximum size of the return string (including zero terminator).
+ * @returns The length of the path (excluding zero terminator) or a negative value if the path does not fit.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_nwsync_store_get_path(const char * store_path, const uint8_t * sha1, char * r, int max_size);
+
+/**
+ * Check if some content is in a store.
+ * @param store_path The root directory of the store.
+ * @param sha1 The SHA-1 digest of the content.
+ * @returns True if the content is in the store.
+ */
+extern CNWN_PUBLIC bool cnwn_nwsync_store_has(const char * store_path, const uint8_t * sha1);
+
+/**
+ * Put content into a store, content that is already in the store is not copied again.
+ * @param store_path The root directory of the store.
+ * @param sha1 The SHA-1 digest of the content.
+ * @param f The file to read the content from (from the current position).
+ * @param size The size of the content (in bytes).
+ * @returns One if the content was added, zero if it was already in the store or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note The content is hashed while it is copied and rejected if it does not match @p sha1.
+ */
+extern CNWN_PUBLIC int cnwn_nwsync_store_put(const char * store_path, const uint8_t * sha1, cnwn_File * f, int64_t size);
+
+/**
+ * Verify the content of a manifest entry in a store.
+ * @param store_path The root directory of the store.
+ * @param entry The manifest entry.
+ * @returns The status of the content or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_nwsync_store_verify(const char * store_path, const cnwn_NWSyncEntry * entry);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -15,6 +15,11 @@
  */
 typedef struct cnwn_Regexp_s cnwn_Regexp;
 
+/**
+ * The patterns of a regexp array compiled together (private).
+ */
+typedef struct cnwn_RegexpMatcher_s cnwn_RegexpMatcher;
+
 /**
  * @see struct cnwn_RegexpArray_s
  */
@@ -34,6 +39,10 @@ struct cnwn_RegexpArray_s {
      * The regular expressions.
      */
     cnwn_Regexp * regexps;
+
+    /** @cond */
+    cnwn_RegexpMatcher * matcher;
+    /** @endcond */
 };
 
 #ifdef __cplusplus
@@ -117,6 +126,9 @@ extern CNWN_PUBLIC bool cnwn_regexp_array_match_all(const cnwn_RegexpArray * reg
  * @param s The string to match.
  * @returns True if any of the regular expressions in the array matches, false if not.
  * @note If the array is empty the function returns true.
+ * @note Literals anchored at the start or end are looked up in a table and simple patterns (characters, '.',
+ * brackets and '*') run as one DFA for all of them, other regular expressions only run if the string contains a
+ * literal every match must have.
  */
 extern CNWN_PUBLIC bool cnwn_regexp_array_match_any(const cnwn_RegexpArray * regexp_array, const char * s);
 
@@ -9,6 +9,8 @@
 #include "cnwn/containers.h"
 #include "cnwn/file_system.h"
 #include "cnwn/resource_type.h"
+#include "cnwn/compression.h"
+#include "cnwn/resref.h"
 
 /**
  * Check if a char is valid for a resource name.
@@ -22,7 +24,7 @@
  * @param t The resource type.
  * @returns A handler or NULL if @p t is invalid.
  */
-#define CNWN_RESOURCE_HANDLER(t) (CNWN_RESOURCE_TYPE_VALID(t) ? CNWN_RESOURCE_HANDLERS + (t) : NULL)
+#define CNWN_RESOURCE_HANDLER(t) (CNWN_RESOURCE_TYPE_VALID(t) ? CNWN_RESOURCE_HANDLERS + CNWN_RESOURCE_TYPE_INDEX(t) : NULL)
 
 /**
  * @see cnwn_Array
@@ -39,6 +41,11 @@ typedef struct cnwn_MetaFile_s cnwn_MetaFile;
  */
 typedef struct cnwn_ResourceCallbacks_s cnwn_ResourceCallbacks;
 
+/**
+ * @see struct cnwn_ResourceEntries_s
+ */
+typedef struct cnwn_ResourceEntries_s cnwn_ResourceEntries;
+
 /**
  * @see struct cnwn_ResourceERF_s
  */
@@ -283,6 +290,28 @@ struct cnwn_ResourceERF_s {
     uint8_t rest[116];
 };
 
+/**
+ * The child resources of a resource as parallel arrays.
+ *
+ * Leaves are plain byte ranges and only take a row here, nested containers also get a full resource in a node.
+ */
+struct cnwn_ResourceEntries_s {
+
+    /** @cond */
+    int length;
+    int capacity;
+    uint16_t * types;
+    uint8_t * compressions;
+    int64_t * offsets;
+    int64_t * sizes;
+    int64_t * uncompressed_sizes;
+    cnwn_ResRef * names;
+    char * keys;
+    int * node_indices;
+    char ** paths;
+    /** @endcond */
+};
+
 /**
  * A resource.
  */
@@ -294,9 +323,15 @@ struct cnwn_Resource_s {
     cnwn_ResourceType type;
 
     /**
-     * The name.
+     * The name (lowercase, truncated to CNWN_RESREF_MAX_LENGTH), used to compare and find resources.
      */
-    char * name;
+    cnwn_ResRef name;
+
+    /**
+     * The name as given or stored in the archive (case kept), used to display, extract and write the resource.
+     * @see cnwn_resource_get_name()
+     */
+    char * key;
     
     /**
      * Offset in a file.
@@ -307,6 +342,22 @@ struct cnwn_Resource_s {
      * Resource size (in bytes).
      */
     int64_t size;
+
+    /**
+     * The codec of the resource data in the file.
+     */
+    cnwn_Compression compression;
+
+    /**
+     * The size of the resource data when decompressed (in bytes), same as size if the resource is not compressed.
+     */
+    int64_t uncompressed_size;
+
+    /**
+     * The file the resource is read from when it isn't read from the file of its parent (directories and the
+     * resources in them), NULL otherwise.
+     */
+    char * path;
     
     /**
      * A parent or NULL if top.
@@ -315,8 +366,14 @@ struct cnwn_Resource_s {
     
     /**
      * The child resources.
+     * @see cnwn_resource_get_resource()
      */
-    cnwn_ResourceArray resources;
+    cnwn_ResourceEntries entries;
+
+    /**
+     * Pointers to the full resources of nested containers (indexed by entries.node_indices).
+     */
+    cnwn_ResourceArray nodes;
 
     /**
      * Resource specific data.
@@ -351,9 +408,19 @@ extern "C" {
 #endif
 
 /**
- * Handlers for different types.
+ * Handlers for different types, in the same order as CNWN_RESOURCE_TYPE_INFOS.
+ * @see CNWN_RESOURCE_HANDLER() and cnwn_resource_set_handler().
+ */
+extern CNWN_PUBLIC cnwn_ResourceHandler CNWN_RESOURCE_HANDLERS[CNWN_NUM_RESOURCE_TYPES];
+
+/**
+ * Set the handler for a resource type.
+ * @param type The resource type.
+ * @param handler The handler.
+ * @returns Zero on success or a negative value if @p type is not a known type.
+ * @see cnwn_get_error() if this function returns a negative value.
  */
-extern CNWN_PUBLIC cnwn_ResourceHandler CNWN_RESOURCE_HANDLERS[CNWN_MAX_RESOURCE_TYPE];
+extern CNWN_PUBLIC int cnwn_resource_set_handler(cnwn_ResourceType type, const cnwn_ResourceHandler * handler);
 
 /**
  * Check if a resource name is valid or not.
@@ -370,7 +437,7 @@ extern CNWN_PUBLIC bool cnwn_resource_name_valid(const char * name, const cnwn_V
  * Vanilla initialization of a resource.
  * @param resource The resource struct to initialize.
  * @param type The resource type.
- * @param name The name of the resource.
+ * @param name The name of the resource (lowercased and truncated to CNWN_RESREF_MAX_LENGTH).
  * @param offset The offset in a file (zero if the file wasn't initialized from file).
  * @param size The size of the resource.
  * @param parent The parent or NULL if the resource is a top resource.
@@ -401,6 +468,9 @@ extern CNWN_PUBLIC int cnwn_resource_init_from_file(cnwn_Resource * resource, cn
  * @returns Zero on success and a negative value on error.
  * @see cnwn_get_error() if this function returns a negative value.
  * @note This function will not actually read any contents of @p path.
+ *
+ * The type comes from the extension of @p path, directories get CNWN_RESOURCE_TYPE_DIRECTORY and are left to its
+ * handler (see CNWN_RESOURCE_HANDLER_DIRECTORY) to add the files in them as child resources.
  */
 extern CNWN_PUBLIC int cnwn_resource_init_from_path(cnwn_Resource * resource, cnwn_Resource * parent, const char * path);
 
@@ -427,7 +497,8 @@ extern CNWN_PUBLIC cnwn_ResourceTypeInfo cnwn_resource_get_type_info(const cnwn_
 /**
  * Get the resource name.
  * @param resource The resource.
- * @returns The resource name (may be empty but never NULL).
+ * @returns The resource name as stored (case kept, may be empty but never NULL).
+ * @note Compare names with the resref in resource->name, two names only differing in case are the same resource.
  */
 extern CNWN_PUBLIC const char * cnwn_resource_get_name(const cnwn_Resource * resource);
 
@@ -440,6 +511,17 @@ extern CNWN_PUBLIC const char * cnwn_resource_get_name(const cnwn_Resource * res
  */
 extern CNWN_PUBLIC int cnwn_resource_get_path(const cnwn_Resource * resource, int max_size, char * ret_path);
 
+/**
+ * Append the resource path to the path of its parent.
+ * @param resource The resource.
+ * @param parent_length The length of the parent path already in @p ret_path, zero for the children of a top resource.
+ * @param max_size The maximum size of @p ret_path (including zero terminator).
+ * @param[in,out] ret_path The parent path, the resource path is appended to it.
+ * @returns The length of the returned path (excluding zero terminator).
+ * @note Building the paths while walking a resource tree saves rebuilding the whole path for every resource like cnwn_resource_get_path() does.
+ */
+extern CNWN_PUBLIC int cnwn_resource_get_path2(const cnwn_Resource * resource, int parent_length, int max_size, char * ret_path);
+
 /**
  * Get the number of resources.
  * @param resource The resource.
@@ -447,13 +529,56 @@ extern CNWN_PUBLIC int cnwn_resource_get_path(const cnwn_Resource * resource, in
  */
 extern CNWN_PUBLIC int cnwn_resource_get_num_resources(const cnwn_Resource * resource);
 
+/**
+ * Add a child resource.
+ * @param resource The resource.
+ * @param type The resource type.
+ * @param name The name of the child resource.
+ * @param offset The offset in a file.
+ * @param size The size of the child resource (in bytes).
+ * @param compression The codec of the data in the file.
+ * @param uncompressed_size The size of the data when decompressed (in bytes).
+ * @param input_f The file to read nested containers from (this function will seek), pass NULL to only add an entry.
+ * @returns The index of the child resource or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note Only uncompressed children with a handler that reads from file (containers) are initialized as full resources.
+ */
+extern CNWN_PUBLIC int cnwn_resource_add_resource(cnwn_Resource * resource, cnwn_ResourceType type, const char * name, int64_t offset, int64_t size, cnwn_Compression compression, int64_t uncompressed_size, cnwn_File * input_f);
+
+/**
+ * Add a child resource that is read from a file of its own.
+ * @param resource The resource.
+ * @param type The resource type.
+ * @param name The name of the child resource.
+ * @param offset The offset in a file.
+ * @param size The size of the child resource (in bytes).
+ * @param compression The codec of the data in the file.
+ * @param uncompressed_size The size of the data when decompressed (in bytes).
+ * @param path The file the child resource is read from or NULL if it is read from the file of @p resource.
+ * @param input_f The file to read nested containers from (this function will seek), pass NULL to only add an entry.
+ * @returns The index of the child resource or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @see cnwn_resource_add_resource()
+ */
+extern CNWN_PUBLIC int cnwn_resource_add_resource2(cnwn_Resource * resource, cnwn_ResourceType type, const char * name, int64_t offset, int64_t size, cnwn_Compression compression, int64_t uncompressed_size, const char * path, cnwn_File * input_f);
+
 /**
  * Get a child resource from the resource.
  * @param resource The resource.
  * @param index The index of the resource, negative values will wrap from the end.
- * @returns The child resource or NULL if @p index is out of range.
+ * @param[out] ret_resource A view of a leaf is returned here, the view is valid as long as @p resource and must not be deinitialized.
+ * @returns The child resource (@p ret_resource or a nested container) or NULL if @p index is out of range.
+ */
+extern CNWN_PUBLIC const cnwn_Resource * cnwn_resource_get_resource(const cnwn_Resource * resource, int index, cnwn_Resource * ret_resource);
+
+/**
+ * Find a child resource by type and name.
+ * @param resource The resource.
+ * @param type The resource type.
+ * @param name The name of the child resource.
+ * @returns The index of the first matching child resource or a negative value if there is none.
  */
-extern CNWN_PUBLIC cnwn_Resource * cnwn_resource_get_resource(const cnwn_Resource * resource, int index);
+extern CNWN_PUBLIC int cnwn_resource_find_resource(const cnwn_Resource * resource, cnwn_ResourceType type, const cnwn_ResRef * name);
 
 /**
  * Extract a resource (binary).
@@ -462,6 +587,8 @@ extern CNWN_PUBLIC cnwn_Resource * cnwn_resource_get_resource(const cnwn_Resourc
  * @param output_f The file to write the resource to.
  * @returns The number of bytes written to @p output_f or a negative value on error.
  * @see cnwn_get_error() if this function returns a negative value.
+ * @note Compressed resources are decompressed in chunks while they are written to @p output_f.
+ * @note Resources with a path (in a directory) are read from that file and @p input_f is ignored.
  */
 extern CNWN_PUBLIC int64_t cnwn_resource_extract(const cnwn_Resource * resource, cnwn_File * input_f, cnwn_File * output_f);
 
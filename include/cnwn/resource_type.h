@@ -8,18 +8,40 @@
 #include "cnwn/file_system.h"
 
 /**
- * Check if the resource type is ERF compatible.
+ * The number of known resource types (the length of CNWN_RESOURCE_TYPE_INFOS).
+ */
+#define CNWN_NUM_RESOURCE_TYPES 112
+
+/**
+ * The number of resource types covered by one page of the type index.
+ */
+#define CNWN_RESOURCE_TYPE_PAGE_SIZE 64
+
+/**
+ * The number of pages in the type index.
+ */
+#define CNWN_RESOURCE_TYPE_NUM_PAGES ((CNWN_MAX_RESOURCE_TYPE + CNWN_RESOURCE_TYPE_PAGE_SIZE - 1) / CNWN_RESOURCE_TYPE_PAGE_SIZE)
+
+/**
+ * Get the index of a resource type in CNWN_RESOURCE_TYPE_INFOS (and CNWN_RESOURCE_HANDLERS).
+ * @param t The resource type.
+ * @returns The index or a negative value if @p t is not a known type.
+ */
+#define CNWN_RESOURCE_TYPE_INDEX(t) ((t) >= 0 && (t) < CNWN_MAX_RESOURCE_TYPE ? (int)CNWN_RESOURCE_TYPE_PAGE_INDICES[CNWN_RESOURCE_TYPE_PAGES[(t) / CNWN_RESOURCE_TYPE_PAGE_SIZE]][(t) % CNWN_RESOURCE_TYPE_PAGE_SIZE] - 1 : -1)
+
+/**
+ * Check if the resource type is a known type.
  * @param t The resource type.
  * @returns True or false.
  */
-#define CNWN_RESOURCE_TYPE_VALID(t) ((t) > CNWN_RESOURCE_TYPE_INVALID && (t) < CNWN_MAX_RESOURCE_TYPE && CNWN_RESOURCE_TYPE_INFOS[(t)].type > CNWN_RESOURCE_TYPE_INVALID && CNWN_RESOURCE_TYPE_INFOS[(t)].type < CNWN_MAX_RESOURCE_TYPE && CNWN_RESOURCE_TYPE_INFOS[(t)].extension != NULL)
+#define CNWN_RESOURCE_TYPE_VALID(t) (CNWN_RESOURCE_TYPE_INDEX(t) >= 0)
 
 /**
  * Get the resource type info.
  * @param t The resource type.
  * @returns Returns the info struct.
  */
-#define CNWN_RESOURCE_TYPE_INFO(t) (CNWN_RESOURCE_TYPE_VALID((t)) ? CNWN_RESOURCE_TYPE_INFOS[(t)] : CNWN_RESOURCE_TYPE_INFO_INVALID)
+#define CNWN_RESOURCE_TYPE_INFO(t) (CNWN_RESOURCE_TYPE_VALID((t)) ? CNWN_RESOURCE_TYPE_INFOS[CNWN_RESOURCE_TYPE_INDEX((t))] : CNWN_RESOURCE_TYPE_INFO_INVALID)
 
 /**
  * Check if the resource type is ERF compatible.
@@ -28,6 +50,13 @@
  */
 #define CNWN_RESOURCE_TYPE_IS_ERF(t) ((t) == CNWN_RESOURCE_TYPE_ERF || (t) == CNWN_RESOURCE_TYPE_HAK || (t) == CNWN_RESOURCE_TYPE_MOD || (t) == CNWN_RESOURCE_TYPE_NWM)
 
+/**
+ * Check if the resource type is GFF based.
+ * @param t The resource type.
+ * @returns True or false.
+ */
+#define CNWN_RESOURCE_TYPE_IS_GFF(t) ((t) == CNWN_RESOURCE_TYPE_ARE || (t) == CNWN_RESOURCE_TYPE_IFO || (t) == CNWN_RESOURCE_TYPE_BIC || (t) == CNWN_RESOURCE_TYPE_GIT || (t) == CNWN_RESOURCE_TYPE_UTI || (t) == CNWN_RESOURCE_TYPE_UTC || (t) == CNWN_RESOURCE_TYPE_DLG || (t) == CNWN_RESOURCE_TYPE_ITP || (t) == CNWN_RESOURCE_TYPE_UTT || (t) == CNWN_RESOURCE_TYPE_UTS || (t) == CNWN_RESOURCE_TYPE_GFF || (t) == CNWN_RESOURCE_TYPE_FAC || (t) == CNWN_RESOURCE_TYPE_UTE || (t) == CNWN_RESOURCE_TYPE_UTD || (t) == CNWN_RESOURCE_TYPE_UTP || (t) == CNWN_RESOURCE_TYPE_GIC)
+
 /**
  * Check if the resource type is a container.
  * @param t The resource type.
@@ -40,7 +69,7 @@
  * @param t The resource type.
  * @returns Returns the extention or a pointer to an empty string if @p t is invalid.
  */
-#define CNWN_RESOURCE_TYPE_EXTENSION(t) (CNWN_RESOURCE_TYPE_VALID((t)) ? CNWN_RESOURCE_TYPE_INFOS[(t)].extension : "")
+#define CNWN_RESOURCE_TYPE_EXTENSION(t) (CNWN_RESOURCE_TYPE_VALID((t)) ? CNWN_RESOURCE_TYPE_INFOS[CNWN_RESOURCE_TYPE_INDEX((t))].extension : "")
 
 /**
  * Resource types.
@@ -606,11 +635,17 @@ enum cnwn_ResourceType_e {
      * 
      */
     CNWN_RESOURCE_TYPE_KEY = 9999,
+
+    /**
+     * Not a BioWare type, directories initialized with cnwn_resource_init_from_path() get it. No file extension maps
+     * to it and it is never stored in archives.
+     */
+    CNWN_RESOURCE_TYPE_DIRECTORY = 10000,
     
     /**
      * Max enum.
      */
-    CNWN_MAX_RESOURCE_TYPE = 10000,
+    CNWN_MAX_RESOURCE_TYPE = 10001,
 };
 
 /**
@@ -649,9 +684,21 @@ extern "C" {
 #endif
 
 /**
- * Resource info.
+ * Resource info for the known types, sorted by type.
+ * @see CNWN_RESOURCE_TYPE_INDEX() to find the info for a type.
+ */
+extern CNWN_PUBLIC const cnwn_ResourceTypeInfo CNWN_RESOURCE_TYPE_INFOS[CNWN_NUM_RESOURCE_TYPES];
+
+/**
+ * First level of the type index, maps a page of types to a row in CNWN_RESOURCE_TYPE_PAGE_INDICES (zero for a page
+ * without types).
+ */
+extern CNWN_PUBLIC const uint8_t CNWN_RESOURCE_TYPE_PAGES[CNWN_RESOURCE_TYPE_NUM_PAGES];
+
+/**
+ * Second level of the type index, the index in CNWN_RESOURCE_TYPE_INFOS plus one (zero for an unknown type).
  */
-extern CNWN_PUBLIC const cnwn_ResourceTypeInfo CNWN_RESOURCE_TYPE_INFOS[CNWN_MAX_RESOURCE_TYPE];
+extern CNWN_PUBLIC const uint8_t CNWN_RESOURCE_TYPE_PAGE_INDICES[][CNWN_RESOURCE_TYPE_PAGE_SIZE];
 
 /**
  * An invalid resource type to return from CNWN_RESOURCE_TYPE_INFO() macro.
@@ -0,0 +1,119 @@
+/**
+ * @file resref.h
+ * Part of cnwn: Small C99 library and tools for Neverwinter Nights.
+ */
+#ifndef CNWN_RESREF_H
+#define CNWN_RESREF_H
+
+#include "cnwn/common.h"
+#include "cnwn/string.h"
+
+/**
+ * The maximum length of a resref (ERF 1.1 keys).
+ */
+#define CNWN_RESREF_MAX_LENGTH 32
+
+/**
+ * The number of 64-bit words in a resref.
+ */
+#define CNWN_RESREF_NUM_WORDS (CNWN_RESREF_MAX_LENGTH / 8)
+
+/**
+ * @see struct cnwn_ResRef_s
+ */
+typedef struct cnwn_ResRef_s cnwn_ResRef;
+
+/**
+ * A resource reference (the name of a resource without the extension) stored inline.
+ *
+ * Resrefs are stored lowercase and zero padded, equality and hashing work on whole 64-bit words.
+ * Case folding and cnwn_resref_find() use SSE2/AVX2 when the CPU has them.
+ */
+struct cnwn_ResRef_s {
+
+    /**
+     * The resref (lowercase, zero padded and zero terminated).
+     */
+    char s[CNWN_RESREF_MAX_LENGTH + 1];
+
+    /**
+     * The length of the resref.
+     */
+    uint8_t length;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initialize a resref from a string.
+ * @param resref The resref to initialize.
+ * @param s The string, will be lowercased and truncated to CNWN_RESREF_MAX_LENGTH, NULL is the same as an empty string.
+ * @returns The length of @p s, larger than CNWN_RESREF_MAX_LENGTH if it was truncated.
+ */
+extern CNWN_PUBLIC int cnwn_resref_init(cnwn_ResRef * resref, const char * s);
+
+/**
+ * Initialize a resref from a string that may not be zero terminated.
+ * @param resref The resref to initialize.
+ * @param s The string, will be lowercased.
+ * @param length The maximum length to read from @p s, stops at a zero terminator before that.
+ * @returns The length of @p s, larger than CNWN_RESREF_MAX_LENGTH if it was truncated.
+ */
+extern CNWN_PUBLIC int cnwn_resref_init2(cnwn_ResRef * resref, const char * s, int length);
+
+/**
+ * Check if two resrefs are equal.
+ * @param resref The resref.
+ * @param other The resref to compare with.
+ * @returns True if the resrefs are equal.
+ */
+extern CNWN_PUBLIC bool cnwn_resref_equal(const cnwn_ResRef * resref, const cnwn_ResRef * other);
+
+/**
+ * Compare two resrefs.
+ * @param resref The resref.
+ * @param other The resref to compare with.
+ * @returns Less than, equal to or greater than zero if @p resref sorts before, equal to or after @p other.
+ */
+extern CNWN_PUBLIC int cnwn_resref_compare(const cnwn_ResRef * resref, const cnwn_ResRef * other);
+
+/**
+ * Hash a resref.
+ * @param resref The resref.
+ * @returns The hash.
+ */
+extern CNWN_PUBLIC uint32_t cnwn_resref_hash(const cnwn_ResRef * resref);
+
+/**
+ * Compare two resref strings case insensitively.
+ * @param s The string.
+ * @param o The string to compare with.
+ * @returns Less than, equal to or greater than zero if @p s sorts before, equal to or after @p o.
+ * @note Only the first CNWN_RESREF_MAX_LENGTH characters are compared.
+ */
+extern CNWN_PUBLIC int cnwn_resref_strcmpi(const char * s, const char * o);
+
+/**
+ * Hash a resref string case insensitively.
+ * @param s The string.
+ * @returns The same hash as cnwn_resref_hash() for a resref initialized from @p s.
+ */
+extern CNWN_PUBLIC uint32_t cnwn_resref_strhashi(const char * s);
+
+/**
+ * Find a resref in an array of resrefs.
+ * @param resrefs The resrefs to search.
+ * @param index The index to start searching from.
+ * @param length The number of resrefs in @p resrefs.
+ * @param resref The resref to find.
+ * @returns The index of the first equal resref or a negative value if it was not found.
+ */
+extern CNWN_PUBLIC int cnwn_resref_find(const cnwn_ResRef * resrefs, int index, int length, const cnwn_ResRef * resref);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -7,6 +7,110 @@
 
 #include "cnwn/common.h"
 
+/**
+ * Tokenizer flag: tokens starting with a double quote end at the next double quote (or end of line).
+ */
+#define CNWN_STRING_TOKENIZER_FLAG_QUOTES 0x1
+
+/**
+ * Tokenizer flag: never use SIMD instructions.
+ */
+#define CNWN_STRING_TOKENIZER_FLAG_SCALAR 0x2
+
+/**
+ * The number of bytes scanned for token boundaries at a time.
+ */
+#define CNWN_STRING_TOKENIZER_BLOCK_SIZE 64
+
+/**
+ * @see struct cnwn_StringToken_s
+ */
+typedef struct cnwn_StringToken_s cnwn_StringToken;
+
+/**
+ * @see struct cnwn_StringTokenizer_s
+ */
+typedef struct cnwn_StringTokenizer_s cnwn_StringTokenizer;
+
+/**
+ * A token found by a tokenizer.
+ */
+struct cnwn_StringToken_s {
+
+    /**
+     * The offset of the token (excluding quotes).
+     */
+    int64_t offset;
+
+    /**
+     * The length of the token (excluding quotes).
+     */
+    int length;
+
+    /**
+     * The line (starting at zero) of the token.
+     */
+    int line;
+
+    /**
+     * True if the token was quoted.
+     */
+    bool quoted;
+};
+
+/**
+ * Splits text into whitespace separated tokens.
+ *
+ * The text is scanned in blocks of CNWN_STRING_TOKENIZER_BLOCK_SIZE bytes that are turned into bitmasks
+ * for whitespace, newlines and quotes (using AVX2, SSE2 or plain C), token boundaries are then found by
+ * scanning the bitmasks.
+ */
+struct cnwn_StringTokenizer_s {
+
+    /**
+     * The text.
+     */
+    const char * data;
+
+    /**
+     * The size of the text (in bytes).
+     */
+    int64_t size;
+
+    /**
+     * The current position.
+     */
+    int64_t pos;
+
+    /**
+     * The current line.
+     */
+    int line;
+
+    /**
+     * Flags, see CNWN_STRING_TOKENIZER_FLAG_QUOTES and friends.
+     */
+    int flags;
+
+    /**
+     * An additional separator char (e.g. '=' for ini files) or zero.
+     */
+    char separator;
+
+    /**
+     * @cond
+     */
+    void (*block_function)(const char * p, char separator, uint64_t * ret_ws, uint64_t * ret_nl, uint64_t * ret_quote);
+    int64_t block_offset;
+    uint64_t block_ws;
+    uint64_t block_nl;
+    uint64_t block_quote;
+    uint64_t block_end;
+    /**
+     * @endcond
+     */
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -351,6 +455,15 @@ extern CNWN_PUBLIC int cnwn_strunescape(char * r, int max_size, const char * s,
  */
 extern CNWN_PUBLIC int cnwn_strnoctl(char * r, int max_size, const char * s);
 
+/**
+ * Format an integer in decimal, like snprintf() with PRId64 but without parsing a format.
+ * @param[out] r Write the return string here, pass NULL to get the required length.
+ * @param max_size The maximum size of the return string (including zero terminator).
+ * @param i The integer.
+ * @returns The length of the return string (excluding zero terminator).
+ */
+extern CNWN_PUBLIC int cnwn_strformatint(char * r, int max_size, int64_t i);
+
 /**
  * Insert a string into another string.
  * @param r Write the return string here, pass NULL to get the required length.
@@ -827,6 +940,27 @@ extern CNWN_PUBLIC bool cnwn_strbool(const char * s, bool * ret_value);
  */
 extern CNWN_PUBLIC bool cnwn_strtobool(const char * s, bool errvalue);
 
+/**
+ * Initialize a tokenizer.
+ * @param tokenizer The tokenizer to initialize.
+ * @param data The text to tokenize (does not have to be zero terminated).
+ * @param size The size of @p data (in bytes).
+ * @param flags Flags, see CNWN_STRING_TOKENIZER_FLAG_QUOTES and friends.
+ * @param separator An additional separator char (e.g. '=' for ini files) or zero for whitespace only.
+ */
+extern CNWN_PUBLIC void cnwn_string_tokenizer_init(cnwn_StringTokenizer * tokenizer, const char * data, int64_t size, int flags, char separator);
+
+/**
+ * Get the next tokens.
+ * @param tokenizer The tokenizer.
+ * @param max_tokens The maximum number of tokens to return.
+ * @param[out] ret_tokens Return the tokens here.
+ * @returns The number of returned tokens, zero when there are no more tokens.
+ * @note The char following each returned token (the separator, newline or closing quote) has been consumed
+ * when the token is returned so the caller may overwrite it, e.g. to zero terminate the token in place.
+ */
+extern CNWN_PUBLIC int cnwn_string_tokenizer_next(cnwn_StringTokenizer * tokenizer, int max_tokens, cnwn_StringToken * ret_tokens);
+
 #ifdef __cplusplus
 }
 #endif
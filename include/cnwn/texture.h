@@ -0,0 +1,199 @@
+/**
+ * @file texture.h
+ * Part of cnwn: Small C99 library and tools for Neverwinter Nights.
+ */
+#ifndef CNWN_TEXTURE_H
+#define CNWN_TEXTURE_H
+
+#include "cnwn/file_system.h"
+#include "cnwn/resource_type.h"
+
+/**
+ * The number of bytes needed to probe a texture header.
+ */
+#define CNWN_TEXTURE_PROBE_SIZE 128
+
+/**
+ * The size of the BioWare DDS header (in bytes).
+ */
+#define CNWN_TEXTURE_BIOWARE_DDS_HEADER_SIZE 20
+
+/**
+ * The size of a standard DDS header including the "DDS " magic (in bytes).
+ */
+#define CNWN_TEXTURE_DDS_HEADER_SIZE 128
+
+/**
+ * The size of a TGA header (in bytes).
+ */
+#define CNWN_TEXTURE_TGA_HEADER_SIZE 18
+
+/**
+ * The size of a PLT header (in bytes).
+ */
+#define CNWN_TEXTURE_PLT_HEADER_SIZE 24
+
+/**
+ * Check if a resource type is a texture type that can be probed.
+ * @param t The resource type.
+ * @returns True if the type can be probed, false if not.
+ */
+#define CNWN_TEXTURE_IS_TEXTURE_TYPE(t) ((t) == CNWN_RESOURCE_TYPE_DDS || (t) == CNWN_RESOURCE_TYPE_TGA || (t) == CNWN_RESOURCE_TYPE_PLT || (t) == CNWN_RESOURCE_TYPE_TEX)
+
+/**
+ * Texture pixel formats.
+ */
+enum cnwn_TextureFormat_e {
+
+    /**
+     * Unknown format.
+     */
+    CNWN_TEXTURE_FORMAT_UNKNOWN = 0,
+
+    /**
+     * DXT1 (BC1) compressed.
+     */
+    CNWN_TEXTURE_FORMAT_DXT1,
+
+    /**
+     * DXT3 (BC2) compressed.
+     */
+    CNWN_TEXTURE_FORMAT_DXT3,
+
+    /**
+     * DXT5 (BC3) compressed.
+     */
+    CNWN_TEXTURE_FORMAT_DXT5,
+
+    /**
+     * 8-bit grayscale.
+     */
+    CNWN_TEXTURE_FORMAT_L8,
+
+    /**
+     * 8-bit color mapped.
+     */
+    CNWN_TEXTURE_FORMAT_INDEXED8,
+
+    /**
+     * 16-bit color.
+     */
+    CNWN_TEXTURE_FORMAT_RGB16,
+
+    /**
+     * 24-bit color.
+     */
+    CNWN_TEXTURE_FORMAT_RGB24,
+
+    /**
+     * 32-bit color with alpha.
+     */
+    CNWN_TEXTURE_FORMAT_RGBA32,
+
+    /**
+     * PLT layered palette texture (value and layer per pixel).
+     */
+    CNWN_TEXTURE_FORMAT_PLT
+};
+
+/**
+ * @see enum cnwn_TextureFormat_e
+ */
+typedef enum cnwn_TextureFormat_e cnwn_TextureFormat;
+
+/**
+ * @see struct cnwn_TextureInfo_s
+ */
+typedef struct cnwn_TextureInfo_s cnwn_TextureInfo;
+
+/**
+ * Texture header information.
+ */
+struct cnwn_TextureInfo_s {
+
+    /**
+     * The width (in pixels).
+     */
+    int width;
+
+    /**
+     * The height (in pixels).
+     */
+    int height;
+
+    /**
+     * The number of mipmaps stored in the file (at least one).
+     */
+    int num_mipmaps;
+
+    /**
+     * The pixel format.
+     */
+    cnwn_TextureFormat format;
+
+    /**
+     * True if the texture data is run length encoded (TGA).
+     */
+    bool compressed;
+
+    /**
+     * The size of the pixel data described by the header (in bytes), all stored mipmaps included.
+     */
+    int64_t data_size;
+
+    /**
+     * Estimated video memory size (in bytes), compressed formats are uploaded as is, other formats as 32-bit
+     * color with a full mipmap chain.
+     */
+    int64_t vram_size;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Get the name of a texture format.
+ * @param format The format.
+ * @returns The name of the format.
+ */
+extern CNWN_PUBLIC const char * cnwn_texture_format_name(cnwn_TextureFormat format);
+
+/**
+ * Probe a texture header.
+ * @param type The resource type (DDS, TGA, PLT or TEX).
+ * @param data The start of the texture data (CNWN_TEXTURE_PROBE_SIZE bytes are enough).
+ * @param data_size The size of @p data (in bytes).
+ * @param resource_size The size of the whole texture resource (in bytes), used to count BioWare DDS mipmaps.
+ * @param[out] ret_info Return the texture information here.
+ * @returns One if the header was recognized, zero if @p type is not a texture type or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_texture_probe(cnwn_ResourceType type, const void * data, int64_t data_size, int64_t resource_size, cnwn_TextureInfo * ret_info);
+
+/**
+ * Probe a texture header in a file, only the first CNWN_TEXTURE_PROBE_SIZE bytes are read.
+ * @param type The resource type (DDS, TGA, PLT or TEX).
+ * @param f The file to read from.
+ * @param offset The offset of the texture in @p f.
+ * @param size The size of the texture (in bytes).
+ * @param[out] ret_info Return the texture information here.
+ * @returns One if the header was recognized, zero if @p type is not a texture type or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_texture_probe_file(cnwn_ResourceType type, cnwn_File * f, int64_t offset, int64_t size, cnwn_TextureInfo * ret_info);
+
+/**
+ * Get a short description of a texture (e.g "512x512 DXT5, 10 mipmaps, 349552 bytes VRAM").
+ * @param info The texture information.
+ * @param[out] r Return the string here, NULL to get the required length.
+ * @param max_size The maximum size of the return string (including zero terminator).
+ * @returns The length of the string (excluding zero terminator).
+ */
+extern CNWN_PUBLIC int cnwn_texture_info_to_string(const cnwn_TextureInfo * info, char * r, int max_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,239 @@
+/**
+ * @file tlk.h
+ * Part of cnwn: Small C99 library and tools for Neverwinter Nights.
+ */
+#ifndef CNWN_TLK_H
+#define CNWN_TLK_H
+
+#include "cnwn/file_system.h"
+#include "cnwn/endian.h"
+#include "cnwn/hash.h"
+
+/**
+ * The size of a TLK header (in bytes).
+ */
+#define CNWN_TLK_HEADER_SIZE 20
+
+/**
+ * The size of an entry in the TLK string data table (in bytes).
+ */
+#define CNWN_TLK_ENTRY_SIZE 40
+
+/**
+ * Strrefs with this bit set refer to the custom TLK.
+ */
+#define CNWN_TLK_STRREF_CUSTOM 0x01000000
+
+/**
+ * Mask to get the TLK index from a strref.
+ */
+#define CNWN_TLK_STRREF_INDEX_MASK 0x00ffffff
+
+/**
+ * Entry flag: the entry has text.
+ */
+#define CNWN_TLK_FLAG_TEXT_PRESENT 0x1
+
+/**
+ * Entry flag: the entry has a sound resref.
+ */
+#define CNWN_TLK_FLAG_SOUND_PRESENT 0x2
+
+/**
+ * Entry flag: the entry has a sound length.
+ */
+#define CNWN_TLK_FLAG_SOUND_LENGTH_PRESENT 0x4
+
+/**
+ * @see struct cnwn_Tlk_s
+ */
+typedef struct cnwn_Tlk_s cnwn_Tlk;
+
+/**
+ * @see struct cnwn_TlkEntry_s
+ */
+typedef struct cnwn_TlkEntry_s cnwn_TlkEntry;
+
+/**
+ * A read only talk table (TLK V3.0).
+ *
+ * The string data table and the string entries are accessed directly in the (mapped) file data,
+ * nothing is copied.
+ */
+struct cnwn_Tlk_s {
+
+    /**
+     * The mapped file, will be empty if initialized from a buffer.
+     */
+    cnwn_FileMap map;
+
+    /**
+     * The TLK data (header included).
+     */
+    const uint8_t * data;
+
+    /**
+     * The size of the TLK data (in bytes).
+     */
+    int64_t size;
+
+    /**
+     * Language ID.
+     */
+    uint32_t language_id;
+
+    /**
+     * The number of entries in the string data table.
+     */
+    uint32_t num_entries;
+
+    /**
+     * The string data table (an array of CNWN_TLK_ENTRY_SIZE sized entries).
+     */
+    const uint8_t * entries;
+
+    /**
+     * The string entries.
+     */
+    const char * strings;
+
+    /**
+     * The size of the string entries (in bytes).
+     */
+    int64_t strings_size;
+};
+
+/**
+ * An entry in a talk table.
+ */
+struct cnwn_TlkEntry_s {
+
+    /**
+     * Flags, see CNWN_TLK_FLAG_TEXT_PRESENT and friends.
+     */
+    uint32_t flags;
+
+    /**
+     * Sound resref.
+     */
+    char sound_resref[17];
+
+    /**
+     * Volume variance (unused by the game).
+     */
+    uint32_t volume_variance;
+
+    /**
+     * Pitch variance (unused by the game).
+     */
+    uint32_t pitch_variance;
+
+    /**
+     * Sound length (in seconds).
+     */
+    float sound_length;
+
+    /**
+     * The text (NOT zero terminated), NULL if there is no text.
+     */
+    const char * text;
+
+    /**
+     * The length of the text.
+     */
+    int text_length;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initialize a talk table from a memory buffer.
+ * @param tlk The talk table to initialize.
+ * @param data The TLK data, must stay valid until the talk table is deinitialized.
+ * @param size The size of @p data (in bytes).
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_tlk_init_from_buffer(cnwn_Tlk * tlk, const void * data, int64_t size);
+
+/**
+ * Initialize a talk table by memory mapping a file.
+ * @param tlk The talk table to initialize.
+ * @param path The path to the TLK file.
+ * @returns Zero on success or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ */
+extern CNWN_PUBLIC int cnwn_tlk_init_from_path(cnwn_Tlk * tlk, const char * path);
+
+/**
+ * Deinitialize a talk table.
+ * @param tlk The talk table to deinitialize.
+ */
+extern CNWN_PUBLIC void cnwn_tlk_deinit(cnwn_Tlk * tlk);
+
+/**
+ * Get the number of entries.
+ * @param tlk The talk table.
+ * @returns The number of entries.
+ */
+extern CNWN_PUBLIC int cnwn_tlk_get_num_entries(const cnwn_Tlk * tlk);
+
+/**
+ * Get an entry.
+ * @param tlk The talk table.
+ * @param index The index in the talk table (CNWN_TLK_STRREF_CUSTOM will be ignored).
+ * @param[out] ret_entry Return the entry, pass NULL to check if the entry exists.
+ * @returns One if the entry was returned or zero if @p index is out of range or the entry is broken.
+ */
+extern CNWN_PUBLIC int cnwn_tlk_get_entry(const cnwn_Tlk * tlk, uint32_t index, cnwn_TlkEntry * ret_entry);
+
+/**
+ * Get the text of an entry.
+ * @param tlk The talk table.
+ * @param index The index in the talk table (CNWN_TLK_STRREF_CUSTOM will be ignored).
+ * @param[out] ret_length Return the length of the text, pass NULL to ignore.
+ * @returns A pointer to the text (NOT zero terminated) or NULL if @p index is out of range or the entry has no text.
+ */
+extern CNWN_PUBLIC const char * cnwn_tlk_get_string(const cnwn_Tlk * tlk, uint32_t index, int * ret_length);
+
+/**
+ * Resolve a strref using a talk table and a custom talk table overlay.
+ * @param tlk The base talk table (usually dialog.tlk), NULL if not available.
+ * @param custom_tlk The custom talk table, NULL if not available.
+ * @param strref The strref, if CNWN_TLK_STRREF_CUSTOM is set the strref will be resolved using @p custom_tlk.
+ * @param[out] ret_length Return the length of the text, pass NULL to ignore.
+ * @returns A pointer to the text (NOT zero terminated) or NULL if the strref could not be resolved.
+ */
+extern CNWN_PUBLIC const char * cnwn_tlk_lookup(const cnwn_Tlk * tlk, const cnwn_Tlk * custom_tlk, uint32_t strref, int * ret_length);
+
+/**
+ * Write a talk table (TLK V3.0).
+ * @param f The file to write to.
+ * @param language_id The language ID.
+ * @param num_entries The number of entries.
+ * @param entries The entries.
+ * @returns The number of written bytes or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note Identical texts are only written once, the entries will share the same string entry.
+ */
+extern CNWN_PUBLIC int64_t cnwn_tlk_write(cnwn_File * f, uint32_t language_id, int num_entries, const cnwn_TlkEntry * entries);
+
+/**
+ * Write a compacted copy of a talk table.
+ * @param tlk The talk table to compact.
+ * @param used Flags for which entries are in use (one per entry), NULL to keep all entries.
+ * @param f The file to write to.
+ * @param[out] ret_num_entries Return the number of written entries, pass NULL to ignore.
+ * @returns The number of written bytes or a negative value on error.
+ * @see cnwn_get_error() if this function returns a negative value.
+ * @note Unused entries are cleared and trailing unused entries are dropped, strrefs of used entries never change.
+ */
+extern CNWN_PUBLIC int64_t cnwn_tlk_write_compact(const cnwn_Tlk * tlk, const bool * used, cnwn_File * f, int * ret_num_entries);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
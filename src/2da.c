@@ -0,0 +1,743 @@
+#include "cnwn/2da.h"
+
+static uint32_t cnwn_2da_hash_name(const char * name)
+{
+    uint32_t hash = 2166136261u;
+    for (const char * c = name; *c != 0; c++) {
+        hash ^= (uint8_t)(*c >= 'A' && *c <= 'Z' ? *c + 32 : *c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t cnwn_2da_cache_read_u32(const uint8_t * p)
+{
+    uint32_t ret;
+    memcpy(&ret, p, sizeof(ret));
+    return ret;
+}
+
+static uint64_t cnwn_2da_cache_read_u64(const uint8_t * p)
+{
+    uint64_t ret;
+    memcpy(&ret, p, sizeof(ret));
+    return ret;
+}
+
+// Free memory that is not part of a mapped cache file.
+static void cnwn_2da_free(const cnwn_2DA * tda, void * ptr)
+{
+    const uint8_t * p = ptr;
+    if (p != NULL && (tda->map.data == NULL || p < tda->map.data || p >= tda->map.data + tda->map.size))
+        free(ptr);
+}
+
+static void cnwn_2da_bit_set(uint8_t * bitmap, int index)
+{
+    bitmap[index >> 3] |= (uint8_t)(1 << (index & 7));
+}
+
+static void cnwn_2da_init_columns(cnwn_2DA * tda, const uint32_t * names, int num_columns, int capacity)
+{
+    tda->columns = malloc(sizeof(cnwn_2DAColumn) * CNWN_MAX(1, num_columns));
+    memset(tda->columns, 0, sizeof(cnwn_2DAColumn) * CNWN_MAX(1, num_columns));
+    int bitmap_size = (capacity + 7) / 8;
+    for (int i = 0; i < num_columns; i++) {
+        cnwn_2DAColumn * column = tda->columns + i;
+        column->name = tda->pool + names[i];
+        column->offsets = malloc(sizeof(uint32_t) * capacity);
+        column->nulls = malloc(bitmap_size);
+        memset(column->nulls, 0, bitmap_size);
+    }
+    tda->num_columns = num_columns;
+    tda->row_labels = malloc(sizeof(uint32_t) * capacity);
+}
+
+static void cnwn_2da_init_column_buckets(cnwn_2DA * tda)
+{
+    int num_buckets = 8;
+    while (num_buckets < tda->num_columns * 2)
+        num_buckets *= 2;
+    tda->column_buckets = malloc(sizeof(int) * num_buckets);
+    memset(tda->column_buckets, 0, sizeof(int) * num_buckets);
+    tda->num_column_buckets = num_buckets;
+    for (int i = 0; i < tda->num_columns; i++) {
+        int bucket = cnwn_2da_hash_name(tda->columns[i].name) & (num_buckets - 1);
+        while (tda->column_buckets[bucket] > 0 && cnwn_strcmpi(tda->columns[tda->column_buckets[bucket] - 1].name, tda->columns[i].name) != 0)
+            bucket = (bucket + 1) & (num_buckets - 1);
+        if (tda->column_buckets[bucket] == 0)
+            tda->column_buckets[bucket] = i + 1;
+    }
+}
+
+static void cnwn_2da_finish_row(cnwn_2DA * tda, int row, int num_cells)
+{
+    for (int i = num_cells; i < tda->num_columns; i++) {
+        tda->columns[i].offsets[row] = (uint32_t)(tda->pool_size - 1);
+        cnwn_2da_bit_set(tda->columns[i].nulls, row);
+    }
+}
+
+static int cnwn_2da_parse(cnwn_2DA * tda)
+{
+    char * pool = tda->pool;
+    int64_t size = tda->pool_size - 1;
+    tda->source_hash = cnwn_hash64_xxh64(pool, size);
+    tda->source_size = size;
+    int capacity = 1;
+    for (const char * c = memchr(pool, '\n', size); c != NULL; c = memchr(c + 1, '\n', size - (c + 1 - pool)))
+        capacity++;
+    cnwn_StringTokenizer tokenizer;
+    cnwn_string_tokenizer_init(&tokenizer, pool, size, CNWN_STRING_TOKENIZER_FLAG_QUOTES, 0);
+    cnwn_StringToken tokens[256];
+    int num_tokens;
+    int line = -1, index = 0;
+    int default_line = -1;
+    uint32_t * names = NULL;
+    int num_names = 0, max_names = 0, header_line = -1;
+    bool version = false;
+    while ((num_tokens = cnwn_string_tokenizer_next(&tokenizer, 256, tokens)) > 0) {
+        for (int t = 0; t < num_tokens; t++) {
+            const cnwn_StringToken * token = tokens + t;
+            uint32_t offset = (uint32_t)token->offset;
+            pool[token->offset + token->length] = 0;
+            if (token->line != line) {
+                if (line >= 0 && !version) {
+                    cnwn_set_error("invalid 2DA header");
+                    if (names != NULL)
+                        free(names);
+                    return -1;
+                }
+                if (tda->columns != NULL && line > header_line)
+                    cnwn_2da_finish_row(tda, tda->num_rows - 1, index);
+                line = token->line;
+                index = 0;
+            } else
+                index++;
+            if (line == 0) {
+                if (index == 0 && strcmp(pool + offset, "2DA") == 0)
+                    continue;
+                if (index == 1 && strcmp(pool + offset, "V2.0") == 0) {
+                    version = true;
+                    continue;
+                }
+                cnwn_set_error("invalid 2DA header");
+                return -1;
+            }
+            if (tda->columns == NULL) {
+                if (header_line < 0 && index == 0 && cnwn_strcmpi(pool + offset, "DEFAULT:") == 0) {
+                    default_line = line;
+                    continue;
+                }
+                if (line == default_line) {
+                    if (index == 1)
+                        tda->default_value = pool + offset;
+                    continue;
+                }
+                if (header_line < 0 || line == header_line) {
+                    if (num_names >= max_names) {
+                        max_names = CNWN_MAX(16, max_names * 2);
+                        names = realloc(names, sizeof(uint32_t) * max_names);
+                    }
+                    names[num_names++] = offset;
+                    header_line = line;
+                    continue;
+                }
+                cnwn_2da_init_columns(tda, names, num_names, capacity);
+            }
+            if (index == 0)
+                tda->row_labels[tda->num_rows++] = offset;
+            else if (index <= tda->num_columns) {
+                cnwn_2DAColumn * column = tda->columns + index - 1;
+                column->offsets[tda->num_rows - 1] = offset;
+                if (token->length == 4 && memcmp(pool + offset, CNWN_2DA_NULL_VALUE, 4) == 0)
+                    cnwn_2da_bit_set(column->nulls, tda->num_rows - 1);
+            }
+        }
+    }
+    if (!version) {
+        cnwn_set_error("invalid 2DA header");
+        if (names != NULL)
+            free(names);
+        return -1;
+    }
+    if (header_line < 0) {
+        cnwn_set_error("no 2DA column header");
+        return -1;
+    }
+    if (tda->columns == NULL)
+        cnwn_2da_init_columns(tda, names, num_names, capacity);
+    else if (line > header_line)
+        cnwn_2da_finish_row(tda, tda->num_rows - 1, index);
+    free(names);
+    cnwn_2da_init_column_buckets(tda);
+    return 0;
+}
+
+static int cnwn_2da_init_pool(cnwn_2DA * tda, int64_t size)
+{
+    memset(tda, 0, sizeof(cnwn_2DA));
+    if (size < 0 || size >= UINT32_MAX) {
+        cnwn_set_error("invalid 2DA size (%"PRId64")", size);
+        return -1;
+    }
+    tda->pool = malloc(size + 1);
+    tda->pool[size] = 0;
+    tda->pool_size = size + 1;
+    return 0;
+}
+
+int cnwn_2da_init_from_buffer(cnwn_2DA * tda, const void * data, int64_t size)
+{
+    if (cnwn_2da_init_pool(tda, size) < 0)
+        return -1;
+    if (size > 0)
+        memcpy(tda->pool, data, size);
+    if (cnwn_2da_parse(tda) < 0) {
+        cnwn_2da_deinit(tda);
+        return -1;
+    }
+    return 0;
+}
+
+int cnwn_2da_init_from_file(cnwn_2DA * tda, cnwn_File * f, int64_t offset, int64_t size)
+{
+    if (cnwn_2da_init_pool(tda, size) < 0)
+        return -1;
+    if (cnwn_file_seek(f, offset) < 0 || cnwn_file_read_fixed(f, size, tda->pool) < 0) {
+        cnwn_2da_deinit(tda);
+        return -1;
+    }
+    if (cnwn_2da_parse(tda) < 0) {
+        cnwn_2da_deinit(tda);
+        return -1;
+    }
+    return 0;
+}
+
+// Get the xxh64 hash of a file without reading it into memory at once.
+static int cnwn_2da_hash_path(const char * path, uint64_t * ret_hash)
+{
+    cnwn_File * f = cnwn_file_open(path, "r");
+    if (f == NULL)
+        return -1;
+    cnwn_Hash64State state;
+    cnwn_hash64_xxh64_init(&state);
+    uint8_t buffer[CNWN_FILE_BUFFER_SIZE];
+    int64_t ret;
+    while ((ret = cnwn_file_read(f, sizeof(buffer), buffer)) > 0)
+        cnwn_hash64_xxh64_update(&state, buffer, ret);
+    cnwn_file_close(f);
+    if (ret < 0)
+        return -1;
+    *ret_hash = cnwn_hash64_xxh64_final(&state);
+    return 0;
+}
+
+int cnwn_2da_init_from_path(cnwn_2DA * tda, const char * path)
+{
+    if (cnwn_strendswithi(path, "." CNWN_2DA_CACHE_EXTENSION))
+        return cnwn_2da_init_from_cache(tda, path);
+    char cache_path[CNWN_PATH_MAX_SIZE];
+    cnwn_2da_cache_path(cache_path, sizeof(cache_path), path);
+    // Modification times can't tell apart edits within their resolution, the cache is only used if it was built
+    // from the same text. Hashing is a lot cheaper than parsing.
+    if (cnwn_file_system_isfile(cache_path) > 0) {
+        int64_t size = cnwn_file_system_size(path, false);
+        if (size >= 0 && cnwn_2da_init_from_cache(tda, cache_path) >= 0) {
+            uint64_t hash;
+            if (tda->source_size == size && cnwn_2da_hash_path(path, &hash) >= 0 && tda->source_hash == hash)
+                return 0;
+            cnwn_2da_deinit(tda);
+        }
+    }
+    cnwn_File * f = cnwn_file_open(path, "r");
+    if (f == NULL) {
+        memset(tda, 0, sizeof(cnwn_2DA));
+        return -1;
+    }
+    int64_t size = cnwn_file_size(f);
+    int ret = -1;
+    if (size >= 0)
+        ret = cnwn_2da_init_from_file(tda, f, 0, size);
+    else
+        memset(tda, 0, sizeof(cnwn_2DA));
+    if (ret < 0)
+        cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+    cnwn_file_close(f);
+    return ret;
+}
+
+void cnwn_2da_deinit(cnwn_2DA * tda)
+{
+    if (tda->columns != NULL) {
+        for (int i = 0; i < tda->num_columns; i++) {
+            cnwn_2DAColumn * column = tda->columns + i;
+            cnwn_2da_free(tda, column->offsets);
+            cnwn_2da_free(tda, column->nulls);
+            cnwn_2da_free(tda, column->ints);
+            cnwn_2da_free(tda, column->ints_valid);
+            cnwn_2da_free(tda, column->floats);
+            cnwn_2da_free(tda, column->floats_valid);
+        }
+        free(tda->columns);
+    }
+    cnwn_2da_free(tda, tda->row_labels);
+    if (tda->column_buckets != NULL)
+        free(tda->column_buckets);
+    cnwn_2da_free(tda, tda->pool);
+    cnwn_file_unmap(&tda->map);
+    memset(tda, 0, sizeof(cnwn_2DA));
+}
+
+int cnwn_2da_get_num_rows(const cnwn_2DA * tda)
+{
+    return tda->num_rows;
+}
+
+int cnwn_2da_get_num_columns(const cnwn_2DA * tda)
+{
+    return tda->num_columns;
+}
+
+const char * cnwn_2da_get_column_name(const cnwn_2DA * tda, int column)
+{
+    if (column >= 0 && column < tda->num_columns)
+        return tda->columns[column].name;
+    return NULL;
+}
+
+int cnwn_2da_find_column(const cnwn_2DA * tda, const char * name)
+{
+    if (name == NULL || tda->num_column_buckets <= 0)
+        return -1;
+    int bucket = cnwn_2da_hash_name(name) & (tda->num_column_buckets - 1);
+    while (tda->column_buckets[bucket] > 0) {
+        int column = tda->column_buckets[bucket] - 1;
+        if (cnwn_strcmpi(tda->columns[column].name, name) == 0)
+            return column;
+        bucket = (bucket + 1) & (tda->num_column_buckets - 1);
+    }
+    return -1;
+}
+
+const char * cnwn_2da_get_row_label(const cnwn_2DA * tda, int row)
+{
+    if (row >= 0 && row < tda->num_rows)
+        return tda->pool + tda->row_labels[row];
+    return NULL;
+}
+
+bool cnwn_2da_is_null(const cnwn_2DA * tda, int row, int column)
+{
+    if (row < 0 || row >= tda->num_rows || column < 0 || column >= tda->num_columns)
+        return true;
+    return CNWN_2DA_BIT(tda->columns[column].nulls, row);
+}
+
+const char * cnwn_2da_get_string(const cnwn_2DA * tda, int row, int column)
+{
+    if (row < 0 || row >= tda->num_rows || column < 0 || column >= tda->num_columns)
+        return tda->default_value;
+    const cnwn_2DAColumn * c = tda->columns + column;
+    if (CNWN_2DA_BIT(c->nulls, row))
+        return NULL;
+    return tda->pool + c->offsets[row];
+}
+
+const char * cnwn_2da_get_string2(const cnwn_2DA * tda, int row, const char * column_name)
+{
+    return cnwn_2da_get_string(tda, row, cnwn_2da_find_column(tda, column_name));
+}
+
+static bool cnwn_2da_parse_int(const char * s, int32_t * ret_value)
+{
+    const char * c = s;
+    bool negative = (*c == '-');
+    if (*c == '-' || *c == '+')
+        c++;
+    int base = 10;
+    if (c[0] == '0' && (c[1] == 'x' || c[1] == 'X')) {
+        base = 16;
+        c += 2;
+    }
+    if (*c == 0)
+        return false;
+    int64_t value = 0;
+    for (; *c != 0; c++) {
+        int digit;
+        if (*c >= '0' && *c <= '9')
+            digit = *c - '0';
+        else if (base == 16 && *c >= 'a' && *c <= 'f')
+            digit = *c - 'a' + 10;
+        else if (base == 16 && *c >= 'A' && *c <= 'F')
+            digit = *c - 'A' + 10;
+        else
+            return false;
+        value = value * base + digit;
+        if (value > (int64_t)UINT32_MAX)
+            return false;
+    }
+    if (negative)
+        value = -value;
+    if (value < INT32_MIN || (base == 10 && value > INT32_MAX))
+        return false;
+    *ret_value = (int32_t)(uint32_t)value;
+    return true;
+}
+
+const int32_t * cnwn_2da_get_int_column(cnwn_2DA * tda, int column, const uint8_t ** ret_valid)
+{
+    if (column < 0 || column >= tda->num_columns)
+        return NULL;
+    cnwn_2DAColumn * c = tda->columns + column;
+    if (c->ints == NULL) {
+        int bitmap_size = (tda->num_rows + 7) / 8;
+        c->ints = malloc(sizeof(int32_t) * CNWN_MAX(1, tda->num_rows));
+        c->ints_valid = malloc(CNWN_MAX(1, bitmap_size));
+        memset(c->ints_valid, 0, CNWN_MAX(1, bitmap_size));
+        for (int row = 0; row < tda->num_rows; row++) {
+            c->ints[row] = 0;
+            if (!CNWN_2DA_BIT(c->nulls, row) && cnwn_2da_parse_int(tda->pool + c->offsets[row], c->ints + row))
+                cnwn_2da_bit_set(c->ints_valid, row);
+        }
+    }
+    if (ret_valid != NULL)
+        *ret_valid = c->ints_valid;
+    return c->ints;
+}
+
+const float * cnwn_2da_get_float_column(cnwn_2DA * tda, int column, const uint8_t ** ret_valid)
+{
+    if (column < 0 || column >= tda->num_columns)
+        return NULL;
+    cnwn_2DAColumn * c = tda->columns + column;
+    if (c->floats == NULL) {
+        int bitmap_size = (tda->num_rows + 7) / 8;
+        c->floats = malloc(sizeof(float) * CNWN_MAX(1, tda->num_rows));
+        c->floats_valid = malloc(CNWN_MAX(1, bitmap_size));
+        memset(c->floats_valid, 0, CNWN_MAX(1, bitmap_size));
+        for (int row = 0; row < tda->num_rows; row++) {
+            c->floats[row] = 0;
+            if (!CNWN_2DA_BIT(c->nulls, row)) {
+                const char * s = tda->pool + c->offsets[row];
+                char * end = NULL;
+                float value = strtof(s, &end);
+                if (end != s && *end == 0) {
+                    c->floats[row] = value;
+                    cnwn_2da_bit_set(c->floats_valid, row);
+                }
+            }
+        }
+    }
+    if (ret_valid != NULL)
+        *ret_valid = c->floats_valid;
+    return c->floats;
+}
+
+bool cnwn_2da_get_int(cnwn_2DA * tda, int row, int column, int32_t * ret_value)
+{
+    if (row < 0 || row >= tda->num_rows)
+        return false;
+    const uint8_t * valid;
+    const int32_t * ints = cnwn_2da_get_int_column(tda, column, &valid);
+    if (ints == NULL || !CNWN_2DA_BIT(valid, row))
+        return false;
+    if (ret_value != NULL)
+        *ret_value = ints[row];
+    return true;
+}
+
+bool cnwn_2da_get_int2(cnwn_2DA * tda, int row, const char * column_name, int32_t * ret_value)
+{
+    return cnwn_2da_get_int(tda, row, cnwn_2da_find_column(tda, column_name), ret_value);
+}
+
+bool cnwn_2da_get_float(cnwn_2DA * tda, int row, int column, float * ret_value)
+{
+    if (row < 0 || row >= tda->num_rows)
+        return false;
+    const uint8_t * valid;
+    const float * floats = cnwn_2da_get_float_column(tda, column, &valid);
+    if (floats == NULL || !CNWN_2DA_BIT(valid, row))
+        return false;
+    if (ret_value != NULL)
+        *ret_value = floats[row];
+    return true;
+}
+
+bool cnwn_2da_get_float2(cnwn_2DA * tda, int row, const char * column_name, float * ret_value)
+{
+    return cnwn_2da_get_float(tda, row, cnwn_2da_find_column(tda, column_name), ret_value);
+}
+
+int cnwn_2da_cache_path(char * r, int max_size, const char * path)
+{
+    char tmps[CNWN_PATH_MAX_SIZE];
+    if (cnwn_strendswithi(path, ".2da")) {
+        int len = cnwn_strcpy(tmps, sizeof(tmps), path, cnwn_strlen(path) - 3);
+        cnwn_strcpy(tmps + len, sizeof(tmps) - len, CNWN_2DA_CACHE_EXTENSION, -1);
+    } else
+        snprintf(tmps, sizeof(tmps), "%s.%s", path, CNWN_2DA_CACHE_EXTENSION);
+    return cnwn_strcpy(r, max_size, tmps, -1);
+}
+
+// Get an array in the mapped cache file, NULL if it is out of range or not aligned.
+static void * cnwn_2da_cache_array(const cnwn_2DA * tda, uint32_t offset, int64_t size)
+{
+    if ((offset & 3) != 0 || offset < CNWN_2DA_CACHE_HEADER_SIZE || (int64_t)offset + size > tda->map.size)
+        return NULL;
+    return (void *)(tda->map.data + offset);
+}
+
+static bool cnwn_2da_cache_offsets_valid(const uint32_t * offsets, int num_offsets, int64_t pool_size)
+{
+    uint32_t max_offset = 0;
+    for (int i = 0; i < num_offsets; i++)
+        max_offset = CNWN_MAX(max_offset, offsets[i]);
+    return num_offsets == 0 || max_offset < pool_size;
+}
+
+static int cnwn_2da_init_cache(cnwn_2DA * tda)
+{
+    const uint8_t * data = tda->map.data;
+    if (tda->map.size < CNWN_2DA_CACHE_HEADER_SIZE || memcmp(data, CNWN_2DA_CACHE_MAGIC, 8) != 0) {
+        cnwn_set_error("invalid 2DA cache header");
+        return -1;
+    }
+    uint32_t num_rows = cnwn_2da_cache_read_u32(data + 8);
+    uint32_t num_columns = cnwn_2da_cache_read_u32(data + 12);
+    uint32_t default_offset = cnwn_2da_cache_read_u32(data + 16);
+    uint32_t pool_offset = cnwn_2da_cache_read_u32(data + 20);
+    uint32_t pool_size = cnwn_2da_cache_read_u32(data + 24);
+    if (num_rows > INT32_MAX / 8 || num_columns > INT32_MAX / CNWN_2DA_CACHE_COLUMN_SIZE) {
+        cnwn_set_error("invalid 2DA cache size (%u rows, %u columns)", num_rows, num_columns);
+        return -1;
+    }
+    tda->pool = cnwn_2da_cache_array(tda, pool_offset, pool_size);
+    if (tda->pool == NULL || pool_size == 0 || tda->pool[pool_size - 1] != 0) {
+        tda->pool = NULL;
+        cnwn_set_error("invalid 2DA cache string pool");
+        return -1;
+    }
+    tda->pool_size = pool_size;
+    if (default_offset != UINT32_MAX) {
+        if (default_offset >= pool_size) {
+            cnwn_set_error("invalid 2DA cache default value");
+            return -1;
+        }
+        tda->default_value = tda->pool + default_offset;
+    }
+    int bitmap_size = (num_rows + 7) / 8;
+    tda->row_labels = cnwn_2da_cache_array(tda, cnwn_2da_cache_read_u32(data + 28), (int64_t)num_rows * 4);
+    const uint8_t * entries = cnwn_2da_cache_array(tda, cnwn_2da_cache_read_u32(data + 32), (int64_t)num_columns * CNWN_2DA_CACHE_COLUMN_SIZE);
+    if (tda->row_labels == NULL || entries == NULL || !cnwn_2da_cache_offsets_valid(tda->row_labels, num_rows, pool_size)) {
+        cnwn_set_error("invalid 2DA cache directory");
+        return -1;
+    }
+    tda->num_rows = (int)num_rows;
+    tda->columns = malloc(sizeof(cnwn_2DAColumn) * CNWN_MAX(1, num_columns));
+    memset(tda->columns, 0, sizeof(cnwn_2DAColumn) * CNWN_MAX(1, num_columns));
+    tda->num_columns = (int)num_columns;
+    for (int i = 0; i < tda->num_columns; i++) {
+        const uint8_t * entry = entries + (int64_t)i * CNWN_2DA_CACHE_COLUMN_SIZE;
+        cnwn_2DAColumn * column = tda->columns + i;
+        uint32_t name_offset = cnwn_2da_cache_read_u32(entry);
+        column->offsets = cnwn_2da_cache_array(tda, cnwn_2da_cache_read_u32(entry + 4), (int64_t)num_rows * 4);
+        column->nulls = cnwn_2da_cache_array(tda, cnwn_2da_cache_read_u32(entry + 8), bitmap_size);
+        if (cnwn_2da_cache_read_u32(entry + 12) != 0) {
+            column->ints = cnwn_2da_cache_array(tda, cnwn_2da_cache_read_u32(entry + 12), (int64_t)num_rows * 4);
+            column->ints_valid = cnwn_2da_cache_array(tda, cnwn_2da_cache_read_u32(entry + 16), bitmap_size);
+        }
+        if (cnwn_2da_cache_read_u32(entry + 20) != 0) {
+            column->floats = cnwn_2da_cache_array(tda, cnwn_2da_cache_read_u32(entry + 20), (int64_t)num_rows * 4);
+            column->floats_valid = cnwn_2da_cache_array(tda, cnwn_2da_cache_read_u32(entry + 24), bitmap_size);
+        }
+        if (name_offset >= pool_size || column->offsets == NULL || column->nulls == NULL
+            || (column->ints == NULL) != (column->ints_valid == NULL)
+            || (column->floats == NULL) != (column->floats_valid == NULL)
+            || !cnwn_2da_cache_offsets_valid(column->offsets, num_rows, pool_size)) {
+            cnwn_set_error("invalid 2DA cache column (%d)", i);
+            return -1;
+        }
+        column->name = tda->pool + name_offset;
+    }
+    tda->source_hash = cnwn_2da_cache_read_u64(data + 40);
+    tda->source_size = (int64_t)cnwn_2da_cache_read_u64(data + 48);
+    cnwn_2da_init_column_buckets(tda);
+    return 0;
+}
+
+int cnwn_2da_init_from_cache(cnwn_2DA * tda, const char * path)
+{
+    memset(tda, 0, sizeof(cnwn_2DA));
+#ifdef BUILD_BIG_ENDIAN
+    cnwn_set_error("2DA cache files are not supported on big endian platforms (%s)", path);
+    return -1;
+#else
+    if (cnwn_file_map_path(path, &tda->map) < 0)
+        return -1;
+    if (cnwn_2da_init_cache(tda) < 0) {
+        cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+        cnwn_2da_deinit(tda);
+        return -1;
+    }
+    return 0;
+#endif
+}
+
+typedef struct cnwn_2DAPoolBuilder_s {
+    char * data;
+    int64_t size;
+    int64_t max_size;
+    uint32_t * buckets;
+    int num_buckets;
+} cnwn_2DAPoolBuilder;
+
+// Add a string to the pool (identical strings are stored once) and return the pool offset.
+static uint32_t cnwn_2da_pool_add(cnwn_2DAPoolBuilder * builder, const char * s)
+{
+    int len = cnwn_strlen(s);
+    int bucket = cnwn_hash32_murmur3(s, len) & (builder->num_buckets - 1);
+    while (builder->buckets[bucket] > 0) {
+        const char * other = builder->data + builder->buckets[bucket] - 1;
+        if (memcmp(other, s, len + 1) == 0)
+            return builder->buckets[bucket] - 1;
+        bucket = (bucket + 1) & (builder->num_buckets - 1);
+    }
+    if (builder->size + len + 1 > builder->max_size) {
+        builder->max_size = CNWN_MAX(builder->max_size * 2, builder->size + len + 1);
+        builder->data = realloc(builder->data, builder->max_size);
+    }
+    uint32_t offset = (uint32_t)builder->size;
+    memcpy(builder->data + offset, s, len + 1);
+    builder->size += len + 1;
+    builder->buckets[bucket] = offset + 1;
+    return offset;
+}
+
+static void cnwn_2da_cache_write_u32(uint8_t * p, uint32_t u)
+{
+    memcpy(p, &u, sizeof(u));
+}
+
+static void cnwn_2da_cache_write_u64(uint8_t * p, uint64_t u)
+{
+    memcpy(p, &u, sizeof(u));
+}
+
+#define CNWN_2DA_ALIGN8(x) (((x) + 7) & ~(int64_t)7)
+
+int64_t cnwn_2da_write_cache(cnwn_2DA * tda, cnwn_File * f)
+{
+#ifdef BUILD_BIG_ENDIAN
+    cnwn_set_error("2DA cache files are not supported on big endian platforms");
+    return -1;
+#else
+    int num_rows = tda->num_rows;
+    int num_columns = tda->num_columns;
+    cnwn_2DAPoolBuilder builder = {0};
+    builder.num_buckets = 16;
+    while (builder.num_buckets < ((int64_t)num_rows * (num_columns + 1) + num_columns + 2) * 2)
+        builder.num_buckets *= 2;
+    builder.buckets = malloc(sizeof(uint32_t) * builder.num_buckets);
+    memset(builder.buckets, 0, sizeof(uint32_t) * builder.num_buckets);
+    uint32_t * labels = malloc(sizeof(uint32_t) * CNWN_MAX(1, num_rows));
+    uint32_t * offsets = malloc(sizeof(uint32_t) * CNWN_MAX(1, (int64_t)num_rows * num_columns));
+    uint32_t * names = malloc(sizeof(uint32_t) * CNWN_MAX(1, num_columns));
+    cnwn_2da_pool_add(&builder, "");
+    uint32_t default_offset = (tda->default_value != NULL ? cnwn_2da_pool_add(&builder, tda->default_value) : UINT32_MAX);
+    for (int i = 0; i < num_columns; i++)
+        names[i] = cnwn_2da_pool_add(&builder, tda->columns[i].name);
+    for (int row = 0; row < num_rows; row++)
+        labels[row] = cnwn_2da_pool_add(&builder, tda->pool + tda->row_labels[row]);
+    for (int i = 0; i < num_columns; i++)
+        for (int row = 0; row < num_rows; row++)
+            offsets[(int64_t)i * num_rows + row] = cnwn_2da_pool_add(&builder, tda->pool + tda->columns[i].offsets[row]);
+    free(builder.buckets);
+    int64_t bitmap_size = (num_rows + 7) / 8;
+    int64_t array_size = CNWN_2DA_ALIGN8((int64_t)num_rows * 4);
+    int64_t columns_offset = CNWN_2DA_CACHE_HEADER_SIZE;
+    int64_t pool_offset = columns_offset + (int64_t)num_columns * CNWN_2DA_CACHE_COLUMN_SIZE;
+    int64_t labels_offset = pool_offset + CNWN_2DA_ALIGN8(builder.size);
+    int64_t size = labels_offset + array_size;
+    for (int i = 0; i < num_columns; i++) {
+        const uint8_t * valid;
+        bool has_ints = false, has_floats = false;
+        cnwn_2da_get_int_column(tda, i, &valid);
+        for (int64_t j = 0; j < bitmap_size && !has_ints; j++)
+            has_ints = (valid[j] != 0);
+        cnwn_2da_get_float_column(tda, i, &valid);
+        for (int64_t j = 0; j < bitmap_size && !has_floats; j++)
+            has_floats = (valid[j] != 0);
+        size += array_size + CNWN_2DA_ALIGN8(bitmap_size);
+        if (has_ints)
+            size += array_size + CNWN_2DA_ALIGN8(bitmap_size);
+        if (has_floats)
+            size += array_size + CNWN_2DA_ALIGN8(bitmap_size);
+    }
+    if (size > UINT32_MAX) {
+        cnwn_set_error("2DA cache too large (%"PRId64" bytes)", size);
+        free(names);
+        free(offsets);
+        free(labels);
+        free(builder.data);
+        return -1;
+    }
+    uint8_t * buffer = malloc(size);
+    memset(buffer, 0, size);
+    memcpy(buffer, CNWN_2DA_CACHE_MAGIC, 8);
+    cnwn_2da_cache_write_u32(buffer + 8, (uint32_t)num_rows);
+    cnwn_2da_cache_write_u32(buffer + 12, (uint32_t)num_columns);
+    cnwn_2da_cache_write_u32(buffer + 16, default_offset);
+    cnwn_2da_cache_write_u32(buffer + 20, (uint32_t)pool_offset);
+    cnwn_2da_cache_write_u32(buffer + 24, (uint32_t)builder.size);
+    cnwn_2da_cache_write_u32(buffer + 28, (uint32_t)labels_offset);
+    cnwn_2da_cache_write_u32(buffer + 32, (uint32_t)columns_offset);
+    cnwn_2da_cache_write_u64(buffer + 40, tda->source_hash);
+    cnwn_2da_cache_write_u64(buffer + 48, (uint64_t)tda->source_size);
+    cnwn_2da_cache_write_u32(buffer + 56, (uint32_t)size);
+    memcpy(buffer + pool_offset, builder.data, builder.size);
+    memcpy(buffer + labels_offset, labels, (int64_t)num_rows * 4);
+    int64_t offset = labels_offset + array_size;
+    for (int i = 0; i < num_columns; i++) {
+        cnwn_2DAColumn * column = tda->columns + i;
+        uint8_t * entry = buffer + columns_offset + (int64_t)i * CNWN_2DA_CACHE_COLUMN_SIZE;
+        cnwn_2da_cache_write_u32(entry, names[i]);
+        cnwn_2da_cache_write_u32(entry + 4, (uint32_t)offset);
+        memcpy(buffer + offset, offsets + (int64_t)i * num_rows, (int64_t)num_rows * 4);
+        offset += array_size;
+        cnwn_2da_cache_write_u32(entry + 8, (uint32_t)offset);
+        memcpy(buffer + offset, column->nulls, bitmap_size);
+        offset += CNWN_2DA_ALIGN8(bitmap_size);
+        bool has_ints = false, has_floats = false;
+        for (int64_t j = 0; j < bitmap_size; j++) {
+            has_ints = has_ints || (column->ints_valid[j] != 0);
+            has_floats = has_floats || (column->floats_valid[j] != 0);
+        }
+        if (has_ints) {
+            cnwn_2da_cache_write_u32(entry + 12, (uint32_t)offset);
+            memcpy(buffer + offset, column->ints, (int64_t)num_rows * 4);
+            offset += array_size;
+            cnwn_2da_cache_write_u32(entry + 16, (uint32_t)offset);
+            memcpy(buffer + offset, column->ints_valid, bitmap_size);
+            offset += CNWN_2DA_ALIGN8(bitmap_size);
+        }
+        if (has_floats) {
+            cnwn_2da_cache_write_u32(entry + 20, (uint32_t)offset);
+            memcpy(buffer + offset, column->floats, (int64_t)num_rows * 4);
+            offset += array_size;
+            cnwn_2da_cache_write_u32(entry + 24, (uint32_t)offset);
+            memcpy(buffer + offset, column->floats_valid, bitmap_size);
+            offset += CNWN_2DA_ALIGN8(bitmap_size);
+        }
+    }
+    free(names);
+    free(offsets);
+    free(labels);
+    free(builder.data);
+    int64_t ret = cnwn_file_write(f, size, buffer);
+    free(buffer);
+    return ret;
+#endif
+}
@@ -1,5 +1,6 @@
 #include "cnwn/cnwna.h"
 #include "cnwn/erf.h"
+#include "cnwn/directory.h"
 
 int main(int argc, char * argv[])
 {
@@ -13,10 +14,11 @@ int main(int argc, char * argv[])
     cnwn_CNWNASettings settings;
     int ret = cnwn_cnwna_settings_init(&settings, argc, argv);
     if (ret >= 0) {
-        CNWN_RESOURCE_HANDLERS[CNWN_RESOURCE_TYPE_ERF] = CNWN_RESOURCE_HANDLER_ERF;
-        CNWN_RESOURCE_HANDLERS[CNWN_RESOURCE_TYPE_MOD] = CNWN_RESOURCE_HANDLER_ERF;
-        CNWN_RESOURCE_HANDLERS[CNWN_RESOURCE_TYPE_HAK] = CNWN_RESOURCE_HANDLER_ERF;
-        CNWN_RESOURCE_HANDLERS[CNWN_RESOURCE_TYPE_NWM] = CNWN_RESOURCE_HANDLER_ERF;
+        cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_ERF, &CNWN_RESOURCE_HANDLER_ERF);
+        cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_MOD, &CNWN_RESOURCE_HANDLER_ERF);
+        cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_HAK, &CNWN_RESOURCE_HANDLER_ERF);
+        cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_NWM, &CNWN_RESOURCE_HANDLER_ERF);
+        cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_DIRECTORY, &CNWN_RESOURCE_HANDLER_DIRECTORY);
         ret = cnwn_cnwna_execute(&settings);
         if (ret < 0)
             fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
@@ -1,5 +1,8 @@
 #include "cnwn/cnwna.h"
 
+#include <pthread.h>
+#include <unistd.h>
+
 const cnwn_Option CNWN_CNWNA_OPTIONS_GENERAL[] = {
     {'h', "help", NULL, "Print help to stdout.", 1},
     {'V', "show-version", NULL, "Print version (and only version) to stdout.", 2},
@@ -9,6 +12,11 @@ const cnwn_Option CNWN_CNWNA_OPTIONS_GENERAL[] = {
 const cnwn_Option CNWN_CNWNA_OPTIONS_LIST[] = {
     {'d', "depth", "n", "Set recursion depth (-1 for no limit).", 1},
     {'v', "verbose", NULL, "Verbose output to stdout.", 2},
+    {'t', "totals", NULL, "Print totals and the number of resources per type.", 3},
+    {'j', "jobs", "n", "Set the number of threads reading archives (default is one per CPU).", 4},
+    {'f', "filter", "expression", "Only list resources matching an expression like \"type in (dds, tga) and size > 1M\".", 5},
+    {'F', "format", "name", "Set the output format, text (default), json, jsonl, tsv or null.", 6},
+    {'D', "directories", NULL, "List directories as archives of the files in them instead of searching them for archives.", 7},
     {0}
 };
 
@@ -16,6 +24,7 @@ const cnwn_Option CNWN_CNWNA_OPTIONS_EXTRACT[] = {
     {'d', "depth", "n", "Set recursion depth (-1 for no limit).", 1},
     {'q', "quiet", NULL, "Supress output to stdout.", 2},
     {'o', "output", "path", "Set the output directory.", 3},
+    {'f', "filter", "expression", "Only extract resources matching an expression like \"type in (dds, tga) and size > 1M\".", 4},
     {0}
 };
 
@@ -25,6 +34,52 @@ const cnwn_Option CNWN_CNWNA_OPTIONS_CREATE[] = {
     {0}
 };
 
+const cnwn_Option CNWN_CNWNA_OPTIONS_TLK_COMPACT[] = {
+    {'o', "output", "path", "Set the output file.", 1},
+    {'b', "base", NULL, "The TLK is a base TLK (dialog.tlk), not a custom TLK.", 2},
+    {'q', "quiet", NULL, "Supress output to stdout.", 3},
+    {0}
+};
+
+const cnwn_Option CNWN_CNWNA_OPTIONS_2DA_CACHE[] = {
+    {'o', "output", "path", "Set the output directory (default is next to each 2DA or hak).", 1},
+    {'q', "quiet", NULL, "Supress output to stdout.", 2},
+    {0}
+};
+
+const cnwn_Option CNWN_CNWNA_OPTIONS_DEDUPE[] = {
+    {'o', "output", "path", "Write the haks without shadowed resources to this directory.", 1},
+    {'q', "quiet", NULL, "Supress output to stdout.", 2},
+    {0}
+};
+
+const cnwn_Option CNWN_CNWNA_OPTIONS_MANIFEST[] = {
+    {'o', "output", "path", "Write the manifest to this file (default is stdout).", 1},
+    {'j', "jobs", "n", "Set the number of hashing threads (default is one per CPU).", 2},
+    {'q', "quiet", NULL, "Supress output to stdout.", 3},
+    {'b', "binary", NULL, "Write a binary NWSync manifest (NSYC).", 4},
+    {'s', "store", "path", "Copy the resources into this content store, content already in the store is skipped.", 5},
+    {0}
+};
+
+const cnwn_Option CNWN_CNWNA_OPTIONS_ERF_COMPRESS[] = {
+    {'o', "output", "path", "Set the output file.", 1},
+    {'c', "codec", "name", "Set the codec, zlib (default) or none to decompress.", 2},
+    {'q', "quiet", NULL, "Supress output to stdout.", 3},
+    {0}
+};
+
+const cnwn_Option CNWN_CNWNA_OPTIONS_NWSYNC_VERIFY[] = {
+    {'q', "quiet", NULL, "Only print the summary.", 1},
+    {0}
+};
+
+const cnwn_Option CNWN_CNWNA_OPTIONS_NWSYNC_DIFF[] = {
+    {'s', "store", "path", "Leave out content that is already in this content store.", 1},
+    {'q', "quiet", NULL, "Supress the summary.", 2},
+    {0}
+};
+
 bool cnwn_cnwna_has_help(int argc, char * argv[])
 {
     int index = 1;
@@ -82,6 +137,20 @@ int cnwn_cnwna_settings_init(cnwn_CNWNASettings * settings, int argc, char * arg
                     return -1;
                 } else if (result.optvalue == 2)
                     settings->verbose = true;
+                else if (result.optvalue == 3)
+                    settings->totals = true;
+                else if (result.optvalue == 4 && (!cnwn_strint(result.optarg, 10, &settings->jobs) || settings->jobs < 0)) {
+                    cnwn_set_error("invalid jobs value (int): %s", result.optarg);
+                    cnwn_cnwna_settings_deinit(settings);
+                    return -1;
+                } else if (result.optvalue == 5)
+                    settings->filter = cnwn_strdup(result.optarg);
+                else if (result.optvalue == 6 && (settings->format = cnwn_cnwna_format_from_name(result.optarg)) < 0) {
+                    cnwn_set_error("invalid format (text, json, jsonl, tsv or null): %s", result.optarg);
+                    cnwn_cnwna_settings_deinit(settings);
+                    return -1;
+                } else if (result.optvalue == 7)
+                    settings->directories = true;
             } else if (used_options == CNWN_CNWNA_OPTIONS_EXTRACT) {
                 if (result.optvalue == 1 && !cnwn_strint(result.optarg, 10, &settings->depth)) {
                     cnwn_set_error("invalid depth value (int): %s", result.optarg);
@@ -91,7 +160,56 @@ int cnwn_cnwna_settings_init(cnwn_CNWNASettings * settings, int argc, char * arg
                     settings->quiet = true;
                 else if (result.optvalue == 3)
                     settings->output_path = cnwn_strdup(result.optarg);
+                else if (result.optvalue == 4)
+                    settings->filter = cnwn_strdup(result.optarg);
             } else if (used_options == CNWN_CNWNA_OPTIONS_CREATE) {
+            } else if (used_options == CNWN_CNWNA_OPTIONS_TLK_COMPACT) {
+                if (result.optvalue == 1)
+                    settings->output_path = cnwn_strdup(result.optarg);
+                else if (result.optvalue == 2)
+                    settings->tlk_base = true;
+                else if (result.optvalue == 3)
+                    settings->quiet = true;
+            } else if (used_options == CNWN_CNWNA_OPTIONS_2DA_CACHE) {
+                if (result.optvalue == 1)
+                    settings->output_path = cnwn_strdup(result.optarg);
+                else if (result.optvalue == 2)
+                    settings->quiet = true;
+            } else if (used_options == CNWN_CNWNA_OPTIONS_DEDUPE) {
+                if (result.optvalue == 1)
+                    settings->output_path = cnwn_strdup(result.optarg);
+                else if (result.optvalue == 2)
+                    settings->quiet = true;
+            } else if (used_options == CNWN_CNWNA_OPTIONS_MANIFEST) {
+                if (result.optvalue == 1)
+                    settings->output_path = cnwn_strdup(result.optarg);
+                else if (result.optvalue == 2 && (!cnwn_strint(result.optarg, 10, &settings->jobs) || settings->jobs < 0)) {
+                    cnwn_set_error("invalid jobs value (int): %s", result.optarg);
+                    cnwn_cnwna_settings_deinit(settings);
+                    return -1;
+                } else if (result.optvalue == 3)
+                    settings->quiet = true;
+                else if (result.optvalue == 4)
+                    settings->binary = true;
+                else if (result.optvalue == 5)
+                    settings->store_path = cnwn_strdup(result.optarg);
+            } else if (used_options == CNWN_CNWNA_OPTIONS_ERF_COMPRESS) {
+                if (result.optvalue == 1)
+                    settings->output_path = cnwn_strdup(result.optarg);
+                else if (result.optvalue == 2 && (settings->compression = cnwn_compression_from_name(result.optarg)) < 0) {
+                    cnwn_set_error("invalid codec: %s", result.optarg);
+                    cnwn_cnwna_settings_deinit(settings);
+                    return -1;
+                } else if (result.optvalue == 3)
+                    settings->quiet = true;
+            } else if (used_options == CNWN_CNWNA_OPTIONS_NWSYNC_VERIFY) {
+                if (result.optvalue == 1)
+                    settings->quiet = true;
+            } else if (used_options == CNWN_CNWNA_OPTIONS_NWSYNC_DIFF) {
+                if (result.optvalue == 1)
+                    settings->store_path = cnwn_strdup(result.optarg);
+                else if (result.optvalue == 2)
+                    settings->quiet = true;
             }
         } else if (settings->command == NULL) {
             settings->command = cnwn_strdup(result.arg != NULL ? result.arg : "");
@@ -103,6 +221,21 @@ int cnwn_cnwna_settings_init(cnwn_CNWNASettings * settings, int argc, char * arg
                 settings->depth = -1;
             } else if (cnwn_strstartswith("create", settings->command))
                 options = CNWN_CNWNA_OPTIONS_CREATE;
+            else if (cnwn_strcmp("tlk-compact", settings->command) == 0)
+                options = CNWN_CNWNA_OPTIONS_TLK_COMPACT;
+            else if (cnwn_strcmp("2da-cache", settings->command) == 0)
+                options = CNWN_CNWNA_OPTIONS_2DA_CACHE;
+            else if (cnwn_strcmp("dedupe", settings->command) == 0)
+                options = CNWN_CNWNA_OPTIONS_DEDUPE;
+            else if (cnwn_strcmp("manifest", settings->command) == 0)
+                options = CNWN_CNWNA_OPTIONS_MANIFEST;
+            else if (cnwn_strcmp("erf-compress", settings->command) == 0) {
+                options = CNWN_CNWNA_OPTIONS_ERF_COMPRESS;
+                settings->compression = CNWN_COMPRESSION_ZLIB;
+            } else if (cnwn_strcmp("nwsync-verify", settings->command) == 0)
+                options = CNWN_CNWNA_OPTIONS_NWSYNC_VERIFY;
+            else if (cnwn_strcmp("nwsync-diff", settings->command) == 0)
+                options = CNWN_CNWNA_OPTIONS_NWSYNC_DIFF;
             else {
                 cnwn_set_error("invalid command: %s", result.arg);
                 cnwn_cnwna_settings_deinit(settings);
@@ -140,6 +273,10 @@ void cnwn_cnwna_settings_deinit(cnwn_CNWNASettings * settings)
         free(settings->path);
     if (settings->output_path != NULL)
         free(settings->output_path);
+    if (settings->store_path != NULL)
+        free(settings->store_path);
+    if (settings->filter != NULL)
+        free(settings->filter);
     cnwn_array_deinit(&settings->arguments);
     memset(settings, 0, sizeof(cnwn_CNWNASettings));
 }
@@ -170,7 +307,7 @@ int cnwn_cnwna_print_help(void)
         }
         ret += fp;        
     }
-    fp = fprintf(stdout, "\nlist [options] [regular expressions]:\n");
+    fp = fprintf(stdout, "\nlist [options] <archives and directories> [regular expressions]:\n");
     if (fp < 0) {
         cnwn_set_error("%s", strerror(errno));
         return -1;
@@ -218,6 +355,118 @@ int cnwn_cnwna_print_help(void)
         }
         ret += fp;        
     }
+    fp = fprintf(stdout, "\ntlk-compact [options] [modules, haks and 2DA files]:\n");
+    if (fp < 0) {
+        cnwn_set_error("%s", strerror(errno));
+        return -1;
+    }
+    ret += fp;
+    for (int i = 0; !CNWN_OPTION_SENTINEL(CNWN_CNWNA_OPTIONS_TLK_COMPACT + i); i++) {
+        char tmps[1024];
+        cnwn_option_to_string(CNWN_CNWNA_OPTIONS_TLK_COMPACT + i, sizeof(tmps), tmps);
+        fp = fprintf(stdout, "  %s\n", tmps);
+        if (fp < 0) {
+            cnwn_set_error("%s", strerror(errno));
+            return -1;
+        }
+        ret += fp;        
+    }
+    fp = fprintf(stdout, "\n2da-cache [options] <2DA files, haks and directories>:\n");
+    if (fp < 0) {
+        cnwn_set_error("%s", strerror(errno));
+        return -1;
+    }
+    ret += fp;
+    for (int i = 0; !CNWN_OPTION_SENTINEL(CNWN_CNWNA_OPTIONS_2DA_CACHE + i); i++) {
+        char tmps[1024];
+        cnwn_option_to_string(CNWN_CNWNA_OPTIONS_2DA_CACHE + i, sizeof(tmps), tmps);
+        fp = fprintf(stdout, "  %s\n", tmps);
+        if (fp < 0) {
+            cnwn_set_error("%s", strerror(errno));
+            return -1;
+        }
+        ret += fp;        
+    }
+    fp = fprintf(stdout, "\ndedupe [options] <haks and modules in priority order>:\n");
+    if (fp < 0) {
+        cnwn_set_error("%s", strerror(errno));
+        return -1;
+    }
+    ret += fp;
+    for (int i = 0; !CNWN_OPTION_SENTINEL(CNWN_CNWNA_OPTIONS_DEDUPE + i); i++) {
+        char tmps[1024];
+        cnwn_option_to_string(CNWN_CNWNA_OPTIONS_DEDUPE + i, sizeof(tmps), tmps);
+        fp = fprintf(stdout, "  %s\n", tmps);
+        if (fp < 0) {
+            cnwn_set_error("%s", strerror(errno));
+            return -1;
+        }
+        ret += fp;        
+    }
+    fp = fprintf(stdout, "\nmanifest [options] <haks, modules and directories in priority order>:\n");
+    if (fp < 0) {
+        cnwn_set_error("%s", strerror(errno));
+        return -1;
+    }
+    ret += fp;
+    for (int i = 0; !CNWN_OPTION_SENTINEL(CNWN_CNWNA_OPTIONS_MANIFEST + i); i++) {
+        char tmps[1024];
+        cnwn_option_to_string(CNWN_CNWNA_OPTIONS_MANIFEST + i, sizeof(tmps), tmps);
+        fp = fprintf(stdout, "  %s\n", tmps);
+        if (fp < 0) {
+            cnwn_set_error("%s", strerror(errno));
+            return -1;
+        }
+        ret += fp;        
+    }
+    fp = fprintf(stdout, "\nerf-compress [options] <hak or module>:\n");
+    if (fp < 0) {
+        cnwn_set_error("%s", strerror(errno));
+        return -1;
+    }
+    ret += fp;
+    for (int i = 0; !CNWN_OPTION_SENTINEL(CNWN_CNWNA_OPTIONS_ERF_COMPRESS + i); i++) {
+        char tmps[1024];
+        cnwn_option_to_string(CNWN_CNWNA_OPTIONS_ERF_COMPRESS + i, sizeof(tmps), tmps);
+        fp = fprintf(stdout, "  %s\n", tmps);
+        if (fp < 0) {
+            cnwn_set_error("%s", strerror(errno));
+            return -1;
+        }
+        ret += fp;        
+    }
+    fp = fprintf(stdout, "\nnwsync-verify [options] <store> <NSYC manifest>:\n");
+    if (fp < 0) {
+        cnwn_set_error("%s", strerror(errno));
+        return -1;
+    }
+    ret += fp;
+    for (int i = 0; !CNWN_OPTION_SENTINEL(CNWN_CNWNA_OPTIONS_NWSYNC_VERIFY + i); i++) {
+        char tmps[1024];
+        cnwn_option_to_string(CNWN_CNWNA_OPTIONS_NWSYNC_VERIFY + i, sizeof(tmps), tmps);
+        fp = fprintf(stdout, "  %s\n", tmps);
+        if (fp < 0) {
+            cnwn_set_error("%s", strerror(errno));
+            return -1;
+        }
+        ret += fp;        
+    }
+    fp = fprintf(stdout, "\nnwsync-diff [options] <old NSYC manifest> <new NSYC manifest>:\n");
+    if (fp < 0) {
+        cnwn_set_error("%s", strerror(errno));
+        return -1;
+    }
+    ret += fp;
+    for (int i = 0; !CNWN_OPTION_SENTINEL(CNWN_CNWNA_OPTIONS_NWSYNC_DIFF + i); i++) {
+        char tmps[1024];
+        cnwn_option_to_string(CNWN_CNWNA_OPTIONS_NWSYNC_DIFF + i, sizeof(tmps), tmps);
+        fp = fprintf(stdout, "  %s\n", tmps);
+        if (fp < 0) {
+            cnwn_set_error("%s", strerror(errno));
+            return -1;
+        }
+        ret += fp;        
+    }
     return ret;
 }
 
@@ -234,32 +483,412 @@ int cnwn_cnwna_print_version(void)
 int cnwn_cnwna_execute(const cnwn_CNWNASettings * settings)
 {
     if (cnwn_strstartswith("list", settings->command) || cnwn_strcmp("ls", settings->command) == 0) {
-        cnwn_RegexpArray * regexps = cnwn_regexp_array_new2(&settings->arguments);
-        if (regexps == NULL) 
+        // Arguments that exist are more archives to list, the rest are regular expressions.
+        cnwn_StringArray paths;
+        cnwn_StringArray patterns;
+        cnwn_string_array_init(&paths);
+        cnwn_string_array_init(&patterns);
+        for (int i = 0; i < cnwn_array_get_length(&settings->arguments); i++) {
+            const char * argument = cnwn_string_array_get(&settings->arguments, i);
+            cnwn_string_array_append((cnwn_file_system_exists(argument) > 0 ? &paths : &patterns), "%s", argument);
+        }
+        cnwn_RegexpArray * regexps = cnwn_regexp_array_new2(&patterns);
+        if (regexps == NULL) {
+            cnwn_array_deinit(&paths);
+            cnwn_array_deinit(&patterns);
             return -1;
-        int ret = cnwn_cnwna_execute_list(settings->path, settings->verbose, settings->depth, regexps);
+        }
+        cnwn_Filter filter;
+        if (cnwn_filter_init(&filter, settings->filter) < 0) {
+            cnwn_set_error("%s (filter)", cnwn_get_error());
+            cnwn_regexp_array_free(regexps);
+            cnwn_array_deinit(&paths);
+            cnwn_array_deinit(&patterns);
+            return -1;
+        }
+        int ret = cnwn_cnwna_execute_list2(settings->path, &paths, settings->verbose, settings->totals, settings->depth, settings->jobs, regexps, &filter, settings->format, settings->directories);
+        cnwn_filter_deinit(&filter);
         cnwn_regexp_array_free(regexps);
+        cnwn_array_deinit(&paths);
+        cnwn_array_deinit(&patterns);
         return ret;
     }
     if (cnwn_strstartswith("extract", settings->command) || cnwn_strcmp("x", settings->command) == 0) {
         cnwn_RegexpArray * regexps = cnwn_regexp_array_new2(&settings->arguments);
         if (regexps == NULL) 
             return -1;
-        int ret = cnwn_cnwna_execute_extract(settings->path, settings->quiet, settings->depth, regexps, settings->output_path);
+        cnwn_Filter filter;
+        if (cnwn_filter_init(&filter, settings->filter) < 0) {
+            cnwn_set_error("%s (filter)", cnwn_get_error());
+            cnwn_regexp_array_free(regexps);
+            return -1;
+        }
+        int ret = cnwn_cnwna_execute_extract2(settings->path, settings->quiet, settings->depth, regexps, &filter, settings->output_path);
+        cnwn_filter_deinit(&filter);
         cnwn_regexp_array_free(regexps);
         return ret;
     }
     if (cnwn_strstartswith("create", settings->command)) {
         return cnwn_cnwna_execute_create(settings->path, settings->quiet, settings->depth, NULL);
     }
+    if (cnwn_strcmp("tlk-compact", settings->command) == 0)
+        return cnwn_cnwna_execute_tlk_compact(settings->path, settings->quiet, settings->tlk_base, &settings->arguments, settings->output_path);
+    if (cnwn_strcmp("2da-cache", settings->command) == 0)
+        return cnwn_cnwna_execute_2da_cache(settings->path, settings->quiet, &settings->arguments, settings->output_path);
+    if (cnwn_strcmp("dedupe", settings->command) == 0)
+        return cnwn_cnwna_execute_dedupe(settings->path, settings->quiet, &settings->arguments, settings->output_path);
+    if (cnwn_strcmp("manifest", settings->command) == 0)
+        return cnwn_cnwna_execute_manifest(settings->path, settings->quiet, &settings->arguments, settings->output_path, settings->jobs, settings->binary, settings->store_path);
+    if (cnwn_strcmp("erf-compress", settings->command) == 0)
+        return cnwn_cnwna_execute_erf_compress(settings->path, settings->quiet, settings->compression, settings->output_path);
+    if (cnwn_strcmp("nwsync-verify", settings->command) == 0)
+        return cnwn_cnwna_execute_nwsync_verify(settings->path, settings->quiet, cnwn_string_array_get(&settings->arguments, 0));
+    if (cnwn_strcmp("nwsync-diff", settings->command) == 0)
+        return cnwn_cnwna_execute_nwsync_diff(settings->path, settings->quiet, cnwn_string_array_get(&settings->arguments, 0), settings->store_path);
     cnwn_set_error("no command specified");
     return -1;
 }
 
-static int cnwn_cnwna_execute_list_recurse(const cnwn_Resource * resource, bool top, bool verbose, int depth, const cnwn_RegexpArray * regexps, int64_t * ret_resource_bytes, int * ret_num_meta_files, int64_t * ret_meta_file_bytes)
+#define CNWN_CNWNA_OUTPUT_BUFFER_SIZE 65536
+
+// List output is formatted into a large buffer that is written in big blocks, integers are formatted without printf.
+typedef struct cnwn_CNWNAOutput_s {
+    FILE * f;
+    cnwn_CNWNAFormat format;
+    bool verbose;
+    const char * archive;
+    int num_records;
+    int length;
+    char * buffer;
+} cnwn_CNWNAOutput;
+
+// One resource or meta file, the fields after size are only set for verbose output.
+typedef struct cnwn_CNWNAListRecord_s {
+    const char * path;
+    const char * name;
+    const char * type;
+    int64_t size;
+    bool meta;
+    const char * description;
+    int num_meta_files;
+    int num_resources;
+    cnwn_Compression compression;
+    int64_t uncompressed_size;
+    const cnwn_TextureInfo * texture;
+    const char * error;
+} cnwn_CNWNAListRecord;
+
+static void cnwn_cnwna_output_init(cnwn_CNWNAOutput * output, FILE * f, cnwn_CNWNAFormat format, bool verbose)
+{
+    memset(output, 0, sizeof(cnwn_CNWNAOutput));
+    output->f = f;
+    output->format = format;
+    output->verbose = verbose;
+    output->buffer = malloc(CNWN_CNWNA_OUTPUT_BUFFER_SIZE);
+}
+
+static void cnwn_cnwna_output_flush(cnwn_CNWNAOutput * output)
+{
+    if (output->length > 0)
+        fwrite(output->buffer, 1, output->length, output->f);
+    output->length = 0;
+}
+
+static void cnwn_cnwna_output_deinit(cnwn_CNWNAOutput * output)
+{
+    cnwn_cnwna_output_flush(output);
+    free(output->buffer);
+    output->buffer = NULL;
+}
+
+// Room for size bytes (at most CNWN_CNWNA_OUTPUT_BUFFER_SIZE) at the end of the buffer.
+static char * cnwn_cnwna_output_reserve(cnwn_CNWNAOutput * output, int size)
+{
+    if (output->length + size > CNWN_CNWNA_OUTPUT_BUFFER_SIZE)
+        cnwn_cnwna_output_flush(output);
+    return output->buffer + output->length;
+}
+
+static void cnwn_cnwna_output_write(cnwn_CNWNAOutput * output, const char * s, int length)
+{
+    if (length > CNWN_CNWNA_OUTPUT_BUFFER_SIZE / 2) {
+        cnwn_cnwna_output_flush(output);
+        fwrite(s, 1, length, output->f);
+    } else if (length > 0) {
+        memcpy(cnwn_cnwna_output_reserve(output, length), s, length);
+        output->length += length;
+    }
+}
+
+static void cnwn_cnwna_output_string(cnwn_CNWNAOutput * output, const char * s)
+{
+    cnwn_cnwna_output_write(output, s, cnwn_strlen(s));
+}
+
+static void cnwn_cnwna_output_char(cnwn_CNWNAOutput * output, char c)
+{
+    *cnwn_cnwna_output_reserve(output, 1) = c;
+    output->length++;
+}
+
+static void cnwn_cnwna_output_int(cnwn_CNWNAOutput * output, int64_t i)
+{
+    output->length += cnwn_strformatint(cnwn_cnwna_output_reserve(output, 21), 21, i);
+}
+
+// JSON strings escape quotes, backslashes and control characters, TSV fields escape backslashes, tabs and line breaks.
+static void cnwn_cnwna_output_escaped(cnwn_CNWNAOutput * output, const char * s)
+{
+    bool json = (output->format != CNWN_CNWNA_FORMAT_TSV);
+    if (json)
+        cnwn_cnwna_output_char(output, '"');
+    int start = 0;
+    for (int i = 0; s != NULL && s[i] != 0; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c != '\\' && (json ? c != '"' && c >= 32 : c != '\t' && c != '\n' && c != '\r'))
+            continue;
+        cnwn_cnwna_output_write(output, s + start, i - start);
+        start = i + 1;
+        char tmps[8] = {'\\', (char)c, 0};
+        if (c == '\t')
+            tmps[1] = 't';
+        else if (c == '\n')
+            tmps[1] = 'n';
+        else if (c == '\r')
+            tmps[1] = 'r';
+        else if (c < 32)
+            snprintf(tmps, sizeof(tmps), "\\u%04x", c);
+        cnwn_cnwna_output_string(output, tmps);
+    }
+    if (s != NULL)
+        cnwn_cnwna_output_write(output, s + start, cnwn_strlen(s + start));
+    if (json)
+        cnwn_cnwna_output_char(output, '"');
+}
+
+static void cnwn_cnwna_output_begin(cnwn_CNWNAOutput * output)
+{
+    if (output->format == CNWN_CNWNA_FORMAT_JSON)
+        cnwn_cnwna_output_string(output, "[\n");
+    else if (output->format == CNWN_CNWNA_FORMAT_TSV) {
+        cnwn_cnwna_output_string(output, "archive\tpath\ttype\tsize");
+        if (output->verbose)
+            cnwn_cnwna_output_string(output, "\tdescription\tmeta_files\tresources\tcompression\tuncompressed_size\twidth\theight\tmipmaps\tformat\tvram_size\terror");
+        cnwn_cnwna_output_char(output, '\n');
+    }
+}
+
+static void cnwn_cnwna_output_end(cnwn_CNWNAOutput * output)
+{
+    if (output->format == CNWN_CNWNA_FORMAT_JSON)
+        cnwn_cnwna_output_string(output, (output->num_records > 0 ? "\n]\n" : "]\n"));
+}
+
+static void cnwn_cnwna_output_record_text(cnwn_CNWNAOutput * output, const cnwn_CNWNAListRecord * record)
+{
+    if (record->meta)
+        cnwn_cnwna_output_string(output, "META ");
+    cnwn_cnwna_output_string(output, record->name);
+    cnwn_cnwna_output_char(output, ' ');
+    cnwn_cnwna_output_int(output, record->size);
+    if (output->verbose && record->meta && !cnwn_strisblank(record->description)) {
+        cnwn_cnwna_output_string(output, " (");
+        cnwn_cnwna_output_string(output, record->description);
+        cnwn_cnwna_output_char(output, ')');
+    } else if (output->verbose && !record->meta) {
+        cnwn_cnwna_output_string(output, " (");
+        cnwn_cnwna_output_string(output, record->description);
+        if (record->num_meta_files > 0) {
+            cnwn_cnwna_output_string(output, ", ");
+            cnwn_cnwna_output_int(output, record->num_meta_files);
+            cnwn_cnwna_output_string(output, " meta files");
+        }
+        if (record->num_resources > 0) {
+            cnwn_cnwna_output_string(output, ", ");
+            cnwn_cnwna_output_int(output, record->num_resources);
+            cnwn_cnwna_output_string(output, " resources");
+        }
+        if (record->compression != CNWN_COMPRESSION_NONE) {
+            cnwn_cnwna_output_string(output, ", ");
+            cnwn_cnwna_output_string(output, cnwn_compression_name(record->compression));
+            cnwn_cnwna_output_char(output, ' ');
+            cnwn_cnwna_output_int(output, record->uncompressed_size);
+            cnwn_cnwna_output_string(output, " bytes uncompressed");
+        } else if (record->texture != NULL) {
+            char tmps[1024];
+            cnwn_texture_info_to_string(record->texture, tmps, sizeof(tmps));
+            cnwn_cnwna_output_string(output, ", ");
+            cnwn_cnwna_output_string(output, tmps);
+        } else if (record->error != NULL) {
+            cnwn_cnwna_output_string(output, ", ");
+            cnwn_cnwna_output_string(output, record->error);
+        }
+        cnwn_cnwna_output_char(output, ')');
+    }
+    cnwn_cnwna_output_char(output, '\n');
+}
+
+static void cnwn_cnwna_output_record_tsv(cnwn_CNWNAOutput * output, const cnwn_CNWNAListRecord * record)
+{
+    cnwn_cnwna_output_escaped(output, output->archive);
+    cnwn_cnwna_output_char(output, '\t');
+    cnwn_cnwna_output_escaped(output, record->path);
+    cnwn_cnwna_output_char(output, '\t');
+    cnwn_cnwna_output_string(output, record->type);
+    cnwn_cnwna_output_char(output, '\t');
+    cnwn_cnwna_output_int(output, record->size);
+    if (output->verbose) {
+        // Columns that don't apply are left empty.
+        cnwn_cnwna_output_char(output, '\t');
+        cnwn_cnwna_output_escaped(output, record->description);
+        cnwn_cnwna_output_char(output, '\t');
+        if (!record->meta)
+            cnwn_cnwna_output_int(output, record->num_meta_files);
+        cnwn_cnwna_output_char(output, '\t');
+        if (!record->meta)
+            cnwn_cnwna_output_int(output, record->num_resources);
+        cnwn_cnwna_output_char(output, '\t');
+        if (record->compression != CNWN_COMPRESSION_NONE) {
+            cnwn_cnwna_output_string(output, cnwn_compression_name(record->compression));
+            cnwn_cnwna_output_char(output, '\t');
+            cnwn_cnwna_output_int(output, record->uncompressed_size);
+        } else
+            cnwn_cnwna_output_char(output, '\t');
+        if (record->texture != NULL) {
+            cnwn_cnwna_output_char(output, '\t');
+            cnwn_cnwna_output_int(output, record->texture->width);
+            cnwn_cnwna_output_char(output, '\t');
+            cnwn_cnwna_output_int(output, record->texture->height);
+            cnwn_cnwna_output_char(output, '\t');
+            cnwn_cnwna_output_int(output, record->texture->num_mipmaps);
+            cnwn_cnwna_output_char(output, '\t');
+            cnwn_cnwna_output_string(output, cnwn_texture_format_name(record->texture->format));
+            cnwn_cnwna_output_char(output, '\t');
+            cnwn_cnwna_output_int(output, record->texture->vram_size);
+        } else
+            cnwn_cnwna_output_string(output, "\t\t\t\t\t");
+        cnwn_cnwna_output_char(output, '\t');
+        cnwn_cnwna_output_escaped(output, record->error);
+    }
+    cnwn_cnwna_output_char(output, '\n');
+}
+
+static void cnwn_cnwna_output_record_json(cnwn_CNWNAOutput * output, const cnwn_CNWNAListRecord * record)
+{
+    if (output->format == CNWN_CNWNA_FORMAT_JSON && output->num_records > 0)
+        cnwn_cnwna_output_string(output, ",\n");
+    cnwn_cnwna_output_string(output, "{\"archive\":");
+    cnwn_cnwna_output_escaped(output, output->archive);
+    cnwn_cnwna_output_string(output, ",\"path\":");
+    cnwn_cnwna_output_escaped(output, record->path);
+    cnwn_cnwna_output_string(output, ",\"type\":\"");
+    cnwn_cnwna_output_string(output, record->type);
+    cnwn_cnwna_output_string(output, "\",\"size\":");
+    cnwn_cnwna_output_int(output, record->size);
+    if (output->verbose) {
+        // Fields that don't apply are left out.
+        if (!cnwn_strisblank(record->description)) {
+            cnwn_cnwna_output_string(output, ",\"description\":");
+            cnwn_cnwna_output_escaped(output, record->description);
+        }
+        if (record->num_meta_files > 0) {
+            cnwn_cnwna_output_string(output, ",\"meta_files\":");
+            cnwn_cnwna_output_int(output, record->num_meta_files);
+        }
+        if (record->num_resources > 0) {
+            cnwn_cnwna_output_string(output, ",\"resources\":");
+            cnwn_cnwna_output_int(output, record->num_resources);
+        }
+        if (record->compression != CNWN_COMPRESSION_NONE) {
+            cnwn_cnwna_output_string(output, ",\"compression\":\"");
+            cnwn_cnwna_output_string(output, cnwn_compression_name(record->compression));
+            cnwn_cnwna_output_string(output, "\",\"uncompressed_size\":");
+            cnwn_cnwna_output_int(output, record->uncompressed_size);
+        }
+        if (record->texture != NULL) {
+            cnwn_cnwna_output_string(output, ",\"width\":");
+            cnwn_cnwna_output_int(output, record->texture->width);
+            cnwn_cnwna_output_string(output, ",\"height\":");
+            cnwn_cnwna_output_int(output, record->texture->height);
+            cnwn_cnwna_output_string(output, ",\"mipmaps\":");
+            cnwn_cnwna_output_int(output, record->texture->num_mipmaps);
+            cnwn_cnwna_output_string(output, ",\"format\":\"");
+            cnwn_cnwna_output_string(output, cnwn_texture_format_name(record->texture->format));
+            cnwn_cnwna_output_string(output, "\",\"vram_size\":");
+            cnwn_cnwna_output_int(output, record->texture->vram_size);
+        }
+        if (record->error != NULL) {
+            cnwn_cnwna_output_string(output, ",\"error\":");
+            cnwn_cnwna_output_escaped(output, record->error);
+        }
+    }
+    cnwn_cnwna_output_char(output, '}');
+    if (output->format == CNWN_CNWNA_FORMAT_JSONL)
+        cnwn_cnwna_output_char(output, '\n');
+}
+
+static void cnwn_cnwna_output_record(cnwn_CNWNAOutput * output, const cnwn_CNWNAListRecord * record)
+{
+    if (output->format == CNWN_CNWNA_FORMAT_TEXT)
+        cnwn_cnwna_output_record_text(output, record);
+    else if (output->format == CNWN_CNWNA_FORMAT_TSV)
+        cnwn_cnwna_output_record_tsv(output, record);
+    else if (output->format == CNWN_CNWNA_FORMAT_JSON || output->format == CNWN_CNWNA_FORMAT_JSONL)
+        cnwn_cnwna_output_record_json(output, record);
+    output->num_records++;
+}
+
+// Directories are opened as archives of the files in them, they have no file of their own (*ret_f is NULL).
+static int cnwn_cnwna_open_archive(const char * path, cnwn_Resource * ret_resource, cnwn_File ** ret_f)
+{
+    *ret_f = NULL;
+    if (cnwn_file_system_isdirectory(path) > 0)
+        return cnwn_resource_init_from_path(ret_resource, NULL, path);
+    cnwn_ResourceType rtype = cnwn_resource_type_from_path(path);
+    if (!CNWN_RESOURCE_TYPE_VALID(rtype)) {
+        cnwn_set_error("invalid resource type (%s)", path);
+        return -1;
+    }
+    char name[CNWN_PATH_MAX_SIZE];
+    cnwn_path_filenamepart(name, sizeof(name), path);
+    cnwn_File * f = cnwn_file_open(path, "r");
+    if (f == NULL) {
+        cnwn_set_error("%s (open %s)", cnwn_get_error(), path);
+        return -1;
+    }
+    int64_t size = cnwn_file_size(f);
+    if (size < 0) {
+        cnwn_set_error("%s (size %s)", cnwn_get_error(), path);
+        cnwn_file_close(f);
+        return -1;
+    }
+    if (cnwn_resource_init_from_file(ret_resource, rtype, name, 0, size, NULL, f) < 0) {
+        cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+        cnwn_file_close(f);
+        return -1;
+    }
+    *ret_f = f;
+    return 0;
+}
+
+// Resources in a directory are read from their own file, it is opened when @p resource has children or meta files
+// (or @p always) and must be closed if it isn't @p input_f.
+static int cnwn_cnwna_open_resource_file(const cnwn_Resource * resource, cnwn_File * input_f, bool always, cnwn_File ** ret_f)
+{
+    *ret_f = input_f;
+    if (resource->path == NULL || (!always && cnwn_resource_get_num_resources(resource) == 0 && cnwn_resource_get_num_meta_files(resource) == 0))
+        return 0;
+    *ret_f = cnwn_file_open(resource->path, "r");
+    if (*ret_f == NULL) {
+        cnwn_set_error("%s (open %s)", cnwn_get_error(), resource->path);
+        return -1;
+    }
+    return 0;
+}
+
+// path holds the path of resource (path_length characters, CNWN_PATH_MAX_SIZE bytes), the children append to it.
+static int cnwn_cnwna_execute_list_recurse(const cnwn_Resource * resource, cnwn_File * input_f, bool top, int depth, const cnwn_RegexpArray * regexps, const cnwn_Filter * filter, char * path, int path_length, int64_t * ret_resource_bytes, int * ret_num_meta_files, int64_t * ret_meta_file_bytes, int * ret_num_textures, int64_t * ret_texture_bytes, cnwn_CNWNAOutput * output, int * type_counts, int64_t * type_bytes)
 {
-    char path[CNWN_PATH_MAX_SIZE];
-    cnwn_resource_get_path(resource, sizeof(path), path);
     if (!top && regexps != NULL && !cnwn_regexp_array_match_any(regexps, path)) {
         if (ret_resource_bytes != NULL)
             *ret_resource_bytes = 0;
@@ -267,122 +896,458 @@ static int cnwn_cnwna_execute_list_recurse(const cnwn_Resource * resource, bool
             *ret_num_meta_files = 0;
         if (ret_meta_file_bytes != NULL)
             *ret_meta_file_bytes = 0;
+        if (ret_num_textures != NULL)
+            *ret_num_textures = 0;
+        if (ret_texture_bytes != NULL)
+            *ret_texture_bytes = 0;
         return 0;
     }
     int has_num_resources = 0;
     int64_t has_resource_bytes = 0;
     int has_num_meta_files = 0;
     int64_t has_meta_file_bytes = 0;
+    int has_num_textures = 0;
+    int64_t has_texture_bytes = 0;
     const cnwn_ResourceTypeInfo info = CNWN_RESOURCE_TYPE_INFO(resource->type);
-    const char * stype = (cnwn_strisblank(info.name) ? info.extension : info.name);
     int num_meta_files = cnwn_resource_get_num_meta_files(resource);
     int num_resources = cnwn_resource_get_num_resources(resource);
     if (!top) {
-        if (verbose) {
-            char meta_files_str[1024];
-            if (num_meta_files > 0)
-                snprintf(meta_files_str, sizeof(meta_files_str), ", %d meta files", num_meta_files);
-            else
-                meta_files_str[0] = 0;
-            char resources_str[1024];
-            if (num_meta_files > 0)
-                snprintf(resources_str, sizeof(resources_str), ", %d resources", num_resources);
-            else
-                meta_files_str[0] = 0;
-            printf("%s %"PRId64" (%s%s%s)\n",
-                   path,
-                   resource->size,
-                   stype,
-                   meta_files_str,
-                   resources_str);
-        } else
-            printf("%s %"PRId64"\n", path, resource->size);
+        cnwn_CNWNAListRecord record;
+        memset(&record, 0, sizeof(record));
+        record.path = path;
+        record.name = path;
+        record.type = (info.extension != NULL ? info.extension : "");
+        record.size = resource->size;
+        cnwn_TextureInfo texture_info;
+        char error[1024];
+        if (output->verbose) {
+            record.description = (cnwn_strisblank(info.name) ? info.extension : info.name);
+            record.num_meta_files = num_meta_files;
+            record.num_resources = num_resources;
+            record.compression = resource->compression;
+            record.uncompressed_size = resource->uncompressed_size;
+            if (resource->compression == CNWN_COMPRESSION_NONE && CNWN_TEXTURE_IS_TEXTURE_TYPE(resource->type)) {
+                int tret = cnwn_texture_probe_file(resource->type, input_f, resource->offset, resource->size, &texture_info);
+                if (tret > 0) {
+                    record.texture = &texture_info;
+                    has_num_textures++;
+                    has_texture_bytes += texture_info.vram_size;
+                } else if (tret < 0) {
+                    snprintf(error, sizeof(error), "%s", cnwn_get_error());
+                    record.error = error;
+                }
+            }
+        }
+        cnwn_cnwna_output_record(output, &record);
+        if (type_counts != NULL) {
+            // Indexed like CNWN_RESOURCE_TYPE_INFOS, unknown types are counted in the last slot.
+            int index = CNWN_RESOURCE_TYPE_INDEX(resource->type);
+            if (index < 0)
+                index = CNWN_NUM_RESOURCE_TYPES;
+            type_counts[index]++;
+            type_bytes[index] += resource->size;
+        }
+        has_num_resources++;
+        has_resource_bytes += resource->size;
     }
     if (depth != 0) {
         for (int i = 0; i < num_meta_files; i++) {
             cnwn_MetaFile meta_file;
             if (cnwn_resource_get_meta_file(resource, i, &meta_file) > 0) {
-                if (verbose && !cnwn_strisblank(meta_file.description)) 
-                    printf("META %s %"PRId64" (%s)\n", meta_file.name, meta_file.size, meta_file.description);
-                else
-                    printf("META %s %"PRId64"\n", meta_file.name, meta_file.size);
+                cnwn_CNWNAListRecord record;
+                memset(&record, 0, sizeof(record));
+                record.path = meta_file.name;
+                record.name = meta_file.name;
+                record.type = "meta";
+                record.size = meta_file.size;
+                record.meta = true;
+                if (output->verbose)
+                    record.description = meta_file.description;
+                // Other formats than text give meta files the path they are extracted to.
+                if (output->format != CNWN_CNWNA_FORMAT_TEXT && path_length > 0) {
+                    int meta_file_length = path_length + cnwn_strcpy(path + path_length, CNWN_PATH_MAX_SIZE - path_length, CNWN_PATH_SEPARATOR, -1);
+                    cnwn_strcpy(path + meta_file_length, CNWN_PATH_MAX_SIZE - meta_file_length, meta_file.name, -1);
+                    record.path = path;
+                }
+                cnwn_cnwna_output_record(output, &record);
+                path[path_length] = 0;
                 has_num_meta_files++;
                 has_meta_file_bytes += meta_file.size;
             }
         }
         for (int i = 0; i < num_resources; i++) {
+            // The filter only needs the entry table, resources it rejects never get a path. Archives it rejects are
+            // still searched like the top archive, only their own line is left out.
+            bool matched = true;
+            if (filter != NULL) {
+                int fret = cnwn_filter_match(filter, resource, i, input_f);
+                if (fret < 0)
+                    return -1;
+                matched = (fret > 0);
+                if (!matched && (depth == 1 || !CNWN_RESOURCE_TYPE_IS_ERF(resource->entries.types[i])))
+                    continue;
+            }
             int64_t tmp_resource_bytes = 0;
             int tmp_num_meta_files = 0;
             int64_t tmp_meta_file_bytes = 0;
-            cnwn_Resource * subresource = cnwn_resource_get_resource(resource, i);
-            int tmp_num_resources = cnwn_cnwna_execute_list_recurse(subresource, false, verbose, (depth > 0 ? depth - 1 : -1), regexps, &tmp_resource_bytes, &tmp_num_meta_files, &tmp_meta_file_bytes);
+            int tmp_num_textures = 0;
+            int64_t tmp_texture_bytes = 0;
+            cnwn_Resource view;
+            const cnwn_Resource * subresource = cnwn_resource_get_resource(resource, i, &view);
+            int subpath_length = cnwn_resource_get_path2(subresource, path_length, CNWN_PATH_MAX_SIZE, path);
+            cnwn_File * subresource_f;
+            if (cnwn_cnwna_open_resource_file(subresource, input_f, output->verbose && CNWN_TEXTURE_IS_TEXTURE_TYPE(subresource->type), &subresource_f) < 0) {
+                path[path_length] = 0;
+                return -1;
+            }
+            int tmp_num_resources = cnwn_cnwna_execute_list_recurse(subresource, subresource_f, !matched, (depth > 0 ? depth - 1 : -1), regexps, filter, path, subpath_length, &tmp_resource_bytes, &tmp_num_meta_files, &tmp_meta_file_bytes, &tmp_num_textures, &tmp_texture_bytes, output, type_counts, type_bytes);
+            if (subresource_f != input_f)
+                cnwn_file_close(subresource_f);
+            path[path_length] = 0;
             if (tmp_num_resources < 0) 
                 return -1;
             has_num_resources += tmp_num_resources;
             has_resource_bytes += tmp_resource_bytes;
             has_num_meta_files += tmp_num_meta_files;
             has_meta_file_bytes += tmp_meta_file_bytes;
+            has_num_textures += tmp_num_textures;
+            has_texture_bytes += tmp_texture_bytes;
         }
-    } else {
-        has_resource_bytes += resource->size;
     }
-    has_num_resources++;
     if (ret_resource_bytes)
         *ret_resource_bytes = has_resource_bytes;
     if (ret_num_meta_files != NULL)
         *ret_num_meta_files = has_num_meta_files;
     if (ret_meta_file_bytes != NULL)
         *ret_meta_file_bytes = has_meta_file_bytes;
+    if (ret_num_textures != NULL)
+        *ret_num_textures = has_num_textures;
+    if (ret_texture_bytes != NULL)
+        *ret_texture_bytes = has_texture_bytes;
     return has_num_resources;
 }
 
-int cnwn_cnwna_execute_list(const char * path, bool verbose, int depth, const cnwn_RegexpArray * regexps)
+static int cnwn_cnwna_list_archive(const char * path, int depth, const cnwn_RegexpArray * regexps, const cnwn_Filter * filter, cnwn_CNWNAOutput * output, int * type_counts, int64_t * type_bytes, int64_t * ret_resource_bytes, int * ret_num_meta_files, int64_t * ret_meta_file_bytes, int * ret_num_textures, int64_t * ret_texture_bytes)
 {
-    cnwn_ResourceType rtype = cnwn_resource_type_from_path(path);
-    if (!CNWN_RESOURCE_TYPE_VALID(rtype)) {
-        cnwn_set_error("invalid resource type (%s)", path);
-        return -1;
-    }
-    char name[CNWN_PATH_MAX_SIZE];
-    cnwn_path_filenamepart(name, sizeof(name), path);
-    cnwn_File * f = cnwn_file_open(path, "r");
-    if (f == NULL) {
-        cnwn_set_error("%s (open %s)", cnwn_get_error(), path);
+    cnwn_Resource resource;
+    cnwn_File * f;
+    if (cnwn_cnwna_open_archive(path, &resource, &f) < 0)
         return -1;
-    }
-    int64_t size = cnwn_file_size(f);
-    if (size < 0) {
-        cnwn_set_error("%s (size %s)", cnwn_get_error(), path);
+    int64_t resource_bytes = 0;
+    int num_meta_files = 0;
+    int64_t meta_file_bytes = 0;
+    int num_textures = 0;
+    int64_t texture_bytes = 0;
+    char resource_path[CNWN_PATH_MAX_SIZE];
+    resource_path[0] = 0;
+    output->archive = path;
+    int ret = cnwn_cnwna_execute_list_recurse(&resource, f, true, depth, regexps, filter, resource_path, 0, &resource_bytes, &num_meta_files, &meta_file_bytes, &num_textures, &texture_bytes, output, type_counts, type_bytes);
+    cnwn_resource_deinit(&resource);
+    if (f != NULL)
         cnwn_file_close(f);
+    if (ret < 0)
         return -1;
+    if (output->verbose && output->format == CNWN_CNWNA_FORMAT_TEXT) {
+        char tmps[1024];
+        snprintf(tmps, sizeof(tmps), "Total %d meta files (%"PRId64" bytes) and %d resources (%"PRId64" bytes)\n", num_meta_files, meta_file_bytes, ret, resource_bytes);
+        cnwn_cnwna_output_string(output, tmps);
+        if (num_textures > 0) {
+            snprintf(tmps, sizeof(tmps), "Total %d textures (%"PRId64" bytes VRAM)\n", num_textures, texture_bytes);
+            cnwn_cnwna_output_string(output, tmps);
+        }
     }
-    cnwn_Resource resource;
-    int ret = cnwn_resource_init_from_file(&resource, rtype, name, 0, size, NULL, f);
-    if (ret < 0) {
+    if (ret_resource_bytes != NULL)
+        *ret_resource_bytes = resource_bytes;
+    if (ret_num_meta_files != NULL)
+        *ret_num_meta_files = num_meta_files;
+    if (ret_meta_file_bytes != NULL)
+        *ret_meta_file_bytes = meta_file_bytes;
+    if (ret_num_textures != NULL)
+        *ret_num_textures = num_textures;
+    if (ret_texture_bytes != NULL)
+        *ret_texture_bytes = texture_bytes;
+    return ret;
+}
+
+int cnwn_cnwna_format_from_name(const char * name)
+{
+    static const char * names[CNWN_CNWNA_MAX_FORMAT] = {"text", "json", "jsonl", "tsv", "null"};
+    for (int i = 0; i < CNWN_CNWNA_MAX_FORMAT; i++)
+        if (name != NULL && cnwn_strcmpi(names[i], name) == 0)
+            return i;
+    return -1;
+}
+
+int cnwn_cnwna_execute_list(const char * path, bool verbose, int depth, const cnwn_RegexpArray * regexps)
+{
+    return cnwn_cnwna_execute_list2(path, NULL, verbose, false, depth, 0, regexps, NULL, CNWN_CNWNA_FORMAT_TEXT, false);
+}
+
+typedef struct cnwn_CNWNAListJob_s {
+    const char * path;
+    FILE * output;
+    bool done;
+    int ret;
+    int num_records;
+    char error[1024];
+    int64_t resource_bytes;
+    int num_meta_files;
+    int64_t meta_file_bytes;
+    int num_textures;
+    int64_t texture_bytes;
+} cnwn_CNWNAListJob;
+
+typedef struct cnwn_CNWNAListJobs_s {
+    cnwn_CNWNAListJob * jobs;
+    int num_jobs;
+    int next;
+    bool verbose;
+    int depth;
+    const cnwn_RegexpArray * regexps;
+    const cnwn_Filter * filter;
+    cnwn_CNWNAFormat format;
+    int * type_counts;
+    int64_t * type_bytes;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} cnwn_CNWNAListJobs;
+
+static void * cnwn_cnwna_list_worker(void * data)
+{
+    cnwn_CNWNAListJobs * jobs = data;
+    // Each worker keeps its own histogram, they are summed when the worker is done.
+    int * type_counts = calloc(CNWN_NUM_RESOURCE_TYPES + 1, sizeof(int));
+    int64_t * type_bytes = calloc(CNWN_NUM_RESOURCE_TYPES + 1, sizeof(int64_t));
+    while (true) {
+        pthread_mutex_lock(&jobs->mutex);
+        int index = jobs->next++;
+        pthread_mutex_unlock(&jobs->mutex);
+        if (index >= jobs->num_jobs)
+            break;
+        cnwn_CNWNAListJob * job = jobs->jobs + index;
+        job->output = tmpfile();
+        if (job->output == NULL) {
+            cnwn_set_error("%s (temporary file for %s)", strerror(errno), job->path);
+            job->ret = -1;
+        } else {
+            cnwn_CNWNAOutput output;
+            cnwn_cnwna_output_init(&output, job->output, jobs->format, jobs->verbose);
+            job->ret = cnwn_cnwna_list_archive(job->path, jobs->depth, jobs->regexps, jobs->filter, &output, type_counts, type_bytes, &job->resource_bytes, &job->num_meta_files, &job->meta_file_bytes, &job->num_textures, &job->texture_bytes);
+            job->num_records = output.num_records;
+            cnwn_cnwna_output_deinit(&output);
+        }
+        if (job->ret < 0)
+            snprintf(job->error, sizeof(job->error), "%s", cnwn_get_error());
+        pthread_mutex_lock(&jobs->mutex);
+        job->done = true;
+        pthread_cond_broadcast(&jobs->cond);
+        pthread_mutex_unlock(&jobs->mutex);
+    }
+    pthread_mutex_lock(&jobs->mutex);
+    for (int i = 0; i <= CNWN_NUM_RESOURCE_TYPES; i++) {
+        jobs->type_counts[i] += type_counts[i];
+        jobs->type_bytes[i] += type_bytes[i];
+    }
+    pthread_mutex_unlock(&jobs->mutex);
+    free(type_bytes);
+    free(type_counts);
+    return NULL;
+}
+
+static int cnwn_cnwna_list_compare_path(const void * a, const void * b)
+{
+    return cnwn_strcmp(*(const char **)a, *(const char **)b);
+}
+
+static int cnwn_cnwna_list_collect(const char * path, bool directories, cnwn_StringArray * archives)
+{
+    if (directories || cnwn_file_system_isdirectory(path) <= 0)
+        return cnwn_string_array_append(archives, "%s", path);
+    cnwn_StringArray paths;
+    cnwn_string_array_init(&paths);
+    if (cnwn_file_system_ls2(path, true, &paths) < 0) {
         cnwn_set_error("%s (%s)", cnwn_get_error(), path);
-        cnwn_file_close(f);
+        cnwn_array_deinit(&paths);
         return -1;
     }
+    int num_paths = cnwn_array_get_length(&paths);
+    if (num_paths > 0)
+        qsort(cnwn_array_element_ptr(&paths, 0), num_paths, sizeof(char *), cnwn_cnwna_list_compare_path);
+    for (int i = 0; i < num_paths; i++) {
+        const char * subpath = cnwn_string_array_get(&paths, i);
+        if (CNWN_RESOURCE_TYPE_IS_ERF(cnwn_resource_type_from_path(subpath)) && cnwn_file_system_isfile(subpath) > 0)
+            cnwn_string_array_append(archives, "%s", subpath);
+    }
+    cnwn_array_deinit(&paths);
+    return cnwn_array_get_length(archives);
+}
+
+static void cnwn_cnwna_list_print_totals(const cnwn_CNWNAListJobs * state, bool histogram, int num_archives, int num_meta_files, int64_t meta_file_bytes, int num_textures, int64_t texture_bytes)
+{
+    int num_types = 0;
+    int num_resources = 0;
     int64_t resource_bytes = 0;
+    for (int i = 0; i <= CNWN_NUM_RESOURCE_TYPES; i++) {
+        if (state->type_counts[i] > 0)
+            num_types++;
+        num_resources += state->type_counts[i];
+        resource_bytes += state->type_bytes[i];
+    }
+    printf("Total %d archives, %d meta files (%"PRId64" bytes) and %d resources (%"PRId64" bytes)\n",
+           num_archives, num_meta_files, meta_file_bytes, num_resources, resource_bytes);
+    if (num_textures > 0)
+        printf("Total %d textures (%"PRId64" bytes VRAM)\n", num_textures, texture_bytes);
+    if (!histogram || num_types == 0)
+        return;
+    int * types = malloc(sizeof(int) * num_types);
+    num_types = 0;
+    for (int i = 0; i <= CNWN_NUM_RESOURCE_TYPES; i++)
+        if (state->type_counts[i] > 0)
+            types[num_types++] = i;
+    // Most common types first, equal counts stay in type order.
+    for (int i = 1; i < num_types; i++) {
+        int type = types[i];
+        int j = i;
+        for (; j > 0 && state->type_counts[types[j - 1]] < state->type_counts[type]; j--)
+            types[j] = types[j - 1];
+        types[j] = type;
+    }
+    for (int i = 0; i < num_types; i++) {
+        const cnwn_ResourceTypeInfo info = (types[i] < CNWN_NUM_RESOURCE_TYPES ? CNWN_RESOURCE_TYPE_INFOS[types[i]] : CNWN_RESOURCE_TYPE_INFO_INVALID);
+        const char * stype = (cnwn_strisblank(info.name) ? (info.extension != NULL ? info.extension : "unknown") : info.name);
+        printf("%s %d %"PRId64" (%s)\n",
+               (cnwn_strisblank(info.extension) ? "?" : info.extension),
+               state->type_counts[types[i]],
+               state->type_bytes[types[i]],
+               stype);
+    }
+    free(types);
+}
+
+int cnwn_cnwna_execute_list2(const char * path, const cnwn_StringArray * paths, bool verbose, bool totals, int depth, int jobs, const cnwn_RegexpArray * regexps, const cnwn_Filter * filter, cnwn_CNWNAFormat format, bool directories)
+{
+    bool text = (format == CNWN_CNWNA_FORMAT_TEXT);
+    bool single = (paths == NULL || cnwn_array_get_length(paths) == 0) && (directories || cnwn_file_system_isdirectory(path) <= 0);
+    cnwn_CNWNAOutput output;
+    cnwn_cnwna_output_init(&output, stdout, format, verbose);
+    cnwn_cnwna_output_begin(&output);
+    if (single && (!totals || !text)) {
+        int ret = cnwn_cnwna_list_archive(path, depth, regexps, filter, &output, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        cnwn_cnwna_output_end(&output);
+        cnwn_cnwna_output_deinit(&output);
+        return ret;
+    }
+    cnwn_StringArray archives;
+    cnwn_string_array_init(&archives);
+    int num_paths = 1 + (paths != NULL ? cnwn_array_get_length(paths) : 0);
+    for (int i = 0; i < num_paths; i++) {
+        if (cnwn_cnwna_list_collect((i == 0 ? path : cnwn_string_array_get(paths, i - 1)), directories, &archives) < 0) {
+            cnwn_cnwna_output_end(&output);
+            cnwn_cnwna_output_deinit(&output);
+            cnwn_array_deinit(&archives);
+            return -1;
+        }
+    }
+    cnwn_CNWNAListJobs state;
+    memset(&state, 0, sizeof(state));
+    state.num_jobs = cnwn_array_get_length(&archives);
+    state.jobs = calloc(CNWN_MAX(1, state.num_jobs), sizeof(cnwn_CNWNAListJob));
+    state.verbose = verbose;
+    state.depth = depth;
+    state.regexps = regexps;
+    state.filter = filter;
+    state.format = format;
+    state.type_counts = calloc(CNWN_NUM_RESOURCE_TYPES + 1, sizeof(int));
+    state.type_bytes = calloc(CNWN_NUM_RESOURCE_TYPES + 1, sizeof(int64_t));
+    pthread_mutex_init(&state.mutex, NULL);
+    pthread_cond_init(&state.cond, NULL);
+    for (int i = 0; i < state.num_jobs; i++)
+        state.jobs[i].path = cnwn_string_array_get(&archives, i);
+    if (jobs <= 0) {
+        long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = (num_cpus > 0 ? (int)num_cpus : 1);
+    }
+    jobs = CNWN_MAX(1, CNWN_MIN(jobs, state.num_jobs));
+    pthread_t * threads = malloc(sizeof(pthread_t) * jobs);
+    int num_threads = 0;
+    for (int i = 0; i < jobs; i++)
+        if (pthread_create(threads + num_threads, NULL, &cnwn_cnwna_list_worker, &state) == 0)
+            num_threads++;
+    if (num_threads == 0)
+        cnwn_cnwna_list_worker(&state);
+    // The calling thread prints each listing as soon as it and all listings before it are done.
+    int ret = 0;
+    int num_failed = 0;
     int num_meta_files = 0;
     int64_t meta_file_bytes = 0;
-    ret = cnwn_cnwna_execute_list_recurse(&resource, true, verbose, depth, regexps, &resource_bytes, &num_meta_files, &meta_file_bytes);
-    if (ret < 0) {
-        cnwn_resource_deinit(&resource);
-        cnwn_file_close(f);
-        return -1;
+    int num_textures = 0;
+    int64_t texture_bytes = 0;
+    for (int i = 0; i < state.num_jobs; i++) {
+        cnwn_CNWNAListJob * job = state.jobs + i;
+        pthread_mutex_lock(&state.mutex);
+        while (!job->done)
+            pthread_cond_wait(&state.cond, &state.mutex);
+        pthread_mutex_unlock(&state.mutex);
+        if (!single && text) {
+            if (i > 0)
+                cnwn_cnwna_output_char(&output, '\n');
+            cnwn_cnwna_output_string(&output, job->path);
+            cnwn_cnwna_output_string(&output, ":\n");
+        }
+        if (job->output != NULL) {
+            // Each listing starts its own JSON array elements.
+            if (format == CNWN_CNWNA_FORMAT_JSON && job->num_records > 0 && output.num_records > 0)
+                cnwn_cnwna_output_string(&output, ",\n");
+            output.num_records += job->num_records;
+            size_t read_size;
+            rewind(job->output);
+            while ((read_size = fread(cnwn_cnwna_output_reserve(&output, CNWN_FILE_BUFFER_SIZE), 1, CNWN_FILE_BUFFER_SIZE, job->output)) > 0)
+                output.length += (int)read_size;
+            fclose(job->output);
+            job->output = NULL;
+        }
+        if (job->ret < 0) {
+            cnwn_cnwna_output_flush(&output);
+            fflush(stdout);
+            fprintf(stderr, "ERROR: %s\n", job->error);
+            num_failed++;
+            continue;
+        }
+        ret += job->ret;
+        num_meta_files += job->num_meta_files;
+        meta_file_bytes += job->meta_file_bytes;
+        num_textures += job->num_textures;
+        texture_bytes += job->texture_bytes;
     }
-    cnwn_resource_deinit(&resource);
-    cnwn_file_close(f);
-    if (verbose)
-        printf("Total %d meta files (%"PRId64" bytes) and %d resources (%"PRId64" bytes)\n", num_meta_files, meta_file_bytes, ret, resource_bytes);
-    return ret;
+    for (int i = 0; i < num_threads; i++)
+        pthread_join(threads[i], NULL);
+    free(threads);
+    cnwn_cnwna_output_end(&output);
+    cnwn_cnwna_output_deinit(&output);
+    if (text && (totals || verbose)) {
+        if (!single)
+            printf("\n");
+        cnwn_cnwna_list_print_totals(&state, totals, state.num_jobs - num_failed, num_meta_files, meta_file_bytes, num_textures, texture_bytes);
+    }
+    if (num_failed > 0) {
+        fflush(stdout);
+        cnwn_set_error("%d of %d archives failed", num_failed, state.num_jobs);
+    }
+    pthread_cond_destroy(&state.cond);
+    pthread_mutex_destroy(&state.mutex);
+    free(state.type_bytes);
+    free(state.type_counts);
+    free(state.jobs);
+    cnwn_array_deinit(&archives);
+    return (num_failed > 0 ? -1 : ret);
 }
 
-static int cnwn_cnwna_execute_extract_recurse(const cnwn_Resource * resource, cnwn_File * input_f, bool top, bool quiet, int depth, const cnwn_RegexpArray * regexps, const char * output_path, int64_t * ret_resource_bytes, int * ret_num_meta_files, int64_t * ret_meta_file_bytes)
+// use_path holds the output path (output_length characters including the separator, CNWN_PATH_MAX_SIZE bytes) followed
+// by the path of resource (path_length characters), the children and meta files append to it.
+static int cnwn_cnwna_execute_extract_recurse(const cnwn_Resource * resource, cnwn_File * input_f, bool top, bool quiet, int depth, const cnwn_RegexpArray * regexps, const cnwn_Filter * filter, char * use_path, int output_length, int path_length, int64_t * ret_resource_bytes, int * ret_num_meta_files, int64_t * ret_meta_file_bytes)
 {
-    char path[CNWN_PATH_MAX_SIZE];
-    cnwn_resource_get_path(resource, sizeof(path), path);
+    char * path = use_path + output_length;
+    int max_path_size = CNWN_PATH_MAX_SIZE - output_length;
     if (!top && regexps != NULL && !cnwn_regexp_array_match_any(regexps, path)) {
         if (ret_resource_bytes != NULL)
             *ret_resource_bytes = 0;
@@ -392,11 +1357,6 @@ static int cnwn_cnwna_execute_extract_recurse(const cnwn_Resource * resource, cn
             *ret_meta_file_bytes = 0;
         return 0;
     }
-    char use_path[CNWN_PATH_MAX_SIZE];
-    if (cnwn_strisblank(output_path))
-        snprintf(use_path, sizeof(use_path), path);
-    else 
-        snprintf(use_path, sizeof(use_path), "%s%s%s", output_path, CNWN_PATH_SEPARATOR, path);
     int has_num_resources = 0;
     int64_t has_resource_bytes = 0;
     int has_num_meta_files = 0;
@@ -404,47 +1364,70 @@ static int cnwn_cnwna_execute_extract_recurse(const cnwn_Resource * resource, cn
     int num_meta_files = cnwn_resource_get_num_meta_files(resource);
     int num_resources = cnwn_resource_get_num_resources(resource);
     if (depth != 0) {
+        // The top resource is not part of the paths but meta files are still reported as its own.
+        char top_path[CNWN_PATH_MAX_SIZE];
+        const char * label = path;
+        int label_length = path_length;
+        if (top && num_meta_files > 0) {
+            label_length = cnwn_resource_get_path(resource, sizeof(top_path), top_path);
+            label = top_path;
+        }
         for (int i = 0; i < num_meta_files; i++) {
             cnwn_MetaFile meta_file;
             if (cnwn_resource_get_meta_file(resource, i, &meta_file) > 0) {
-                char meta_file_path[CNWN_PATH_MAX_SIZE];
-                if (cnwn_strisblank(output_path)) {
-                    if (top)
-                        snprintf(meta_file_path, sizeof(meta_file_path), "%s", meta_file.name);
-                    else
-                        snprintf(meta_file_path, sizeof(meta_file_path), "%s%s%s", path, CNWN_PATH_SEPARATOR, meta_file.name);
-                } else {
-                    if (top)
-                        snprintf(meta_file_path, sizeof(meta_file_path), "%s%s%s", output_path, CNWN_PATH_SEPARATOR, meta_file.name);
-                    else
-                        snprintf(meta_file_path, sizeof(meta_file_path), "%s%s%s%s%s", output_path, CNWN_PATH_SEPARATOR, path, CNWN_PATH_SEPARATOR, meta_file.name);
-                }
-                int64_t er = cnwn_resource_meta_file_extract_to_path(resource, i, input_f, meta_file_path);
+                int meta_file_length = path_length;
+                if (meta_file_length > 0)
+                    meta_file_length += cnwn_strcpy(path + meta_file_length, max_path_size - meta_file_length, CNWN_PATH_SEPARATOR, -1);
+                cnwn_strcpy(path + meta_file_length, max_path_size - meta_file_length, meta_file.name, -1);
+                int64_t er = cnwn_resource_meta_file_extract_to_path(resource, i, input_f, use_path);
                 if (er < 0) {
-                    cnwn_set_error("%s (extracting meta file \"%s\")", cnwn_get_error(), meta_file_path);
+                    cnwn_set_error("%s (extracting meta file \"%s\")", cnwn_get_error(), use_path);
+                    path[path_length] = 0;
                     return -1;
                 }
                 if (!quiet)
-                    printf("%s => %s %"PRId64"\n", path, meta_file_path, er);
+                    printf("%.*s => %s %"PRId64"\n", label_length, label, use_path, er);
+                path[path_length] = 0;
                 has_num_meta_files++;
                 has_meta_file_bytes += er;
             }
         }
         for (int i = 0; i < num_resources; i++) {
+            bool matched = true;
+            if (filter != NULL) {
+                int fret = cnwn_filter_match(filter, resource, i, input_f);
+                if (fret < 0)
+                    return -1;
+                matched = (fret > 0);
+                if (!matched && (depth == 1 || !CNWN_RESOURCE_TYPE_IS_ERF(resource->entries.types[i])))
+                    continue;
+            }
             int64_t tmp_resource_bytes = 0;
             int tmp_num_meta_files = 0;
             int64_t tmp_meta_file_bytes = 0;
-            cnwn_Resource * subresource = cnwn_resource_get_resource(resource, i);
-            int tmp_num_resources = cnwn_cnwna_execute_extract_recurse(subresource, input_f, false, quiet, (depth > 0 ? depth - 1 : -1), regexps, output_path, &tmp_resource_bytes, &tmp_num_meta_files, &tmp_meta_file_bytes);
+            cnwn_Resource view;
+            const cnwn_Resource * subresource = cnwn_resource_get_resource(resource, i, &view);
+            int subpath_length = cnwn_resource_get_path2(subresource, path_length, max_path_size, path);
+            cnwn_File * subresource_f;
+            if (cnwn_cnwna_open_resource_file(subresource, input_f, false, &subresource_f) < 0) {
+                path[path_length] = 0;
+                return -1;
+            }
+            int tmp_num_resources = cnwn_cnwna_execute_extract_recurse(subresource, subresource_f, !matched, quiet, (depth > 0 ? depth - 1 : -1), regexps, filter, use_path, output_length, subpath_length, &tmp_resource_bytes, &tmp_num_meta_files, &tmp_meta_file_bytes);
+            if (subresource_f != input_f)
+                cnwn_file_close(subresource_f);
+            path[path_length] = 0;
             if (tmp_num_resources < 0) 
                 return -1;
-            has_num_resources += tmp_num_resources;
+            has_num_resources += tmp_num_resources - (matched ? 0 : 1);
             has_resource_bytes += tmp_resource_bytes;
             has_num_meta_files += tmp_num_meta_files;
             has_meta_file_bytes += tmp_meta_file_bytes;
         }
     }
-    if (!top) {
+    // A container extracted into a directory of its own name can't also be written as a file there.
+    bool expanded = (depth != 0 && num_resources + num_meta_files > 0);
+    if (!top && !expanded) {
         int64_t er = cnwn_resource_extract_to_path(resource, input_f, use_path);
         if (er < 0) {
             cnwn_set_error("%s (extracting \"%s\")", cnwn_get_error(), use_path);
@@ -454,7 +1437,8 @@ static int cnwn_cnwna_execute_extract_recurse(const cnwn_Resource * resource, cn
             printf("%s => %s %"PRId64"\n", path, use_path, er);
         has_resource_bytes += resource->size;
     }
-    has_num_resources++;
+    if (top || !expanded)
+        has_num_resources++;
     if (ret_resource_bytes)
         *ret_resource_bytes = has_resource_bytes;
     if (ret_num_meta_files != NULL)
@@ -465,6 +1449,136 @@ static int cnwn_cnwna_execute_extract_recurse(const cnwn_Resource * resource, cn
 }
 
 int cnwn_cnwna_execute_extract(const char * path, bool quiet, int depth, const cnwn_RegexpArray * regexps, const char * output_path)
+{
+    return cnwn_cnwna_execute_extract2(path, quiet, depth, regexps, NULL, output_path);
+}
+
+int cnwn_cnwna_execute_extract2(const char * path, bool quiet, int depth, const cnwn_RegexpArray * regexps, const cnwn_Filter * filter, const char * output_path)
+{
+    cnwn_Resource resource;
+    cnwn_File * f;
+    if (cnwn_cnwna_open_archive(path, &resource, &f) < 0)
+        return -1;
+    int64_t resource_bytes = 0;
+    int num_meta_files = 0;
+    int64_t meta_file_bytes = 0;
+    char use_path[CNWN_PATH_MAX_SIZE];
+    int output_length = 0;
+    if (!cnwn_strisblank(output_path))
+        output_length = snprintf(use_path, sizeof(use_path), "%s%s", output_path, CNWN_PATH_SEPARATOR);
+    output_length = CNWN_MIN(output_length, (int)sizeof(use_path) - 1);
+    use_path[output_length] = 0;
+    int ret = cnwn_cnwna_execute_extract_recurse(&resource, f, true, quiet, depth, regexps, filter, use_path, output_length, 0, &resource_bytes, &num_meta_files, &meta_file_bytes);
+    cnwn_resource_deinit(&resource);
+    if (f != NULL)
+        cnwn_file_close(f);
+    if (ret < 0)
+        return -1;
+    if (!quiet)
+        printf("Total %d meta files (%"PRId64" bytes) and %d resources (%"PRId64" bytes)\n", num_meta_files, meta_file_bytes, ret, resource_bytes);
+    return ret;
+}
+
+int cnwn_cnwna_execute_create(const char * path, bool quiet, int depth, const cnwn_StringArray * paths)
+{
+    return 0;
+}
+
+static void cnwn_cnwna_mark_strref(uint32_t strref, bool base, bool * used, int num_used)
+{
+    if (base ? (strref & ~CNWN_TLK_STRREF_INDEX_MASK) != 0 : (strref & ~CNWN_TLK_STRREF_INDEX_MASK) != CNWN_TLK_STRREF_CUSTOM)
+        return;
+    uint32_t index = strref & CNWN_TLK_STRREF_INDEX_MASK;
+    if (index < num_used)
+        used[index] = true;
+}
+
+static void cnwn_cnwna_scan_strrefs_2da(const char * data, int64_t size, bool base, bool * used, int num_used)
+{
+    int64_t offset = 0;
+    while (offset < size) {
+        while (offset < size && (data[offset] < '0' || data[offset] > '9'))
+            offset++;
+        bool token_start = (offset == 0 || data[offset - 1] <= 32);
+        uint64_t value = 0;
+        int digits = 0;
+        while (offset < size && data[offset] >= '0' && data[offset] <= '9') {
+            if (digits < 12)
+                value = value * 10 + (data[offset] - '0');
+            digits++;
+            offset++;
+        }
+        if (token_start && digits > 0 && (offset == size || data[offset] <= 32) && value <= UINT32_MAX)
+            cnwn_cnwna_mark_strref((uint32_t)value, base, used, num_used);
+    }
+}
+
+static uint32_t cnwn_cnwna_read_u32(const uint8_t * p)
+{
+    uint32_t ret;
+    memcpy(&ret, p, sizeof(ret));
+    return (uint32_t)cnwn_endian_ltoh32((int32_t)ret);
+}
+
+static void cnwn_cnwna_scan_strrefs_gff(const uint8_t * data, int64_t size, bool base, bool * used, int num_used)
+{
+    if (size < 56 || memcmp(data + 4, "V3.2", 4) != 0)
+        return;
+    uint32_t fields_offset = cnwn_cnwna_read_u32(data + 16);
+    uint32_t num_fields = cnwn_cnwna_read_u32(data + 20);
+    uint32_t field_data_offset = cnwn_cnwna_read_u32(data + 32);
+    uint32_t field_data_size = cnwn_cnwna_read_u32(data + 36);
+    if ((int64_t)fields_offset + (int64_t)num_fields * 12 > size || (int64_t)field_data_offset + field_data_size > size)
+        return;
+    for (uint32_t i = 0; i < num_fields; i++) {
+        const uint8_t * field = data + fields_offset + (int64_t)i * 12;
+        uint32_t type = cnwn_cnwna_read_u32(field);
+        uint32_t value = cnwn_cnwna_read_u32(field + 8);
+        if (type == 4 || type == 5)
+            cnwn_cnwna_mark_strref(value, base, used, num_used);
+        else if (type == 12 && (int64_t)value + 8 <= field_data_size)
+            cnwn_cnwna_mark_strref(cnwn_cnwna_read_u32(data + field_data_offset + value + 4), base, used, num_used);
+    }
+}
+
+static int cnwn_cnwna_scan_strrefs_file(cnwn_ResourceType type, cnwn_File * f, int64_t offset, int64_t size, bool base, bool * used, int num_used)
+{
+    if (type != CNWN_RESOURCE_TYPE_2DA && !CNWN_RESOURCE_TYPE_IS_GFF(type))
+        return 0;
+    if (cnwn_file_seek(f, offset) < 0)
+        return -1;
+    uint8_t * data = malloc(CNWN_MAX(1, size));
+    if (cnwn_file_read_fixed(f, size, data) < 0) {
+        free(data);
+        return -1;
+    }
+    if (type == CNWN_RESOURCE_TYPE_2DA)
+        cnwn_cnwna_scan_strrefs_2da((const char *)data, size, base, used, num_used);
+    else
+        cnwn_cnwna_scan_strrefs_gff(data, size, base, used, num_used);
+    free(data);
+    return 1;
+}
+
+static int cnwn_cnwna_scan_strrefs_resource(const cnwn_Resource * resource, cnwn_File * f, bool base, bool * used, int num_used)
+{
+    int num_resources = cnwn_resource_get_num_resources(resource);
+    if (num_resources <= 0)
+        return cnwn_cnwna_scan_strrefs_file(resource->type, f, resource->offset, resource->size, base, used, num_used);
+    int ret = 0;
+    for (int i = 0; i < num_resources; i++) {
+        cnwn_Resource view;
+        int sret = cnwn_cnwna_scan_strrefs_resource(cnwn_resource_get_resource(resource, i, &view), f, base, used, num_used);
+        if (sret < 0) {
+            cnwn_set_error("%s (%s)", cnwn_get_error(), cnwn_resource_get_name(resource));
+            return -1;
+        }
+        ret += sret;
+    }
+    return ret;
+}
+
+static int cnwn_cnwna_scan_strrefs_path(const char * path, bool base, bool * used, int num_used)
 {
     cnwn_ResourceType rtype = cnwn_resource_type_from_path(path);
     if (!CNWN_RESOURCE_TYPE_VALID(rtype)) {
@@ -484,30 +1598,1103 @@ int cnwn_cnwna_execute_extract(const char * path, bool quiet, int depth, const c
         cnwn_file_close(f);
         return -1;
     }
+    int ret;
+    if (CNWN_RESOURCE_TYPE_IS_CONTAINER(rtype)) {
+        cnwn_Resource resource;
+        ret = cnwn_resource_init_from_file(&resource, rtype, name, 0, size, NULL, f);
+        if (ret >= 0) {
+            ret = cnwn_cnwna_scan_strrefs_resource(&resource, f, base, used, num_used);
+            cnwn_resource_deinit(&resource);
+        }
+    } else
+        ret = cnwn_cnwna_scan_strrefs_file(rtype, f, 0, size, base, used, num_used);
+    if (ret < 0)
+        cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+    cnwn_file_close(f);
+    return ret;
+}
+
+int cnwn_cnwna_execute_tlk_compact(const char * path, bool quiet, bool base, const cnwn_StringArray * paths, const char * output_path)
+{
+    if (cnwn_strisblank(output_path)) {
+        cnwn_set_error("no output path specified");
+        return -1;
+    }
+    cnwn_Tlk tlk;
+    if (cnwn_tlk_init_from_path(&tlk, path) < 0)
+        return -1;
+    int num_entries = cnwn_tlk_get_num_entries(&tlk);
+    bool * used = NULL;
+    int num_paths = (paths != NULL ? cnwn_array_get_length(paths) : 0);
+    if (num_paths > 0) {
+        used = malloc(sizeof(bool) * CNWN_MAX(1, num_entries));
+        memset(used, 0, sizeof(bool) * CNWN_MAX(1, num_entries));
+        for (int i = 0; i < num_paths; i++) {
+            const char * scan_path = cnwn_string_array_get(paths, i);
+            int ret = cnwn_cnwna_scan_strrefs_path(scan_path, base, used, num_entries);
+            if (ret < 0) {
+                free(used);
+                cnwn_tlk_deinit(&tlk);
+                return -1;
+            }
+            if (!quiet)
+                printf("Scanned %s (%d resources)\n", scan_path, ret);
+        }
+    }
+    cnwn_File * f = cnwn_file_open(output_path, "wt");
+    if (f == NULL) {
+        cnwn_set_error("%s (open %s)", cnwn_get_error(), output_path);
+        if (used != NULL)
+            free(used);
+        cnwn_tlk_deinit(&tlk);
+        return -1;
+    }
+    int num_written = 0;
+    int64_t ret = cnwn_tlk_write_compact(&tlk, used, f, &num_written);
+    cnwn_file_close(f);
+    if (ret >= 0 && !quiet) {
+        int num_used = 0;
+        for (int i = 0; i < num_entries; i++)
+            if (used == NULL || used[i])
+                num_used++;
+        printf("Compacted %s => %s: %d of %d entries in use, %d entries and %"PRId64" bytes (was %"PRId64" bytes)\n",
+               path, output_path, num_used, num_entries, num_written, ret, tlk.size);
+    }
+    if (used != NULL)
+        free(used);
+    cnwn_tlk_deinit(&tlk);
+    if (ret < 0) {
+        cnwn_set_error("%s (writing %s)", cnwn_get_error(), output_path);
+        return -1;
+    }
+    return num_written;
+}
+
+static int cnwn_cnwna_2da_cache_write(cnwn_2DA * tda, const char * output_path, bool quiet, const char * source)
+{
+    cnwn_File * f = cnwn_file_open(output_path, "wt");
+    if (f == NULL) {
+        cnwn_set_error("%s (open %s)", cnwn_get_error(), output_path);
+        return -1;
+    }
+    int64_t ret = cnwn_2da_write_cache(tda, f);
+    cnwn_file_close(f);
+    if (ret < 0) {
+        cnwn_set_error("%s (writing %s)", cnwn_get_error(), output_path);
+        return -1;
+    }
+    if (!quiet)
+        printf("%s => %s (%d rows, %d columns, %"PRId64" bytes)\n", source, output_path, cnwn_2da_get_num_rows(tda), cnwn_2da_get_num_columns(tda), ret);
+    return 1;
+}
+
+static int cnwn_cnwna_2da_cache_resource(const cnwn_Resource * resource, cnwn_File * f, bool quiet, const char * output_dir)
+{
+    int num_resources = cnwn_resource_get_num_resources(resource);
+    if (num_resources <= 0) {
+        if (resource->type != CNWN_RESOURCE_TYPE_2DA)
+            return 0;
+        char path[CNWN_PATH_MAX_SIZE];
+        char output_path[CNWN_PATH_MAX_SIZE];
+        cnwn_resource_get_path(resource, sizeof(path), path);
+        int length = snprintf(output_path, sizeof(output_path), "%s%s%s.%s", output_dir, CNWN_PATH_SEPARATOR, resource->name.s, CNWN_2DA_CACHE_EXTENSION);
+        if (length < 0 || length >= (int)sizeof(output_path)) {
+            cnwn_set_error("cache path too long (%s)", path);
+            return -1;
+        }
+        cnwn_2DA tda;
+        if (cnwn_2da_init_from_file(&tda, f, resource->offset, resource->size) < 0) {
+            cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+            return -1;
+        }
+        int ret = cnwn_cnwna_2da_cache_write(&tda, output_path, quiet, path);
+        cnwn_2da_deinit(&tda);
+        return ret;
+    }
+    int ret = 0;
+    for (int i = 0; i < num_resources; i++) {
+        cnwn_Resource view;
+        int sret = cnwn_cnwna_2da_cache_resource(cnwn_resource_get_resource(resource, i, &view), f, quiet, output_dir);
+        if (sret < 0)
+            return -1;
+        ret += sret;
+    }
+    return ret;
+}
+
+static int cnwn_cnwna_2da_cache_path(const char * path, bool quiet, const char * output_path)
+{
+    if (cnwn_file_system_isdirectory(path) > 0) {
+        cnwn_StringArray paths;
+        cnwn_string_array_init(&paths);
+        if (cnwn_file_system_ls2(path, true, &paths) < 0) {
+            cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+            cnwn_array_deinit(&paths);
+            return -1;
+        }
+        cnwn_array_sort(&paths, false);
+        int ret = 0;
+        for (int i = 0; i < cnwn_array_get_length(&paths) && ret >= 0; i++) {
+            const char * subpath = cnwn_string_array_get(&paths, i);
+            cnwn_ResourceType rtype = cnwn_resource_type_from_path(subpath);
+            if (cnwn_file_system_isfile(subpath) > 0 && (rtype == CNWN_RESOURCE_TYPE_2DA || CNWN_RESOURCE_TYPE_IS_CONTAINER(rtype))) {
+                int sret = cnwn_cnwna_2da_cache_path(subpath, quiet, output_path);
+                ret = (sret < 0 ? -1 : ret + sret);
+            }
+        }
+        cnwn_array_deinit(&paths);
+        return ret;
+    }
+    cnwn_ResourceType rtype = cnwn_resource_type_from_path(path);
+    if (rtype != CNWN_RESOURCE_TYPE_2DA && !CNWN_RESOURCE_TYPE_IS_CONTAINER(rtype)) {
+        cnwn_set_error("not a 2DA, hak or directory (%s)", path);
+        return -1;
+    }
+    cnwn_File * f = cnwn_file_open(path, "r");
+    if (f == NULL) {
+        cnwn_set_error("%s (open %s)", cnwn_get_error(), path);
+        return -1;
+    }
+    int64_t size = cnwn_file_size(f);
+    int ret = -1;
+    if (size < 0)
+        cnwn_set_error("%s (size %s)", cnwn_get_error(), path);
+    else if (rtype == CNWN_RESOURCE_TYPE_2DA) {
+        char cache_path[CNWN_PATH_MAX_SIZE];
+        int length = 0;
+        if (output_path != NULL) {
+            char filename[CNWN_PATH_MAX_SIZE];
+            cnwn_path_filenamepart(filename, sizeof(filename), path);
+            length = snprintf(cache_path, sizeof(cache_path), "%s%s%s.%s", output_path, CNWN_PATH_SEPARATOR, filename, CNWN_2DA_CACHE_EXTENSION);
+        } else
+            cnwn_2da_cache_path(cache_path, sizeof(cache_path), path);
+        cnwn_2DA tda;
+        if (length < 0 || length >= (int)sizeof(cache_path))
+            cnwn_set_error("cache path too long (%s)", path);
+        else if (cnwn_2da_init_from_file(&tda, f, 0, size) >= 0) {
+            ret = cnwn_cnwna_2da_cache_write(&tda, cache_path, quiet, path);
+            cnwn_2da_deinit(&tda);
+        } else
+            cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+    } else {
+        char output_dir[CNWN_PATH_MAX_SIZE];
+        if (output_path != NULL)
+            cnwn_strcpy(output_dir, sizeof(output_dir), output_path, -1);
+        else if (cnwn_path_directorypart(output_dir, sizeof(output_dir), path) <= 0)
+            cnwn_strcpy(output_dir, sizeof(output_dir), ".", -1);
+        char name[CNWN_PATH_MAX_SIZE];
+        cnwn_path_filenamepart(name, sizeof(name), path);
+        cnwn_Resource resource;
+        if (cnwn_resource_init_from_file(&resource, rtype, name, 0, size, NULL, f) >= 0) {
+            ret = cnwn_cnwna_2da_cache_resource(&resource, f, quiet, output_dir);
+            cnwn_resource_deinit(&resource);
+        }
+        if (ret < 0)
+            cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+    }
+    cnwn_file_close(f);
+    return ret;
+}
+
+int cnwn_cnwna_execute_2da_cache(const char * path, bool quiet, const cnwn_StringArray * paths, const char * output_path)
+{
+    if (cnwn_strisblank(path)) {
+        cnwn_set_error("no 2DA file, hak or directory specified");
+        return -1;
+    }
+    if (output_path != NULL && cnwn_file_system_mkdir(output_path) < 0)
+        return -1;
+    int ret = cnwn_cnwna_2da_cache_path(path, quiet, output_path);
+    int num_paths = (paths != NULL ? cnwn_array_get_length(paths) : 0);
+    for (int i = 0; i < num_paths && ret >= 0; i++) {
+        int sret = cnwn_cnwna_2da_cache_path(cnwn_string_array_get(paths, i), quiet, output_path);
+        ret = (sret < 0 ? -1 : ret + sret);
+    }
+    if (ret >= 0 && !quiet)
+        printf("Wrote %d 2DA cache files\n", ret);
+    return ret;
+}
+
+typedef struct cnwn_CNWNADedupeArchive_s {
+    const char * path;
+    cnwn_File * f;
     cnwn_Resource resource;
-    int ret = cnwn_resource_init_from_file(&resource, rtype, name, 0, size, NULL, f);
+} cnwn_CNWNADedupeArchive;
+
+typedef struct cnwn_CNWNADedupeEntry_s {
+    cnwn_ResourceType type;
+    cnwn_ResRef name;
+    int64_t offset;
+    int64_t size;
+    int archive;
+    int index;
+    int shadowed_by;
+    bool hashed;
+    uint64_t hash;
+} cnwn_CNWNADedupeEntry;
+
+static int cnwn_cnwna_dedupe_compare_name(const void * a, const void * b)
+{
+    const cnwn_CNWNADedupeEntry * ea = a;
+    const cnwn_CNWNADedupeEntry * eb = b;
+    if (ea->type != eb->type)
+        return (ea->type < eb->type ? -1 : 1);
+    int ret = cnwn_resref_compare(&ea->name, &eb->name);
+    if (ret != 0)
+        return ret;
+    if (ea->archive != eb->archive)
+        return (ea->archive < eb->archive ? -1 : 1);
+    return (ea->index < eb->index ? -1 : (ea->index > eb->index ? 1 : 0));
+}
+
+static int cnwn_cnwna_dedupe_compare_content(const void * a, const void * b)
+{
+    const cnwn_CNWNADedupeEntry * ea = a;
+    const cnwn_CNWNADedupeEntry * eb = b;
+    if (ea->size != eb->size)
+        return (ea->size < eb->size ? -1 : 1);
+    if (ea->hash != eb->hash)
+        return (ea->hash < eb->hash ? -1 : 1);
+    if (ea->archive != eb->archive)
+        return (ea->archive < eb->archive ? -1 : 1);
+    return (ea->index < eb->index ? -1 : (ea->index > eb->index ? 1 : 0));
+}
+
+static int64_t cnwn_cnwna_dedupe_hash(cnwn_File * f, const cnwn_CNWNADedupeEntry * entry, uint8_t * buffer, int buffer_size, uint64_t * ret_hash)
+{
+    if (cnwn_file_seek(f, entry->offset) < 0)
+        return -1;
+    cnwn_Hash64State state;
+    cnwn_hash64_xxh64_init(&state);
+    int64_t remaining = entry->size;
+    while (remaining > 0) {
+        int64_t ret = cnwn_file_read_fixed(f, CNWN_MIN(remaining, buffer_size), buffer);
+        if (ret < 0)
+            return -1;
+        cnwn_hash64_xxh64_update(&state, buffer, ret);
+        remaining -= ret;
+    }
+    *ret_hash = cnwn_hash64_xxh64_final(&state);
+    return entry->size;
+}
+
+static int cnwn_cnwna_dedupe_report(cnwn_CNWNADedupeArchive * archives, int num_archives, cnwn_CNWNADedupeEntry * entries, int num_entries, bool quiet)
+{
+    int64_t total_bytes = 0;
+    for (int i = 0; i < num_entries; i++)
+        total_bytes += entries[i].size;
+
+    // Same name and type in an earlier archive shadows the resource.
+    qsort(entries, num_entries, sizeof(cnwn_CNWNADedupeEntry), cnwn_cnwna_dedupe_compare_name);
+    for (int i = 1; i < num_entries; i++) {
+        const cnwn_CNWNADedupeEntry * prev = entries + i - 1;
+        if (prev->type == entries[i].type
+            && cnwn_resref_equal(&prev->name, &entries[i].name))
+            entries[i].shadowed_by = (prev->shadowed_by >= 0 ? prev->shadowed_by : prev->archive);
+    }
+
+    // Size pre-filter, only resources that share their size with another resource are hashed.
+    qsort(entries, num_entries, sizeof(cnwn_CNWNADedupeEntry), cnwn_cnwna_dedupe_compare_content);
+    int buffer_size = CNWN_FILE_BUFFER_SIZE * 8;
+    uint8_t * buffer = malloc(buffer_size);
+    int num_hashed = 0;
+    int64_t hashed_bytes = 0;
+    for (int i = 0; i < num_entries; ) {
+        int j = i + 1;
+        while (j < num_entries && entries[j].size == entries[i].size)
+            j++;
+        for (int k = i; j - i > 1 && k < j; k++) {
+            cnwn_CNWNADedupeEntry * entry = entries + k;
+            if (cnwn_cnwna_dedupe_hash(archives[entry->archive].f, entry, buffer, buffer_size, &entry->hash) < 0) {
+                cnwn_set_error("%s (hashing %s in %s)", cnwn_get_error(), entry->name.s, archives[entry->archive].path);
+                free(buffer);
+                return -1;
+            }
+            entry->hashed = true;
+            num_hashed++;
+            hashed_bytes += entry->size;
+        }
+        i = j;
+    }
+    free(buffer);
+    qsort(entries, num_entries, sizeof(cnwn_CNWNADedupeEntry), cnwn_cnwna_dedupe_compare_content);
+
+    char filename[CNWN_PATH_MAX_SIZE];
+    char rpath[CNWN_PATH_MAX_SIZE];
+    cnwn_Resource view;
+    int num_groups = 0;
+    int num_copies = 0;
+    int64_t duplicate_bytes = 0;
+    for (int i = 0; i < num_entries; ) {
+        int j = i + 1;
+        while (j < num_entries && entries[j].hashed && entries[j].size == entries[i].size && entries[j].hash == entries[i].hash)
+            j++;
+        int num_live = 0;
+        for (int k = i; k < j; k++)
+            if (entries[k].shadowed_by < 0)
+                num_live++;
+        if (num_live > 1) {
+            num_groups++;
+            num_copies += num_live - 1;
+            duplicate_bytes += (num_live - 1) * entries[i].size;
+            if (!quiet) {
+                printf("Duplicate %016"PRIx64" (%"PRId64" bytes):", entries[i].hash, entries[i].size);
+                for (int k = i; k < j; k++) {
+                    if (entries[k].shadowed_by >= 0)
+                        continue;
+                    cnwn_path_basepart(filename, sizeof(filename), archives[entries[k].archive].path);
+                    cnwn_resource_get_path(cnwn_resource_get_resource(&archives[entries[k].archive].resource, entries[k].index, &view), sizeof(rpath), rpath);
+                    printf(" %s:%s", filename, rpath);
+                }
+                printf("\n");
+            }
+        }
+        i = j;
+    }
+
+    qsort(entries, num_entries, sizeof(cnwn_CNWNADedupeEntry), cnwn_cnwna_dedupe_compare_name);
+    int num_shadowed = 0;
+    int64_t shadowed_bytes = 0;
+    for (int i = 0, winner = 0; i < num_entries; i++) {
+        if (entries[i].shadowed_by < 0) {
+            winner = i;
+            continue;
+        }
+        num_shadowed++;
+        shadowed_bytes += entries[i].size;
+        if (!quiet) {
+            const cnwn_CNWNADedupeEntry * w = entries + winner;
+            bool identical = (w->hashed && entries[i].hashed && w->size == entries[i].size && w->hash == entries[i].hash);
+            char winner_filename[CNWN_PATH_MAX_SIZE];
+            cnwn_path_basepart(filename, sizeof(filename), archives[entries[i].archive].path);
+            cnwn_path_basepart(winner_filename, sizeof(winner_filename), archives[w->archive].path);
+            cnwn_resource_get_path(cnwn_resource_get_resource(&archives[entries[i].archive].resource, entries[i].index, &view), sizeof(rpath), rpath);
+            printf("Shadowed %s:%s by %s (%s)\n", filename, rpath, winner_filename, (identical ? "identical" : "different"));
+        }
+    }
+    if (!quiet) {
+        printf("Scanned %d resources (%"PRId64" bytes) in %d archives, hashed %d resources (%"PRId64" bytes)\n",
+               num_entries, total_bytes, num_archives, num_hashed, hashed_bytes);
+        printf("%d shadowed resources (%"PRId64" bytes), %d duplicate groups with %d redundant copies (%"PRId64" bytes)\n",
+               num_shadowed, shadowed_bytes, num_groups, num_copies, duplicate_bytes);
+        printf("Wasted %"PRId64" bytes\n", shadowed_bytes + duplicate_bytes);
+    }
+    return num_shadowed + num_copies;
+}
+
+static int cnwn_cnwna_dedupe_write(const cnwn_CNWNADedupeArchive * archive, int archive_index, const cnwn_CNWNADedupeEntry * entries, int num_entries, bool quiet, const char * output_path)
+{
+    int num_resources = cnwn_resource_get_num_resources(&archive->resource);
+    bool * keep = malloc(sizeof(bool) * CNWN_MAX(1, num_resources));
+    int num_kept = num_resources;
+    for (int i = 0; i < num_resources; i++)
+        keep[i] = true;
+    for (int i = 0; i < num_entries; i++) {
+        if (entries[i].archive == archive_index && entries[i].shadowed_by >= 0) {
+            keep[entries[i].index] = false;
+            num_kept--;
+        }
+    }
+    char filename[CNWN_PATH_MAX_SIZE];
+    char archive_output_path[CNWN_PATH_MAX_SIZE];
+    cnwn_path_basepart(filename, sizeof(filename), archive->path);
+    snprintf(archive_output_path, sizeof(archive_output_path), "%s%s%s", output_path, CNWN_PATH_SEPARATOR, filename);
+    cnwn_File * output_f = cnwn_file_open(archive_output_path, "wt");
+    if (output_f == NULL) {
+        cnwn_set_error("%s (open %s)", cnwn_get_error(), archive_output_path);
+        free(keep);
+        return -1;
+    }
+    int64_t ret = cnwn_erf_write_subset(&archive->resource, archive->f, keep, output_f);
+    cnwn_file_close(output_f);
+    free(keep);
     if (ret < 0) {
+        cnwn_set_error("%s (writing %s)", cnwn_get_error(), archive_output_path);
+        return -1;
+    }
+    if (!quiet)
+        printf("%s => %s (%d of %d resources, %"PRId64" bytes)\n", archive->path, archive_output_path, num_kept, num_resources, ret);
+    return num_kept;
+}
+
+int cnwn_cnwna_execute_dedupe(const char * path, bool quiet, const cnwn_StringArray * paths, const char * output_path)
+{
+    if (cnwn_strisblank(path)) {
+        cnwn_set_error("no haks or modules specified");
+        return -1;
+    }
+    int num_paths = (paths != NULL ? cnwn_array_get_length(paths) : 0);
+    cnwn_CNWNADedupeArchive * archives = malloc(sizeof(cnwn_CNWNADedupeArchive) * (num_paths + 1));
+    int num_archives = 0;
+    int num_entries = 0;
+    int ret = 0;
+    for (int i = 0; i < num_paths + 1 && ret >= 0; i++) {
+        const char * archive_path = (i == 0 ? path : cnwn_string_array_get(paths, i - 1));
+        cnwn_ResourceType rtype = cnwn_resource_type_from_path(archive_path);
+        if (!CNWN_RESOURCE_TYPE_IS_ERF(rtype)) {
+            cnwn_set_error("not a hak or module (%s)", archive_path);
+            ret = -1;
+            break;
+        }
+        cnwn_File * f = cnwn_file_open(archive_path, "r");
+        if (f == NULL) {
+            cnwn_set_error("%s (open %s)", cnwn_get_error(), archive_path);
+            ret = -1;
+            break;
+        }
+        char name[CNWN_PATH_MAX_SIZE];
+        cnwn_path_filenamepart(name, sizeof(name), archive_path);
+        int64_t size = cnwn_file_size(f);
+        if (size < 0 || cnwn_resource_init_from_file(&archives[num_archives].resource, rtype, name, 0, size, NULL, f) < 0) {
+            cnwn_set_error("%s (%s)", cnwn_get_error(), archive_path);
+            cnwn_file_close(f);
+            ret = -1;
+            break;
+        }
+        archives[num_archives].path = archive_path;
+        archives[num_archives].f = f;
+        num_entries += CNWN_MAX(0, cnwn_resource_get_num_resources(&archives[num_archives].resource));
+        num_archives++;
+    }
+    cnwn_CNWNADedupeEntry * entries = NULL;
+    if (ret >= 0) {
+        entries = malloc(sizeof(cnwn_CNWNADedupeEntry) * CNWN_MAX(1, num_entries));
+        for (int i = 0, k = 0; i < num_archives; i++) {
+            int num_resources = cnwn_resource_get_num_resources(&archives[i].resource);
+            for (int j = 0; j < num_resources; j++, k++) {
+                cnwn_Resource view;
+                const cnwn_Resource * subresource = cnwn_resource_get_resource(&archives[i].resource, j, &view);
+                entries[k].type = subresource->type;
+                entries[k].name = subresource->name;
+                entries[k].offset = subresource->offset;
+                entries[k].size = subresource->size;
+                entries[k].archive = i;
+                entries[k].index = j;
+                entries[k].shadowed_by = -1;
+                entries[k].hashed = false;
+                entries[k].hash = 0;
+            }
+        }
+        ret = cnwn_cnwna_dedupe_report(archives, num_archives, entries, num_entries, quiet);
+    }
+    if (ret >= 0 && output_path != NULL) {
+        if (cnwn_file_system_mkdir(output_path) < 0)
+            ret = -1;
+        for (int i = 0; i < num_archives && ret >= 0; i++)
+            if (cnwn_cnwna_dedupe_write(archives + i, i, entries, num_entries, quiet, output_path) < 0)
+                ret = -1;
+    }
+    if (entries != NULL)
+        free(entries);
+    for (int i = 0; i < num_archives; i++) {
+        cnwn_resource_deinit(&archives[i].resource);
+        cnwn_file_close(archives[i].f);
+    }
+    free(archives);
+    return ret;
+}
+
+typedef struct cnwn_CNWNAManifestEntry_s {
+    const char * path;
+    int order;
+    cnwn_ResourceType type;
+    cnwn_ResRef name;
+    int64_t offset;
+    int64_t stored_size;
+    cnwn_Compression compression;
+    int64_t size;
+    bool shadowed;
+    uint8_t sha1[CNWN_SHA1_SIZE];
+} cnwn_CNWNAManifestEntry;
+
+typedef struct cnwn_CNWNAManifestJobs_s {
+    cnwn_CNWNAManifestEntry ** schedule;
+    int num_scheduled;
+    int next;
+    bool failed;
+    char error[1024];
+    pthread_mutex_t mutex;
+} cnwn_CNWNAManifestJobs;
+
+static int cnwn_cnwna_manifest_compare_name(const void * a, const void * b)
+{
+    const cnwn_CNWNAManifestEntry * ea = a;
+    const cnwn_CNWNAManifestEntry * eb = b;
+    int ret = cnwn_resref_compare(&ea->name, &eb->name);
+    if (ret != 0)
+        return ret;
+    if (ea->type != eb->type)
+        return (ea->type < eb->type ? -1 : 1);
+    return (ea->order < eb->order ? -1 : (ea->order > eb->order ? 1 : 0));
+}
+
+static int cnwn_cnwna_manifest_compare_location(const void * a, const void * b)
+{
+    const cnwn_CNWNAManifestEntry * ea = *(const cnwn_CNWNAManifestEntry **)a;
+    const cnwn_CNWNAManifestEntry * eb = *(const cnwn_CNWNAManifestEntry **)b;
+    if (ea->order != eb->order)
+        return (ea->order < eb->order ? -1 : 1);
+    int ret = cnwn_strcmp(ea->path, eb->path);
+    if (ret != 0)
+        return ret;
+    return (ea->offset < eb->offset ? -1 : (ea->offset > eb->offset ? 1 : 0));
+}
+
+static void cnwn_cnwna_manifest_append(cnwn_Array * entries, const char * path, int order, cnwn_ResourceType type, const char * name, int64_t offset, int64_t stored_size, cnwn_Compression compression, int64_t size)
+{
+    cnwn_CNWNAManifestEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.path = path;
+    entry.order = order;
+    entry.type = type;
+    cnwn_resref_init(&entry.name, name);
+    entry.offset = offset;
+    entry.stored_size = stored_size;
+    entry.compression = compression;
+    entry.size = size;
+    cnwn_array_append(entries, 1, &entry);
+}
+
+// Compressed entries are decompressed into a temporary file so hashing and storing read the content, not the stored bytes.
+static cnwn_File * cnwn_cnwna_manifest_open_content(const cnwn_CNWNAManifestEntry * entry, int index, cnwn_File * input_f, char * ret_tmp_path, int max_size)
+{
+    ret_tmp_path[0] = 0;
+    if (entry->compression == CNWN_COMPRESSION_NONE)
+        return (cnwn_file_seek(input_f, entry->offset) >= 0 ? input_f : NULL);
+    const char * tmp_dir = getenv("TMPDIR");
+    if (cnwn_strisblank(tmp_dir))
+        tmp_dir = "/tmp";
+    snprintf(ret_tmp_path, max_size, "%s%scnwna-manifest-%ld-%d.tmp", tmp_dir, CNWN_PATH_SEPARATOR, (long)getpid(), index);
+    cnwn_Resource view;
+    memset(&view, 0, sizeof(view));
+    view.type = entry->type;
+    view.name = entry->name;
+    view.offset = entry->offset;
+    view.size = entry->stored_size;
+    view.compression = entry->compression;
+    view.uncompressed_size = entry->size;
+    cnwn_File * f = cnwn_file_open(ret_tmp_path, "t");
+    if (f == NULL) {
+        cnwn_set_error("%s (open %s)", cnwn_get_error(), ret_tmp_path);
+        ret_tmp_path[0] = 0;
+        return NULL;
+    }
+    int64_t ret = cnwn_resource_extract(&view, input_f, f);
+    cnwn_file_close(f);
+    f = (ret == entry->size ? cnwn_file_open(ret_tmp_path, "r") : NULL);
+    if (f == NULL) {
+        if (ret >= 0)
+            cnwn_set_error("decompressed %"PRId64" bytes, expected %"PRId64, ret, entry->size);
+        cnwn_file_system_rm(ret_tmp_path);
+        ret_tmp_path[0] = 0;
+    }
+    return f;
+}
+
+static void cnwn_cnwna_manifest_close_content(cnwn_File * content_f, cnwn_File * input_f, const char * tmp_path)
+{
+    if (content_f != NULL && content_f != input_f)
+        cnwn_file_close(content_f);
+    if (tmp_path[0] != 0)
+        cnwn_file_system_rm(tmp_path);
+}
+
+static int cnwn_cnwna_manifest_collect(const char * path, int order, cnwn_Array * entries, cnwn_StringArray * loose_paths)
+{
+    if (cnwn_file_system_isdirectory(path) > 0) {
+        cnwn_StringArray paths;
+        cnwn_string_array_init(&paths);
+        if (cnwn_file_system_ls2(path, true, &paths) < 0) {
+            cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+            cnwn_array_deinit(&paths);
+            return -1;
+        }
+        int ret = 0;
+        for (int i = 0; i < cnwn_array_get_length(&paths); i++) {
+            const char * subpath = cnwn_string_array_get(&paths, i);
+            cnwn_ResourceType rtype = cnwn_resource_type_from_path(subpath);
+            if (!CNWN_RESOURCE_TYPE_VALID(rtype) || cnwn_file_system_isfile(subpath) <= 0)
+                continue;
+            int64_t size = cnwn_file_system_size(subpath, false);
+            if (size < 0) {
+                cnwn_set_error("%s (%s)", cnwn_get_error(), subpath);
+                ret = -1;
+                break;
+            }
+            char name[CNWN_PATH_MAX_SIZE];
+            cnwn_path_filenamepart(name, sizeof(name), subpath);
+            cnwn_string_array_append(loose_paths, "%s", subpath);
+            const char * loose_path = cnwn_string_array_get(loose_paths, -1);
+            cnwn_cnwna_manifest_append(entries, loose_path, order, rtype, name, 0, size, CNWN_COMPRESSION_NONE, size);
+            ret++;
+        }
+        cnwn_array_deinit(&paths);
+        return ret;
+    }
+    cnwn_ResourceType rtype = cnwn_resource_type_from_path(path);
+    if (!CNWN_RESOURCE_TYPE_IS_ERF(rtype)) {
+        cnwn_set_error("not a hak, module or directory (%s)", path);
+        return -1;
+    }
+    cnwn_File * f = cnwn_file_open(path, "r");
+    if (f == NULL) {
+        cnwn_set_error("%s (open %s)", cnwn_get_error(), path);
+        return -1;
+    }
+    char name[CNWN_PATH_MAX_SIZE];
+    cnwn_path_filenamepart(name, sizeof(name), path);
+    int64_t size = cnwn_file_size(f);
+    cnwn_Resource resource;
+    if (size < 0 || cnwn_resource_init_from_file(&resource, rtype, name, 0, size, NULL, f) < 0) {
         cnwn_set_error("%s (%s)", cnwn_get_error(), path);
         cnwn_file_close(f);
         return -1;
     }
-    int64_t resource_bytes = 0;
-    int num_meta_files = 0;
-    int64_t meta_file_bytes = 0;
-    ret = cnwn_cnwna_execute_extract_recurse(&resource, f, true, quiet, depth, regexps, output_path, &resource_bytes, &num_meta_files, &meta_file_bytes);
-    if (ret < 0) {
-        cnwn_resource_deinit(&resource);
+    int num_resources = cnwn_resource_get_num_resources(&resource);
+    for (int i = 0; i < num_resources; i++) {
+        cnwn_Resource view;
+        const cnwn_Resource * subresource = cnwn_resource_get_resource(&resource, i, &view);
+        cnwn_cnwna_manifest_append(entries, path, order, subresource->type, cnwn_resource_get_name(subresource), subresource->offset, subresource->size, subresource->compression, subresource->uncompressed_size);
+    }
+    cnwn_resource_deinit(&resource);
+    cnwn_file_close(f);
+    return num_resources;
+}
+
+static void * cnwn_cnwna_manifest_worker(void * data)
+{
+    cnwn_CNWNAManifestJobs * jobs = data;
+    int buffer_size = CNWN_FILE_BUFFER_SIZE * 8;
+    uint8_t * buffer = malloc(buffer_size);
+    if (buffer == NULL) {
+        pthread_mutex_lock(&jobs->mutex);
+        if (!jobs->failed)
+            snprintf(jobs->error, sizeof(jobs->error), "out of memory (hash buffer)");
+        jobs->failed = true;
+        pthread_mutex_unlock(&jobs->mutex);
+        return NULL;
+    }
+    cnwn_File * f = NULL;
+    const char * f_path = NULL;
+    while (true) {
+        pthread_mutex_lock(&jobs->mutex);
+        int index = (jobs->failed ? jobs->num_scheduled : jobs->next++);
+        pthread_mutex_unlock(&jobs->mutex);
+        if (index >= jobs->num_scheduled)
+            break;
+        cnwn_CNWNAManifestEntry * entry = jobs->schedule[index];
+        if (f == NULL || f_path != entry->path) {
+            if (f != NULL)
+                cnwn_file_close(f);
+            f_path = entry->path;
+            f = cnwn_file_open(f_path, "r");
+        }
+        char tmp_path[CNWN_PATH_MAX_SIZE];
+        tmp_path[0] = 0;
+        cnwn_File * content_f = (f != NULL ? cnwn_cnwna_manifest_open_content(entry, index, f, tmp_path, sizeof(tmp_path)) : NULL);
+        bool ok = (content_f != NULL);
+        cnwn_Sha1State state;
+        cnwn_hash_sha1_init(&state);
+        for (int64_t remaining = entry->size; ok && remaining > 0; ) {
+            int64_t ret = cnwn_file_read_fixed(content_f, CNWN_MIN(remaining, buffer_size), buffer);
+            ok = (ret > 0);
+            if (ok) {
+                cnwn_hash_sha1_update(&state, buffer, ret);
+                remaining -= ret;
+            }
+        }
+        cnwn_cnwna_manifest_close_content(content_f, f, tmp_path);
+        if (!ok) {
+            pthread_mutex_lock(&jobs->mutex);
+            if (!jobs->failed)
+                snprintf(jobs->error, sizeof(jobs->error), "%s (hashing %s in %s)", cnwn_get_error(), entry->name.s, entry->path);
+            jobs->failed = true;
+            pthread_mutex_unlock(&jobs->mutex);
+            break;
+        }
+        cnwn_hash_sha1_final(&state, entry->sha1);
+    }
+    if (f != NULL)
         cnwn_file_close(f);
+    free(buffer);
+    return NULL;
+}
+
+static int cnwn_cnwna_manifest_hash(cnwn_CNWNAManifestEntry ** schedule, int num_scheduled, int jobs)
+{
+    cnwn_CNWNAManifestJobs state;
+    memset(&state, 0, sizeof(state));
+    state.schedule = schedule;
+    state.num_scheduled = num_scheduled;
+    pthread_mutex_init(&state.mutex, NULL);
+    if (jobs <= 0) {
+        long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = (num_cpus > 0 ? (int)num_cpus : 1);
+    }
+    jobs = CNWN_MAX(1, CNWN_MIN(jobs, num_scheduled));
+    pthread_t * threads = malloc(sizeof(pthread_t) * jobs);
+    int num_threads = 0;
+    // The calling thread is one of the workers.
+    for (int i = 1; i < jobs; i++)
+        if (pthread_create(threads + num_threads, NULL, &cnwn_cnwna_manifest_worker, &state) == 0)
+            num_threads++;
+    cnwn_cnwna_manifest_worker(&state);
+    for (int i = 0; i < num_threads; i++)
+        pthread_join(threads[i], NULL);
+    free(threads);
+    pthread_mutex_destroy(&state.mutex);
+    if (state.failed) {
+        cnwn_set_error("%s", state.error);
+        return -1;
+    }
+    return num_threads + 1;
+}
+
+static int cnwn_cnwna_manifest_store(cnwn_CNWNAManifestEntry ** schedule, int num_scheduled, const char * store_path, int64_t * ret_stored_bytes)
+{
+    int ret = 0;
+    cnwn_File * f = NULL;
+    const char * f_path = NULL;
+    for (int i = 0; i < num_scheduled && ret >= 0; i++) {
+        cnwn_CNWNAManifestEntry * entry = schedule[i];
+        if (cnwn_nwsync_store_has(store_path, entry->sha1))
+            continue;
+        if (f == NULL || f_path != entry->path) {
+            if (f != NULL)
+                cnwn_file_close(f);
+            f_path = entry->path;
+            f = cnwn_file_open(f_path, "r");
+            if (f == NULL) {
+                cnwn_set_error("%s (open %s)", cnwn_get_error(), f_path);
+                ret = -1;
+                break;
+            }
+        }
+        char tmp_path[CNWN_PATH_MAX_SIZE];
+        cnwn_File * content_f = cnwn_cnwna_manifest_open_content(entry, i, f, tmp_path, sizeof(tmp_path));
+        int put_ret = -1;
+        if (content_f != NULL)
+            put_ret = cnwn_nwsync_store_put(store_path, entry->sha1, content_f, entry->size);
+        cnwn_cnwna_manifest_close_content(content_f, f, tmp_path);
+        if (put_ret < 0) {
+            cnwn_set_error("%s (storing %s.%s from %s)", cnwn_get_error(), entry->name.s, CNWN_RESOURCE_TYPE_EXTENSION(entry->type), entry->path);
+            ret = -1;
+        } else if (put_ret > 0) {
+            *ret_stored_bytes += entry->size;
+            ret++;
+        }
+    }
+    if (f != NULL)
+        cnwn_file_close(f);
+    return ret;
+}
+
+static int64_t cnwn_cnwna_manifest_write_binary(const cnwn_CNWNAManifestEntry * entries, int num_entries, const char * output_path, const char * store_path, int max_size, char * ret_path)
+{
+    cnwn_NWSyncManifest manifest;
+    cnwn_nwsync_manifest_init(&manifest);
+    int64_t ret = 0;
+    for (int i = 0; i < num_entries && ret >= 0; i++)
+        if (!entries[i].shadowed && cnwn_nwsync_manifest_add(&manifest, entries[i].sha1, entries[i].size, entries[i].name.s, entries[i].type) < 0) {
+            cnwn_set_error("%s (%s)", cnwn_get_error(), entries[i].path);
+            ret = -1;
+        }
+    char tmps[CNWN_PATH_MAX_SIZE];
+    if (output_path != NULL)
+        cnwn_strcpy(tmps, sizeof(tmps), output_path, -1);
+    else {
+        // Named by its own hash, so write it to a temporary file first.
+        snprintf(tmps, sizeof(tmps), "%s%smanifests", store_path, CNWN_PATH_SEPARATOR);
+        if (ret >= 0 && cnwn_file_system_mkdir(tmps) < 0) {
+            cnwn_set_error("%s (mkdir %s)", cnwn_get_error(), tmps);
+            ret = -1;
+        }
+        snprintf(tmps, sizeof(tmps), "%s%smanifests%smanifest.tmp", store_path, CNWN_PATH_SEPARATOR, CNWN_PATH_SEPARATOR);
+    }
+    uint8_t sha1[CNWN_SHA1_SIZE];
+    if (ret >= 0) {
+        cnwn_File * f = cnwn_file_open(tmps, "t");
+        if (f == NULL) {
+            cnwn_set_error("%s (open %s)", cnwn_get_error(), tmps);
+            ret = -1;
+        } else {
+            ret = cnwn_nwsync_manifest_write(&manifest, f, sha1);
+            cnwn_file_close(f);
+        }
+    }
+    if (ret >= 0 && output_path == NULL) {
+        char sha1_str[CNWN_SHA1_STRING_SIZE];
+        cnwn_hash_sha1_to_string(sha1, sha1_str, sizeof(sha1_str));
+        char final_path[CNWN_PATH_MAX_SIZE];
+        snprintf(final_path, sizeof(final_path), "%s%smanifests%s%s", store_path, CNWN_PATH_SEPARATOR, CNWN_PATH_SEPARATOR, sha1_str);
+        if (cnwn_file_system_mv(tmps, final_path) < 0) {
+            cnwn_set_error("%s (rename %s)", cnwn_get_error(), tmps);
+            ret = -1;
+        }
+        cnwn_strcpy(tmps, sizeof(tmps), final_path, -1);
+    }
+    cnwn_strcpy(ret_path, max_size, tmps, -1);
+    cnwn_nwsync_manifest_deinit(&manifest);
+    return ret;
+}
+
+int cnwn_cnwna_execute_manifest(const char * path, bool quiet, const cnwn_StringArray * paths, const char * output_path, int jobs, bool binary, const char * store_path)
+{
+    if (binary && output_path == NULL && store_path == NULL) {
+        cnwn_set_error("a binary manifest needs an output path or a store");
         return -1;
     }
+    if (cnwn_strisblank(path)) {
+        cnwn_set_error("no haks, modules or directories specified");
+        return -1;
+    }
+    cnwn_Array entries;
+    cnwn_array_init(&entries, sizeof(cnwn_CNWNAManifestEntry), NULL);
+    cnwn_StringArray loose_paths;
+    cnwn_string_array_init(&loose_paths);
+    int num_paths = (paths != NULL ? cnwn_array_get_length(paths) : 0);
+    int ret = 0;
+    for (int i = 0; i < num_paths + 1 && ret >= 0; i++)
+        if (cnwn_cnwna_manifest_collect((i == 0 ? path : cnwn_string_array_get(paths, i - 1)), i, &entries, &loose_paths) < 0)
+            ret = -1;
+    int num_entries = cnwn_array_get_length(&entries);
+    cnwn_CNWNAManifestEntry * e = cnwn_array_element_ptr(&entries, 0);
+    cnwn_CNWNAManifestEntry ** schedule = NULL;
+    int num_scheduled = 0;
+    int64_t scheduled_bytes = 0;
+    if (ret >= 0 && num_entries > 0) {
+        qsort(e, num_entries, sizeof(cnwn_CNWNAManifestEntry), cnwn_cnwna_manifest_compare_name);
+        schedule = malloc(sizeof(cnwn_CNWNAManifestEntry *) * num_entries);
+        for (int i = 0; i < num_entries; i++) {
+            e[i].shadowed = (i > 0 && e[i].type == e[i - 1].type && cnwn_resref_equal(&e[i].name, &e[i - 1].name));
+            if (!e[i].shadowed) {
+                schedule[num_scheduled++] = e + i;
+                scheduled_bytes += e[i].size;
+            }
+        }
+        // Hash in file order so each thread mostly reads forward through one archive.
+        qsort(schedule, num_scheduled, sizeof(cnwn_CNWNAManifestEntry *), cnwn_cnwna_manifest_compare_location);
+        ret = cnwn_cnwna_manifest_hash(schedule, num_scheduled, jobs);
+    }
+    int num_threads = ret;
+    int num_stored = 0;
+    int64_t stored_bytes = 0;
+    if (ret >= 0 && store_path != NULL) {
+        num_stored = cnwn_cnwna_manifest_store(schedule, num_scheduled, store_path, &stored_bytes);
+        if (num_stored < 0)
+            ret = -1;
+    }
+    char written_path[CNWN_PATH_MAX_SIZE];
+    written_path[0] = 0;
+    if (ret >= 0 && binary) {
+        if (cnwn_cnwna_manifest_write_binary(e, num_entries, output_path, store_path, sizeof(written_path), written_path) < 0)
+            ret = -1;
+    } else if (ret >= 0) {
+        if (output_path != NULL)
+            cnwn_strcpy(written_path, sizeof(written_path), output_path, -1);
+        FILE * output = (output_path != NULL ? fopen(output_path, "w") : stdout);
+        if (output == NULL) {
+            cnwn_set_error("%s (open %s)", strerror(errno), output_path);
+            ret = -1;
+        } else {
+            for (int i = 0; i < num_entries; i++) {
+                if (e[i].shadowed)
+                    continue;
+                char sha1[CNWN_SHA1_STRING_SIZE];
+                cnwn_hash_sha1_to_string(e[i].sha1, sha1, sizeof(sha1));
+                fprintf(output, "%s %s %s %"PRId64"\n", sha1, e[i].name.s, CNWN_RESOURCE_TYPE_EXTENSION(e[i].type), e[i].size);
+            }
+            if (output != stdout && fclose(output) != 0) {
+                cnwn_set_error("%s (writing %s)", strerror(errno), output_path);
+                ret = -1;
+            }
+        }
+    }
+    if (ret >= 0) {
+        ret = num_scheduled;
+        if (!quiet && written_path[0] != 0)
+            printf("Wrote %s: %d resources (%"PRId64" bytes, %d shadowed) hashed with %d threads\n",
+                   written_path, num_scheduled, scheduled_bytes, num_entries - num_scheduled, num_threads);
+        if (!quiet && store_path != NULL)
+            printf("Stored %d new resources (%"PRId64" bytes) in %s\n", num_stored, stored_bytes, store_path);
+    }
+    if (schedule != NULL)
+        free(schedule);
+    cnwn_array_deinit(&loose_paths);
+    cnwn_array_deinit(&entries);
+    return ret;
+}
+
+int cnwn_cnwna_execute_erf_compress(const char * path, bool quiet, cnwn_Compression compression, const char * output_path)
+{
+    if (cnwn_strisblank(path)) {
+        cnwn_set_error("no hak or module specified");
+        return -1;
+    }
+    if (cnwn_strisblank(output_path)) {
+        cnwn_set_error("no output file specified");
+        return -1;
+    }
+    cnwn_ResourceType rtype = cnwn_resource_type_from_path(path);
+    if (!CNWN_RESOURCE_TYPE_IS_ERF(rtype)) {
+        cnwn_set_error("not a hak or module (%s)", path);
+        return -1;
+    }
+    cnwn_File * f = cnwn_file_open(path, "r");
+    if (f == NULL) {
+        cnwn_set_error("%s (open %s)", cnwn_get_error(), path);
+        return -1;
+    }
+    char name[CNWN_PATH_MAX_SIZE];
+    cnwn_path_filenamepart(name, sizeof(name), path);
+    int64_t size = cnwn_file_size(f);
+    cnwn_Resource resource;
+    if (size < 0 || cnwn_resource_init_from_file(&resource, rtype, name, 0, size, NULL, f) < 0) {
+        cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+        cnwn_file_close(f);
+        return -1;
+    }
+    int ret = 0;
+    cnwn_File * output_f = cnwn_file_open(output_path, "wt");
+    if (output_f == NULL) {
+        cnwn_set_error("%s (open %s)", cnwn_get_error(), output_path);
+        ret = -1;
+    }
+    int64_t written = 0;
+    if (ret >= 0) {
+        written = cnwn_erf_write_subset2(&resource, f, NULL, compression, output_f);
+        cnwn_file_close(output_f);
+        if (written < 0) {
+            cnwn_set_error("%s (writing %s)", cnwn_get_error(), output_path);
+            ret = -1;
+        }
+    }
+    if (ret >= 0) {
+        ret = cnwn_resource_get_num_resources(&resource);
+        if (!quiet)
+            printf("%s => %s (%d resources, %"PRId64" => %"PRId64" bytes, %s)\n", path, output_path, ret, size, written, cnwn_compression_name(compression));
+    }
     cnwn_resource_deinit(&resource);
     cnwn_file_close(f);
-    if (!quiet)
-        printf("Total %d meta files (%"PRId64" bytes) and %d resources (%"PRId64" bytes)\n", num_meta_files, meta_file_bytes, ret, resource_bytes);
     return ret;
 }
 
-int cnwn_cnwna_execute_create(const char * path, bool quiet, int depth, const cnwn_StringArray * paths)
+static int cnwn_cnwna_nwsync_compare_sha1(const void * a, const void * b)
 {
-    return 0;
+    const cnwn_NWSyncEntry * ea = *(const cnwn_NWSyncEntry **)a;
+    const cnwn_NWSyncEntry * eb = *(const cnwn_NWSyncEntry **)b;
+    int ret = memcmp(ea->sha1, eb->sha1, CNWN_SHA1_SIZE);
+    if (ret != 0)
+        return ret;
+    ret = cnwn_resref_compare(&ea->resref, &eb->resref);
+    if (ret != 0)
+        return ret;
+    return (ea->type < eb->type ? -1 : (ea->type > eb->type ? 1 : 0));
+}
+
+int cnwn_cnwna_execute_nwsync_verify(const char * path, bool quiet, const char * manifest_path)
+{
+    if (cnwn_strisblank(path) || cnwn_strisblank(manifest_path)) {
+        cnwn_set_error("need a store and a manifest");
+        return -1;
+    }
+    cnwn_NWSyncManifest manifest;
+    if (cnwn_nwsync_manifest_init_from_path(&manifest, manifest_path) < 0)
+        return -1;
+    int num_entries = cnwn_nwsync_manifest_get_num_entries(&manifest);
+    const cnwn_NWSyncEntry ** sorted = malloc(sizeof(cnwn_NWSyncEntry *) * CNWN_MAX(1, num_entries));
+    for (int i = 0; i < num_entries; i++)
+        sorted[i] = cnwn_nwsync_manifest_get_entry(&manifest, i);
+    // Entries sharing content are verified once.
+    qsort(sorted, num_entries, sizeof(cnwn_NWSyncEntry *), cnwn_cnwna_nwsync_compare_sha1);
+    int num_contents = 0, num_missing = 0, num_broken = 0;
+    int64_t verified_bytes = 0;
+    int ret = 0;
+    int status = CNWN_NWSYNC_STATUS_OK;
+    for (int i = 0; i < num_entries && ret >= 0; i++) {
+        const cnwn_NWSyncEntry * entry = sorted[i];
+        if (i == 0 || memcmp(sorted[i - 1]->sha1, entry->sha1, CNWN_SHA1_SIZE) != 0) {
+            status = cnwn_nwsync_store_verify(path, entry);
+            if (status < 0) {
+                ret = -1;
+                break;
+            }
+            num_contents++;
+            verified_bytes += entry->size;
+        }
+        if (status == CNWN_NWSYNC_STATUS_OK)
+            continue;
+        if (status == CNWN_NWSYNC_STATUS_MISSING)
+            num_missing++;
+        else
+            num_broken++;
+        if (!quiet) {
+            char sha1[CNWN_SHA1_STRING_SIZE];
+            cnwn_hash_sha1_to_string(entry->sha1, sha1, sizeof(sha1));
+            printf("%s %s %s.%s\n", (status == CNWN_NWSYNC_STATUS_MISSING ? "Missing" : (status == CNWN_NWSYNC_STATUS_SIZE_MISMATCH ? "Wrong size" : "Wrong hash")),
+                   sha1, entry->resref.s, CNWN_RESOURCE_TYPE_EXTENSION(entry->type));
+        }
+    }
+    if (ret >= 0) {
+        if (!quiet)
+            printf("Verified %d resources, %d unique (%"PRId64" bytes): %d missing, %d broken\n", num_entries, num_contents, verified_bytes, num_missing, num_broken);
+        ret = num_entries;
+        if (num_missing + num_broken > 0) {
+            cnwn_set_error("%d resources failed verification", num_missing + num_broken);
+            ret = -1;
+        }
+    }
+    free(sorted);
+    cnwn_nwsync_manifest_deinit(&manifest);
+    return ret;
+}
+
+int cnwn_cnwna_execute_nwsync_diff(const char * path, bool quiet, const char * other_path, const char * store_path)
+{
+    if (cnwn_strisblank(path) || cnwn_strisblank(other_path)) {
+        cnwn_set_error("need an old and a new manifest");
+        return -1;
+    }
+    cnwn_NWSyncManifest manifest, other, added, removed;
+    if (cnwn_nwsync_manifest_init_from_path(&manifest, path) < 0)
+        return -1;
+    if (cnwn_nwsync_manifest_init_from_path(&other, other_path) < 0) {
+        cnwn_nwsync_manifest_deinit(&manifest);
+        return -1;
+    }
+    cnwn_nwsync_manifest_init(&added);
+    cnwn_nwsync_manifest_init(&removed);
+    int ret = cnwn_nwsync_manifest_diff(&manifest, &other, &added, &removed);
+    if (ret < 0) {
+        cnwn_nwsync_manifest_deinit(&removed);
+        cnwn_nwsync_manifest_deinit(&added);
+        cnwn_nwsync_manifest_deinit(&other);
+        cnwn_nwsync_manifest_deinit(&manifest);
+        return -1;
+    }
+    int num_added = cnwn_nwsync_manifest_get_num_entries(&added);
+    int num_removed = cnwn_nwsync_manifest_get_num_entries(&removed);
+    int num_needed = 0;
+    int64_t needed_bytes = 0;
+    for (int i = 0; i < num_added; i++) {
+        const cnwn_NWSyncEntry * entry = cnwn_nwsync_manifest_get_entry(&added, i);
+        if (store_path != NULL && cnwn_nwsync_store_has(store_path, entry->sha1))
+            continue;
+        char sha1[CNWN_SHA1_STRING_SIZE];
+        cnwn_hash_sha1_to_string(entry->sha1, sha1, sizeof(sha1));
+        printf("+ %s %s.%s %u\n", sha1, entry->resref.s, CNWN_RESOURCE_TYPE_EXTENSION(entry->type), entry->size);
+        num_needed++;
+        needed_bytes += entry->size;
+    }
+    for (int i = 0; i < num_removed; i++) {
+        const cnwn_NWSyncEntry * entry = cnwn_nwsync_manifest_get_entry(&removed, i);
+        printf("- %s.%s\n", entry->resref.s, CNWN_RESOURCE_TYPE_EXTENSION(entry->type));
+    }
+    if (!quiet)
+        printf("%d added or changed, %d removed, %d needed (%"PRId64" bytes)\n", num_added, num_removed, num_needed, needed_bytes);
+    cnwn_nwsync_manifest_deinit(&removed);
+    cnwn_nwsync_manifest_deinit(&added);
+    cnwn_nwsync_manifest_deinit(&other);
+    cnwn_nwsync_manifest_deinit(&manifest);
+    return ret;
 }
@@ -1,6 +1,11 @@
 #include "cnwn/common.h"
 
-static char CNWN_ERROR_MESSAGE[8192] = {0};
+#ifdef CNWN_X86
+#include <cpuid.h>
+#endif
+
+// Per thread so worker threads (e.g. cnwna manifest) can report errors.
+static CNWN_THREAD_LOCAL char CNWN_ERROR_MESSAGE[8192] = {0};
 
 const char * cnwn_get_error(void)
 {
@@ -25,6 +30,43 @@ void cnwn_set_error(const char * format, ...)
     va_end(args);
 }
 
+int cnwn_cpu_features(void)
+{
+    static int features = -1;
+    if (features >= 0)
+        return features;
+    int ret = 0;
+#ifdef CNWN_X86
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        if (edx & bit_SSE2)
+            ret |= CNWN_CPU_FEATURE_SSE2;
+        if (ecx & bit_SSE4_2)
+            ret |= CNWN_CPU_FEATURE_SSE42;
+        if (ecx & bit_PCLMUL)
+            ret |= CNWN_CPU_FEATURE_PCLMUL;
+        bool os_avx = false;
+        if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX)) {
+            unsigned int xcr0_lo, xcr0_hi;
+            __asm__ volatile ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+            os_avx = ((xcr0_lo & 0x6) == 0x6);
+        }
+        if (__get_cpuid_max(0, NULL) >= 7) {
+            __cpuid_count(7, 0, eax, ebx, ecx, edx);
+            if (os_avx && (ebx & bit_AVX2))
+                ret |= CNWN_CPU_FEATURE_AVX2;
+            if (ebx & bit_SHA)
+                ret |= CNWN_CPU_FEATURE_SHA;
+        }
+    }
+#endif
+    const char * mask = getenv("CNWN_CPU_FEATURES");
+    if (mask != NULL && *mask != 0)
+        ret &= (int)strtol(mask, NULL, 0);
+    features = ret;
+    return features;
+}
+
 // void cnwn_free_strings(char ** strings)
 // {
 //     if (strings != NULL) {
@@ -0,0 +1,245 @@
+#include "cnwn/compression.h"
+
+#ifdef BUILD_ZLIB
+#include <zlib.h>
+#endif
+
+static const char * CNWN_COMPRESSION_NAMES[CNWN_MAX_COMPRESSION] = {"none", "zlib", "zstd"};
+
+static uint32_t cnwn_compression_read_u32(const uint8_t * p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void cnwn_compression_write_u32(uint8_t * p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+const char * cnwn_compression_name(cnwn_Compression compression)
+{
+    if (compression >= 0 && compression < CNWN_MAX_COMPRESSION)
+        return CNWN_COMPRESSION_NAMES[compression];
+    return "";
+}
+
+int cnwn_compression_from_name(const char * name)
+{
+    for (int i = 0; i < CNWN_MAX_COMPRESSION; i++)
+        if (name != NULL && cnwn_strcmpi(CNWN_COMPRESSION_NAMES[i], name) == 0)
+            return i;
+    return -1;
+}
+
+bool cnwn_compression_supported(cnwn_Compression compression)
+{
+    if (compression == CNWN_COMPRESSION_NONE)
+        return true;
+#ifdef BUILD_ZLIB
+    if (compression == CNWN_COMPRESSION_ZLIB)
+        return true;
+#endif
+    return false;
+}
+
+int cnwn_compression_read_header(const void * data, int64_t size, cnwn_Compression * ret_compression, int64_t * ret_uncompressed_size)
+{
+    const uint8_t * p = data;
+    if (size < CNWN_COMPRESSION_HEADER_SIZE) {
+        cnwn_set_error("not enough data for compression header (%"PRId64" bytes)", size);
+        return -1;
+    }
+    if (memcmp(p, CNWN_COMPRESSION_MAGIC, 4) != 0) {
+        cnwn_set_error("invalid compression header (%.4s)", (const char *)p);
+        return -1;
+    }
+    uint32_t version = cnwn_compression_read_u32(p + 4);
+    if (version != CNWN_COMPRESSION_HEADER_VERSION) {
+        cnwn_set_error("unsupported compression header version (%u)", version);
+        return -1;
+    }
+    uint32_t compression = cnwn_compression_read_u32(p + 8);
+    if (compression >= CNWN_MAX_COMPRESSION) {
+        cnwn_set_error("invalid codec (%u)", compression);
+        return -1;
+    }
+    if (ret_compression != NULL)
+        *ret_compression = (cnwn_Compression)compression;
+    if (ret_uncompressed_size != NULL)
+        *ret_uncompressed_size = cnwn_compression_read_u32(p + 12);
+    return 0;
+}
+
+int64_t cnwn_compression_compress(cnwn_Compression compression, const void * data, int64_t size, void * ret_data, int64_t max_size)
+{
+    if (!cnwn_compression_supported(compression) || compression == CNWN_COMPRESSION_NONE) {
+        cnwn_set_error("unsupported codec (%s)", cnwn_compression_name(compression));
+        return -1;
+    }
+    if (size < 0 || size > UINT32_MAX) {
+        cnwn_set_error("invalid size to compress (%"PRId64" bytes)", size);
+        return -1;
+    }
+    if (max_size <= CNWN_COMPRESSION_HEADER_SIZE)
+        return 0;
+    uint8_t * p = ret_data;
+    memcpy(p, CNWN_COMPRESSION_MAGIC, 4);
+    cnwn_compression_write_u32(p + 4, CNWN_COMPRESSION_HEADER_VERSION);
+    cnwn_compression_write_u32(p + 8, compression);
+    cnwn_compression_write_u32(p + 12, (uint32_t)size);
+    cnwn_compression_write_u32(p + 16, 0);
+#ifdef BUILD_ZLIB
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit(&stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        cnwn_set_error("zlib init failed");
+        return -1;
+    }
+    stream.next_in = (Bytef *)data;
+    stream.avail_in = (uInt)size;
+    stream.next_out = p + CNWN_COMPRESSION_HEADER_SIZE;
+    stream.avail_out = (uInt)CNWN_MIN(max_size - CNWN_COMPRESSION_HEADER_SIZE, (int64_t)UINT32_MAX);
+    int zret = deflate(&stream, Z_FINISH);
+    int64_t ret = CNWN_COMPRESSION_HEADER_SIZE + (int64_t)stream.total_out;
+    deflateEnd(&stream);
+    if (zret == Z_STREAM_END)
+        return ret;
+    if (zret == Z_OK || zret == Z_BUF_ERROR)
+        return 0;
+    cnwn_set_error("zlib compression failed (%d)", zret);
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+int64_t cnwn_compression_decompress(const void * data, int64_t size, void * ret_data, int64_t max_size)
+{
+    cnwn_Compression compression;
+    int64_t uncompressed_size;
+    if (cnwn_compression_read_header(data, size, &compression, &uncompressed_size) < 0)
+        return -1;
+    if (uncompressed_size > max_size) {
+        cnwn_set_error("not enough space to decompress (%"PRId64" bytes needed)", uncompressed_size);
+        return -1;
+    }
+    if (compression == CNWN_COMPRESSION_NONE) {
+        if (size - CNWN_COMPRESSION_HEADER_SIZE != uncompressed_size) {
+            cnwn_set_error("invalid uncompressed data size (%"PRId64" bytes)", size - CNWN_COMPRESSION_HEADER_SIZE);
+            return -1;
+        }
+        memcpy(ret_data, (const uint8_t *)data + CNWN_COMPRESSION_HEADER_SIZE, uncompressed_size);
+        return uncompressed_size;
+    }
+    if (!cnwn_compression_supported(compression)) {
+        cnwn_set_error("unsupported codec (%s)", cnwn_compression_name(compression));
+        return -1;
+    }
+#ifdef BUILD_ZLIB
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit(&stream) != Z_OK) {
+        cnwn_set_error("zlib init failed");
+        return -1;
+    }
+    stream.next_in = (Bytef *)data + CNWN_COMPRESSION_HEADER_SIZE;
+    stream.avail_in = (uInt)CNWN_MIN(size - CNWN_COMPRESSION_HEADER_SIZE, (int64_t)UINT32_MAX);
+    stream.next_out = ret_data;
+    stream.avail_out = (uInt)uncompressed_size;
+    int zret = inflate(&stream, Z_FINISH);
+    int64_t ret = (int64_t)stream.total_out;
+    inflateEnd(&stream);
+    if (zret != Z_STREAM_END || ret != uncompressed_size) {
+        cnwn_set_error("zlib decompression failed (%d, %"PRId64" of %"PRId64" bytes)", zret, ret, uncompressed_size);
+        return -1;
+    }
+    return ret;
+#else
+    return -1;
+#endif
+}
+
+int64_t cnwn_compression_decompress_file(cnwn_File * input_f, int64_t size, cnwn_File * output_f)
+{
+    uint8_t header[CNWN_COMPRESSION_HEADER_SIZE];
+    if (size < CNWN_COMPRESSION_HEADER_SIZE || cnwn_file_read_fixed(input_f, sizeof(header), header) != sizeof(header)) {
+        cnwn_set_error("not enough data for compression header (%"PRId64" bytes)", size);
+        return -1;
+    }
+    cnwn_Compression compression;
+    int64_t uncompressed_size;
+    if (cnwn_compression_read_header(header, sizeof(header), &compression, &uncompressed_size) < 0)
+        return -1;
+    size -= CNWN_COMPRESSION_HEADER_SIZE;
+    if (compression == CNWN_COMPRESSION_NONE) {
+        if (size != uncompressed_size) {
+            cnwn_set_error("invalid uncompressed data size (%"PRId64" bytes)", size);
+            return -1;
+        }
+        return cnwn_file_copy(input_f, size, output_f);
+    }
+    if (!cnwn_compression_supported(compression)) {
+        cnwn_set_error("unsupported codec (%s)", cnwn_compression_name(compression));
+        return -1;
+    }
+#ifdef BUILD_ZLIB
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit(&stream) != Z_OK) {
+        cnwn_set_error("zlib init failed");
+        return -1;
+    }
+    uint8_t in_buffer[CNWN_FILE_BUFFER_SIZE];
+    uint8_t out_buffer[CNWN_FILE_BUFFER_SIZE * 4];
+    int64_t ret = 0;
+    int zret = Z_OK;
+    while (ret >= 0 && zret != Z_STREAM_END) {
+        if (stream.avail_in == 0 && size > 0) {
+            int64_t read_ret = cnwn_file_read_fixed(input_f, CNWN_MIN(size, (int64_t)sizeof(in_buffer)), in_buffer);
+            if (read_ret <= 0) {
+                cnwn_set_error("%s (reading compressed data)", (read_ret == 0 ? "unexpected end of file" : cnwn_get_error()));
+                ret = -1;
+                break;
+            }
+            size -= read_ret;
+            stream.next_in = in_buffer;
+            stream.avail_in = (uInt)read_ret;
+        }
+        stream.next_out = out_buffer;
+        stream.avail_out = sizeof(out_buffer);
+        zret = inflate(&stream, Z_NO_FLUSH);
+        if (zret != Z_OK && zret != Z_STREAM_END) {
+            cnwn_set_error("zlib decompression failed (%d)", zret);
+            ret = -1;
+            break;
+        }
+        int64_t out_size = sizeof(out_buffer) - stream.avail_out;
+        if (ret + out_size > uncompressed_size) {
+            cnwn_set_error("decompressed data larger than %"PRId64" bytes", uncompressed_size);
+            ret = -1;
+            break;
+        }
+        if (out_size > 0 && cnwn_file_write(output_f, out_size, out_buffer) != out_size) {
+            cnwn_set_error("%s (writing decompressed data)", cnwn_get_error());
+            ret = -1;
+            break;
+        }
+        ret += out_size;
+        if (zret != Z_STREAM_END && out_size == 0 && stream.avail_in == 0 && size == 0) {
+            cnwn_set_error("truncated compressed data");
+            ret = -1;
+        }
+    }
+    inflateEnd(&stream);
+    if (ret >= 0 && ret != uncompressed_size) {
+        cnwn_set_error("decompressed %"PRId64" of %"PRId64" bytes", ret, uncompressed_size);
+        ret = -1;
+    }
+    return ret;
+#else
+    return -1;
+#endif
+}
@@ -0,0 +1,199 @@
+// getdents64(), the DT_* entry types, openat() and fstatat() are not in C99/POSIX 2001.
+#define _GNU_SOURCE
+#include "cnwn/directory.h"
+
+#ifndef BUILD_WINDOWS_FILE
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+const cnwn_ResourceHandler CNWN_RESOURCE_HANDLER_DIRECTORY = {
+    "directory",
+    {
+        NULL, // init1
+        &cnwn_resource_init_from_path_directory, // init2
+        NULL, // deinit
+        NULL, // extract
+        NULL, // archive
+        NULL, // get num meta
+        NULL, // get meta
+        NULL, // extract meta
+        NULL // archive meta
+    }
+};
+
+typedef struct cnwn_DirectoryEntry_s {
+    cnwn_ResourceType type;
+    int name_length;
+    int64_t size;
+    int filename_offset;
+    const char * filename;
+} cnwn_DirectoryEntry;
+
+#ifndef BUILD_WINDOWS_FILE
+
+#ifdef __linux__
+// The record getdents64() fills the buffer with, glibc only declares it for readdir().
+typedef struct cnwn_LinuxDirent64_s {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+} cnwn_LinuxDirent64;
+#endif
+
+// Filenames are kept in one array of chars (zero terminated) while reading the directory, entries point into it after.
+static int cnwn_directory_scan_entry(int fd, const char * filename, unsigned char d_type, cnwn_Array * entries, cnwn_Array * filenames)
+{
+    if (d_type != DT_REG && d_type != DT_LNK && d_type != DT_UNKNOWN)
+        return 0;
+    int name_length = cnwn_strfind(filename, 0, ".", NULL);
+    if (name_length <= 0 || name_length > CNWN_RESREF_MAX_LENGTH)
+        return 0;
+    // "foo.bak.2da" is neither resource foo nor foo.bak, names can't contain dots.
+    if (cnwn_strfind(filename, name_length + 1, ".", NULL) >= 0)
+        return 0;
+    cnwn_ResourceType type = cnwn_resource_type_from_path(filename);
+    if (!CNWN_RESOURCE_TYPE_VALID(type))
+        return 0;
+    // Only kept files are stat'ed, links and file systems without entry types also need it to know what they are.
+    struct stat st;
+    if (fstatat(fd, filename, &st, 0) < 0) {
+        if (errno == ENOENT)
+            return 0;
+        cnwn_set_error("%s (stat %s)", strerror(errno), filename);
+        return -1;
+    }
+    if (!S_ISREG(st.st_mode))
+        return 0;
+    cnwn_DirectoryEntry entry = {type, name_length, (int64_t)st.st_size, cnwn_array_get_length(filenames), NULL};
+    cnwn_array_append(entries, 1, &entry);
+    cnwn_array_append(filenames, cnwn_strlen(filename) + 1, filename);
+    return 0;
+}
+
+static int cnwn_directory_scan(const char * path, cnwn_Array * entries, cnwn_Array * filenames)
+{
+#ifdef __linux__
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOTDIR)
+            return 0;
+        cnwn_set_error("%s", strerror(errno));
+        return -1;
+    }
+    char * buffer = malloc(CNWN_FILE_BUFFER_SIZE * 4);
+    if (buffer == NULL) {
+        cnwn_set_error("out of memory (getdents64 buffer)");
+        close(fd);
+        return -1;
+    }
+    int ret = 0;
+    long num_bytes = 0;
+    while (ret >= 0 && (num_bytes = syscall(SYS_getdents64, fd, buffer, CNWN_FILE_BUFFER_SIZE * 4)) > 0) {
+        for (long pos = 0; ret >= 0 && pos < num_bytes; ) {
+            const cnwn_LinuxDirent64 * dirent = (const cnwn_LinuxDirent64 *)(buffer + pos);
+            ret = cnwn_directory_scan_entry(fd, dirent->d_name, dirent->d_type, entries, filenames);
+            pos += dirent->d_reclen;
+        }
+    }
+    if (ret >= 0 && num_bytes < 0) {
+        cnwn_set_error("%s (getdents64)", strerror(errno));
+        ret = -1;
+    }
+    free(buffer);
+    close(fd);
+    return ret;
+#else
+    DIR * dp = opendir(path);
+    if (dp == NULL) {
+        if (errno == ENOTDIR)
+            return 0;
+        cnwn_set_error("%s", strerror(errno));
+        return -1;
+    }
+    int ret = 0;
+    struct dirent * ep;
+    while (ret >= 0 && (ep = readdir(dp)) != NULL)
+        ret = cnwn_directory_scan_entry(dirfd(dp), ep->d_name, ep->d_type, entries, filenames);
+    closedir(dp);
+    return ret;
+#endif
+}
+
+static int cnwn_directory_compare_filename(const void * a, const void * b)
+{
+    const char * fa = ((const cnwn_DirectoryEntry *)a)->filename;
+    const char * fb = ((const cnwn_DirectoryEntry *)b)->filename;
+    // Compare the lowercase characters so names only differing in case end up next to each other.
+    for (int i = 0; fa[i] != 0 || fb[i] != 0; i++) {
+        unsigned char ca = (fa[i] >= 'A' && fa[i] <= 'Z' ? fa[i] + 32 : fa[i]);
+        unsigned char cb = (fb[i] >= 'A' && fb[i] <= 'Z' ? fb[i] + 32 : fb[i]);
+        if (ca != cb)
+            return (ca < cb ? -1 : 1);
+    }
+    return cnwn_strcmp(fa, fb);
+}
+
+#endif
+
+int cnwn_resource_init_from_path_directory(cnwn_Resource * resource, const char * path)
+{
+#ifdef BUILD_WINDOWS_FILE
+    cnwn_set_error("directories are not supported");
+    return -1;
+#else
+    cnwn_Array entries;
+    cnwn_Array filenames;
+    cnwn_array_init(&entries, sizeof(cnwn_DirectoryEntry), NULL);
+    cnwn_array_init(&filenames, sizeof(char), NULL);
+    int ret = cnwn_directory_scan(path, &entries, &filenames);
+    int num_entries = cnwn_array_get_length(&entries);
+    if (ret >= 0 && num_entries > 0) {
+        cnwn_DirectoryEntry * entry_ptr = cnwn_array_element_ptr(&entries, 0);
+        const char * filename_ptr = cnwn_array_element_ptr(&filenames, 0);
+        for (int i = 0; i < num_entries; i++)
+            entry_ptr[i].filename = filename_ptr + entry_ptr[i].filename_offset;
+        // Directory order depends on the file system, sorting by filename (ignoring case like resource names) makes
+        // the order the same everywhere.
+        qsort(entry_ptr, num_entries, sizeof(cnwn_DirectoryEntry), &cnwn_directory_compare_filename);
+        for (int i = 0; ret >= 0 && i < num_entries; i++) {
+            // Files only differing in case are the same resource, the first one (in byte order) is used.
+            if (i > 0 && cnwn_strcmpi(entry_ptr[i - 1].filename, entry_ptr[i].filename) == 0)
+                continue;
+            char name[CNWN_RESREF_MAX_LENGTH + 1];
+            char entry_path[CNWN_PATH_MAX_SIZE];
+            cnwn_strcpy(name, sizeof(name), entry_ptr[i].filename, entry_ptr[i].name_length);
+            int length = snprintf(entry_path, sizeof(entry_path), "%s%s%s", path, CNWN_PATH_SEPARATOR, entry_ptr[i].filename);
+            if (length < 0 || length >= (int)sizeof(entry_path)) {
+                cnwn_set_error("path too long (%s%s%s)", path, CNWN_PATH_SEPARATOR, entry_ptr[i].filename);
+                ret = -1;
+                break;
+            }
+            // Archives are opened to initialize them as nested containers, other files are only added as entries.
+            cnwn_File * f = NULL;
+            if (CNWN_RESOURCE_HANDLER(entry_ptr[i].type)->callbacks.f_init_from_file != NULL) {
+                f = cnwn_file_open(entry_path, "r");
+                if (f == NULL) {
+                    cnwn_set_error("%s (open %s)", cnwn_get_error(), entry_path);
+                    ret = -1;
+                    break;
+                }
+            }
+            ret = cnwn_resource_add_resource2(resource, entry_ptr[i].type, name, 0, entry_ptr[i].size, CNWN_COMPRESSION_NONE, entry_ptr[i].size, entry_path, f);
+            if (f != NULL)
+                cnwn_file_close(f);
+        }
+    }
+    cnwn_array_deinit(&filenames);
+    cnwn_array_deinit(&entries);
+    return (ret < 0 ? -1 : 0);
+#endif
+}
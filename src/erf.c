@@ -203,14 +203,27 @@ int cnwn_resource_init_from_file_erf(cnwn_Resource * resource, cnwn_File * f)
             entries[i].size = cnwn_endian_ltoh32(entries[i].size);
         }
         for (int i = 0; i < num_entries; i++) {
-            cnwn_Resource subresource;
-            int ret = cnwn_resource_init_from_file(&subresource, entries[i].type, entries[i].key, resource->offset + entries[i].offset, entries[i].size, resource, f);
-            if (ret < 0) {
+            int64_t offset = resource->offset + entries[i].offset;
+            cnwn_Compression compression = CNWN_COMPRESSION_NONE;
+            int64_t uncompressed_size = entries[i].size;
+            // The reserved field of a key is the codec of a compressed resource, the type handler can't parse
+            // compressed data so only the compression header is read. Other tools may leave junk in the field, a
+            // resource is only compressed if its codec is known and the header at its offset agrees with it.
+            if (entries[i].unused != CNWN_COMPRESSION_NONE && entries[i].unused < CNWN_MAX_COMPRESSION && entries[i].size >= CNWN_COMPRESSION_HEADER_SIZE) {
+                uint8_t header[CNWN_COMPRESSION_HEADER_SIZE];
+                if (cnwn_file_seek(f, offset) < 0
+                    || cnwn_file_read_fixed(f, sizeof(header), header) != sizeof(header)
+                    || cnwn_compression_read_header(header, entries[i].size, &compression, &uncompressed_size) < 0
+                    || compression != entries[i].unused) {
+                    compression = CNWN_COMPRESSION_NONE;
+                    uncompressed_size = entries[i].size;
+                }
+            }
+            if (cnwn_resource_add_resource(resource, entries[i].type, entries[i].key, offset, entries[i].size, compression, uncompressed_size, f) < 0) {
                 cnwn_set_error("%s (%s \"%s\")", cnwn_get_error(), "subresource", entries[i].key);
                 free(entries);
                 return -1;
             }
-            cnwn_array_append(&resource->resources, 1, &subresource);
         }
         free(entries);
     }
@@ -288,3 +301,149 @@ int64_t cnwn_resource_meta_file_extract_erf(const cnwn_Resource * resource, int
     cnwn_set_error("invalid meta file index (erf %d)", index);
     return -1;
 }
+
+static void cnwn_erf_write_u32(uint8_t * p, uint32_t u)
+{
+    p[0] = u & 0xff;
+    p[1] = (u >> 8) & 0xff;
+    p[2] = (u >> 16) & 0xff;
+    p[3] = (u >> 24) & 0xff;
+}
+
+static int64_t cnwn_erf_write_recoded(const cnwn_Resource * subresource, cnwn_File * input_f, cnwn_Compression compression, cnwn_File * output_f, cnwn_Compression * ret_compression)
+{
+    int64_t size = subresource->uncompressed_size;
+    int64_t raw_size = CNWN_MAX(subresource->size, size);
+    uint8_t * data = malloc(CNWN_MAX(1, size + raw_size));
+    uint8_t * raw = data + size;
+    int64_t ret = cnwn_file_seek(input_f, subresource->offset);
+    if (ret >= 0 && cnwn_file_read_fixed(input_f, subresource->size, raw) != subresource->size) {
+        cnwn_set_error("%s (reading)", cnwn_get_error());
+        ret = -1;
+    }
+    if (ret >= 0) {
+        if (subresource->compression != CNWN_COMPRESSION_NONE)
+            ret = cnwn_compression_decompress(raw, subresource->size, data, size);
+        else
+            memcpy(data, raw, size);
+    }
+    if (ret >= 0 && compression != CNWN_COMPRESSION_NONE) {
+        // Only keep the compressed data if it is smaller.
+        ret = cnwn_compression_compress(compression, data, size, raw, size - 1);
+        if (ret > 0) {
+            *ret_compression = compression;
+            ret = cnwn_file_write(output_f, ret, raw);
+        }
+    }
+    if (ret == 0 || (ret > 0 && compression == CNWN_COMPRESSION_NONE)) {
+        *ret_compression = CNWN_COMPRESSION_NONE;
+        ret = cnwn_file_write(output_f, size, data);
+    }
+    free(data);
+    return ret;
+}
+
+int64_t cnwn_erf_write_subset(const cnwn_Resource * resource, cnwn_File * input_f, const bool * keep, cnwn_File * output_f)
+{
+    return cnwn_erf_write_subset2(resource, input_f, keep, -1, output_f);
+}
+
+int64_t cnwn_erf_write_subset2(const cnwn_Resource * resource, cnwn_File * input_f, const bool * keep, int compression, cnwn_File * output_f)
+{
+    if (!CNWN_RESOURCE_TYPE_IS_ERF(resource->type)) {
+        cnwn_set_error("%s() type mismatch %d\n", __func__, resource->type);
+        return -1;
+    }
+    if (compression >= 0 && !cnwn_compression_supported(compression)) {
+        cnwn_set_error("unsupported codec (%s)", cnwn_compression_name(compression));
+        return -1;
+    }
+    const cnwn_ResourceERF * erf = &resource->r.r_erf;
+    int num_resources = cnwn_resource_get_num_resources(resource);
+    int num_kept = 0;
+    for (int i = 0; i < num_resources; i++)
+        if (keep == NULL || keep[i])
+            num_kept++;
+    int key_size = (erf->version.minor > 0 ? 32 : 16);
+    uint32_t keys_offset = 160 + erf->localized_strings_size;
+    uint32_t values_offset = keys_offset + (uint32_t)num_kept * (key_size + 8);
+    int64_t data_offset = (int64_t)values_offset + (int64_t)num_kept * 8;
+    int64_t table_size = data_offset - keys_offset;
+    uint8_t * table = malloc(CNWN_MAX(1, table_size));
+    memset(table, 0, CNWN_MAX(1, table_size));
+    int64_t start = cnwn_file_get_seek(output_f);
+    uint8_t header[160];
+    memset(header, 0, sizeof(header));
+    memcpy(header, erf->typestr, cnwn_strlen(erf->typestr));
+    memcpy(header + 4, erf->versionstr, cnwn_strlen(erf->versionstr));
+    cnwn_erf_write_u32(header + 8, erf->num_localized_strings);
+    cnwn_erf_write_u32(header + 12, erf->localized_strings_size);
+    cnwn_erf_write_u32(header + 16, num_kept);
+    cnwn_erf_write_u32(header + 20, 160);
+    cnwn_erf_write_u32(header + 24, keys_offset);
+    cnwn_erf_write_u32(header + 28, values_offset);
+    cnwn_erf_write_u32(header + 32, erf->year);
+    cnwn_erf_write_u32(header + 36, erf->day_of_year);
+    cnwn_erf_write_u32(header + 40, erf->description_strref);
+    memcpy(header + 44, erf->rest, sizeof(erf->rest));
+    int64_t ret = (start >= 0 ? cnwn_file_write(output_f, sizeof(header), header) : -1);
+    if (ret >= 0 && erf->localized_strings_size > 0) {
+        ret = cnwn_file_seek(input_f, resource->offset + erf->localized_strings_offset);
+        if (ret >= 0)
+            ret = cnwn_file_copy(input_f, erf->localized_strings_size, output_f);
+    }
+    // The table is written again when the sizes of (re)compressed resources are known.
+    if (ret >= 0)
+        ret = cnwn_file_write(output_f, table_size, table);
+    if (ret < 0) {
+        cnwn_set_error("%s (%s)", cnwn_get_error(), "writing header");
+        free(table);
+        return -1;
+    }
+    int64_t offset = data_offset;
+    for (int i = 0, j = 0; i < num_resources; i++) {
+        if (keep != NULL && !keep[i])
+            continue;
+        cnwn_Resource view;
+        const cnwn_Resource * subresource = cnwn_resource_get_resource(resource, i, &view);
+        cnwn_Compression stored_compression = subresource->compression;
+        if (compression < 0 || compression == subresource->compression) {
+            ret = cnwn_file_seek(input_f, subresource->offset);
+            if (ret >= 0)
+                ret = cnwn_file_copy(input_f, subresource->size, output_f);
+        } else
+            ret = cnwn_erf_write_recoded(subresource, input_f, compression, output_f, &stored_compression);
+        if (ret >= 0 && offset + ret > UINT32_MAX) {
+            cnwn_set_error("ERF too large (%"PRId64" bytes)", offset + ret);
+            ret = -1;
+        }
+        if (ret < 0) {
+            cnwn_set_error("%s (copying %s)", cnwn_get_error(), cnwn_resource_get_name(subresource));
+            free(table);
+            return -1;
+        }
+        uint8_t * key = table + j * (key_size + 8);
+        cnwn_strcpy((char *)key, key_size + 1, cnwn_resource_get_name(subresource), key_size);
+        cnwn_erf_write_u32(key + key_size, j);
+        key[key_size + 4] = subresource->type & 0xff;
+        key[key_size + 5] = (subresource->type >> 8) & 0xff;
+        key[key_size + 6] = stored_compression & 0xff;
+        key[key_size + 7] = (stored_compression >> 8) & 0xff;
+        uint8_t * value = table + (values_offset - keys_offset) + j * 8;
+        cnwn_erf_write_u32(value, (uint32_t)offset);
+        cnwn_erf_write_u32(value + 4, (uint32_t)ret);
+        offset += ret;
+        j++;
+    }
+    ret = cnwn_file_seek(output_f, start + keys_offset);
+    if (ret >= 0)
+        ret = cnwn_file_write(output_f, table_size, table);
+    if (ret >= 0)
+        ret = cnwn_file_seek(output_f, start + offset);
+    free(table);
+    if (ret < 0) {
+        cnwn_set_error("%s (%s)", cnwn_get_error(), "writing keys");
+        return -1;
+    }
+    return offset;
+}
@@ -9,6 +9,7 @@ struct cnwn_File_s { HFILE hfile; };
 #include <fcntl.h>
 #include <unistd.h>
 #include <dirent.h>
+#include <sys/mman.h>
 struct cnwn_File_s { int fd; };
 #endif
 
@@ -153,7 +154,8 @@ int cnwn_file_system_mkdir(const char * path)
     int index = CNWN_PATH_CASE_INSENSETIVE ? cnwn_strfindi(path, 0, CNWN_PATH_SEPARATOR, CNWN_PATH_ESCAPE) : cnwn_strfind(path, 0, CNWN_PATH_SEPARATOR, CNWN_PATH_ESCAPE);
     while (index >= 0) {
         cnwn_strcpy(tmps, sizeof(tmps), clean_path, index);
-        int isdir = cnwn_file_system_isdirectory(tmps);
+        // An absolute path starts with an empty component.
+        int isdir = (index > 0 ? cnwn_file_system_isdirectory(tmps) : 1);
         if (isdir < 0)
             return -1;
         if (isdir == 0) {
@@ -391,6 +393,19 @@ int cnwn_file_system_isdirectory(const char * path)
 #endif
 }
 
+int64_t cnwn_file_system_mtime(const char * path)
+{
+#ifdef BUILD_WINDOWS_FILE
+#else
+    struct stat st = {0};
+    if (stat(path, &st) < 0) {
+        cnwn_set_error("%s", strerror(errno));
+        return -1;
+    }
+    return (int64_t)st.st_mtime;
+#endif
+}
+
 cnwn_File * cnwn_file_open(const char * path, const char * mode)
 {
     bool flag_read = false;
@@ -888,3 +903,64 @@ int64_t cnwn_file_copy(cnwn_File * f, int64_t size, cnwn_File * output_f)
     return ret;
 #endif
 }
+
+int64_t cnwn_file_map(cnwn_File * f, int64_t offset, int64_t size, cnwn_FileMap * ret_map)
+{
+    memset(ret_map, 0, sizeof(cnwn_FileMap));
+    if (offset < 0) {
+        cnwn_set_error("invalid map offset %"PRId64, offset);
+        return -1;
+    }
+    int64_t file_size = cnwn_file_size(f);
+    if (file_size < 0)
+        return -1;
+    if (size < 0)
+        size = file_size - offset;
+    if (offset + size > file_size) {
+        cnwn_set_error("map out of range (%"PRId64" + %"PRId64" > %"PRId64")", offset, size, file_size);
+        return -1;
+    }
+    if (size <= 0)
+        return 0;
+#ifdef BUILD_WINDOWS_FILE
+#else
+    int64_t page_size = sysconf(_SC_PAGESIZE);
+    int64_t base_offset = offset - (offset % page_size);
+    int64_t base_size = size + (offset - base_offset);
+    void * base = mmap(NULL, base_size, PROT_READ, MAP_PRIVATE, f->fd, base_offset);
+    if (base == MAP_FAILED) {
+        cnwn_set_error("%s", strerror(errno));
+        return -1;
+    }
+    ret_map->base = base;
+    ret_map->base_size = base_size;
+    ret_map->data = ((const uint8_t *)base) + (offset - base_offset);
+    ret_map->size = size;
+    return size;
+#endif
+}
+
+int64_t cnwn_file_map_path(const char * path, cnwn_FileMap * ret_map)
+{
+    cnwn_File * f = cnwn_file_open(path, "r");
+    if (f == NULL) {
+        memset(ret_map, 0, sizeof(cnwn_FileMap));
+        cnwn_set_error("%s (open %s)", cnwn_get_error(), path);
+        return -1;
+    }
+    int64_t ret = cnwn_file_map(f, 0, -1, ret_map);
+    cnwn_file_close(f);
+    if (ret < 0)
+        cnwn_set_error("%s (map %s)", cnwn_get_error(), path);
+    return ret;
+}
+
+void cnwn_file_unmap(cnwn_FileMap * map)
+{
+#ifdef BUILD_WINDOWS_FILE
+#else
+    if (map->base != NULL)
+        munmap(map->base, map->base_size);
+#endif
+    memset(map, 0, sizeof(cnwn_FileMap));
+}
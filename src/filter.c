@@ -0,0 +1,515 @@
+#include "cnwn/filter.h"
+
+#define CNWN_FILTER_FIELD_TYPE 0
+#define CNWN_FILTER_FIELD_NAME 1
+#define CNWN_FILTER_FIELD_SIZE 2
+#define CNWN_FILTER_FIELD_ARCHIVE 3
+#define CNWN_FILTER_FIELD_HASH 4
+
+#define CNWN_FILTER_COMPARE_EQUAL 0
+#define CNWN_FILTER_COMPARE_LESS 1
+#define CNWN_FILTER_COMPARE_LESS_EQUAL 2
+#define CNWN_FILTER_COMPARE_GREATER 3
+#define CNWN_FILTER_COMPARE_GREATER_EQUAL 4
+
+// The program works on one boolean register: TEST sets it, NOT flips it and the jumps skip the rest of an and/or
+// when the register already decides it.
+#define CNWN_FILTER_OP_TEST 0
+#define CNWN_FILTER_OP_NOT 1
+#define CNWN_FILTER_OP_JUMP_IF_FALSE 2
+#define CNWN_FILTER_OP_JUMP_IF_TRUE 3
+
+#define CNWN_FILTER_NODE_TEST 0
+#define CNWN_FILTER_NODE_NOT 1
+#define CNWN_FILTER_NODE_AND 2
+#define CNWN_FILTER_NODE_OR 3
+
+#define CNWN_FILTER_TOKEN_END 0
+#define CNWN_FILTER_TOKEN_WORD 1
+#define CNWN_FILTER_TOKEN_STRING 2
+#define CNWN_FILTER_TOKEN_OPERATOR 3
+#define CNWN_FILTER_TOKEN_OPEN 4
+#define CNWN_FILTER_TOKEN_CLOSE 5
+#define CNWN_FILTER_TOKEN_COMMA 6
+
+struct cnwn_FilterInstruction_s {
+    uint8_t op;
+    uint8_t field;
+    uint8_t compare;
+    int jump;
+    int first_value;
+    int num_values;
+    int64_t number;
+};
+
+struct cnwn_FilterValue_s {
+    cnwn_ResourceType type;
+    cnwn_ResRef name;
+    uint8_t hash[CNWN_SHA1_SIZE];
+    int hash_digits;
+};
+
+typedef struct cnwn_FilterNode_s {
+    int kind;
+    int left;
+    int right;
+    bool negate;
+    struct cnwn_FilterInstruction_s test;
+} cnwn_FilterNode;
+
+typedef struct cnwn_FilterParser_s {
+    const char * expression;
+    int position;
+    int token;
+    int token_start;
+    int token_length;
+    cnwn_Filter * filter;
+    int num_nodes;
+    int max_nodes;
+    cnwn_FilterNode * nodes;
+} cnwn_FilterParser;
+
+static void cnwn_filter_next_token(cnwn_FilterParser * parser)
+{
+    const char * s = parser->expression;
+    int i = parser->position;
+    while (s[i] == ' ' || s[i] == '\t' || s[i] == '\n' || s[i] == '\r')
+        i++;
+    parser->token_start = i;
+    if (s[i] == 0)
+        parser->token = CNWN_FILTER_TOKEN_END;
+    else if (s[i] == '(' || s[i] == ')' || s[i] == ',') {
+        parser->token = (s[i] == '(' ? CNWN_FILTER_TOKEN_OPEN : (s[i] == ')' ? CNWN_FILTER_TOKEN_CLOSE : CNWN_FILTER_TOKEN_COMMA));
+        i++;
+    } else if (s[i] == '=' || s[i] == '!' || s[i] == '<' || s[i] == '>') {
+        parser->token = CNWN_FILTER_TOKEN_OPERATOR;
+        i++;
+        if (s[i] == '=')
+            i++;
+    } else if (s[i] == '"') {
+        parser->token = CNWN_FILTER_TOKEN_STRING;
+        parser->token_start = ++i;
+        while (s[i] != 0 && s[i] != '"')
+            i++;
+        parser->token_length = i - parser->token_start;
+        parser->position = (s[i] == '"' ? i + 1 : i);
+        return;
+    } else {
+        parser->token = CNWN_FILTER_TOKEN_WORD;
+        while (s[i] != 0 && strchr(" \t\n\r(),=!<>\"", s[i]) == NULL)
+            i++;
+    }
+    parser->token_length = i - parser->token_start;
+    parser->position = i;
+}
+
+static bool cnwn_filter_token_is(const cnwn_FilterParser * parser, const char * word)
+{
+    return (parser->token == CNWN_FILTER_TOKEN_WORD || parser->token == CNWN_FILTER_TOKEN_OPERATOR)
+        && cnwn_strlen(word) == parser->token_length
+        && cnwn_strncmpi(parser->expression + parser->token_start, word, parser->token_length) == 0;
+}
+
+static int cnwn_filter_error(const cnwn_FilterParser * parser, const char * what)
+{
+    if (parser->token == CNWN_FILTER_TOKEN_END)
+        cnwn_set_error("%s at the end of the filter", what);
+    else
+        cnwn_set_error("%s at \"%.*s\" (column %d)", what, CNWN_MAX(parser->token_length, 1), parser->expression + parser->token_start, parser->token_start + 1);
+    return -1;
+}
+
+static int cnwn_filter_add_node(cnwn_FilterParser * parser, int kind, int left, int right)
+{
+    if (parser->num_nodes >= parser->max_nodes) {
+        parser->max_nodes = CNWN_MAX(16, parser->max_nodes * 2);
+        parser->nodes = realloc(parser->nodes, sizeof(cnwn_FilterNode) * parser->max_nodes);
+    }
+    cnwn_FilterNode * node = parser->nodes + parser->num_nodes;
+    memset(node, 0, sizeof(cnwn_FilterNode));
+    node->kind = kind;
+    node->left = left;
+    node->right = right;
+    return parser->num_nodes++;
+}
+
+static int cnwn_filter_parse_value(cnwn_FilterParser * parser, int field, struct cnwn_FilterValue_s * ret_value)
+{
+    if (parser->token != CNWN_FILTER_TOKEN_WORD && parser->token != CNWN_FILTER_TOKEN_STRING)
+        return cnwn_filter_error(parser, "expected a value");
+    char tmps[CNWN_PATH_MAX_SIZE];
+    cnwn_strcpy(tmps, sizeof(tmps), parser->expression + parser->token_start, parser->token_length);
+    memset(ret_value, 0, sizeof(struct cnwn_FilterValue_s));
+    ret_value->type = CNWN_RESOURCE_TYPE_INVALID;
+    if (field == CNWN_FILTER_FIELD_TYPE) {
+        ret_value->type = cnwn_resource_type_from_path(tmps);
+        if (!CNWN_RESOURCE_TYPE_VALID(ret_value->type))
+            return cnwn_filter_error(parser, "invalid resource type");
+    } else if (field == CNWN_FILTER_FIELD_NAME) {
+        if (cnwn_resref_init(&ret_value->name, tmps) > CNWN_RESREF_MAX_LENGTH)
+            return cnwn_filter_error(parser, "name too long");
+    } else if (field == CNWN_FILTER_FIELD_ARCHIVE) {
+        // A name with an extension has to match both.
+        int dot = cnwn_strfindchar(tmps, 0, '.', 0);
+        if (dot >= 0) {
+            ret_value->type = cnwn_resource_type_from_path(tmps);
+            if (!CNWN_RESOURCE_TYPE_VALID(ret_value->type))
+                return cnwn_filter_error(parser, "invalid archive type");
+        }
+        if (cnwn_resref_init2(&ret_value->name, tmps, (dot >= 0 ? dot : INT_MAX)) > CNWN_RESREF_MAX_LENGTH)
+            return cnwn_filter_error(parser, "archive name too long");
+    } else if (field == CNWN_FILTER_FIELD_HASH) {
+        if (parser->token_length > CNWN_SHA1_SIZE * 2)
+            return cnwn_filter_error(parser, "hash too long");
+        for (int i = 0; tmps[i] != 0; i++) {
+            char c = tmps[i];
+            int nibble = (c >= '0' && c <= '9' ? c - '0' : (c >= 'a' && c <= 'f' ? c - 'a' + 10 : (c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1)));
+            if (nibble < 0)
+                return cnwn_filter_error(parser, "invalid hex digit in hash");
+            ret_value->hash[i / 2] |= (uint8_t)(i % 2 == 0 ? nibble << 4 : nibble);
+        }
+        ret_value->hash_digits = parser->token_length;
+    }
+    cnwn_filter_next_token(parser);
+    return 0;
+}
+
+static int cnwn_filter_parse_expression(cnwn_FilterParser * parser);
+
+static int cnwn_filter_parse_test(cnwn_FilterParser * parser)
+{
+    int field;
+    if (cnwn_filter_token_is(parser, "type"))
+        field = CNWN_FILTER_FIELD_TYPE;
+    else if (cnwn_filter_token_is(parser, "name"))
+        field = CNWN_FILTER_FIELD_NAME;
+    else if (cnwn_filter_token_is(parser, "size"))
+        field = CNWN_FILTER_FIELD_SIZE;
+    else if (cnwn_filter_token_is(parser, "archive"))
+        field = CNWN_FILTER_FIELD_ARCHIVE;
+    else if (cnwn_filter_token_is(parser, "hash"))
+        field = CNWN_FILTER_FIELD_HASH;
+    else
+        return cnwn_filter_error(parser, "expected type, name, size, archive or hash");
+    cnwn_filter_next_token(parser);
+    int index = cnwn_filter_add_node(parser, CNWN_FILTER_NODE_TEST, -1, -1);
+    struct cnwn_FilterInstruction_s test = {0};
+    test.op = CNWN_FILTER_OP_TEST;
+    test.field = (uint8_t)field;
+    test.compare = CNWN_FILTER_COMPARE_EQUAL;
+    bool negate = false;
+    bool list = false;
+    if (cnwn_filter_token_is(parser, "=") || cnwn_filter_token_is(parser, "=="))
+        test.compare = CNWN_FILTER_COMPARE_EQUAL;
+    else if (cnwn_filter_token_is(parser, "!="))
+        negate = true;
+    else if (field == CNWN_FILTER_FIELD_SIZE && cnwn_filter_token_is(parser, "<"))
+        test.compare = CNWN_FILTER_COMPARE_LESS;
+    else if (field == CNWN_FILTER_FIELD_SIZE && cnwn_filter_token_is(parser, "<="))
+        test.compare = CNWN_FILTER_COMPARE_LESS_EQUAL;
+    else if (field == CNWN_FILTER_FIELD_SIZE && cnwn_filter_token_is(parser, ">"))
+        test.compare = CNWN_FILTER_COMPARE_GREATER;
+    else if (field == CNWN_FILTER_FIELD_SIZE && cnwn_filter_token_is(parser, ">="))
+        test.compare = CNWN_FILTER_COMPARE_GREATER_EQUAL;
+    else if (field != CNWN_FILTER_FIELD_SIZE && cnwn_filter_token_is(parser, "in"))
+        list = true;
+    else if (field != CNWN_FILTER_FIELD_SIZE && cnwn_filter_token_is(parser, "not")) {
+        cnwn_filter_next_token(parser);
+        if (!cnwn_filter_token_is(parser, "in"))
+            return cnwn_filter_error(parser, "expected in");
+        negate = true;
+        list = true;
+    } else
+        return cnwn_filter_error(parser, "expected a comparison");
+    cnwn_filter_next_token(parser);
+    if (field == CNWN_FILTER_FIELD_SIZE) {
+        if (parser->token != CNWN_FILTER_TOKEN_WORD)
+            return cnwn_filter_error(parser, "expected a size");
+        char * end = NULL;
+        long long size = strtoll(parser->expression + parser->token_start, &end, 10);
+        int64_t multiplier = 1;
+        if (end < parser->expression + parser->token_start + parser->token_length) {
+            char unit = (*end >= 'a' && *end <= 'z' ? *end - 32 : *end);
+            multiplier = (unit == 'K' ? 1024 : (unit == 'M' ? 1024 * 1024 : (unit == 'G' ? 1024 * 1024 * 1024 : 0)));
+            end++;
+        }
+        if (end == parser->expression + parser->token_start || end != parser->expression + parser->token_start + parser->token_length || multiplier <= 0 || size < 0)
+            return cnwn_filter_error(parser, "invalid size");
+        test.number = (int64_t)size * multiplier;
+        cnwn_filter_next_token(parser);
+    } else {
+        if (list) {
+            if (parser->token != CNWN_FILTER_TOKEN_OPEN)
+                return cnwn_filter_error(parser, "expected (");
+            cnwn_filter_next_token(parser);
+        }
+        test.first_value = parser->filter->num_values;
+        do {
+            if (test.num_values > 0)
+                cnwn_filter_next_token(parser);
+            cnwn_Filter * filter = parser->filter;
+            filter->values = realloc(filter->values, sizeof(struct cnwn_FilterValue_s) * (filter->num_values + 1));
+            if (cnwn_filter_parse_value(parser, field, filter->values + filter->num_values) < 0)
+                return -1;
+            filter->num_values++;
+            test.num_values++;
+        } while (list && parser->token == CNWN_FILTER_TOKEN_COMMA);
+        if (list) {
+            if (parser->token != CNWN_FILTER_TOKEN_CLOSE)
+                return cnwn_filter_error(parser, "expected , or )");
+            cnwn_filter_next_token(parser);
+        }
+    }
+    parser->nodes[index].test = test;
+    parser->nodes[index].negate = negate;
+    return index;
+}
+
+static int cnwn_filter_parse_unary(cnwn_FilterParser * parser)
+{
+    if (cnwn_filter_token_is(parser, "not")) {
+        cnwn_filter_next_token(parser);
+        int child = cnwn_filter_parse_unary(parser);
+        if (child < 0)
+            return -1;
+        return cnwn_filter_add_node(parser, CNWN_FILTER_NODE_NOT, child, -1);
+    }
+    if (parser->token == CNWN_FILTER_TOKEN_OPEN) {
+        cnwn_filter_next_token(parser);
+        int ret = cnwn_filter_parse_expression(parser);
+        if (ret < 0)
+            return -1;
+        if (parser->token != CNWN_FILTER_TOKEN_CLOSE)
+            return cnwn_filter_error(parser, "expected )");
+        cnwn_filter_next_token(parser);
+        return ret;
+    }
+    return cnwn_filter_parse_test(parser);
+}
+
+static int cnwn_filter_parse_and(cnwn_FilterParser * parser)
+{
+    int left = cnwn_filter_parse_unary(parser);
+    while (left >= 0 && cnwn_filter_token_is(parser, "and")) {
+        cnwn_filter_next_token(parser);
+        int right = cnwn_filter_parse_unary(parser);
+        if (right < 0)
+            return -1;
+        left = cnwn_filter_add_node(parser, CNWN_FILTER_NODE_AND, left, right);
+    }
+    return left;
+}
+
+static int cnwn_filter_parse_expression(cnwn_FilterParser * parser)
+{
+    int left = cnwn_filter_parse_and(parser);
+    while (left >= 0 && cnwn_filter_token_is(parser, "or")) {
+        cnwn_filter_next_token(parser);
+        int right = cnwn_filter_parse_and(parser);
+        if (right < 0)
+            return -1;
+        left = cnwn_filter_add_node(parser, CNWN_FILTER_NODE_OR, left, right);
+    }
+    return left;
+}
+
+// True if evaluating the node may read resource data.
+static bool cnwn_filter_node_reads_data(const cnwn_FilterParser * parser, int index)
+{
+    const cnwn_FilterNode * node = parser->nodes + index;
+    if (node->kind == CNWN_FILTER_NODE_TEST)
+        return node->test.field == CNWN_FILTER_FIELD_HASH;
+    if (node->kind == CNWN_FILTER_NODE_NOT)
+        return cnwn_filter_node_reads_data(parser, node->left);
+    return cnwn_filter_node_reads_data(parser, node->left) || cnwn_filter_node_reads_data(parser, node->right);
+}
+
+static int cnwn_filter_emit(cnwn_FilterParser * parser, int index, struct cnwn_FilterInstruction_s * instructions, int num_instructions)
+{
+    const cnwn_FilterNode * node = parser->nodes + index;
+    if (node->kind == CNWN_FILTER_NODE_TEST) {
+        instructions[num_instructions++] = node->test;
+        if (node->negate)
+            instructions[num_instructions++].op = CNWN_FILTER_OP_NOT;
+    } else if (node->kind == CNWN_FILTER_NODE_NOT) {
+        num_instructions = cnwn_filter_emit(parser, node->left, instructions, num_instructions);
+        instructions[num_instructions++].op = CNWN_FILTER_OP_NOT;
+    } else {
+        // And/or don't care about the order, the side that may read data goes last.
+        int first = node->left;
+        int second = node->right;
+        if (cnwn_filter_node_reads_data(parser, first) && !cnwn_filter_node_reads_data(parser, second)) {
+            first = node->right;
+            second = node->left;
+        }
+        num_instructions = cnwn_filter_emit(parser, first, instructions, num_instructions);
+        int jump = num_instructions++;
+        instructions[jump].op = (node->kind == CNWN_FILTER_NODE_AND ? CNWN_FILTER_OP_JUMP_IF_FALSE : CNWN_FILTER_OP_JUMP_IF_TRUE);
+        num_instructions = cnwn_filter_emit(parser, second, instructions, num_instructions);
+        instructions[jump].jump = num_instructions;
+    }
+    return num_instructions;
+}
+
+int cnwn_filter_init(cnwn_Filter * filter, const char * expression)
+{
+    memset(filter, 0, sizeof(cnwn_Filter));
+    if (cnwn_strisblank(expression))
+        return 0;
+    cnwn_FilterParser parser = {0};
+    parser.expression = expression;
+    parser.filter = filter;
+    cnwn_filter_next_token(&parser);
+    int root = cnwn_filter_parse_expression(&parser);
+    if (root >= 0 && parser.token != CNWN_FILTER_TOKEN_END)
+        root = cnwn_filter_error(&parser, "expected and, or or the end");
+    if (root < 0) {
+        free(parser.nodes);
+        cnwn_filter_deinit(filter);
+        return -1;
+    }
+    // Every node emits at most two instructions.
+    struct cnwn_FilterInstruction_s * instructions = calloc(parser.num_nodes * 2, sizeof(struct cnwn_FilterInstruction_s));
+    filter->num_instructions = cnwn_filter_emit(&parser, root, instructions, 0);
+    filter->instructions = instructions;
+    free(parser.nodes);
+    return 0;
+}
+
+void cnwn_filter_deinit(cnwn_Filter * filter)
+{
+    free(filter->instructions);
+    free(filter->values);
+    memset(filter, 0, sizeof(cnwn_Filter));
+}
+
+static int cnwn_filter_hash(const cnwn_Resource * resource, int index, cnwn_File * input_f, uint8_t * ret_hash)
+{
+    const cnwn_ResourceEntries * entries = &resource->entries;
+    // Resources in a directory are read from their own file.
+    cnwn_File * path_f = NULL;
+    if (entries->paths != NULL && entries->paths[index] != NULL) {
+        path_f = cnwn_file_open(entries->paths[index], "r");
+        if (path_f == NULL) {
+            cnwn_set_error("%s (open for hash of %s)", cnwn_get_error(), entries->paths[index]);
+            return -1;
+        }
+        input_f = path_f;
+    }
+    int ret = 0;
+    if (input_f == NULL || cnwn_file_seek(input_f, entries->offsets[index]) < 0) {
+        cnwn_set_error("%s (seek for hash of %s)", (input_f == NULL ? "no file" : cnwn_get_error()), entries->names[index].s);
+        ret = -1;
+    }
+    if (ret >= 0 && entries->compressions[index] != CNWN_COMPRESSION_NONE) {
+        // The hash is of the content, compressed data is decompressed in memory first.
+        uint8_t * data = malloc(CNWN_MAX(1, entries->sizes[index]));
+        uint8_t * uncompressed_data = malloc(CNWN_MAX(1, entries->uncompressed_sizes[index]));
+        if (data == NULL || uncompressed_data == NULL) {
+            cnwn_set_error("out of memory (hash of %s)", entries->names[index].s);
+            ret = -1;
+        } else if (cnwn_file_read_fixed(input_f, entries->sizes[index], data) < 0) {
+            cnwn_set_error("%s (reading for hash of %s)", cnwn_get_error(), entries->names[index].s);
+            ret = -1;
+        } else {
+            int64_t uncompressed_size = cnwn_compression_decompress(data, entries->sizes[index], uncompressed_data, entries->uncompressed_sizes[index]);
+            if (uncompressed_size < 0) {
+                cnwn_set_error("%s (decompressing for hash of %s)", cnwn_get_error(), entries->names[index].s);
+                ret = -1;
+            } else
+                cnwn_hash_sha1(uncompressed_data, uncompressed_size, ret_hash);
+        }
+        free(uncompressed_data);
+        free(data);
+        if (path_f != NULL)
+            cnwn_file_close(path_f);
+        return ret;
+    }
+    uint8_t buffer[CNWN_FILE_BUFFER_SIZE];
+    cnwn_Sha1State state;
+    cnwn_hash_sha1_init(&state);
+    for (int64_t remaining = (ret < 0 ? 0 : entries->sizes[index]); remaining > 0; ) {
+        int64_t read_size = cnwn_file_read_fixed(input_f, CNWN_MIN(remaining, (int64_t)sizeof(buffer)), buffer);
+        if (read_size <= 0) {
+            cnwn_set_error("%s (reading for hash of %s)", cnwn_get_error(), entries->names[index].s);
+            ret = -1;
+            break;
+        }
+        cnwn_hash_sha1_update(&state, buffer, read_size);
+        remaining -= read_size;
+    }
+    if (path_f != NULL)
+        cnwn_file_close(path_f);
+    if (ret >= 0)
+        cnwn_hash_sha1_final(&state, ret_hash);
+    return ret;
+}
+
+static bool cnwn_filter_hash_equal(const uint8_t * hash, const struct cnwn_FilterValue_s * value)
+{
+    int num_bytes = value->hash_digits / 2;
+    if (memcmp(hash, value->hash, num_bytes) != 0)
+        return false;
+    return value->hash_digits % 2 == 0 || (hash[num_bytes] & 0xf0) == value->hash[num_bytes];
+}
+
+int cnwn_filter_match(const cnwn_Filter * filter, const cnwn_Resource * resource, int index, cnwn_File * input_f)
+{
+    const cnwn_ResourceEntries * entries = &resource->entries;
+    if (index < 0 || index >= entries->length) {
+        cnwn_set_error("invalid resource index %d", index);
+        return -1;
+    }
+    bool ret = true;
+    bool has_hash = false;
+    uint8_t hash[CNWN_SHA1_SIZE];
+    for (int pc = 0; pc < filter->num_instructions; pc++) {
+        const struct cnwn_FilterInstruction_s * instruction = filter->instructions + pc;
+        switch (instruction->op) {
+        case CNWN_FILTER_OP_NOT:
+            ret = !ret;
+            break;
+        case CNWN_FILTER_OP_JUMP_IF_FALSE:
+            if (!ret)
+                pc = instruction->jump - 1;
+            break;
+        case CNWN_FILTER_OP_JUMP_IF_TRUE:
+            if (ret)
+                pc = instruction->jump - 1;
+            break;
+        default: {
+            const struct cnwn_FilterValue_s * values = filter->values + instruction->first_value;
+            ret = false;
+            if (instruction->field == CNWN_FILTER_FIELD_SIZE) {
+                int64_t size = entries->sizes[index];
+                switch (instruction->compare) {
+                case CNWN_FILTER_COMPARE_LESS: ret = size < instruction->number; break;
+                case CNWN_FILTER_COMPARE_LESS_EQUAL: ret = size <= instruction->number; break;
+                case CNWN_FILTER_COMPARE_GREATER: ret = size > instruction->number; break;
+                case CNWN_FILTER_COMPARE_GREATER_EQUAL: ret = size >= instruction->number; break;
+                default: ret = size == instruction->number; break;
+                }
+            } else if (instruction->field == CNWN_FILTER_FIELD_TYPE) {
+                for (int i = 0; !ret && i < instruction->num_values; i++)
+                    ret = entries->types[index] == values[i].type;
+            } else if (instruction->field == CNWN_FILTER_FIELD_NAME) {
+                for (int i = 0; !ret && i < instruction->num_values; i++)
+                    ret = cnwn_resref_equal(entries->names + index, &values[i].name);
+            } else if (instruction->field == CNWN_FILTER_FIELD_ARCHIVE) {
+                for (int i = 0; !ret && i < instruction->num_values; i++)
+                    ret = cnwn_resref_equal(&resource->name, &values[i].name) && (values[i].type == CNWN_RESOURCE_TYPE_INVALID || values[i].type == resource->type);
+            } else if (instruction->field == CNWN_FILTER_FIELD_HASH) {
+                if (!has_hash) {
+                    if (cnwn_filter_hash(resource, index, input_f, hash) < 0)
+                        return -1;
+                    has_hash = true;
+                }
+                for (int i = 0; !ret && i < instruction->num_values; i++)
+                    ret = cnwn_filter_hash_equal(hash, values + i);
+            }
+            break;
+        }
+        }
+    }
+    return (ret ? 1 : 0);
+}
@@ -0,0 +1,331 @@
+#include "cnwn/ncs.h"
+
+static const char * CNWN_NCS_OPCODE_NAMES[] = {
+    "???", "CPDOWNSP", "RSADD", "CPTOPSP", "CONST", "ACTION", "LOGAND", "LOGOR",
+    "INCOR", "EXCOR", "BOOLAND", "EQUAL", "NEQUAL", "GEQ", "GT", "LT",
+    "LEQ", "SHLEFT", "SHRIGHT", "USHRIGHT", "ADD", "SUB", "MUL", "DIV",
+    "MOD", "NEG", "COMP", "MOVSP", "STORE_STATEALL", "JMP", "JSR", "JZ",
+    "RETN", "DESTRUCT", "NOT", "DECSP", "INCSP", "JNZ", "CPDOWNBP", "CPTOPBP",
+    "DECBP", "INCBP", "SAVEBP", "RESTOREBP", "STORE_STATE", "NOP"
+};
+
+static uint32_t cnwn_ncs_read_u32(const uint8_t * p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static uint16_t cnwn_ncs_read_u16(const uint8_t * p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static int cnwn_ncs_operands_length(const uint8_t * p, int64_t avail)
+{
+    switch (p[0]) {
+        case CNWN_NCS_OPCODE_CPDOWNSP:
+        case CNWN_NCS_OPCODE_CPTOPSP:
+        case CNWN_NCS_OPCODE_CPDOWNBP:
+        case CNWN_NCS_OPCODE_CPTOPBP:
+        case CNWN_NCS_OPCODE_DESTRUCT:
+            return 6;
+        case CNWN_NCS_OPCODE_CONST:
+            if (p[1] == CNWN_NCS_TYPE_STRING) {
+                if (avail < 4)
+                    return 2;
+                return 2 + cnwn_ncs_read_u16(p + 2);
+            }
+            if (p[1] == CNWN_NCS_TYPE_INT || p[1] == CNWN_NCS_TYPE_FLOAT || p[1] == CNWN_NCS_TYPE_OBJECT)
+                return 4;
+            return -1;
+        case CNWN_NCS_OPCODE_ACTION:
+            return 3;
+        case CNWN_NCS_OPCODE_EQUAL:
+        case CNWN_NCS_OPCODE_NEQUAL:
+            return (p[1] == CNWN_NCS_TYPE_STRUCT_STRUCT ? 2 : 0);
+        case CNWN_NCS_OPCODE_MOVSP:
+        case CNWN_NCS_OPCODE_JMP:
+        case CNWN_NCS_OPCODE_JSR:
+        case CNWN_NCS_OPCODE_JZ:
+        case CNWN_NCS_OPCODE_JNZ:
+        case CNWN_NCS_OPCODE_DECSP:
+        case CNWN_NCS_OPCODE_INCSP:
+        case CNWN_NCS_OPCODE_DECBP:
+        case CNWN_NCS_OPCODE_INCBP:
+            return 4;
+        case CNWN_NCS_OPCODE_STORE_STATE:
+            return 8;
+        default:
+            if (p[0] >= CNWN_NCS_OPCODE_CPDOWNSP && p[0] <= CNWN_NCS_OPCODE_NOP)
+                return 0;
+            return -1;
+    }
+}
+
+static bool cnwn_ncs_is_jump(uint8_t opcode)
+{
+    return (opcode == CNWN_NCS_OPCODE_JMP || opcode == CNWN_NCS_OPCODE_JSR || opcode == CNWN_NCS_OPCODE_JZ
+            || opcode == CNWN_NCS_OPCODE_JNZ || opcode == CNWN_NCS_OPCODE_STORE_STATE);
+}
+
+static int cnwn_ncs_compare_int32(const void * a, const void * b)
+{
+    int32_t ia = *(const int32_t *)a;
+    int32_t ib = *(const int32_t *)b;
+    return (ia > ib) - (ia < ib);
+}
+
+static int cnwn_ncs_decode(cnwn_Ncs * ncs)
+{
+    const uint8_t * p = ncs->data;
+    int64_t size = ncs->size;
+    if (p == NULL || size < CNWN_NCS_HEADER_SIZE) {
+        cnwn_set_error("not enough data for NCS header (%"PRId64" bytes)", size);
+        return -1;
+    }
+    if (memcmp(p, "NCS ", 4) != 0) {
+        cnwn_set_error("invalid NCS type (%.4s)", (const char *)p);
+        return -1;
+    }
+    if (memcmp(p + 4, "V1.0", 4) != 0) {
+        cnwn_set_error("unsupported NCS version (%.4s)", (const char *)p + 4);
+        return -1;
+    }
+    if (p[8] != CNWN_NCS_OPCODE_T) {
+        cnwn_set_error("missing NCS program size (%02x)", p[8]);
+        return -1;
+    }
+    uint32_t program_size = cnwn_ncs_read_u32(p + 9);
+    if (program_size < CNWN_NCS_HEADER_SIZE || program_size > size) {
+        cnwn_set_error("invalid NCS program size (%u)", program_size);
+        return -1;
+    }
+    size = program_size;
+    ncs->size = size;
+    int capacity = (int)((size - CNWN_NCS_HEADER_SIZE) / 2 + 1);
+    ncs->instructions = malloc(sizeof(cnwn_NcsInstruction) * capacity);
+    int num_instructions = 0;
+    int num_jsrs = 0;
+    int64_t offset = CNWN_NCS_HEADER_SIZE;
+    while (offset < size) {
+        if (size - offset < 2) {
+            cnwn_set_error("truncated NCS instruction at %08"PRIx64, offset);
+            return -1;
+        }
+        int length = cnwn_ncs_operands_length(p + offset, size - offset);
+        if (length < 0) {
+            cnwn_set_error("invalid NCS instruction %02x %02x at %08"PRIx64, p[offset], p[offset + 1], offset);
+            return -1;
+        }
+        if (offset + 2 + length > size) {
+            cnwn_set_error("truncated NCS instruction at %08"PRIx64, offset);
+            return -1;
+        }
+        cnwn_NcsInstruction * ins = ncs->instructions + num_instructions++;
+        ins->offset = (uint32_t)offset;
+        ins->opcode = p[offset];
+        ins->type = p[offset + 1];
+        ins->length = (uint16_t)(2 + length);
+        if (ins->opcode == CNWN_NCS_OPCODE_JSR)
+            num_jsrs++;
+        offset += 2 + length;
+    }
+    ncs->num_instructions = num_instructions;
+    ncs->jump_targets = malloc(sizeof(int32_t) * CNWN_MAX(1, num_instructions));
+    ncs->subroutines = malloc(sizeof(int32_t) * (num_jsrs + 1));
+    ncs->subroutines[0] = 0;
+    int num_subroutines = 1;
+    for (int i = 0; i < num_instructions; i++) {
+        const cnwn_NcsInstruction * ins = ncs->instructions + i;
+        ncs->jump_targets[i] = -1;
+        if (!cnwn_ncs_is_jump(ins->opcode))
+            continue;
+        int64_t target_offset = (int64_t)ins->offset + (ins->opcode == CNWN_NCS_OPCODE_STORE_STATE ? 0x10 : cnwn_ncs_operand32(ncs, ins, 0));
+        int target = (target_offset >= 0 && target_offset <= UINT32_MAX ? cnwn_ncs_find_instruction(ncs, (uint32_t)target_offset) : -1);
+        if (target < 0) {
+            cnwn_set_error("invalid NCS jump target %08"PRIx64" at %08x", target_offset, ins->offset);
+            return -1;
+        }
+        ncs->jump_targets[i] = target;
+        if (ins->opcode == CNWN_NCS_OPCODE_JSR)
+            ncs->subroutines[num_subroutines++] = target;
+    }
+    qsort(ncs->subroutines, num_subroutines, sizeof(int32_t), cnwn_ncs_compare_int32);
+    int num_unique = 0;
+    for (int i = 0; i < num_subroutines; i++)
+        if (num_unique == 0 || ncs->subroutines[num_unique - 1] != ncs->subroutines[i])
+            ncs->subroutines[num_unique++] = ncs->subroutines[i];
+    ncs->num_subroutines = num_unique;
+    return 0;
+}
+
+const char * cnwn_ncs_opcode_name(uint8_t opcode)
+{
+    if (opcode == CNWN_NCS_OPCODE_T)
+        return "T";
+    if (opcode <= CNWN_NCS_OPCODE_NOP)
+        return CNWN_NCS_OPCODE_NAMES[opcode];
+    return CNWN_NCS_OPCODE_NAMES[0];
+}
+
+int cnwn_ncs_init_from_buffer(cnwn_Ncs * ncs, const void * data, int64_t size)
+{
+    memset(ncs, 0, sizeof(cnwn_Ncs));
+    ncs->data = data;
+    ncs->size = size;
+    if (cnwn_ncs_decode(ncs) < 0) {
+        cnwn_ncs_deinit(ncs);
+        return -1;
+    }
+    return 0;
+}
+
+int cnwn_ncs_init_from_file(cnwn_Ncs * ncs, cnwn_File * f, int64_t offset, int64_t size)
+{
+    memset(ncs, 0, sizeof(cnwn_Ncs));
+    if (size < 0) {
+        cnwn_set_error("invalid NCS size (%"PRId64")", size);
+        return -1;
+    }
+    uint8_t * buffer = malloc(CNWN_MAX(1, size));
+    if (cnwn_file_seek(f, offset) < 0 || cnwn_file_read_fixed(f, size, buffer) < 0) {
+        free(buffer);
+        return -1;
+    }
+    if (cnwn_ncs_init_from_buffer(ncs, buffer, size) < 0) {
+        free(buffer);
+        return -1;
+    }
+    ncs->buffer = buffer;
+    return 0;
+}
+
+int cnwn_ncs_init_from_path(cnwn_Ncs * ncs, const char * path)
+{
+    cnwn_FileMap map;
+    if (cnwn_file_map_path(path, &map) < 0) {
+        memset(ncs, 0, sizeof(cnwn_Ncs));
+        return -1;
+    }
+    if (cnwn_ncs_init_from_buffer(ncs, map.data, map.size) < 0) {
+        cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+        cnwn_file_unmap(&map);
+        return -1;
+    }
+    ncs->map = map;
+    return 0;
+}
+
+void cnwn_ncs_deinit(cnwn_Ncs * ncs)
+{
+    cnwn_file_unmap(&ncs->map);
+    if (ncs->buffer != NULL)
+        free(ncs->buffer);
+    if (ncs->instructions != NULL)
+        free(ncs->instructions);
+    if (ncs->jump_targets != NULL)
+        free(ncs->jump_targets);
+    if (ncs->subroutines != NULL)
+        free(ncs->subroutines);
+    memset(ncs, 0, sizeof(cnwn_Ncs));
+}
+
+int cnwn_ncs_find_instruction(const cnwn_Ncs * ncs, uint32_t offset)
+{
+    int low = 0;
+    int high = ncs->num_instructions - 1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        uint32_t mid_offset = ncs->instructions[mid].offset;
+        if (mid_offset == offset)
+            return mid;
+        if (mid_offset < offset)
+            low = mid + 1;
+        else
+            high = mid - 1;
+    }
+    return -1;
+}
+
+int cnwn_ncs_find_subroutine(const cnwn_Ncs * ncs, int index)
+{
+    if (index < 0 || index >= ncs->num_instructions || ncs->num_subroutines <= 0)
+        return -1;
+    int low = 0;
+    int high = ncs->num_subroutines - 1;
+    while (low < high) {
+        int mid = high - (high - low) / 2;
+        if (ncs->subroutines[mid] <= index)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+    return low;
+}
+
+int32_t cnwn_ncs_operand32(const cnwn_Ncs * ncs, const cnwn_NcsInstruction * instruction, int offset)
+{
+    return (int32_t)cnwn_ncs_read_u32(ncs->data + instruction->offset + 2 + offset);
+}
+
+int16_t cnwn_ncs_operand16(const cnwn_Ncs * ncs, const cnwn_NcsInstruction * instruction, int offset)
+{
+    return (int16_t)cnwn_ncs_read_u16(ncs->data + instruction->offset + 2 + offset);
+}
+
+int cnwn_ncs_instruction_to_string(const cnwn_Ncs * ncs, int index, char * r, int max_size)
+{
+    if (index < 0 || index >= ncs->num_instructions)
+        return cnwn_strcpy(r, max_size, "", 0);
+    const cnwn_NcsInstruction * ins = ncs->instructions + index;
+    char tmps[256];
+    int len = snprintf(tmps, sizeof(tmps), "%08x %-14s %02x", ins->offset, cnwn_ncs_opcode_name(ins->opcode), ins->type);
+    switch (ins->opcode) {
+        case CNWN_NCS_OPCODE_CPDOWNSP:
+        case CNWN_NCS_OPCODE_CPTOPSP:
+        case CNWN_NCS_OPCODE_CPDOWNBP:
+        case CNWN_NCS_OPCODE_CPTOPBP:
+            snprintf(tmps + len, sizeof(tmps) - len, " %d, %d", cnwn_ncs_operand32(ncs, ins, 0), cnwn_ncs_operand16(ncs, ins, 4));
+            break;
+        case CNWN_NCS_OPCODE_DESTRUCT:
+            snprintf(tmps + len, sizeof(tmps) - len, " %d, %d, %d", cnwn_ncs_operand16(ncs, ins, 0), cnwn_ncs_operand16(ncs, ins, 2), cnwn_ncs_operand16(ncs, ins, 4));
+            break;
+        case CNWN_NCS_OPCODE_CONST:
+            if (ins->type == CNWN_NCS_TYPE_STRING)
+                snprintf(tmps + len, sizeof(tmps) - len, " \"%.*s\"", CNWN_MIN(ins->length - 4, 200), (const char *)ncs->data + ins->offset + 4);
+            else if (ins->type == CNWN_NCS_TYPE_FLOAT) {
+                int32_t i = cnwn_ncs_operand32(ncs, ins, 0);
+                float f;
+                memcpy(&f, &i, sizeof(f));
+                snprintf(tmps + len, sizeof(tmps) - len, " %g", f);
+            } else
+                snprintf(tmps + len, sizeof(tmps) - len, " %d", cnwn_ncs_operand32(ncs, ins, 0));
+            break;
+        case CNWN_NCS_OPCODE_ACTION:
+            snprintf(tmps + len, sizeof(tmps) - len, " %d, %d", (uint16_t)cnwn_ncs_operand16(ncs, ins, 0), ncs->data[ins->offset + 4]);
+            break;
+        case CNWN_NCS_OPCODE_EQUAL:
+        case CNWN_NCS_OPCODE_NEQUAL:
+            if (ins->type == CNWN_NCS_TYPE_STRUCT_STRUCT)
+                snprintf(tmps + len, sizeof(tmps) - len, " %d", cnwn_ncs_operand16(ncs, ins, 0));
+            break;
+        case CNWN_NCS_OPCODE_JMP:
+        case CNWN_NCS_OPCODE_JSR:
+        case CNWN_NCS_OPCODE_JZ:
+        case CNWN_NCS_OPCODE_JNZ:
+            snprintf(tmps + len, sizeof(tmps) - len, " %08x", ncs->instructions[ncs->jump_targets[index]].offset);
+            break;
+        case CNWN_NCS_OPCODE_MOVSP:
+        case CNWN_NCS_OPCODE_DECSP:
+        case CNWN_NCS_OPCODE_INCSP:
+        case CNWN_NCS_OPCODE_DECBP:
+        case CNWN_NCS_OPCODE_INCBP:
+            snprintf(tmps + len, sizeof(tmps) - len, " %d", cnwn_ncs_operand32(ncs, ins, 0));
+            break;
+        case CNWN_NCS_OPCODE_STORE_STATE:
+            snprintf(tmps + len, sizeof(tmps) - len, " %d, %d", cnwn_ncs_operand32(ncs, ins, 0), cnwn_ncs_operand32(ncs, ins, 4));
+            break;
+        default:
+            break;
+    }
+    return cnwn_strcpy(r, max_size, tmps, -1);
+}
@@ -0,0 +1,1147 @@
+#include "cnwn/ncs_vm.h"
+
+#define CNWN_NCS_VM_HANDLERS(X) \
+    X(INVALID) X(END) X(NOP) \
+    X(CPDOWNSP) X(CPTOPSP) X(CPDOWNBP) X(CPTOPBP) X(RSADD) \
+    X(CONST_I) X(CONST_F) X(CONST_S) X(CONST_O) X(ACTION) \
+    X(LOGAND) X(LOGOR) X(INCOR) X(EXCOR) X(BOOLAND) \
+    X(EQUAL_BITS) X(EQUAL_FF) X(EQUAL_SS) X(EQUAL_TT) \
+    X(NEQUAL_BITS) X(NEQUAL_FF) X(NEQUAL_SS) X(NEQUAL_TT) \
+    X(GEQ_II) X(GEQ_FF) X(GT_II) X(GT_FF) X(LT_II) X(LT_FF) X(LEQ_II) X(LEQ_FF) \
+    X(SHLEFT) X(SHRIGHT) X(USHRIGHT) \
+    X(ADD_II) X(ADD_IF) X(ADD_FI) X(ADD_FF) X(ADD_SS) X(ADD_VV) \
+    X(SUB_II) X(SUB_IF) X(SUB_FI) X(SUB_FF) X(SUB_VV) \
+    X(MUL_II) X(MUL_IF) X(MUL_FI) X(MUL_FF) X(MUL_VF) X(MUL_FV) \
+    X(DIV_II) X(DIV_IF) X(DIV_FI) X(DIV_FF) X(DIV_VF) \
+    X(MOD_II) X(NEG_I) X(NEG_F) X(COMP) X(NOT) \
+    X(MOVSP) X(JMP) X(JSR) X(JZ) X(JNZ) X(RETN) X(DESTRUCT) \
+    X(DECSP) X(INCSP) X(DECBP) X(INCBP) X(SAVEBP) X(RESTOREBP)
+
+#define CNWN_NCS_VM_HANDLER_ENUM(name_) CNWN_NCS_VM_H_##name_,
+
+enum {
+    CNWN_NCS_VM_HANDLERS(CNWN_NCS_VM_HANDLER_ENUM)
+    CNWN_NCS_VM_NUM_HANDLERS
+};
+
+static const char * CNWN_NCS_VM_STATUS_NAMES[] = {"ok", "instruction limit", "stack limit", "call limit", "string limit", "error"};
+
+static uint8_t cnwn_ncs_actions_type(const char * s, int len, const char * const * engine_names, int * ret_cells)
+{
+    static const char * names[] = {"int", "float", "string", "object"};
+    static const uint8_t types[] = {CNWN_NCS_TYPE_INT, CNWN_NCS_TYPE_FLOAT, CNWN_NCS_TYPE_STRING, CNWN_NCS_TYPE_OBJECT};
+    *ret_cells = 1;
+    for (int i = 0; i < 4; i++)
+        if (cnwn_strlen(names[i]) == len && memcmp(s, names[i], len) == 0)
+            return types[i];
+    if (len == 6 && memcmp(s, "vector", 6) == 0) {
+        *ret_cells = 3;
+        return CNWN_NCS_TYPE_FLOAT;
+    }
+    *ret_cells = 0;
+    if ((len == 4 && memcmp(s, "void", 4) == 0) || (len == 6 && memcmp(s, "action", 6) == 0))
+        return CNWN_NCS_TYPE_NONE;
+    for (int i = 0; i < CNWN_NCS_TYPE_ENGINE_9 - CNWN_NCS_TYPE_ENGINE_0 + 1; i++)
+        if (engine_names[i] != NULL && cnwn_strlen(engine_names[i]) == len && memcmp(s, engine_names[i], len) == 0) {
+            *ret_cells = 1;
+            return CNWN_NCS_TYPE_ENGINE_0 + i;
+        }
+    *ret_cells = -1;
+    return CNWN_NCS_TYPE_NONE;
+}
+
+static bool cnwn_ncs_actions_isident(char c)
+{
+    return (c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'));
+}
+
+static int cnwn_ncs_actions_parse_prototype(cnwn_NcsActions * actions, const char * s, int len, const char * const * engine_names, int * capacity)
+{
+    int paren = 0;
+    while (paren < len && s[paren] != '(' && s[paren] != '=')
+        paren++;
+    if (paren >= len || s[paren] != '(')
+        return 0;
+    int i = 0;
+    while (i < paren && cnwn_ncs_actions_isident(s[i]))
+        i++;
+    int return_cells;
+    uint8_t return_type = cnwn_ncs_actions_type(s, i, engine_names, &return_cells);
+    if (return_cells < 0) {
+        cnwn_set_error("unknown action return type (%.*s)", i, s);
+        return -1;
+    }
+    int name_end = paren;
+    while (name_end > i && !cnwn_ncs_actions_isident(s[name_end - 1]))
+        name_end--;
+    int name_start = name_end;
+    while (name_start > i && cnwn_ncs_actions_isident(s[name_start - 1]))
+        name_start--;
+    if (name_start == name_end) {
+        cnwn_set_error("missing action name (%.*s)", CNWN_MIN(len, 64), s);
+        return -1;
+    }
+    if (actions->num_actions >= *capacity) {
+        *capacity = CNWN_MAX(256, *capacity * 2);
+        actions->actions = realloc(actions->actions, sizeof(cnwn_NcsAction) * *capacity);
+    }
+    cnwn_NcsAction * action = actions->actions + actions->num_actions++;
+    memset(action, 0, sizeof(cnwn_NcsAction));
+    action->name = cnwn_strndup(s + name_start, name_end - name_start);
+    action->return_type = return_type;
+    action->return_cells = return_cells;
+    action->argument_cells = malloc(CNWN_MAX(1, len / 2));
+    int depth = 0;
+    bool quoted = false;
+    bool first = true;
+    for (i = paren + 1; i < len; i++) {
+        char c = s[i];
+        if (quoted) {
+            if (c == '\\')
+                i++;
+            else if (c == '"')
+                quoted = false;
+            continue;
+        }
+        if (c == '"')
+            quoted = true;
+        else if (c == '(' || c == '[')
+            depth++;
+        else if ((c == ')' || c == ']') && depth > 0)
+            depth--;
+        else if (c == ',' && depth == 0)
+            first = true;
+        else if (cnwn_ncs_actions_isident(c) && first && depth == 0) {
+            int type_start = i;
+            while (i < len && cnwn_ncs_actions_isident(s[i]))
+                i++;
+            int cells;
+            cnwn_ncs_actions_type(s + type_start, i - type_start, engine_names, &cells);
+            if (cells < 0) {
+                cnwn_set_error("unknown argument type (%.*s) for action %s", i - type_start, s + type_start, action->name);
+                return -1;
+            }
+            action->argument_cells[action->num_arguments++] = (uint8_t)cells;
+            first = false;
+            i--;
+        }
+    }
+    return 0;
+}
+
+int cnwn_ncs_actions_init_from_buffer(cnwn_NcsActions * actions, const char * data, int64_t size)
+{
+    static const char * default_engine_names[] = {"effect", "event", "location", "talent", "itemproperty", "sqlquery", "cassowary", "json", NULL, NULL};
+    const char * engine_names[CNWN_NCS_TYPE_ENGINE_9 - CNWN_NCS_TYPE_ENGINE_0 + 1];
+    char engine_buffer[CNWN_NCS_TYPE_ENGINE_9 - CNWN_NCS_TYPE_ENGINE_0 + 1][64];
+    memcpy(engine_names, default_engine_names, sizeof(engine_names));
+    memset(actions, 0, sizeof(cnwn_NcsActions));
+    int capacity = 0;
+    char * statement = malloc(CNWN_MAX(1, size));
+    int statement_length = 0;
+    int64_t i = 0;
+    while (i < size) {
+        char c = data[i];
+        if (c == '/' && i + 1 < size && data[i + 1] == '/') {
+            while (i < size && data[i] != '\n')
+                i++;
+        } else if (c == '/' && i + 1 < size && data[i + 1] == '*') {
+            i += 2;
+            while (i + 1 < size && !(data[i] == '*' && data[i + 1] == '/'))
+                i++;
+            i += 2;
+        } else if (c == '#' && statement_length == 0) {
+            int64_t start = i;
+            while (i < size && data[i] != '\n' && data[i] != '\r')
+                i++;
+            char line[128];
+            cnwn_strcpy(line, sizeof(line), data + start, (int)CNWN_MIN(i - start, 127));
+            int index;
+            char name[64];
+            if (sscanf(line, "#define ENGINE_STRUCTURE_%d %63s", &index, name) == 2 && index >= 0 && index <= CNWN_NCS_TYPE_ENGINE_9 - CNWN_NCS_TYPE_ENGINE_0) {
+                cnwn_strcpy(engine_buffer[index], sizeof(engine_buffer[index]), name, -1);
+                engine_names[index] = engine_buffer[index];
+            }
+        } else if (c == '"') {
+            statement[statement_length++] = c;
+            i++;
+            while (i < size && data[i] != '"') {
+                if (data[i] == '\\' && i + 1 < size)
+                    statement[statement_length++] = data[i++];
+                statement[statement_length++] = data[i++];
+            }
+            if (i < size)
+                statement[statement_length++] = data[i++];
+        } else if (c == ';') {
+            if (cnwn_ncs_actions_parse_prototype(actions, statement, statement_length, engine_names, &capacity) < 0) {
+                free(statement);
+                cnwn_ncs_actions_deinit(actions);
+                return -1;
+            }
+            statement_length = 0;
+            i++;
+        } else {
+            if (statement_length > 0 || (c != ' ' && c != '\t' && c != '\r' && c != '\n'))
+                statement[statement_length++] = c;
+            i++;
+        }
+    }
+    free(statement);
+    return 0;
+}
+
+int cnwn_ncs_actions_init_from_path(cnwn_NcsActions * actions, const char * path)
+{
+    cnwn_FileMap map;
+    if (cnwn_file_map_path(path, &map) < 0) {
+        memset(actions, 0, sizeof(cnwn_NcsActions));
+        return -1;
+    }
+    int ret = cnwn_ncs_actions_init_from_buffer(actions, (const char *)map.data, map.size);
+    if (ret < 0)
+        cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+    cnwn_file_unmap(&map);
+    return ret;
+}
+
+void cnwn_ncs_actions_deinit(cnwn_NcsActions * actions)
+{
+    if (actions->actions != NULL) {
+        for (int i = 0; i < actions->num_actions; i++) {
+            free(actions->actions[i].name);
+            free(actions->actions[i].argument_cells);
+        }
+        free(actions->actions);
+    }
+    memset(actions, 0, sizeof(cnwn_NcsActions));
+}
+
+static cnwn_NcsString * cnwn_ncs_vm_alloc_string(const char * s, int length)
+{
+    cnwn_NcsString * ret = malloc(sizeof(cnwn_NcsString) + length + 1);
+    ret->length = length;
+    if (s != NULL && length > 0)
+        memcpy(ret->data, s, length);
+    ret->data[length] = 0;
+    return ret;
+}
+
+static int cnwn_ncs_vm_cells(const cnwn_NcsInstruction * ins, int32_t bytes, int32_t * ret_cells)
+{
+    if (bytes % 4 != 0) {
+        cnwn_set_error("unaligned stack operand %d at %08x", bytes, ins->offset);
+        return -1;
+    }
+    *ret_cells = bytes / 4;
+    return 0;
+}
+
+static int cnwn_ncs_vm_prepare(cnwn_NcsVm * vm, int index, cnwn_NcsVmOp * op)
+{
+    const cnwn_Ncs * ncs = vm->ncs;
+    const cnwn_NcsInstruction * ins = ncs->instructions + index;
+    int type = ins->type;
+    int h = CNWN_NCS_VM_H_INVALID;
+    memset(op, 0, sizeof(cnwn_NcsVmOp));
+    switch (ins->opcode) {
+        case CNWN_NCS_OPCODE_CPDOWNSP:
+        case CNWN_NCS_OPCODE_CPTOPSP:
+        case CNWN_NCS_OPCODE_CPDOWNBP:
+        case CNWN_NCS_OPCODE_CPTOPBP:
+            if (cnwn_ncs_vm_cells(ins, cnwn_ncs_operand32(ncs, ins, 0), &op->a) < 0 || cnwn_ncs_vm_cells(ins, cnwn_ncs_operand16(ncs, ins, 4), &op->b) < 0)
+                return -1;
+            if (op->b < 0)
+                break;
+            if (ins->opcode == CNWN_NCS_OPCODE_CPDOWNSP)
+                h = CNWN_NCS_VM_H_CPDOWNSP;
+            else if (ins->opcode == CNWN_NCS_OPCODE_CPTOPSP)
+                h = CNWN_NCS_VM_H_CPTOPSP;
+            else if (ins->opcode == CNWN_NCS_OPCODE_CPDOWNBP)
+                h = CNWN_NCS_VM_H_CPDOWNBP;
+            else
+                h = CNWN_NCS_VM_H_CPTOPBP;
+            break;
+        case CNWN_NCS_OPCODE_RSADD:
+            if (type == CNWN_NCS_TYPE_INT || type == CNWN_NCS_TYPE_FLOAT || type == CNWN_NCS_TYPE_STRING || type == CNWN_NCS_TYPE_OBJECT
+                    || (type >= CNWN_NCS_TYPE_ENGINE_0 && type <= CNWN_NCS_TYPE_ENGINE_9)) {
+                h = CNWN_NCS_VM_H_RSADD;
+                op->a = type;
+            }
+            break;
+        case CNWN_NCS_OPCODE_CONST:
+            op->a = cnwn_ncs_operand32(ncs, ins, 0);
+            if (type == CNWN_NCS_TYPE_INT)
+                h = CNWN_NCS_VM_H_CONST_I;
+            else if (type == CNWN_NCS_TYPE_FLOAT)
+                h = CNWN_NCS_VM_H_CONST_F;
+            else if (type == CNWN_NCS_TYPE_OBJECT)
+                h = CNWN_NCS_VM_H_CONST_O;
+            else if (type == CNWN_NCS_TYPE_STRING) {
+                h = CNWN_NCS_VM_H_CONST_S;
+                op->a = vm->num_constants;
+                vm->constants[vm->num_constants++] = cnwn_ncs_vm_alloc_string((const char *)ncs->data + ins->offset + 4, ins->length - 4);
+            }
+            break;
+        case CNWN_NCS_OPCODE_ACTION:
+            h = CNWN_NCS_VM_H_ACTION;
+            op->a = (uint16_t)cnwn_ncs_operand16(ncs, ins, 0);
+            op->b = ncs->data[ins->offset + 4];
+            break;
+        case CNWN_NCS_OPCODE_LOGAND:
+        case CNWN_NCS_OPCODE_LOGOR:
+        case CNWN_NCS_OPCODE_INCOR:
+        case CNWN_NCS_OPCODE_EXCOR:
+        case CNWN_NCS_OPCODE_BOOLAND:
+        case CNWN_NCS_OPCODE_SHLEFT:
+        case CNWN_NCS_OPCODE_SHRIGHT:
+        case CNWN_NCS_OPCODE_USHRIGHT:
+        case CNWN_NCS_OPCODE_MOD:
+            if (type != CNWN_NCS_TYPE_INT_INT)
+                break;
+            switch (ins->opcode) {
+                case CNWN_NCS_OPCODE_LOGAND: h = CNWN_NCS_VM_H_LOGAND; break;
+                case CNWN_NCS_OPCODE_LOGOR: h = CNWN_NCS_VM_H_LOGOR; break;
+                case CNWN_NCS_OPCODE_INCOR: h = CNWN_NCS_VM_H_INCOR; break;
+                case CNWN_NCS_OPCODE_EXCOR: h = CNWN_NCS_VM_H_EXCOR; break;
+                case CNWN_NCS_OPCODE_BOOLAND: h = CNWN_NCS_VM_H_BOOLAND; break;
+                case CNWN_NCS_OPCODE_SHLEFT: h = CNWN_NCS_VM_H_SHLEFT; break;
+                case CNWN_NCS_OPCODE_SHRIGHT: h = CNWN_NCS_VM_H_SHRIGHT; break;
+                case CNWN_NCS_OPCODE_USHRIGHT: h = CNWN_NCS_VM_H_USHRIGHT; break;
+                default: h = CNWN_NCS_VM_H_MOD_II; break;
+            }
+            break;
+        case CNWN_NCS_OPCODE_EQUAL:
+        case CNWN_NCS_OPCODE_NEQUAL: {
+            bool equal = (ins->opcode == CNWN_NCS_OPCODE_EQUAL);
+            if (type == CNWN_NCS_TYPE_INT_INT || type == CNWN_NCS_TYPE_OBJECT_OBJECT || (type >= CNWN_NCS_TYPE_ENGINE_ENGINE_0 && type <= CNWN_NCS_TYPE_ENGINE_ENGINE_9))
+                h = (equal ? CNWN_NCS_VM_H_EQUAL_BITS : CNWN_NCS_VM_H_NEQUAL_BITS);
+            else if (type == CNWN_NCS_TYPE_FLOAT_FLOAT)
+                h = (equal ? CNWN_NCS_VM_H_EQUAL_FF : CNWN_NCS_VM_H_NEQUAL_FF);
+            else if (type == CNWN_NCS_TYPE_STRING_STRING)
+                h = (equal ? CNWN_NCS_VM_H_EQUAL_SS : CNWN_NCS_VM_H_NEQUAL_SS);
+            else if (type == CNWN_NCS_TYPE_STRUCT_STRUCT) {
+                if (cnwn_ncs_vm_cells(ins, cnwn_ncs_operand16(ncs, ins, 0), &op->a) < 0)
+                    return -1;
+                if (op->a >= 0)
+                    h = (equal ? CNWN_NCS_VM_H_EQUAL_TT : CNWN_NCS_VM_H_NEQUAL_TT);
+            }
+            break;
+        }
+        case CNWN_NCS_OPCODE_GEQ:
+        case CNWN_NCS_OPCODE_GT:
+        case CNWN_NCS_OPCODE_LT:
+        case CNWN_NCS_OPCODE_LEQ: {
+            int offset = (type == CNWN_NCS_TYPE_INT_INT ? 0 : (type == CNWN_NCS_TYPE_FLOAT_FLOAT ? 1 : -1));
+            if (offset < 0)
+                break;
+            if (ins->opcode == CNWN_NCS_OPCODE_GEQ)
+                h = CNWN_NCS_VM_H_GEQ_II + offset;
+            else if (ins->opcode == CNWN_NCS_OPCODE_GT)
+                h = CNWN_NCS_VM_H_GT_II + offset;
+            else if (ins->opcode == CNWN_NCS_OPCODE_LT)
+                h = CNWN_NCS_VM_H_LT_II + offset;
+            else
+                h = CNWN_NCS_VM_H_LEQ_II + offset;
+            break;
+        }
+        case CNWN_NCS_OPCODE_ADD:
+        case CNWN_NCS_OPCODE_SUB:
+        case CNWN_NCS_OPCODE_MUL:
+        case CNWN_NCS_OPCODE_DIV: {
+            static const int add[] = {CNWN_NCS_VM_H_ADD_II, CNWN_NCS_VM_H_ADD_IF, CNWN_NCS_VM_H_ADD_FI, CNWN_NCS_VM_H_ADD_FF, CNWN_NCS_VM_H_ADD_SS, CNWN_NCS_VM_H_ADD_VV, CNWN_NCS_VM_H_INVALID, CNWN_NCS_VM_H_INVALID};
+            static const int sub[] = {CNWN_NCS_VM_H_SUB_II, CNWN_NCS_VM_H_SUB_IF, CNWN_NCS_VM_H_SUB_FI, CNWN_NCS_VM_H_SUB_FF, CNWN_NCS_VM_H_INVALID, CNWN_NCS_VM_H_SUB_VV, CNWN_NCS_VM_H_INVALID, CNWN_NCS_VM_H_INVALID};
+            static const int mul[] = {CNWN_NCS_VM_H_MUL_II, CNWN_NCS_VM_H_MUL_IF, CNWN_NCS_VM_H_MUL_FI, CNWN_NCS_VM_H_MUL_FF, CNWN_NCS_VM_H_INVALID, CNWN_NCS_VM_H_INVALID, CNWN_NCS_VM_H_MUL_VF, CNWN_NCS_VM_H_MUL_FV};
+            static const int div[] = {CNWN_NCS_VM_H_DIV_II, CNWN_NCS_VM_H_DIV_IF, CNWN_NCS_VM_H_DIV_FI, CNWN_NCS_VM_H_DIV_FF, CNWN_NCS_VM_H_INVALID, CNWN_NCS_VM_H_INVALID, CNWN_NCS_VM_H_DIV_VF, CNWN_NCS_VM_H_INVALID};
+            int variant;
+            switch (type) {
+                case CNWN_NCS_TYPE_INT_INT: variant = 0; break;
+                case CNWN_NCS_TYPE_INT_FLOAT: variant = 1; break;
+                case CNWN_NCS_TYPE_FLOAT_INT: variant = 2; break;
+                case CNWN_NCS_TYPE_FLOAT_FLOAT: variant = 3; break;
+                case CNWN_NCS_TYPE_STRING_STRING: variant = 4; break;
+                case CNWN_NCS_TYPE_VECTOR_VECTOR: variant = 5; break;
+                case CNWN_NCS_TYPE_VECTOR_FLOAT: variant = 6; break;
+                case CNWN_NCS_TYPE_FLOAT_VECTOR: variant = 7; break;
+                default: variant = -1; break;
+            }
+            if (variant < 0)
+                break;
+            if (ins->opcode == CNWN_NCS_OPCODE_ADD)
+                h = add[variant];
+            else if (ins->opcode == CNWN_NCS_OPCODE_SUB)
+                h = sub[variant];
+            else if (ins->opcode == CNWN_NCS_OPCODE_MUL)
+                h = mul[variant];
+            else
+                h = div[variant];
+            break;
+        }
+        case CNWN_NCS_OPCODE_NEG:
+            if (type == CNWN_NCS_TYPE_INT)
+                h = CNWN_NCS_VM_H_NEG_I;
+            else if (type == CNWN_NCS_TYPE_FLOAT)
+                h = CNWN_NCS_VM_H_NEG_F;
+            break;
+        case CNWN_NCS_OPCODE_COMP:
+            if (type == CNWN_NCS_TYPE_INT)
+                h = CNWN_NCS_VM_H_COMP;
+            break;
+        case CNWN_NCS_OPCODE_NOT:
+            if (type == CNWN_NCS_TYPE_INT)
+                h = CNWN_NCS_VM_H_NOT;
+            break;
+        case CNWN_NCS_OPCODE_MOVSP:
+            if (cnwn_ncs_vm_cells(ins, cnwn_ncs_operand32(ncs, ins, 0), &op->a) < 0)
+                return -1;
+            h = CNWN_NCS_VM_H_MOVSP;
+            break;
+        case CNWN_NCS_OPCODE_JMP:
+        case CNWN_NCS_OPCODE_JSR:
+        case CNWN_NCS_OPCODE_JZ:
+        case CNWN_NCS_OPCODE_JNZ:
+            op->a = ncs->jump_targets[index];
+            if (ins->opcode == CNWN_NCS_OPCODE_JMP)
+                h = CNWN_NCS_VM_H_JMP;
+            else if (ins->opcode == CNWN_NCS_OPCODE_JSR)
+                h = CNWN_NCS_VM_H_JSR;
+            else if (ins->opcode == CNWN_NCS_OPCODE_JZ)
+                h = CNWN_NCS_VM_H_JZ;
+            else
+                h = CNWN_NCS_VM_H_JNZ;
+            break;
+        case CNWN_NCS_OPCODE_RETN:
+            h = CNWN_NCS_VM_H_RETN;
+            break;
+        case CNWN_NCS_OPCODE_DESTRUCT:
+            if (cnwn_ncs_vm_cells(ins, cnwn_ncs_operand16(ncs, ins, 0), &op->a) < 0
+                    || cnwn_ncs_vm_cells(ins, cnwn_ncs_operand16(ncs, ins, 2), &op->b) < 0
+                    || cnwn_ncs_vm_cells(ins, cnwn_ncs_operand16(ncs, ins, 4), &op->c) < 0)
+                return -1;
+            if (op->a >= 0 && op->b >= 0 && op->c >= 0 && op->b + op->c <= op->a)
+                h = CNWN_NCS_VM_H_DESTRUCT;
+            break;
+        case CNWN_NCS_OPCODE_DECSP:
+        case CNWN_NCS_OPCODE_INCSP:
+        case CNWN_NCS_OPCODE_DECBP:
+        case CNWN_NCS_OPCODE_INCBP:
+            if (cnwn_ncs_vm_cells(ins, cnwn_ncs_operand32(ncs, ins, 0), &op->a) < 0)
+                return -1;
+            if (ins->opcode == CNWN_NCS_OPCODE_DECSP)
+                h = CNWN_NCS_VM_H_DECSP;
+            else if (ins->opcode == CNWN_NCS_OPCODE_INCSP)
+                h = CNWN_NCS_VM_H_INCSP;
+            else if (ins->opcode == CNWN_NCS_OPCODE_DECBP)
+                h = CNWN_NCS_VM_H_DECBP;
+            else
+                h = CNWN_NCS_VM_H_INCBP;
+            break;
+        case CNWN_NCS_OPCODE_SAVEBP:
+            h = CNWN_NCS_VM_H_SAVEBP;
+            break;
+        case CNWN_NCS_OPCODE_RESTOREBP:
+            h = CNWN_NCS_VM_H_RESTOREBP;
+            break;
+        case CNWN_NCS_OPCODE_STORE_STATE:
+        case CNWN_NCS_OPCODE_STORE_STATEALL:
+        case CNWN_NCS_OPCODE_NOP:
+            h = CNWN_NCS_VM_H_NOP;
+            break;
+        default:
+            break;
+    }
+    if (h == CNWN_NCS_VM_H_INVALID) {
+        cnwn_set_error("unsupported NCS instruction %s %02x at %08x", cnwn_ncs_opcode_name(ins->opcode), ins->type, ins->offset);
+        return -1;
+    }
+    op->handler = h;
+    return 0;
+}
+
+int cnwn_ncs_vm_init(cnwn_NcsVm * vm, const cnwn_Ncs * ncs, const cnwn_NcsActions * actions, cnwn_NcsActionFunction action_function, void * action_data)
+{
+    memset(vm, 0, sizeof(cnwn_NcsVm));
+    vm->ncs = ncs;
+    vm->actions = actions;
+    vm->action_function = (action_function != NULL ? action_function : cnwn_ncs_vm_stub_action);
+    vm->action_data = action_data;
+    vm->max_stack = CNWN_NCS_VM_DEFAULT_MAX_STACK;
+    vm->max_calls = CNWN_NCS_VM_DEFAULT_MAX_CALLS;
+    vm->max_instructions = CNWN_NCS_VM_DEFAULT_MAX_INSTRUCTIONS;
+    vm->max_string_bytes = CNWN_NCS_VM_DEFAULT_MAX_STRING_BYTES;
+    vm->ops = malloc(sizeof(cnwn_NcsVmOp) * (ncs->num_instructions + 1));
+    vm->constants = malloc(sizeof(cnwn_NcsString *) * (ncs->num_instructions + 1));
+    vm->constants[vm->num_constants++] = cnwn_ncs_vm_alloc_string("", 0);
+    for (int i = 0; i < ncs->num_instructions; i++) {
+        if (cnwn_ncs_vm_prepare(vm, i, vm->ops + i) < 0) {
+            cnwn_ncs_vm_deinit(vm);
+            return -1;
+        }
+    }
+    memset(vm->ops + ncs->num_instructions, 0, sizeof(cnwn_NcsVmOp));
+    vm->ops[ncs->num_instructions].handler = CNWN_NCS_VM_H_END;
+    return 0;
+}
+
+static void cnwn_ncs_vm_free_strings(cnwn_NcsVm * vm)
+{
+    for (int i = 0; i < vm->num_strings; i++)
+        free(vm->strings[i]);
+    vm->num_strings = 0;
+    vm->string_bytes = 0;
+}
+
+void cnwn_ncs_vm_deinit(cnwn_NcsVm * vm)
+{
+    cnwn_ncs_vm_free_strings(vm);
+    if (vm->strings != NULL)
+        free(vm->strings);
+    if (vm->constants != NULL) {
+        for (int i = 0; i < vm->num_constants; i++)
+            free(vm->constants[i]);
+        free(vm->constants);
+    }
+    if (vm->ops != NULL)
+        free(vm->ops);
+    if (vm->stack != NULL)
+        free(vm->stack);
+    if (vm->calls != NULL)
+        free(vm->calls);
+    memset(vm, 0, sizeof(cnwn_NcsVm));
+}
+
+static cnwn_NcsString * cnwn_ncs_vm_track_string(cnwn_NcsVm * vm, const char * s, int length)
+{
+    if (vm->string_bytes + length + 1 > vm->max_string_bytes) {
+        cnwn_set_error("string memory limit reached (%"PRId64" bytes)", vm->max_string_bytes);
+        vm->status = CNWN_NCS_VM_STATUS_STRING_LIMIT;
+        return NULL;
+    }
+    if (vm->num_strings >= vm->strings_capacity) {
+        vm->strings_capacity = CNWN_MAX(64, vm->strings_capacity * 2);
+        vm->strings = realloc(vm->strings, sizeof(cnwn_NcsString *) * vm->strings_capacity);
+    }
+    cnwn_NcsString * ret = cnwn_ncs_vm_alloc_string(s, length);
+    vm->strings[vm->num_strings++] = ret;
+    vm->string_bytes += length + 1;
+    return ret;
+}
+
+const cnwn_NcsString * cnwn_ncs_vm_new_string(cnwn_NcsVm * vm, const char * s, int length)
+{
+    if (length < 0)
+        length = cnwn_strlen(s);
+    if (length == 0)
+        return vm->constants[0];
+    return cnwn_ncs_vm_track_string(vm, s, length);
+}
+
+static const cnwn_NcsString * cnwn_ncs_vm_concat(cnwn_NcsVm * vm, const cnwn_NcsString * a, const cnwn_NcsString * b)
+{
+    if (a->length == 0)
+        return b;
+    if (b->length == 0)
+        return a;
+    cnwn_NcsString * ret = cnwn_ncs_vm_track_string(vm, NULL, a->length + b->length);
+    if (ret != NULL) {
+        memcpy(ret->data, a->data, a->length);
+        memcpy(ret->data + a->length, b->data, b->length);
+    }
+    return ret;
+}
+
+int cnwn_ncs_vm_push(cnwn_NcsVm * vm, int num_values, const cnwn_NcsValue * values)
+{
+    if (num_values < 0 || vm->sp + num_values > vm->max_stack) {
+        cnwn_set_error("stack limit reached (%d cells)", vm->max_stack);
+        vm->status = CNWN_NCS_VM_STATUS_STACK_LIMIT;
+        return -1;
+    }
+    memcpy(vm->stack + vm->sp, values, sizeof(cnwn_NcsValue) * num_values);
+    vm->sp += num_values;
+    return 0;
+}
+
+int cnwn_ncs_vm_pop(cnwn_NcsVm * vm, int num_values, cnwn_NcsValue * ret_values)
+{
+    if (num_values < 0 || num_values > vm->sp) {
+        cnwn_set_error("stack underflow (%d cells)", num_values);
+        return -1;
+    }
+    vm->sp -= num_values;
+    if (ret_values != NULL)
+        memcpy(ret_values, vm->stack + vm->sp, sizeof(cnwn_NcsValue) * num_values);
+    return 0;
+}
+
+static cnwn_NcsValue cnwn_ncs_vm_default_value(cnwn_NcsVm * vm, uint8_t type)
+{
+    cnwn_NcsValue ret;
+    ret.type = type;
+    ret.v.s = NULL;
+    if (type == CNWN_NCS_TYPE_STRING)
+        ret.v.s = vm->constants[0];
+    else if (type == CNWN_NCS_TYPE_OBJECT)
+        ret.v.o = CNWN_NCS_OBJECT_INVALID;
+    else if (type == CNWN_NCS_TYPE_FLOAT)
+        ret.v.f = 0.0f;
+    else
+        ret.v.i = 0;
+    return ret;
+}
+
+int cnwn_ncs_vm_stub_action(cnwn_NcsVm * vm, int action, int num_arguments, void * user_data)
+{
+    if (vm->actions == NULL)
+        return cnwn_ncs_vm_pop(vm, num_arguments, NULL);
+    if (action < 0 || action >= vm->actions->num_actions) {
+        cnwn_set_error("unknown action %d", action);
+        return -1;
+    }
+    const cnwn_NcsAction * a = vm->actions->actions + action;
+    int cells = 0;
+    for (int i = 0; i < num_arguments && i < a->num_arguments; i++)
+        cells += a->argument_cells[i];
+    if (cnwn_ncs_vm_pop(vm, cells, NULL) < 0) {
+        cnwn_set_error("%s (%s)", cnwn_get_error(), a->name);
+        return -1;
+    }
+    cnwn_NcsValue values[3];
+    for (int i = 0; i < a->return_cells; i++)
+        values[i] = cnwn_ncs_vm_default_value(vm, a->return_type);
+    return cnwn_ncs_vm_push(vm, a->return_cells, values);
+}
+
+static bool cnwn_ncs_vm_equal(const cnwn_NcsValue * a, const cnwn_NcsValue * b)
+{
+    if (a->type != b->type)
+        return false;
+    if (a->type == CNWN_NCS_TYPE_STRING)
+        return (a->v.s->length == b->v.s->length && memcmp(a->v.s->data, b->v.s->data, a->v.s->length) == 0);
+    if (a->type == CNWN_NCS_TYPE_FLOAT)
+        return a->v.f == b->v.f;
+    return a->v.i == b->v.i;
+}
+
+#ifdef CNWN_NCS_VM_COMPUTED_GOTO
+#define CNWN_NCS_VM_HANDLER_LABEL(name_) &&h_##name_,
+#define CNWN_NCS_VM_CASE(name_) h_##name_
+#define CNWN_NCS_VM_DISPATCH() do { if (++count > max_instructions) goto instruction_limit; goto *labels[ops[pc].handler]; } while (0)
+#else
+#define CNWN_NCS_VM_CASE(name_) case CNWN_NCS_VM_H_##name_
+#define CNWN_NCS_VM_DISPATCH() goto dispatch
+#endif
+#define CNWN_NCS_VM_NEXT() do { pc++; CNWN_NCS_VM_DISPATCH(); } while (0)
+#define CNWN_NCS_VM_NEED(n_) do { if (sp - (n_) < 0) goto underflow; } while (0)
+#define CNWN_NCS_VM_ROOM(n_) do { if (sp + (n_) > max_stack) goto stack_limit; } while (0)
+#define CNWN_NCS_VM_INT_BINARY(expr_) do { \
+        CNWN_NCS_VM_NEED(2); \
+        int32_t x = stack[sp - 2].v.i, y = stack[sp - 1].v.i; \
+        sp--; \
+        stack[sp - 1].type = CNWN_NCS_TYPE_INT; \
+        stack[sp - 1].v.i = (int32_t)(expr_); \
+        CNWN_NCS_VM_NEXT(); \
+    } while (0)
+#define CNWN_NCS_VM_FLOAT_BINARY(xtype_, ytype_, expr_) do { \
+        CNWN_NCS_VM_NEED(2); \
+        float x = (float)stack[sp - 2].v.xtype_, y = (float)stack[sp - 1].v.ytype_; \
+        sp--; \
+        stack[sp - 1].type = CNWN_NCS_TYPE_FLOAT; \
+        stack[sp - 1].v.f = (expr_); \
+        CNWN_NCS_VM_NEXT(); \
+    } while (0)
+#define CNWN_NCS_VM_COMPARE(type_, expr_) do { \
+        CNWN_NCS_VM_NEED(2); \
+        type_ x = stack[sp - 2].v.CNWN_NCS_VM_FIELD_##type_, y = stack[sp - 1].v.CNWN_NCS_VM_FIELD_##type_; \
+        sp--; \
+        stack[sp - 1].type = CNWN_NCS_TYPE_INT; \
+        stack[sp - 1].v.i = (expr_); \
+        CNWN_NCS_VM_NEXT(); \
+    } while (0)
+#define CNWN_NCS_VM_FIELD_int32_t i
+#define CNWN_NCS_VM_FIELD_float f
+
+int cnwn_ncs_vm_run(cnwn_NcsVm * vm)
+{
+#ifdef CNWN_NCS_VM_COMPUTED_GOTO
+    static void * labels[CNWN_NCS_VM_NUM_HANDLERS] = {CNWN_NCS_VM_HANDLERS(CNWN_NCS_VM_HANDLER_LABEL)};
+#endif
+    cnwn_ncs_vm_free_strings(vm);
+    if (vm->stack_capacity != vm->max_stack) {
+        vm->stack = realloc(vm->stack, sizeof(cnwn_NcsValue) * CNWN_MAX(1, vm->max_stack));
+        vm->stack_capacity = vm->max_stack;
+    }
+    if (vm->calls_capacity != vm->max_calls) {
+        vm->calls = realloc(vm->calls, sizeof(int32_t) * CNWN_MAX(1, vm->max_calls));
+        vm->calls_capacity = vm->max_calls;
+    }
+    vm->status = CNWN_NCS_VM_STATUS_OK;
+    const cnwn_NcsVmOp * ops = vm->ops;
+    cnwn_NcsValue * stack = vm->stack;
+    const int max_stack = vm->max_stack;
+    const int64_t max_instructions = vm->max_instructions;
+    int32_t * calls = vm->calls;
+    int num_calls = 0;
+    int sp = 0;
+    int bp = 0;
+    int pc = 0;
+    int64_t count = 0;
+    const cnwn_NcsVmOp * op;
+
+#ifdef CNWN_NCS_VM_COMPUTED_GOTO
+    CNWN_NCS_VM_DISPATCH();
+#else
+dispatch:
+    if (++count > max_instructions)
+        goto instruction_limit;
+    switch (ops[pc].handler) {
+#endif
+
+    CNWN_NCS_VM_CASE(NOP):
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(CPDOWNSP):
+        op = ops + pc;
+        if (sp + op->a < 0 || op->a + op->b > 0 || sp < op->b)
+            goto invalid_operand;
+        memmove(stack + sp + op->a, stack + sp - op->b, sizeof(cnwn_NcsValue) * op->b);
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(CPTOPSP):
+        op = ops + pc;
+        if (sp + op->a < 0 || op->a + op->b > 0)
+            goto invalid_operand;
+        CNWN_NCS_VM_ROOM(op->b);
+        memcpy(stack + sp, stack + sp + op->a, sizeof(cnwn_NcsValue) * op->b);
+        sp += op->b;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(CPDOWNBP):
+        op = ops + pc;
+        if (bp + op->a < 0 || bp + op->a + op->b > sp || sp < op->b)
+            goto invalid_operand;
+        memmove(stack + bp + op->a, stack + sp - op->b, sizeof(cnwn_NcsValue) * op->b);
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(CPTOPBP):
+        op = ops + pc;
+        if (bp + op->a < 0 || bp + op->a + op->b > sp)
+            goto invalid_operand;
+        CNWN_NCS_VM_ROOM(op->b);
+        memcpy(stack + sp, stack + bp + op->a, sizeof(cnwn_NcsValue) * op->b);
+        sp += op->b;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(RSADD):
+        CNWN_NCS_VM_ROOM(1);
+        stack[sp++] = cnwn_ncs_vm_default_value(vm, (uint8_t)ops[pc].a);
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(CONST_I):
+        CNWN_NCS_VM_ROOM(1);
+        stack[sp].type = CNWN_NCS_TYPE_INT;
+        stack[sp++].v.i = ops[pc].a;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(CONST_F):
+        CNWN_NCS_VM_ROOM(1);
+        stack[sp].type = CNWN_NCS_TYPE_FLOAT;
+        memcpy(&stack[sp++].v.f, &ops[pc].a, sizeof(float));
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(CONST_S):
+        CNWN_NCS_VM_ROOM(1);
+        stack[sp].type = CNWN_NCS_TYPE_STRING;
+        stack[sp++].v.s = vm->constants[ops[pc].a];
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(CONST_O):
+        CNWN_NCS_VM_ROOM(1);
+        stack[sp].type = CNWN_NCS_TYPE_OBJECT;
+        stack[sp++].v.o = (uint32_t)ops[pc].a;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(ACTION):
+        vm->sp = sp;
+        vm->bp = bp;
+        if (vm->action_function(vm, ops[pc].a, ops[pc].b, vm->action_data) < 0) {
+            if (vm->status == CNWN_NCS_VM_STATUS_OK)
+                vm->status = CNWN_NCS_VM_STATUS_ERROR;
+            goto failed;
+        }
+        sp = vm->sp;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(LOGAND):
+        CNWN_NCS_VM_INT_BINARY(x && y);
+
+    CNWN_NCS_VM_CASE(LOGOR):
+        CNWN_NCS_VM_INT_BINARY(x || y);
+
+    CNWN_NCS_VM_CASE(INCOR):
+        CNWN_NCS_VM_INT_BINARY(x | y);
+
+    CNWN_NCS_VM_CASE(EXCOR):
+        CNWN_NCS_VM_INT_BINARY(x ^ y);
+
+    CNWN_NCS_VM_CASE(BOOLAND):
+        CNWN_NCS_VM_INT_BINARY(x & y);
+
+    CNWN_NCS_VM_CASE(EQUAL_BITS):
+        CNWN_NCS_VM_INT_BINARY(x == y);
+
+    CNWN_NCS_VM_CASE(NEQUAL_BITS):
+        CNWN_NCS_VM_INT_BINARY(x != y);
+
+    CNWN_NCS_VM_CASE(EQUAL_FF):
+        CNWN_NCS_VM_COMPARE(float, x == y);
+
+    CNWN_NCS_VM_CASE(NEQUAL_FF):
+        CNWN_NCS_VM_COMPARE(float, x != y);
+
+    CNWN_NCS_VM_CASE(EQUAL_SS):
+    CNWN_NCS_VM_CASE(NEQUAL_SS): {
+        CNWN_NCS_VM_NEED(2);
+        if (stack[sp - 2].type != CNWN_NCS_TYPE_STRING || stack[sp - 1].type != CNWN_NCS_TYPE_STRING)
+            goto invalid_operand;
+        int32_t equal = cnwn_ncs_vm_equal(stack + sp - 2, stack + sp - 1);
+        sp--;
+        stack[sp - 1].type = CNWN_NCS_TYPE_INT;
+        stack[sp - 1].v.i = (ops[pc].handler == CNWN_NCS_VM_H_EQUAL_SS ? equal : !equal);
+        CNWN_NCS_VM_NEXT();
+    }
+
+    CNWN_NCS_VM_CASE(EQUAL_TT):
+    CNWN_NCS_VM_CASE(NEQUAL_TT): {
+        op = ops + pc;
+        CNWN_NCS_VM_NEED(op->a * 2);
+        int32_t equal = 1;
+        for (int i = 0; i < op->a && equal; i++) {
+            const cnwn_NcsValue * x = stack + sp - op->a * 2 + i;
+            const cnwn_NcsValue * y = stack + sp - op->a + i;
+            if (x->type == CNWN_NCS_TYPE_STRING && (x->type != y->type || x->v.s == NULL || y->v.s == NULL))
+                goto invalid_operand;
+            equal = cnwn_ncs_vm_equal(x, y);
+        }
+        sp -= op->a * 2;
+        CNWN_NCS_VM_ROOM(1);
+        stack[sp].type = CNWN_NCS_TYPE_INT;
+        stack[sp++].v.i = (op->handler == CNWN_NCS_VM_H_EQUAL_TT ? equal : !equal);
+        CNWN_NCS_VM_NEXT();
+    }
+
+    CNWN_NCS_VM_CASE(GEQ_II):
+        CNWN_NCS_VM_COMPARE(int32_t, x >= y);
+
+    CNWN_NCS_VM_CASE(GEQ_FF):
+        CNWN_NCS_VM_COMPARE(float, x >= y);
+
+    CNWN_NCS_VM_CASE(GT_II):
+        CNWN_NCS_VM_COMPARE(int32_t, x > y);
+
+    CNWN_NCS_VM_CASE(GT_FF):
+        CNWN_NCS_VM_COMPARE(float, x > y);
+
+    CNWN_NCS_VM_CASE(LT_II):
+        CNWN_NCS_VM_COMPARE(int32_t, x < y);
+
+    CNWN_NCS_VM_CASE(LT_FF):
+        CNWN_NCS_VM_COMPARE(float, x < y);
+
+    CNWN_NCS_VM_CASE(LEQ_II):
+        CNWN_NCS_VM_COMPARE(int32_t, x <= y);
+
+    CNWN_NCS_VM_CASE(LEQ_FF):
+        CNWN_NCS_VM_COMPARE(float, x <= y);
+
+    CNWN_NCS_VM_CASE(SHLEFT):
+        CNWN_NCS_VM_INT_BINARY((uint32_t)x << (y & 31));
+
+    CNWN_NCS_VM_CASE(SHRIGHT):
+        CNWN_NCS_VM_INT_BINARY(x < 0 ? ~(~(uint32_t)x >> (y & 31)) : (uint32_t)x >> (y & 31));
+
+    CNWN_NCS_VM_CASE(USHRIGHT):
+        CNWN_NCS_VM_INT_BINARY((uint32_t)x >> (y & 31));
+
+    CNWN_NCS_VM_CASE(ADD_II):
+        CNWN_NCS_VM_INT_BINARY((uint32_t)x + (uint32_t)y);
+
+    CNWN_NCS_VM_CASE(ADD_IF):
+        CNWN_NCS_VM_FLOAT_BINARY(i, f, x + y);
+
+    CNWN_NCS_VM_CASE(ADD_FI):
+        CNWN_NCS_VM_FLOAT_BINARY(f, i, x + y);
+
+    CNWN_NCS_VM_CASE(ADD_FF):
+        CNWN_NCS_VM_FLOAT_BINARY(f, f, x + y);
+
+    CNWN_NCS_VM_CASE(ADD_SS): {
+        CNWN_NCS_VM_NEED(2);
+        if (stack[sp - 2].type != CNWN_NCS_TYPE_STRING || stack[sp - 1].type != CNWN_NCS_TYPE_STRING)
+            goto invalid_operand;
+        const cnwn_NcsString * s = cnwn_ncs_vm_concat(vm, stack[sp - 2].v.s, stack[sp - 1].v.s);
+        if (s == NULL)
+            goto failed;
+        sp--;
+        stack[sp - 1].v.s = s;
+        CNWN_NCS_VM_NEXT();
+    }
+
+    CNWN_NCS_VM_CASE(ADD_VV):
+        CNWN_NCS_VM_NEED(6);
+        for (int i = 0; i < 3; i++)
+            stack[sp - 6 + i].v.f += stack[sp - 3 + i].v.f;
+        sp -= 3;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(SUB_II):
+        CNWN_NCS_VM_INT_BINARY((uint32_t)x - (uint32_t)y);
+
+    CNWN_NCS_VM_CASE(SUB_IF):
+        CNWN_NCS_VM_FLOAT_BINARY(i, f, x - y);
+
+    CNWN_NCS_VM_CASE(SUB_FI):
+        CNWN_NCS_VM_FLOAT_BINARY(f, i, x - y);
+
+    CNWN_NCS_VM_CASE(SUB_FF):
+        CNWN_NCS_VM_FLOAT_BINARY(f, f, x - y);
+
+    CNWN_NCS_VM_CASE(SUB_VV):
+        CNWN_NCS_VM_NEED(6);
+        for (int i = 0; i < 3; i++)
+            stack[sp - 6 + i].v.f -= stack[sp - 3 + i].v.f;
+        sp -= 3;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(MUL_II):
+        CNWN_NCS_VM_INT_BINARY((uint32_t)x * (uint32_t)y);
+
+    CNWN_NCS_VM_CASE(MUL_IF):
+        CNWN_NCS_VM_FLOAT_BINARY(i, f, x * y);
+
+    CNWN_NCS_VM_CASE(MUL_FI):
+        CNWN_NCS_VM_FLOAT_BINARY(f, i, x * y);
+
+    CNWN_NCS_VM_CASE(MUL_FF):
+        CNWN_NCS_VM_FLOAT_BINARY(f, f, x * y);
+
+    CNWN_NCS_VM_CASE(MUL_VF):
+        CNWN_NCS_VM_NEED(4);
+        for (int i = 0; i < 3; i++)
+            stack[sp - 4 + i].v.f *= stack[sp - 1].v.f;
+        sp--;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(MUL_FV): {
+        CNWN_NCS_VM_NEED(4);
+        float f = stack[sp - 4].v.f;
+        for (int i = 0; i < 3; i++) {
+            stack[sp - 4 + i].type = CNWN_NCS_TYPE_FLOAT;
+            stack[sp - 4 + i].v.f = f * stack[sp - 3 + i].v.f;
+        }
+        sp--;
+        CNWN_NCS_VM_NEXT();
+    }
+
+    CNWN_NCS_VM_CASE(DIV_II): {
+        CNWN_NCS_VM_NEED(2);
+        int32_t y = stack[sp - 1].v.i;
+        if (y == 0)
+            goto division_by_zero;
+        CNWN_NCS_VM_INT_BINARY(y == -1 ? (int32_t)(0 - (uint32_t)x) : x / y);
+    }
+
+    CNWN_NCS_VM_CASE(DIV_IF):
+        if (sp > 0 && stack[sp - 1].v.f == 0.0f)
+            goto division_by_zero;
+        CNWN_NCS_VM_FLOAT_BINARY(i, f, x / y);
+
+    CNWN_NCS_VM_CASE(DIV_FI):
+        if (sp > 0 && stack[sp - 1].v.i == 0)
+            goto division_by_zero;
+        CNWN_NCS_VM_FLOAT_BINARY(f, i, x / y);
+
+    CNWN_NCS_VM_CASE(DIV_FF):
+        if (sp > 0 && stack[sp - 1].v.f == 0.0f)
+            goto division_by_zero;
+        CNWN_NCS_VM_FLOAT_BINARY(f, f, x / y);
+
+    CNWN_NCS_VM_CASE(DIV_VF):
+        CNWN_NCS_VM_NEED(4);
+        if (stack[sp - 1].v.f == 0.0f)
+            goto division_by_zero;
+        for (int i = 0; i < 3; i++)
+            stack[sp - 4 + i].v.f /= stack[sp - 1].v.f;
+        sp--;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(MOD_II): {
+        CNWN_NCS_VM_NEED(2);
+        int32_t y = stack[sp - 1].v.i;
+        if (y == 0)
+            goto division_by_zero;
+        CNWN_NCS_VM_INT_BINARY(y == -1 ? 0 : x % y);
+    }
+
+    CNWN_NCS_VM_CASE(NEG_I):
+        CNWN_NCS_VM_NEED(1);
+        stack[sp - 1].v.i = (int32_t)(0 - (uint32_t)stack[sp - 1].v.i);
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(NEG_F):
+        CNWN_NCS_VM_NEED(1);
+        stack[sp - 1].v.f = -stack[sp - 1].v.f;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(COMP):
+        CNWN_NCS_VM_NEED(1);
+        stack[sp - 1].v.i = ~stack[sp - 1].v.i;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(NOT):
+        CNWN_NCS_VM_NEED(1);
+        stack[sp - 1].v.i = !stack[sp - 1].v.i;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(MOVSP):
+        op = ops + pc;
+        if (op->a > 0)
+            goto invalid_operand;
+        CNWN_NCS_VM_NEED(-op->a);
+        sp += op->a;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(JMP):
+        pc = ops[pc].a;
+        CNWN_NCS_VM_DISPATCH();
+
+    CNWN_NCS_VM_CASE(JSR):
+        if (num_calls >= vm->max_calls)
+            goto call_limit;
+        calls[num_calls++] = pc + 1;
+        pc = ops[pc].a;
+        CNWN_NCS_VM_DISPATCH();
+
+    CNWN_NCS_VM_CASE(JZ):
+        CNWN_NCS_VM_NEED(1);
+        pc = (stack[--sp].v.i == 0 ? ops[pc].a : pc + 1);
+        CNWN_NCS_VM_DISPATCH();
+
+    CNWN_NCS_VM_CASE(JNZ):
+        CNWN_NCS_VM_NEED(1);
+        pc = (stack[--sp].v.i != 0 ? ops[pc].a : pc + 1);
+        CNWN_NCS_VM_DISPATCH();
+
+    CNWN_NCS_VM_CASE(RETN):
+        if (num_calls == 0)
+            goto done;
+        pc = calls[--num_calls];
+        CNWN_NCS_VM_DISPATCH();
+
+    CNWN_NCS_VM_CASE(DESTRUCT):
+        op = ops + pc;
+        CNWN_NCS_VM_NEED(op->a);
+        memmove(stack + sp - op->a, stack + sp - op->a + op->b, sizeof(cnwn_NcsValue) * op->c);
+        sp += op->c - op->a;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(DECSP):
+    CNWN_NCS_VM_CASE(INCSP): {
+        op = ops + pc;
+        int i = sp + op->a;
+        if (op->a >= 0 || i < 0)
+            goto invalid_operand;
+        stack[i].v.i = (int32_t)((uint32_t)stack[i].v.i + (op->handler == CNWN_NCS_VM_H_INCSP ? 1 : -1));
+        CNWN_NCS_VM_NEXT();
+    }
+
+    CNWN_NCS_VM_CASE(DECBP):
+    CNWN_NCS_VM_CASE(INCBP): {
+        op = ops + pc;
+        int i = bp + op->a;
+        if (i < 0 || i >= sp)
+            goto invalid_operand;
+        stack[i].v.i = (int32_t)((uint32_t)stack[i].v.i + (op->handler == CNWN_NCS_VM_H_INCBP ? 1 : -1));
+        CNWN_NCS_VM_NEXT();
+    }
+
+    CNWN_NCS_VM_CASE(SAVEBP):
+        CNWN_NCS_VM_ROOM(1);
+        stack[sp].type = CNWN_NCS_TYPE_INT;
+        stack[sp++].v.i = bp;
+        bp = sp;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(RESTOREBP):
+        CNWN_NCS_VM_NEED(1);
+        bp = stack[--sp].v.i;
+        if (bp < 0 || bp > sp)
+            goto invalid_operand;
+        CNWN_NCS_VM_NEXT();
+
+    CNWN_NCS_VM_CASE(END):
+        cnwn_set_error("program ran past the last instruction");
+        vm->status = CNWN_NCS_VM_STATUS_ERROR;
+        goto failed;
+
+    CNWN_NCS_VM_CASE(INVALID):
+        goto invalid_operand;
+
+#ifndef CNWN_NCS_VM_COMPUTED_GOTO
+    default:
+        goto invalid_operand;
+    }
+#endif
+
+done:
+    vm->sp = sp;
+    vm->bp = bp;
+    vm->num_calls = num_calls;
+    vm->num_instructions = count;
+    return 0;
+
+instruction_limit:
+    count--;
+    cnwn_set_error("instruction limit reached (%"PRId64" instructions)", max_instructions);
+    vm->status = CNWN_NCS_VM_STATUS_INSTRUCTION_LIMIT;
+    goto failed;
+
+stack_limit:
+    cnwn_set_error("stack limit reached (%d cells) at %08x", max_stack, vm->ncs->instructions[pc].offset);
+    vm->status = CNWN_NCS_VM_STATUS_STACK_LIMIT;
+    goto failed;
+
+call_limit:
+    cnwn_set_error("call depth limit reached (%d calls) at %08x", vm->max_calls, vm->ncs->instructions[pc].offset);
+    vm->status = CNWN_NCS_VM_STATUS_CALL_LIMIT;
+    goto failed;
+
+underflow:
+    cnwn_set_error("stack underflow at %08x", vm->ncs->instructions[pc].offset);
+    vm->status = CNWN_NCS_VM_STATUS_ERROR;
+    goto failed;
+
+division_by_zero:
+    cnwn_set_error("division by zero at %08x", vm->ncs->instructions[pc].offset);
+    vm->status = CNWN_NCS_VM_STATUS_ERROR;
+    goto failed;
+
+invalid_operand:
+    cnwn_set_error("invalid %s operand at %08x", cnwn_ncs_opcode_name(vm->ncs->instructions[pc].opcode), vm->ncs->instructions[pc].offset);
+    vm->status = CNWN_NCS_VM_STATUS_ERROR;
+
+failed:
+    if (vm->status == CNWN_NCS_VM_STATUS_OK)
+        vm->status = CNWN_NCS_VM_STATUS_ERROR;
+    vm->sp = sp;
+    vm->bp = bp;
+    vm->num_calls = num_calls;
+    vm->num_instructions = count;
+    return -1;
+}
+
+const char * cnwn_ncs_vm_status_name(cnwn_NcsVmStatus status)
+{
+    if (status >= CNWN_NCS_VM_STATUS_OK && status <= CNWN_NCS_VM_STATUS_ERROR)
+        return CNWN_NCS_VM_STATUS_NAMES[status];
+    return "unknown";
+}
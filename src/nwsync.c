@@ -0,0 +1,362 @@
+#include "cnwn/nwsync.h"
+
+static uint32_t cnwn_nwsync_read_u32(const uint8_t * p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void cnwn_nwsync_write_u32(uint8_t * p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void cnwn_nwsync_write_resref(uint8_t * p, const cnwn_NWSyncEntry * entry)
+{
+    memset(p, 0, CNWN_NWSYNC_RESREF_SIZE);
+    memcpy(p, entry->resref.s, entry->resref.length);
+    p[CNWN_NWSYNC_RESREF_SIZE] = (uint8_t)entry->type;
+    p[CNWN_NWSYNC_RESREF_SIZE + 1] = (uint8_t)(entry->type >> 8);
+}
+
+static int cnwn_nwsync_compare_resref(const cnwn_NWSyncEntry * a, const cnwn_NWSyncEntry * b)
+{
+    int ret = cnwn_resref_compare(&a->resref, &b->resref);
+    if (ret != 0)
+        return ret;
+    return (a->type < b->type ? -1 : (a->type > b->type ? 1 : 0));
+}
+
+static int cnwn_nwsync_compare_entry_resref(const void * a, const void * b)
+{
+    return cnwn_nwsync_compare_resref(a, b);
+}
+
+static int cnwn_nwsync_compare_ptr_resref(const void * a, const void * b)
+{
+    return cnwn_nwsync_compare_resref(*(const cnwn_NWSyncEntry **)a, *(const cnwn_NWSyncEntry **)b);
+}
+
+static int cnwn_nwsync_compare_ptr_sha1(const void * a, const void * b)
+{
+    const cnwn_NWSyncEntry * ea = *(const cnwn_NWSyncEntry **)a;
+    const cnwn_NWSyncEntry * eb = *(const cnwn_NWSyncEntry **)b;
+    int ret = memcmp(ea->sha1, eb->sha1, CNWN_SHA1_SIZE);
+    if (ret != 0)
+        return ret;
+    return cnwn_nwsync_compare_resref(ea, eb);
+}
+
+static const cnwn_NWSyncEntry ** cnwn_nwsync_manifest_sorted(const cnwn_NWSyncManifest * manifest, int (*compare)(const void *, const void *))
+{
+    int num_entries = cnwn_array_get_length(&manifest->entries);
+    const cnwn_NWSyncEntry ** ret = malloc(sizeof(cnwn_NWSyncEntry *) * CNWN_MAX(1, num_entries));
+    for (int i = 0; i < num_entries; i++)
+        ret[i] = cnwn_array_element_ptr(&manifest->entries, i);
+    qsort(ret, num_entries, sizeof(cnwn_NWSyncEntry *), compare);
+    return ret;
+}
+
+static int cnwn_nwsync_add_raw(cnwn_NWSyncManifest * manifest, const uint8_t * sha1, uint32_t size, const uint8_t * resref)
+{
+    char tmps[CNWN_NWSYNC_RESREF_SIZE + 1];
+    memcpy(tmps, resref, CNWN_NWSYNC_RESREF_SIZE);
+    tmps[CNWN_NWSYNC_RESREF_SIZE] = 0;
+    cnwn_ResourceType type = (cnwn_ResourceType)(resref[CNWN_NWSYNC_RESREF_SIZE] | (resref[CNWN_NWSYNC_RESREF_SIZE + 1] << 8));
+    return cnwn_nwsync_manifest_add(manifest, sha1, size, tmps, type);
+}
+
+void cnwn_nwsync_manifest_init(cnwn_NWSyncManifest * manifest)
+{
+    cnwn_array_init(&manifest->entries, sizeof(cnwn_NWSyncEntry), NULL);
+}
+
+int cnwn_nwsync_manifest_init_from_path(cnwn_NWSyncManifest * manifest, const char * path)
+{
+    cnwn_FileMap map;
+    if (cnwn_file_map_path(path, &map) < 0) {
+        cnwn_nwsync_manifest_init(manifest);
+        return -1;
+    }
+    int ret = cnwn_nwsync_manifest_init_from_buffer(manifest, map.data, map.size);
+    if (ret < 0)
+        cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+    cnwn_file_unmap(&map);
+    return ret;
+}
+
+int cnwn_nwsync_manifest_init_from_buffer(cnwn_NWSyncManifest * manifest, const void * data, int64_t size)
+{
+    cnwn_nwsync_manifest_init(manifest);
+    const uint8_t * p = data;
+    if (p == NULL || size < CNWN_NWSYNC_MANIFEST_HEADER_SIZE) {
+        cnwn_set_error("not enough data for NWSync manifest header (%"PRId64" bytes)", size);
+        return -1;
+    }
+    if (memcmp(p, "NSYC", 4) != 0) {
+        cnwn_set_error("invalid NWSync manifest type (%.4s)", (const char *)p);
+        return -1;
+    }
+    uint32_t version = cnwn_nwsync_read_u32(p + 4);
+    if (version != CNWN_NWSYNC_MANIFEST_VERSION) {
+        cnwn_set_error("unsupported NWSync manifest version (%u)", version);
+        return -1;
+    }
+    uint32_t num_entries = cnwn_nwsync_read_u32(p + 8);
+    uint32_t num_mappings = cnwn_nwsync_read_u32(p + 12);
+    int64_t required_size = CNWN_NWSYNC_MANIFEST_HEADER_SIZE
+        + (int64_t)num_entries * CNWN_NWSYNC_MANIFEST_ENTRY_SIZE
+        + (int64_t)num_mappings * CNWN_NWSYNC_MANIFEST_MAPPING_SIZE;
+    if (required_size > size || (int64_t)num_entries + num_mappings > INT32_MAX) {
+        cnwn_set_error("NWSync manifest out of range (%u entries, %u mappings, %"PRId64" bytes)", num_entries, num_mappings, size);
+        return -1;
+    }
+    const uint8_t * entries = p + CNWN_NWSYNC_MANIFEST_HEADER_SIZE;
+    for (uint32_t i = 0; i < num_entries; i++) {
+        const uint8_t * e = entries + (int64_t)i * CNWN_NWSYNC_MANIFEST_ENTRY_SIZE;
+        cnwn_nwsync_add_raw(manifest, e, cnwn_nwsync_read_u32(e + CNWN_SHA1_SIZE), e + CNWN_SHA1_SIZE + 4);
+    }
+    const uint8_t * mappings = entries + (int64_t)num_entries * CNWN_NWSYNC_MANIFEST_ENTRY_SIZE;
+    for (uint32_t i = 0; i < num_mappings; i++) {
+        const uint8_t * m = mappings + (int64_t)i * CNWN_NWSYNC_MANIFEST_MAPPING_SIZE;
+        uint32_t index = cnwn_nwsync_read_u32(m);
+        if (index >= num_entries) {
+            cnwn_set_error("NWSync manifest mapping %u out of range (%u)", i, index);
+            cnwn_nwsync_manifest_deinit(manifest);
+            return -1;
+        }
+        const uint8_t * e = entries + (int64_t)index * CNWN_NWSYNC_MANIFEST_ENTRY_SIZE;
+        cnwn_nwsync_add_raw(manifest, e, cnwn_nwsync_read_u32(e + CNWN_SHA1_SIZE), m + 4);
+    }
+    return cnwn_array_get_length(&manifest->entries);
+}
+
+void cnwn_nwsync_manifest_deinit(cnwn_NWSyncManifest * manifest)
+{
+    cnwn_array_deinit(&manifest->entries);
+}
+
+int cnwn_nwsync_manifest_add(cnwn_NWSyncManifest * manifest, const uint8_t * sha1, int64_t size, const char * resref, cnwn_ResourceType type)
+{
+    if (size < 0 || size > UINT32_MAX) {
+        cnwn_set_error("invalid NWSync entry size (%"PRId64" bytes)", size);
+        return -1;
+    }
+    if (cnwn_strlen(resref) > CNWN_NWSYNC_RESREF_SIZE) {
+        cnwn_set_error("resref too long for NWSync manifest (%s)", resref);
+        return -1;
+    }
+    cnwn_NWSyncEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    memcpy(entry.sha1, sha1, CNWN_SHA1_SIZE);
+    entry.size = (uint32_t)size;
+    cnwn_resref_init(&entry.resref, resref);
+    entry.type = type;
+    cnwn_array_append(&manifest->entries, 1, &entry);
+    return cnwn_array_get_length(&manifest->entries) - 1;
+}
+
+int cnwn_nwsync_manifest_get_num_entries(const cnwn_NWSyncManifest * manifest)
+{
+    return cnwn_array_get_length(&manifest->entries);
+}
+
+const cnwn_NWSyncEntry * cnwn_nwsync_manifest_get_entry(const cnwn_NWSyncManifest * manifest, int index)
+{
+    return cnwn_array_element_ptr(&manifest->entries, index);
+}
+
+void cnwn_nwsync_manifest_sort(cnwn_NWSyncManifest * manifest)
+{
+    int num_entries = cnwn_array_get_length(&manifest->entries);
+    if (num_entries > 1)
+        qsort(cnwn_array_element_ptr(&manifest->entries, 0), num_entries, sizeof(cnwn_NWSyncEntry), cnwn_nwsync_compare_entry_resref);
+}
+
+int64_t cnwn_nwsync_manifest_write(const cnwn_NWSyncManifest * manifest, cnwn_File * f, uint8_t * ret_sha1)
+{
+    int num_entries = cnwn_array_get_length(&manifest->entries);
+    const cnwn_NWSyncEntry ** sorted = cnwn_nwsync_manifest_sorted(manifest, cnwn_nwsync_compare_ptr_sha1);
+    int num_unique = 0;
+    for (int i = 0; i < num_entries; i++)
+        if (i == 0 || memcmp(sorted[i]->sha1, sorted[i - 1]->sha1, CNWN_SHA1_SIZE) != 0)
+            num_unique++;
+    int64_t size = CNWN_NWSYNC_MANIFEST_HEADER_SIZE
+        + (int64_t)num_unique * CNWN_NWSYNC_MANIFEST_ENTRY_SIZE
+        + (int64_t)(num_entries - num_unique) * CNWN_NWSYNC_MANIFEST_MAPPING_SIZE;
+    uint8_t * data = malloc(size);
+    memcpy(data, "NSYC", 4);
+    cnwn_nwsync_write_u32(data + 4, CNWN_NWSYNC_MANIFEST_VERSION);
+    cnwn_nwsync_write_u32(data + 8, num_unique);
+    cnwn_nwsync_write_u32(data + 12, num_entries - num_unique);
+    uint8_t * entry_p = data + CNWN_NWSYNC_MANIFEST_HEADER_SIZE;
+    uint8_t * mapping_p = entry_p + (int64_t)num_unique * CNWN_NWSYNC_MANIFEST_ENTRY_SIZE;
+    int entry_index = -1;
+    for (int i = 0; i < num_entries; i++) {
+        const cnwn_NWSyncEntry * entry = sorted[i];
+        if (i == 0 || memcmp(entry->sha1, sorted[i - 1]->sha1, CNWN_SHA1_SIZE) != 0) {
+            memcpy(entry_p, entry->sha1, CNWN_SHA1_SIZE);
+            cnwn_nwsync_write_u32(entry_p + CNWN_SHA1_SIZE, entry->size);
+            cnwn_nwsync_write_resref(entry_p + CNWN_SHA1_SIZE + 4, entry);
+            entry_p += CNWN_NWSYNC_MANIFEST_ENTRY_SIZE;
+            entry_index++;
+        } else {
+            cnwn_nwsync_write_u32(mapping_p, entry_index);
+            cnwn_nwsync_write_resref(mapping_p + 4, entry);
+            mapping_p += CNWN_NWSYNC_MANIFEST_MAPPING_SIZE;
+        }
+    }
+    free(sorted);
+    int64_t ret = cnwn_file_write(f, size, data);
+    if (ret >= 0 && ret_sha1 != NULL)
+        cnwn_hash_sha1(data, size, ret_sha1);
+    free(data);
+    if (ret < 0) {
+        cnwn_set_error("%s (writing NWSync manifest)", cnwn_get_error());
+        return -1;
+    }
+    return ret;
+}
+
+int cnwn_nwsync_manifest_diff(const cnwn_NWSyncManifest * manifest, const cnwn_NWSyncManifest * other, cnwn_NWSyncManifest * ret_added, cnwn_NWSyncManifest * ret_removed)
+{
+    int num_entries = cnwn_array_get_length(&manifest->entries);
+    int num_other_entries = cnwn_array_get_length(&other->entries);
+    const cnwn_NWSyncEntry ** sorted = cnwn_nwsync_manifest_sorted(manifest, cnwn_nwsync_compare_ptr_resref);
+    const cnwn_NWSyncEntry ** other_sorted = cnwn_nwsync_manifest_sorted(other, cnwn_nwsync_compare_ptr_resref);
+    int ret = 0;
+    int i = 0, j = 0;
+    while (i < num_entries || j < num_other_entries) {
+        int cmp = (i >= num_entries ? 1 : (j >= num_other_entries ? -1 : cnwn_nwsync_compare_resref(sorted[i], other_sorted[j])));
+        if (cmp < 0) {
+            if (ret_removed != NULL)
+                cnwn_array_append(&ret_removed->entries, 1, sorted[i]);
+            ret++;
+            i++;
+        } else if (cmp > 0 || memcmp(sorted[i]->sha1, other_sorted[j]->sha1, CNWN_SHA1_SIZE) != 0) {
+            if (ret_added != NULL)
+                cnwn_array_append(&ret_added->entries, 1, other_sorted[j]);
+            ret++;
+            if (cmp == 0)
+                i++;
+            j++;
+        } else {
+            i++;
+            j++;
+        }
+    }
+    free(other_sorted);
+    free(sorted);
+    return ret;
+}
+
+int cnwn_nwsync_store_get_path(const char * store_path, const uint8_t * sha1, char * r, int max_size)
+{
+    char hex[CNWN_SHA1_STRING_SIZE];
+    cnwn_hash_sha1_to_string(sha1, hex, sizeof(hex));
+    char tmps[CNWN_PATH_MAX_SIZE];
+    int length = snprintf(tmps, sizeof(tmps), "%s%sdata%ssha1%s%.2s%s%.2s%s%s",
+                          store_path, CNWN_PATH_SEPARATOR,
+                          CNWN_PATH_SEPARATOR,
+                          CNWN_PATH_SEPARATOR, hex,
+                          CNWN_PATH_SEPARATOR, hex + 2,
+                          CNWN_PATH_SEPARATOR, hex);
+    if (length < 0 || length >= (int)sizeof(tmps) || (r != NULL && length >= max_size)) {
+        cnwn_set_error("store path too long (%s)", store_path);
+        return -1;
+    }
+    return cnwn_strcpy(r, max_size, tmps, -1);
+}
+
+bool cnwn_nwsync_store_has(const char * store_path, const uint8_t * sha1)
+{
+    char path[CNWN_PATH_MAX_SIZE];
+    if (cnwn_nwsync_store_get_path(store_path, sha1, path, sizeof(path)) < 0)
+        return false;
+    return cnwn_file_system_isfile(path) > 0;
+}
+
+int cnwn_nwsync_store_put(const char * store_path, const uint8_t * sha1, cnwn_File * f, int64_t size)
+{
+    char path[CNWN_PATH_MAX_SIZE];
+    if (cnwn_nwsync_store_get_path(store_path, sha1, path, sizeof(path)) < 0)
+        return -1;
+    if (cnwn_file_system_isfile(path) > 0)
+        return 0;
+    char tmps[CNWN_PATH_MAX_SIZE];
+    cnwn_path_directorypart(tmps, sizeof(tmps), path);
+    if (cnwn_file_system_mkdir(tmps) < 0) {
+        cnwn_set_error("%s (mkdir %s)", cnwn_get_error(), tmps);
+        return -1;
+    }
+    // Copy to a temporary file first so a failed put never leaves broken content behind.
+    char tmp_path[CNWN_PATH_MAX_SIZE];
+    int length = snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    if (length < 0 || length >= (int)sizeof(tmp_path)) {
+        cnwn_set_error("store path too long (%s)", path);
+        return -1;
+    }
+    cnwn_File * output_f = cnwn_file_open(tmp_path, "t");
+    if (output_f == NULL) {
+        cnwn_set_error("%s (open %s)", cnwn_get_error(), tmp_path);
+        return -1;
+    }
+    uint8_t buffer[CNWN_FILE_BUFFER_SIZE];
+    cnwn_Sha1State state;
+    cnwn_hash_sha1_init(&state);
+    int ret = 1;
+    for (int64_t remaining = size; ret > 0 && remaining > 0; ) {
+        int64_t read_ret = cnwn_file_read_fixed(f, CNWN_MIN(remaining, (int64_t)sizeof(buffer)), buffer);
+        if (read_ret <= 0 || cnwn_file_write(output_f, read_ret, buffer) != read_ret) {
+            cnwn_set_error("%s (copying to %s)", (read_ret == 0 ? "unexpected end of file" : cnwn_get_error()), tmp_path);
+            ret = -1;
+        } else {
+            cnwn_hash_sha1_update(&state, buffer, read_ret);
+            remaining -= read_ret;
+        }
+    }
+    cnwn_file_close(output_f);
+    if (ret > 0) {
+        uint8_t digest[CNWN_SHA1_SIZE];
+        cnwn_hash_sha1_final(&state, digest);
+        if (memcmp(digest, sha1, CNWN_SHA1_SIZE) != 0) {
+            char hex[CNWN_SHA1_STRING_SIZE], expected_hex[CNWN_SHA1_STRING_SIZE];
+            cnwn_hash_sha1_to_string(digest, hex, sizeof(hex));
+            cnwn_hash_sha1_to_string(sha1, expected_hex, sizeof(expected_hex));
+            cnwn_set_error("content hash mismatch (got %s, expected %s)", hex, expected_hex);
+            ret = -1;
+        }
+    }
+    if (ret > 0 && cnwn_file_system_mv(tmp_path, path) < 0) {
+        cnwn_set_error("%s (rename %s)", cnwn_get_error(), tmp_path);
+        ret = -1;
+    }
+    if (ret < 0)
+        cnwn_file_system_rm(tmp_path);
+    return ret;
+}
+
+int cnwn_nwsync_store_verify(const char * store_path, const cnwn_NWSyncEntry * entry)
+{
+    char path[CNWN_PATH_MAX_SIZE];
+    if (cnwn_nwsync_store_get_path(store_path, entry->sha1, path, sizeof(path)) < 0)
+        return -1;
+    if (cnwn_file_system_isfile(path) <= 0)
+        return CNWN_NWSYNC_STATUS_MISSING;
+    if (cnwn_file_system_size(path, false) != (int64_t)entry->size)
+        return CNWN_NWSYNC_STATUS_SIZE_MISMATCH;
+    uint8_t digest[CNWN_SHA1_SIZE];
+    if (entry->size > 0) {
+        cnwn_FileMap map;
+        if (cnwn_file_map_path(path, &map) < 0)
+            return -1;
+        cnwn_hash_sha1(map.data, map.size, digest);
+        cnwn_file_unmap(&map);
+    } else
+        cnwn_hash_sha1("", 0, digest);
+    if (memcmp(digest, entry->sha1, CNWN_SHA1_SIZE) != 0)
+        return CNWN_NWSYNC_STATUS_HASH_MISMATCH;
+    return CNWN_NWSYNC_STATUS_OK;
+}
@@ -29,11 +29,16 @@ int cnwn_option_to_string(const cnwn_Option * option, int max_size, char * ret_s
 
 int cnwn_options_find(const cnwn_Option * options, const char * opt)
 {
-    if (options != NULL && !cnwn_strisblank(opt)) 
+    if (options != NULL && !cnwn_strisblank(opt)) {
+        // A single char is a shorthand, longhands end at the value (name=value).
+        int length = cnwn_strfind(opt, 0, "=", NULL);
+        if (length < 0)
+            length = cnwn_strlen(opt);
         for (int i = 0; !CNWN_OPTION_SENTINEL(options + i); i++)
-            if ((options[i].shorthand != 0 && options[i].shorthand == opt[0])
-                || (!cnwn_strisblank(options[i].longhand) && cnwn_strcmp(options[i].longhand, opt) == 0))
+            if ((options[i].shorthand != 0 && options[i].shorthand == opt[0] && opt[1] == 0)
+                || (!cnwn_strisblank(options[i].longhand) && cnwn_strlen(options[i].longhand) == length && cnwn_strncmp(options[i].longhand, opt, length) == 0))
                 return i;
+    }
     return -1;
 }
 
@@ -122,7 +127,7 @@ int cnwn_options_parse_argument(const cnwn_Option * options, int index, int argc
                     ret_result->arg = argv[index];
                     ret_result->optindex = optindex;
                     ret_result->option = options + optindex;
-                    ret_result->optarg = argv[index + 1] + finder + 1;
+                    ret_result->optarg = argv[index] + finder + 1;
                     ret_result->optvalue = options[optindex].optvalue;
                 }
                 return 1;
@@ -24,12 +24,12 @@ int cnwn_path_clean(char * r, int max_size, const char * path)
             offset += cnwn_strcpy(tmps + offset, sizeof(tmps) - offset, path + last, len);
         last = index + 1;
         index = (CNWN_PATH_CASE_INSENSETIVE ? cnwn_strfindi(path, last, CNWN_PATH_SEPARATOR, CNWN_PATH_ESCAPE) : cnwn_strfind(path, last, CNWN_PATH_SEPARATOR, CNWN_PATH_ESCAPE));
-        if (index >= 0 && index - last > 1)
+        if (index >= 0 && index - last > 0)
             offset += cnwn_strcpy(tmps + offset, sizeof(tmps) - offset, CNWN_PATH_SEPARATOR, -1);
     }
-    if (pathlen - last > 1) {
+    if (pathlen - last > 0) {
         if (last > 0)
-            offset += cnwn_strcpy(tmps + offset, max_size - offset, CNWN_PATH_SEPARATOR, -1);
+            offset += cnwn_strcpy(tmps + offset, sizeof(tmps) - offset, CNWN_PATH_SEPARATOR, -1);
         offset += cnwn_strcpy(tmps + offset, sizeof(tmps) - offset, path + last, pathlen - last);
     }
     return cnwn_strcpy(r, max_size, tmps, -1);
@@ -3,6 +3,684 @@
 #include <regex.h>
 struct cnwn_Regexp_s { regex_t regex; };
 
+// The patterns of a regexp array are also compiled together for cnwn_regexp_array_match_any():
+// - Literals anchored at the start, the end or both go to a table indexed by their first or last character.
+// - Other patterns made of characters, '.', brackets and '*' (globs and unanchored literals) are compiled to one DFA
+//   that runs over the string once for all of them.
+// - Everything else uses regexec(), but only when the literal that every match must contain is in the string.
+
+#define CNWN_REGEXP_MAX_DFA_STATES 4096
+#define CNWN_REGEXP_MAX_DFA_POSITIONS 4096
+#define CNWN_REGEXP_MAX_FOLDED_SIZE 4096
+
+#define CNWN_REGEXP_LITERAL_EXACT 0
+#define CNWN_REGEXP_LITERAL_PREFIX 1
+#define CNWN_REGEXP_LITERAL_SUFFIX 2
+
+#define CNWN_REGEXP_ACCEPT_NOW 1
+#define CNWN_REGEXP_ACCEPT_END 2
+
+typedef struct cnwn_RegexpByteSet_s { uint32_t bits[8]; } cnwn_RegexpByteSet;
+
+#define CNWN_REGEXP_BYTE_SET_HAS(set, b) (((set)->bits[(uint8_t)(b) >> 5] >> ((uint8_t)(b) & 31)) & 1)
+#define CNWN_REGEXP_BYTE_SET_ADD(set, b) ((set)->bits[(uint8_t)(b) >> 5] |= (uint32_t)1 << ((uint8_t)(b) & 31))
+
+typedef struct cnwn_RegexpDfa_s {
+    int num_states;
+    int num_classes;
+    uint8_t classes[256];
+    int * transitions;
+    uint8_t * accepts;
+} cnwn_RegexpDfa;
+
+struct cnwn_RegexpMatcher_s {
+    int num_patterns;
+    char ** patterns;
+    bool match_everything;
+    int num_literals;
+    char ** literals;
+    int * literal_lengths;
+    uint8_t * literal_kinds;
+    int * literal_next;
+    int start_heads[256];
+    int end_heads[256];
+    cnwn_RegexpDfa dfa;
+    int num_regexps;
+    bool has_required_dfa;
+    cnwn_RegexpDfa required_dfa;
+    int * regexp_indices;
+    char *** required_literals;
+};
+
+typedef struct cnwn_RegexpSimple_s {
+    int num_atoms;
+    cnwn_RegexpByteSet * sets;
+    bool * stars;
+    char * literal;
+    bool is_literal;
+    bool start_anchor;
+    bool end_anchor;
+} cnwn_RegexpSimple;
+
+static char cnwn_regexp_lower(char c)
+{
+    return (c >= 'A' && c <= 'Z' ? c + 32 : c);
+}
+
+static void cnwn_regexp_byte_set_fold(cnwn_RegexpByteSet * set)
+{
+    for (int c = 'a'; c <= 'z'; c++) {
+        if (CNWN_REGEXP_BYTE_SET_HAS(set, c) || CNWN_REGEXP_BYTE_SET_HAS(set, c - 32)) {
+            CNWN_REGEXP_BYTE_SET_ADD(set, c);
+            CNWN_REGEXP_BYTE_SET_ADD(set, c - 32);
+        }
+    }
+}
+
+// Parse a bracket expression starting after the '[', returns the index after the ']' or a negative value if it
+// uses something the DFA doesn't handle (character classes, collating elements).
+static int cnwn_regexp_parse_bracket(const char * re, int i, cnwn_RegexpByteSet * ret_set)
+{
+    memset(ret_set, 0, sizeof(cnwn_RegexpByteSet));
+    bool negate = re[i] == '^';
+    if (negate)
+        i++;
+    bool first = true;
+    while (re[i] != ']' || first) {
+        if (re[i] == 0 || (re[i] == '[' && (re[i + 1] == ':' || re[i + 1] == '=' || re[i + 1] == '.')))
+            return -1;
+        uint8_t from = (uint8_t)re[i];
+        uint8_t to = from;
+        if (re[i + 1] == '-' && re[i + 2] != ']' && re[i + 2] != 0) {
+            to = (uint8_t)re[i + 2];
+            // Ranges mixing cases or letters with other characters (or reversed, like a-Z) depend on how the regex library
+            // folds and collates them.
+            if (from > to || !((from >= 'a' && to <= 'z') || (from >= 'A' && to <= 'Z') || (from >= '0' && to <= '9')))
+                return -1;
+            i += 3;
+        } else
+            i++;
+        for (int b = from; b <= to; b++)
+            CNWN_REGEXP_BYTE_SET_ADD(ret_set, b);
+        first = false;
+    }
+    cnwn_regexp_byte_set_fold(ret_set);
+    if (negate) {
+        for (int j = 0; j < 8; j++)
+            ret_set->bits[j] = ~ret_set->bits[j];
+    }
+    ret_set->bits[0] &= ~(uint32_t)1;
+    return i + 1;
+}
+
+static void cnwn_regexp_simple_deinit(cnwn_RegexpSimple * simple)
+{
+    free(simple->sets);
+    free(simple->stars);
+    free(simple->literal);
+}
+
+// Parse a (basic) regular expression made of characters, '.', brackets and '*' with optional anchors.
+static bool cnwn_regexp_simple_init(cnwn_RegexpSimple * simple, const char * re)
+{
+    int length = cnwn_strlen(re);
+    memset(simple, 0, sizeof(cnwn_RegexpSimple));
+    simple->sets = malloc(sizeof(cnwn_RegexpByteSet) * (length + 1));
+    simple->stars = malloc(sizeof(bool) * (length + 1));
+    simple->literal = malloc(sizeof(char) * (length + 1));
+    simple->is_literal = true;
+    int i = 0;
+    if (re[i] == '^') {
+        simple->start_anchor = true;
+        i++;
+    }
+    while (re[i] != 0) {
+        cnwn_RegexpByteSet * set = simple->sets + simple->num_atoms;
+        char c = re[i];
+        bool literal = true;
+        if (c == '$' && re[i + 1] == 0) {
+            simple->end_anchor = true;
+            break;
+        } else if (c == '\\') {
+            c = re[i + 1];
+            if (c == 0 || strchr(".[]\\*^$/", c) == NULL) {
+                cnwn_regexp_simple_deinit(simple);
+                return false;
+            }
+            i += 2;
+        } else if (c == '[') {
+            i = cnwn_regexp_parse_bracket(re, i + 1, set);
+            if (i < 0) {
+                cnwn_regexp_simple_deinit(simple);
+                return false;
+            }
+            literal = false;
+        } else if (c == '.') {
+            memset(set, 0xff, sizeof(cnwn_RegexpByteSet));
+            set->bits[0] &= ~(uint32_t)1;
+            literal = false;
+            i++;
+        } else if (c == '*' && simple->num_atoms > 0) {
+            // A repeated star, the same as one.
+            i++;
+            continue;
+        } else
+            i++;
+        if (literal) {
+            memset(set, 0, sizeof(cnwn_RegexpByteSet));
+            CNWN_REGEXP_BYTE_SET_ADD(set, c);
+            cnwn_regexp_byte_set_fold(set);
+            simple->literal[simple->num_atoms] = cnwn_regexp_lower(c);
+        }
+        // A '*' at the start is a literal in basic regular expressions.
+        simple->stars[simple->num_atoms] = re[i] == '*';
+        if (simple->stars[simple->num_atoms])
+            i++;
+        if (!literal || simple->stars[simple->num_atoms])
+            simple->is_literal = false;
+        simple->num_atoms++;
+    }
+    simple->literal[simple->num_atoms] = 0;
+    return true;
+}
+
+// An unanchored pattern matching the (lowercase) literal @p s.
+static void cnwn_regexp_simple_init_literal(cnwn_RegexpSimple * simple, const char * s)
+{
+    int length = cnwn_strlen(s);
+    memset(simple, 0, sizeof(cnwn_RegexpSimple));
+    simple->sets = calloc(length + 1, sizeof(cnwn_RegexpByteSet));
+    simple->stars = calloc(length + 1, sizeof(bool));
+    simple->literal = cnwn_strdup(s);
+    simple->is_literal = true;
+    simple->num_atoms = length;
+    for (int i = 0; i < length; i++) {
+        CNWN_REGEXP_BYTE_SET_ADD(simple->sets + i, s[i]);
+        cnwn_regexp_byte_set_fold(simple->sets + i);
+    }
+}
+
+// Parse "a\|b\|c\)" made of plain characters starting after a "\(", returns the index after the "\)" or a negative
+// value. The alternatives are written lowercase and zero terminated one after the other to @p ret_literals.
+static int cnwn_regexp_parse_literal_group(const char * re, int i, char * ret_literals, int * ret_num_literals, int * ret_min_length)
+{
+    int num_literals = 0;
+    int min_length = INT_MAX;
+    int length = 0;
+    int size = 0;
+    while (true) {
+        char c = re[i];
+        if (c == 0 || c == '.' || c == '[' || c == '*' || c == '^' || c == '$')
+            return -1;
+        if (c == '\\') {
+            char e = re[i + 1];
+            if (e == '|' || e == ')') {
+                ret_literals[size++] = 0;
+                num_literals++;
+                min_length = CNWN_MIN(min_length, length);
+                length = 0;
+                i += 2;
+                if (e == ')')
+                    break;
+                continue;
+            }
+            if (e == 0 || strchr(".[]\\*^$/", e) == NULL)
+                return -1;
+            c = e;
+            i++;
+        }
+        ret_literals[size++] = cnwn_regexp_lower(c);
+        length++;
+        i++;
+    }
+    *ret_num_literals = num_literals;
+    *ret_min_length = min_length;
+    return i;
+}
+
+static char ** cnwn_regexp_literals_new(int num_literals, const char * literals)
+{
+    char ** ret = malloc(sizeof(char *) * (num_literals + 1));
+    for (int i = 0; i < num_literals; i++) {
+        ret[i] = cnwn_strdup(literals);
+        literals += cnwn_strlen(literals) + 1;
+    }
+    ret[num_literals] = NULL;
+    return ret;
+}
+
+// Literals every match must contain one of (lowercase, NULL terminated), the longest run of characters outside of
+// groups or a group of plain alternatives, or NULL if there is no such thing.
+static char ** cnwn_regexp_required_literals(const char * re)
+{
+    int length = cnwn_strlen(re);
+    char * run = malloc(sizeof(char) * (length + 1));
+    char * group = malloc(sizeof(char) * (length + 1));
+    char ** best = NULL;
+    int run_length = 0;
+    int best_length = 0;
+    int depth = 0;
+    int i = (re[0] == '^' ? 1 : 0);
+    while (re[i] != 0) {
+        char c = re[i];
+        bool literal = false;
+        int num_group_literals = 0;
+        int group_length = 0;
+        int next = i + 1;
+        if (c == '\\') {
+            char e = re[i + 1];
+            next = (e != 0 ? i + 2 : i + 1);
+            if (e == '|' && depth == 0) {
+                // Alternatives at the top, nothing in particular is required.
+                cnwn_strings_free(best);
+                best = NULL;
+                best_length = 0;
+                run_length = 0;
+                break;
+            } else if (e == '(') {
+                int end = (depth == 0 ? cnwn_regexp_parse_literal_group(re, i + 2, group, &num_group_literals, &group_length) : -1);
+                if (end >= 0)
+                    next = end;
+                else
+                    depth++;
+            } else if (e == ')')
+                depth--;
+            else if (e != 0 && strchr(".[]\\*^$/", e) != NULL) {
+                literal = true;
+                c = e;
+            }
+        } else if (c == '[') {
+            cnwn_RegexpByteSet set;
+            next = cnwn_regexp_parse_bracket(re, i + 1, &set);
+            if (next < 0) {
+                // A character class, find the end by hand.
+                next = i + 1;
+                if (re[next] == '^')
+                    next++;
+                if (re[next] == ']')
+                    next++;
+                while (re[next] != 0 && re[next] != ']') {
+                    if (re[next] == '[' && (re[next + 1] == ':' || re[next + 1] == '=' || re[next + 1] == '.')) {
+                        char delimiter = re[next + 1];
+                        next += 2;
+                        while (re[next] != 0 && !(re[next] == delimiter && re[next + 1] == ']'))
+                            next++;
+                        if (re[next] != 0)
+                            next += 2;
+                    } else
+                        next++;
+                }
+                if (re[next] != 0)
+                    next++;
+            }
+        } else if (c == '$' && re[i + 1] == 0) {
+            next = i + 1;
+        } else if (c != '.' && (c != '*' || i == (re[0] == '^' ? 1 : 0)))
+            literal = true;
+        // Anything followed by a repetition may not be there at all.
+        bool optional = false;
+        if (re[next] == '*') {
+            optional = true;
+            next++;
+        } else if (re[next] == '\\' && (re[next + 1] == '?' || re[next + 1] == '+' || re[next + 1] == '{')) {
+            optional = true;
+            if (re[next + 1] == '{') {
+                next += 2;
+                while (re[next] != 0 && !(re[next] == '\\' && re[next + 1] == '}'))
+                    next++;
+                next += (re[next] != 0 ? 2 : 0);
+            } else
+                next += 2;
+        }
+        if (literal && !optional && depth == 0)
+            run[run_length++] = cnwn_regexp_lower(c);
+        else {
+            if (run_length > best_length) {
+                cnwn_strings_free(best);
+                run[run_length] = 0;
+                best = cnwn_regexp_literals_new(1, run);
+                best_length = run_length;
+            }
+            run_length = 0;
+            if (num_group_literals > 0 && !optional && group_length > best_length) {
+                cnwn_strings_free(best);
+                best = cnwn_regexp_literals_new(num_group_literals, group);
+                best_length = group_length;
+            }
+        }
+        i = next;
+    }
+    if (run_length > best_length) {
+        cnwn_strings_free(best);
+        run[run_length] = 0;
+        best = cnwn_regexp_literals_new(1, run);
+    }
+    free(group);
+    free(run);
+    return best;
+}
+
+static uint32_t cnwn_regexp_dfa_hash(const uint64_t * set, int num_words)
+{
+    uint64_t h = 0x9e3779b97f4a7c15ULL;
+    for (int i = 0; i < num_words; i++) {
+        h = (h ^ set[i]) * 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 31;
+    }
+    return (uint32_t)h;
+}
+
+// Glushkov style positions: every atom of a pattern is a position and the position after the last atom is final.
+// A DFA state is the set of positions waiting for their atom.
+static bool cnwn_regexp_dfa_init(cnwn_RegexpDfa * dfa, int num_simples, const cnwn_RegexpSimple * simples)
+{
+    int num_positions = 0;
+    for (int i = 0; i < num_simples; i++)
+        num_positions += simples[i].num_atoms + 1;
+    memset(dfa, 0, sizeof(cnwn_RegexpDfa));
+    if (num_positions > CNWN_REGEXP_MAX_DFA_POSITIONS)
+        return false;
+    int num_words = (num_positions + 63) / 64;
+    const cnwn_RegexpByteSet ** sets = malloc(sizeof(cnwn_RegexpByteSet *) * num_positions);
+    bool * stars = malloc(sizeof(bool) * num_positions);
+    uint8_t * finals = malloc(sizeof(uint8_t) * num_positions);
+    uint64_t * start = calloc(num_words * 3, sizeof(uint64_t));
+    uint64_t * unanchored = start + num_words;
+    uint64_t * next = unanchored + num_words;
+    int p = 0;
+    for (int i = 0; i < num_simples; i++) {
+        start[p / 64] |= (uint64_t)1 << (p % 64);
+        if (!simples[i].start_anchor)
+            unanchored[p / 64] |= (uint64_t)1 << (p % 64);
+        for (int j = 0; j < simples[i].num_atoms; j++, p++) {
+            sets[p] = simples[i].sets + j;
+            stars[p] = simples[i].stars[j];
+            finals[p] = 0;
+        }
+        sets[p] = NULL;
+        stars[p] = false;
+        finals[p++] = (simples[i].end_anchor ? CNWN_REGEXP_ACCEPT_END : CNWN_REGEXP_ACCEPT_NOW);
+    }
+    for (p = 0; p < num_positions - 1; p++) {
+        if (stars[p] && (start[p / 64] >> (p % 64)) & 1)
+            start[(p + 1) / 64] |= (uint64_t)1 << ((p + 1) % 64);
+        if (stars[p] && (unanchored[p / 64] >> (p % 64)) & 1)
+            unanchored[(p + 1) / 64] |= (uint64_t)1 << ((p + 1) % 64);
+    }
+
+    // Bytes no atom can tell apart share a class.
+    memset(dfa->classes, 0, sizeof(dfa->classes));
+    dfa->num_classes = 1;
+    for (p = 0; p < num_positions; p++) {
+        if (sets[p] == NULL)
+            continue;
+        int remap[512];
+        for (int i = 0; i < 512; i++)
+            remap[i] = -1;
+        int num_classes = 0;
+        for (int b = 0; b < 256; b++) {
+            int key = dfa->classes[b] * 2 + CNWN_REGEXP_BYTE_SET_HAS(sets[p], b);
+            if (remap[key] < 0)
+                remap[key] = num_classes++;
+            dfa->classes[b] = (uint8_t)remap[key];
+        }
+        dfa->num_classes = num_classes;
+    }
+    uint8_t representatives[256];
+    for (int b = 255; b >= 0; b--)
+        representatives[dfa->classes[b]] = (uint8_t)b;
+
+    int num_classes = dfa->num_classes;
+    int max_states = 64;
+    uint64_t * states = malloc(sizeof(uint64_t) * num_words * max_states);
+    dfa->transitions = malloc(sizeof(int) * num_classes * max_states);
+    dfa->accepts = malloc(sizeof(uint8_t) * max_states);
+    int table_size = CNWN_REGEXP_MAX_DFA_STATES * 2;
+    int * table = malloc(sizeof(int) * table_size);
+    for (int i = 0; i < table_size; i++)
+        table[i] = -1;
+    dfa->num_states = 0;
+    bool ok = true;
+    const uint64_t * add = start;
+    int * ret_state = NULL;
+    for (int s = -1; ok && s < dfa->num_states; s++) {
+        for (int c = (s < 0 ? num_classes - 1 : 0); ok && c < num_classes; c++) {
+            if (s >= 0) {
+                ret_state = dfa->transitions + s * num_classes + c;
+                if (dfa->accepts[s] & CNWN_REGEXP_ACCEPT_NOW) {
+                    // Matched already, the rest of the string doesn't matter.
+                    *ret_state = s;
+                    continue;
+                }
+                const uint64_t * current = states + s * num_words;
+                memcpy(next, unanchored, sizeof(uint64_t) * num_words);
+                for (p = 0; p < num_positions; p++) {
+                    if (((current[p / 64] >> (p % 64)) & 1) && sets[p] != NULL && CNWN_REGEXP_BYTE_SET_HAS(sets[p], representatives[c])) {
+                        if (stars[p])
+                            next[p / 64] |= (uint64_t)1 << (p % 64);
+                        next[(p + 1) / 64] |= (uint64_t)1 << ((p + 1) % 64);
+                    }
+                }
+                for (p = 0; p < num_positions - 1; p++)
+                    if (stars[p] && (next[p / 64] >> (p % 64)) & 1)
+                        next[(p + 1) / 64] |= (uint64_t)1 << ((p + 1) % 64);
+                add = next;
+            }
+            uint32_t slot = cnwn_regexp_dfa_hash(add, num_words) % table_size;
+            while (table[slot] >= 0 && memcmp(states + table[slot] * num_words, add, sizeof(uint64_t) * num_words) != 0)
+                slot = (slot + 1) % table_size;
+            if (table[slot] < 0) {
+                if (dfa->num_states >= CNWN_REGEXP_MAX_DFA_STATES) {
+                    ok = false;
+                    break;
+                }
+                if (dfa->num_states >= max_states) {
+                    max_states *= 2;
+                    states = realloc(states, sizeof(uint64_t) * num_words * max_states);
+                    dfa->transitions = realloc(dfa->transitions, sizeof(int) * num_classes * max_states);
+                    dfa->accepts = realloc(dfa->accepts, sizeof(uint8_t) * max_states);
+                    if (s >= 0)
+                        ret_state = dfa->transitions + s * num_classes + c;
+                }
+                int state = dfa->num_states++;
+                memcpy(states + state * num_words, add, sizeof(uint64_t) * num_words);
+                uint8_t accept = 0;
+                for (p = 0; p < num_positions; p++)
+                    if ((add[p / 64] >> (p % 64)) & 1)
+                        accept |= finals[p];
+                dfa->accepts[state] = accept;
+                table[slot] = state;
+            }
+            if (s >= 0)
+                *ret_state = table[slot];
+        }
+    }
+    free(table);
+    free(states);
+    free(start);
+    free(finals);
+    free(stars);
+    free(sets);
+    if (!ok) {
+        free(dfa->transitions);
+        free(dfa->accepts);
+        memset(dfa, 0, sizeof(cnwn_RegexpDfa));
+    }
+    return ok;
+}
+
+static void cnwn_regexp_dfa_deinit(cnwn_RegexpDfa * dfa)
+{
+    free(dfa->transitions);
+    free(dfa->accepts);
+}
+
+// True if any of the patterns the DFA was built from matches.
+static bool cnwn_regexp_dfa_match(const cnwn_RegexpDfa * dfa, const char * s)
+{
+    const int * transitions = dfa->transitions;
+    const uint8_t * accepts = dfa->accepts;
+    int num_classes = dfa->num_classes;
+    int state = 0;
+    if (accepts[state] & CNWN_REGEXP_ACCEPT_NOW)
+        return true;
+    for (const uint8_t * c = (const uint8_t *)s; *c != 0; c++) {
+        state = transitions[state * num_classes + dfa->classes[*c]];
+        if (accepts[state] & CNWN_REGEXP_ACCEPT_NOW)
+            return true;
+    }
+    return (accepts[state] & CNWN_REGEXP_ACCEPT_END) != 0;
+}
+
+static void cnwn_regexp_matcher_free(cnwn_RegexpMatcher * matcher)
+{
+    if (matcher == NULL)
+        return;
+    for (int i = 0; i < matcher->num_patterns; i++)
+        free(matcher->patterns[i]);
+    free(matcher->patterns);
+    for (int i = 0; i < matcher->num_literals; i++)
+        free(matcher->literals[i]);
+    free(matcher->literals);
+    free(matcher->literal_lengths);
+    free(matcher->literal_kinds);
+    free(matcher->literal_next);
+    cnwn_regexp_dfa_deinit(&matcher->dfa);
+    if (matcher->has_required_dfa)
+        cnwn_regexp_dfa_deinit(&matcher->required_dfa);
+    for (int i = 0; i < matcher->num_regexps; i++)
+        cnwn_strings_free(matcher->required_literals[i]);
+    free(matcher->required_literals);
+    free(matcher->regexp_indices);
+    free(matcher);
+}
+
+// The patterns are the same (non blank) strings the regexps were compiled from, in the same order.
+static cnwn_RegexpMatcher * cnwn_regexp_matcher_new(int num_patterns, const char ** patterns)
+{
+    cnwn_RegexpMatcher * matcher = calloc(1, sizeof(cnwn_RegexpMatcher));
+    matcher->num_patterns = num_patterns;
+    matcher->patterns = malloc(sizeof(char *) * CNWN_MAX(1, num_patterns));
+    matcher->literals = malloc(sizeof(char *) * CNWN_MAX(1, num_patterns));
+    matcher->literal_lengths = malloc(sizeof(int) * CNWN_MAX(1, num_patterns));
+    matcher->literal_kinds = malloc(sizeof(uint8_t) * CNWN_MAX(1, num_patterns));
+    matcher->literal_next = malloc(sizeof(int) * CNWN_MAX(1, num_patterns));
+    matcher->regexp_indices = malloc(sizeof(int) * CNWN_MAX(1, num_patterns));
+    matcher->required_literals = malloc(sizeof(char **) * CNWN_MAX(1, num_patterns));
+    for (int i = 0; i < 256; i++) {
+        matcher->start_heads[i] = -1;
+        matcher->end_heads[i] = -1;
+    }
+    cnwn_RegexpSimple * simples = malloc(sizeof(cnwn_RegexpSimple) * CNWN_MAX(1, num_patterns));
+    int * simple_indices = malloc(sizeof(int) * CNWN_MAX(1, num_patterns));
+    int num_simples = 0;
+    for (int i = 0; i < num_patterns; i++) {
+        matcher->patterns[i] = cnwn_strdup(patterns[i]);
+        cnwn_RegexpSimple * simple = simples + num_simples;
+        if (!cnwn_regexp_simple_init(simple, patterns[i])) {
+            int index = matcher->num_regexps++;
+            matcher->regexp_indices[index] = i;
+            matcher->required_literals[index] = cnwn_regexp_required_literals(patterns[i]);
+        } else if (simple->num_atoms == 0 && simple->start_anchor != simple->end_anchor) {
+            matcher->match_everything = true;
+            cnwn_regexp_simple_deinit(simple);
+        } else if (simple->is_literal && simple->num_atoms > 0 && (simple->start_anchor || simple->end_anchor)) {
+            int index = matcher->num_literals++;
+            matcher->literals[index] = cnwn_strdup(simple->literal);
+            matcher->literal_lengths[index] = simple->num_atoms;
+            if (simple->start_anchor) {
+                matcher->literal_kinds[index] = (simple->end_anchor ? CNWN_REGEXP_LITERAL_EXACT : CNWN_REGEXP_LITERAL_PREFIX);
+                matcher->literal_next[index] = matcher->start_heads[(uint8_t)simple->literal[0]];
+                matcher->start_heads[(uint8_t)simple->literal[0]] = index;
+            } else {
+                matcher->literal_kinds[index] = CNWN_REGEXP_LITERAL_SUFFIX;
+                matcher->literal_next[index] = matcher->end_heads[(uint8_t)simple->literal[simple->num_atoms - 1]];
+                matcher->end_heads[(uint8_t)simple->literal[simple->num_atoms - 1]] = index;
+            }
+            cnwn_regexp_simple_deinit(simple);
+        } else
+            simple_indices[num_simples++] = i;
+    }
+    if (num_simples > 0 && !cnwn_regexp_dfa_init(&matcher->dfa, num_simples, simples)) {
+        // Too many states, run them as regular expressions instead.
+        for (int i = 0; i < num_simples; i++) {
+            int index = matcher->num_regexps++;
+            matcher->regexp_indices[index] = simple_indices[i];
+            matcher->required_literals[index] = cnwn_regexp_required_literals(patterns[simple_indices[i]]);
+        }
+    }
+    for (int i = 0; i < num_simples; i++)
+        cnwn_regexp_simple_deinit(simples + i);
+    // When every regular expression requires some literal a string without any of them skips all of them.
+    int num_required = 0;
+    for (int i = 0; i < matcher->num_regexps && num_required >= 0; i++) {
+        if (matcher->required_literals[i] == NULL)
+            num_required = -1;
+        else
+            num_required += cnwn_strings_len(matcher->required_literals[i]);
+    }
+    if (num_required > 0) {
+        cnwn_RegexpSimple * required = malloc(sizeof(cnwn_RegexpSimple) * num_required);
+        num_required = 0;
+        for (int i = 0; i < matcher->num_regexps; i++)
+            for (char ** literal = matcher->required_literals[i]; *literal != NULL; literal++)
+                cnwn_regexp_simple_init_literal(required + num_required++, *literal);
+        matcher->has_required_dfa = cnwn_regexp_dfa_init(&matcher->required_dfa, num_required, required);
+        for (int i = 0; i < num_required; i++)
+            cnwn_regexp_simple_deinit(required + i);
+        free(required);
+    }
+    free(simple_indices);
+    free(simples);
+    return matcher;
+}
+
+static bool cnwn_regexp_matcher_match(const cnwn_RegexpMatcher * matcher, const cnwn_Regexp * regexps, const char * s)
+{
+    if (matcher->match_everything)
+        return true;
+    if (matcher->dfa.num_states > 0 && cnwn_regexp_dfa_match(&matcher->dfa, s))
+        return true;
+    if (matcher->num_literals <= 0 && matcher->num_regexps <= 0)
+        return false;
+    char lower[CNWN_REGEXP_MAX_FOLDED_SIZE];
+    int length = 0;
+    for (; s[length] != 0 && length < (int)sizeof(lower) - 1; length++)
+        lower[length] = cnwn_regexp_lower(s[length]);
+    lower[length] = 0;
+    if (s[length] != 0) {
+        // Too long for the buffer, let the regular expressions handle it.
+        for (int i = 0; i < matcher->num_patterns; i++)
+            if (cnwn_regexp_match(regexps + i, s))
+                return true;
+        return false;
+    }
+    if (length > 0) {
+        for (int i = matcher->start_heads[(uint8_t)lower[0]]; i >= 0; i = matcher->literal_next[i]) {
+            int literal_length = matcher->literal_lengths[i];
+            if (literal_length <= length && memcmp(lower, matcher->literals[i], literal_length) == 0
+                && (literal_length == length || matcher->literal_kinds[i] == CNWN_REGEXP_LITERAL_PREFIX))
+                return true;
+        }
+        for (int i = matcher->end_heads[(uint8_t)lower[length - 1]]; i >= 0; i = matcher->literal_next[i]) {
+            int literal_length = matcher->literal_lengths[i];
+            if (literal_length <= length && memcmp(lower + length - literal_length, matcher->literals[i], literal_length) == 0)
+                return true;
+        }
+    }
+    if (matcher->has_required_dfa && !cnwn_regexp_dfa_match(&matcher->required_dfa, lower))
+        return false;
+    for (int i = 0; i < matcher->num_regexps; i++) {
+        char ** required_literals = matcher->required_literals[i];
+        bool found = required_literals == NULL;
+        for (int j = 0; !found && required_literals[j] != NULL; j++)
+            found = strstr(lower, required_literals[j]) != NULL;
+        if (found && cnwn_regexp_match(regexps + matcher->regexp_indices[i], s))
+            return true;
+    }
+    return false;
+}
+
 int cnwn_regexp_init(cnwn_Regexp * regexp, const char * re)
 {
     regex_t regex;
@@ -53,6 +731,13 @@ cnwn_RegexpArray * cnwn_regexp_array_new(int num_strings, const char ** strings)
             free(array.regexps);
             array.regexps = NULL;
         }
+        const char ** patterns = malloc(sizeof(char *) * num_strings);
+        count = 0;
+        for (int i = 0; i < num_strings; i++)
+            if (!cnwn_strisblank(strings[i]))
+                patterns[count++] = strings[i];
+        array.matcher = cnwn_regexp_matcher_new(count, patterns);
+        free(patterns);
     }
     cnwn_RegexpArray * ret = malloc(sizeof(cnwn_RegexpArray));
     *ret = array;
@@ -85,6 +770,13 @@ cnwn_RegexpArray * cnwn_regexp_array_new2(const cnwn_StringArray * string_array)
             free(array.regexps);
             array.regexps = NULL;
         }
+        const char ** patterns = malloc(sizeof(char *) * num_strings);
+        count = 0;
+        for (int i = 0; i < num_strings; i++)
+            if (!cnwn_strisblank(cnwn_string_array_get(string_array, i)))
+                patterns[count++] = cnwn_string_array_get(string_array, i);
+        array.matcher = cnwn_regexp_matcher_new(count, patterns);
+        free(patterns);
     }
     cnwn_RegexpArray * ret = malloc(sizeof(cnwn_RegexpArray));
     *ret = array;
@@ -98,6 +790,7 @@ void cnwn_regexp_array_free(cnwn_RegexpArray * regexp_array)
             cnwn_regexp_deinit(regexp_array->regexps + i);
         free(regexp_array->regexps);
     }
+    cnwn_regexp_matcher_free(regexp_array->matcher);
     free(regexp_array);
 }
 
@@ -115,6 +808,15 @@ int cnwn_regexp_array_append(cnwn_RegexpArray * regexp_array, const char * re)
     regexp_array->regexps = realloc(regexp_array->regexps, sizeof(cnwn_Regexp) * (regexp_array->length + 1));
     regexp_array->regexps[regexp_array->length] = regexp;
     regexp_array->length++;
+    // Recompile the patterns together with the new one.
+    const char ** patterns = malloc(sizeof(char *) * regexp_array->length);
+    for (int i = 0; i < regexp_array->length - 1; i++)
+        patterns[i] = regexp_array->matcher->patterns[i];
+    patterns[regexp_array->length - 1] = re;
+    cnwn_RegexpMatcher * matcher = cnwn_regexp_matcher_new(regexp_array->length, patterns);
+    free(patterns);
+    cnwn_regexp_matcher_free(regexp_array->matcher);
+    regexp_array->matcher = matcher;
     return regexp_array->length;
 }
 
@@ -128,6 +830,8 @@ bool cnwn_regexp_array_match_all(const cnwn_RegexpArray * regexp_array, const ch
 
 bool cnwn_regexp_array_match_any(const cnwn_RegexpArray * regexp_array, const char * s)
 {
+    if (regexp_array->matcher != NULL && regexp_array->length > 0)
+        return cnwn_regexp_matcher_match(regexp_array->matcher, regexp_array->regexps, s);
     for (int i = 0; i < regexp_array->length; i++)
         if (cnwn_regexp_match(regexp_array->regexps + i, s))
             return true;
@@ -1,12 +1,75 @@
 #include "cnwn/resource.h"
 
-cnwn_ResourceHandler CNWN_RESOURCE_HANDLERS[CNWN_MAX_RESOURCE_TYPE] = {0};
+cnwn_ResourceHandler CNWN_RESOURCE_HANDLERS[CNWN_NUM_RESOURCE_TYPES] = {0};
+
+// Child names as stored are kept in one array of fixed size slots next to the resrefs.
+#define CNWN_RESOURCE_KEY_SIZE (CNWN_RESREF_MAX_LENGTH + 1)
+
+int cnwn_resource_set_handler(cnwn_ResourceType type, const cnwn_ResourceHandler * handler)
+{
+    if (!CNWN_RESOURCE_TYPE_VALID(type)) {
+        cnwn_set_error("invalid resource type (%d)", type);
+        return -1;
+    }
+    CNWN_RESOURCE_HANDLERS[CNWN_RESOURCE_TYPE_INDEX(type)] = *handler;
+    return 0;
+}
 
 static void cnwn_resource_array_deinit_elements(void * elements, int length)
 {
-    cnwn_Resource * resources = elements;
-    for (int i = 0; i < length; i++)
-        cnwn_resource_deinit(resources + i);
+    cnwn_Resource ** nodes = elements;
+    for (int i = 0; i < length; i++) {
+        cnwn_resource_deinit(nodes[i]);
+        free(nodes[i]);
+    }
+}
+
+static void cnwn_resource_entries_deinit(cnwn_ResourceEntries * entries)
+{
+    free(entries->types);
+    free(entries->compressions);
+    free(entries->offsets);
+    free(entries->sizes);
+    free(entries->uncompressed_sizes);
+    free(entries->names);
+    free(entries->keys);
+    free(entries->node_indices);
+    if (entries->paths != NULL) {
+        for (int i = 0; i < entries->length; i++)
+            free(entries->paths[i]);
+        free(entries->paths);
+    }
+    memset(entries, 0, sizeof(cnwn_ResourceEntries));
+}
+
+static void cnwn_resource_entries_append(cnwn_ResourceEntries * entries, cnwn_ResourceType type, const char * name, int64_t offset, int64_t size, cnwn_Compression compression, int64_t uncompressed_size, int node_index)
+{
+    if (entries->length >= entries->capacity) {
+        int capacity = (entries->capacity > 0 ? entries->capacity * 2 : 16);
+        entries->types = realloc(entries->types, sizeof(uint16_t) * capacity);
+        entries->compressions = realloc(entries->compressions, sizeof(uint8_t) * capacity);
+        entries->offsets = realloc(entries->offsets, sizeof(int64_t) * capacity);
+        entries->sizes = realloc(entries->sizes, sizeof(int64_t) * capacity);
+        entries->uncompressed_sizes = realloc(entries->uncompressed_sizes, sizeof(int64_t) * capacity);
+        entries->names = realloc(entries->names, sizeof(cnwn_ResRef) * capacity);
+        entries->keys = realloc(entries->keys, sizeof(char) * CNWN_RESOURCE_KEY_SIZE * capacity);
+        entries->node_indices = realloc(entries->node_indices, sizeof(int) * capacity);
+        if (entries->paths != NULL)
+            entries->paths = realloc(entries->paths, sizeof(char *) * capacity);
+        entries->capacity = capacity;
+    }
+    int i = entries->length;
+    entries->types[i] = (uint16_t)type;
+    entries->compressions[i] = (uint8_t)compression;
+    entries->offsets[i] = offset;
+    entries->sizes[i] = size;
+    entries->uncompressed_sizes[i] = uncompressed_size;
+    cnwn_resref_init(entries->names + i, name);
+    cnwn_strcpy(entries->keys + i * CNWN_RESOURCE_KEY_SIZE, CNWN_RESOURCE_KEY_SIZE, name, -1);
+    entries->node_indices[i] = node_index;
+    if (entries->paths != NULL)
+        entries->paths[i] = NULL;
+    entries->length++;
 }
 
 bool cnwn_resource_name_valid(const char * name, const cnwn_Version * version)
@@ -43,12 +106,14 @@ int cnwn_resource_init(cnwn_Resource * resource, cnwn_ResourceType type, const c
         return -1;
     }
     resource->type = type;
-    resource->name = cnwn_strdup(name);
+    cnwn_resref_init(&resource->name, name);
+    resource->key = cnwn_strdup(name != NULL ? name : "");
     resource->offset = offset;
     resource->size = size;
+    resource->uncompressed_size = size;
     resource->parent = parent;
-    cnwn_ContainerCallbacks cb_resources = {NULL, &cnwn_resource_array_deinit_elements, NULL};
-    cnwn_array_init(&resource->resources, sizeof(cnwn_Resource), &cb_resources);
+    cnwn_ContainerCallbacks cb_nodes = {NULL, &cnwn_resource_array_deinit_elements, NULL};
+    cnwn_array_init(&resource->nodes, sizeof(cnwn_Resource *), &cb_nodes);
     return 0;
 }
 
@@ -58,7 +123,7 @@ int cnwn_resource_init_from_file(cnwn_Resource * resource, cnwn_ResourceType typ
         return -1;
     const cnwn_ResourceHandler * handler = CNWN_RESOURCE_HANDLER(type);
     if (handler == NULL) {
-        cnwn_set_error("invalid type when getting handler (%s)", resource->name);
+        cnwn_set_error("invalid type when getting handler (%s)", resource->name.s);
         return -1;
     }
     if (handler->callbacks.f_init_from_file != NULL) {
@@ -71,16 +136,48 @@ int cnwn_resource_init_from_file(cnwn_Resource * resource, cnwn_ResourceType typ
     return 0;
 }
 
-int cnwn_resource_init_from_path(cnwn_Resource * resource, cnwn_Resource * parent, const char * path);
+int cnwn_resource_init_from_path(cnwn_Resource * resource, cnwn_Resource * parent, const char * path)
+{
+    int isdirectory = cnwn_file_system_isdirectory(path);
+    if (isdirectory < 0) {
+        cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+        return -1;
+    }
+    cnwn_ResourceType type = (isdirectory > 0 ? CNWN_RESOURCE_TYPE_DIRECTORY : cnwn_resource_type_from_path(path));
+    int64_t size = 0;
+    if (isdirectory == 0 && (size = cnwn_file_system_size(path, false)) < 0) {
+        cnwn_set_error("%s (size %s)", cnwn_get_error(), path);
+        return -1;
+    }
+    char name[CNWN_PATH_MAX_SIZE];
+    cnwn_path_filenamepart(name, sizeof(name), path);
+    if (cnwn_resource_init(resource, type, name, 0, size, parent) < 0) {
+        cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+        return -1;
+    }
+    resource->path = cnwn_strdup(path);
+    const cnwn_ResourceHandler * handler = CNWN_RESOURCE_HANDLER(type);
+    if (handler->callbacks.f_init_from_path != NULL) {
+        if (handler->callbacks.f_init_from_path(resource, path) < 0) {
+            cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+            cnwn_resource_deinit(resource);
+            return -1;
+        }
+    }
+    return 0;
+}
 
 void cnwn_resource_deinit(cnwn_Resource * resource)
 {
     const cnwn_ResourceHandler * handler = CNWN_RESOURCE_HANDLER(resource->type);
     if (handler != NULL && handler->callbacks.f_deinit != NULL) 
         handler->callbacks.f_deinit(resource);
-    cnwn_array_deinit(&resource->resources);
-    if (resource->name != NULL)
-        free(resource->name);
+    cnwn_array_deinit(&resource->nodes);
+    cnwn_resource_entries_deinit(&resource->entries);
+    if (resource->path != NULL)
+        free(resource->path);
+    if (resource->key != NULL)
+        free(resource->key);
     memset(resource, 0, sizeof(cnwn_Resource));
 }
 
@@ -96,49 +193,139 @@ cnwn_ResourceTypeInfo cnwn_resource_get_type_info(const cnwn_Resource * resource
 
 const char * cnwn_resource_get_name(const cnwn_Resource * resource)
 {
-    return resource->name != NULL ? resource->name : "";
+    return (resource->key != NULL ? resource->key : resource->name.s);
 }
 
 int cnwn_resource_get_path(const cnwn_Resource * resource, int max_size, char * ret_path)
 {
-    char filename[CNWN_PATH_MAX_SIZE];
-    if (resource->parent != NULL && resource->parent->parent != NULL) {
-        char parentpath[CNWN_PATH_MAX_SIZE];
-        cnwn_resource_get_path(resource->parent, sizeof(parentpath), parentpath);
-        snprintf(filename, sizeof(filename), "%s%s%s.%s", parentpath, CNWN_PATH_SEPARATOR, resource->name, CNWN_RESOURCE_TYPE_EXTENSION(resource->type));
-    } else
-        snprintf(filename, sizeof(filename), "%s.%s", resource->name, CNWN_RESOURCE_TYPE_EXTENSION(resource->type));
-    return cnwn_strcpy(ret_path, max_size, filename, -1);
+    if (ret_path == NULL) {
+        char path[CNWN_PATH_MAX_SIZE];
+        return cnwn_resource_get_path(resource, CNWN_MIN(max_size, (int)sizeof(path)), path);
+    }
+    if (max_size > 0)
+        ret_path[0] = 0;
+    int parent_length = 0;
+    if (resource->parent != NULL && resource->parent->parent != NULL)
+        parent_length = cnwn_resource_get_path(resource->parent, max_size, ret_path);
+    return cnwn_resource_get_path2(resource, parent_length, max_size, ret_path);
 }
 
-int cnwn_resource_get_num_resources(const cnwn_Resource * resource)
+int cnwn_resource_get_path2(const cnwn_Resource * resource, int parent_length, int max_size, char * ret_path)
 {
-    return cnwn_array_get_length(&resource->resources);
+    int length = parent_length;
+    if (length > 0)
+        length += cnwn_strcpy(ret_path + length, max_size - length, CNWN_PATH_SEPARATOR, -1);
+    length += cnwn_strcpy(ret_path + length, max_size - length, cnwn_resource_get_name(resource), -1);
+    length += cnwn_strcpy(ret_path + length, max_size - length, ".", 1);
+    length += cnwn_strcpy(ret_path + length, max_size - length, CNWN_RESOURCE_TYPE_EXTENSION(resource->type), -1);
+    return length;
 }
 
-cnwn_Resource * cnwn_resource_get_resource(const cnwn_Resource * resource, int index)
+int cnwn_resource_add_resource(cnwn_Resource * resource, cnwn_ResourceType type, const char * name, int64_t offset, int64_t size, cnwn_Compression compression, int64_t uncompressed_size, cnwn_File * input_f)
 {
-    return cnwn_array_element_ptr(&resource->resources, index);
+    return cnwn_resource_add_resource2(resource, type, name, offset, size, compression, uncompressed_size, NULL, input_f);
 }
 
-int64_t cnwn_resource_extract(const cnwn_Resource * resource, cnwn_File * input_f, cnwn_File * output_f)
+int cnwn_resource_add_resource2(cnwn_Resource * resource, cnwn_ResourceType type, const char * name, int64_t offset, int64_t size, cnwn_Compression compression, int64_t uncompressed_size, const char * path, cnwn_File * input_f)
 {
-    if (cnwn_file_seek(input_f, resource->offset) < 0) {
-        cnwn_set_error("%s (seek)", cnwn_get_error());
+    const cnwn_ResourceHandler * handler = CNWN_RESOURCE_HANDLER(type);
+    if (handler == NULL) {
+        cnwn_set_error("invalid resource type %d (%s)", type, name);
         return -1;
     }
-    int64_t ret;
+    if (offset < 0 || size < 0 || uncompressed_size < 0) {
+        cnwn_set_error("invalid offset or size %"PRId64" %"PRId64" (%s)", offset, size, name);
+        return -1;
+    }
+    int node_index = -1;
+    if (input_f != NULL && compression == CNWN_COMPRESSION_NONE && handler->callbacks.f_init_from_file != NULL) {
+        cnwn_Resource * node = malloc(sizeof(cnwn_Resource));
+        if (cnwn_file_seek(input_f, offset) < 0 || cnwn_resource_init_from_file(node, type, name, offset, size, resource, input_f) < 0) {
+            free(node);
+            return -1;
+        }
+        if (path != NULL)
+            node->path = cnwn_strdup(path);
+        node_index = cnwn_array_get_length(&resource->nodes);
+        cnwn_array_append(&resource->nodes, 1, &node);
+        type = node->type;
+    }
+    cnwn_ResourceEntries * entries = &resource->entries;
+    cnwn_resource_entries_append(entries, type, name, offset, size, compression, uncompressed_size, node_index);
+    // The path column is only allocated once a child has a file of its own.
+    if (path != NULL) {
+        if (entries->paths == NULL)
+            entries->paths = calloc(entries->capacity, sizeof(char *));
+        entries->paths[entries->length - 1] = cnwn_strdup(path);
+    }
+    return entries->length - 1;
+}
+
+int cnwn_resource_get_num_resources(const cnwn_Resource * resource)
+{
+    return resource->entries.length;
+}
+
+const cnwn_Resource * cnwn_resource_get_resource(const cnwn_Resource * resource, int index, cnwn_Resource * ret_resource)
+{
+    const cnwn_ResourceEntries * entries = &resource->entries;
+    index = CNWN_WRAP_INDEX(index, entries->length);
+    if (index < 0 || index >= entries->length)
+        return NULL;
+    if (entries->node_indices[index] >= 0)
+        return *(cnwn_Resource **)cnwn_array_element_ptr(&resource->nodes, entries->node_indices[index]);
+    memset(ret_resource, 0, sizeof(cnwn_Resource));
+    ret_resource->type = entries->types[index];
+    ret_resource->name = entries->names[index];
+    ret_resource->key = entries->keys + index * CNWN_RESOURCE_KEY_SIZE;
+    ret_resource->offset = entries->offsets[index];
+    ret_resource->size = entries->sizes[index];
+    ret_resource->compression = entries->compressions[index];
+    ret_resource->uncompressed_size = entries->uncompressed_sizes[index];
+    ret_resource->path = (entries->paths != NULL ? entries->paths[index] : NULL);
+    ret_resource->parent = (cnwn_Resource *)resource;
+    return ret_resource;
+}
+
+int cnwn_resource_find_resource(const cnwn_Resource * resource, cnwn_ResourceType type, const cnwn_ResRef * name)
+{
+    const cnwn_ResourceEntries * entries = &resource->entries;
+    for (int i = cnwn_resref_find(entries->names, 0, entries->length, name); i >= 0; i = cnwn_resref_find(entries->names, i + 1, entries->length, name))
+        if (entries->types[i] == type)
+            return i;
+    return -1;
+}
+
+int64_t cnwn_resource_extract(const cnwn_Resource * resource, cnwn_File * input_f, cnwn_File * output_f)
+{
     const cnwn_ResourceHandler * handler = CNWN_RESOURCE_HANDLER(resource->type);
     if (handler == NULL) {
-        cnwn_set_error("invalid type when getting handler (%s)", resource->name);
+        cnwn_set_error("invalid type when getting handler (%s)", resource->name.s);
         return -1;
     }
-    if (handler->callbacks.f_extract != NULL)
+    cnwn_File * path_f = NULL;
+    if (resource->path != NULL) {
+        path_f = cnwn_file_open(resource->path, "r");
+        if (path_f == NULL) {
+            cnwn_set_error("%s (open %s)", cnwn_get_error(), resource->path);
+            return -1;
+        }
+        input_f = path_f;
+    }
+    int64_t ret;
+    if (cnwn_file_seek(input_f, resource->offset) < 0) {
+        cnwn_set_error("%s (seek)", cnwn_get_error());
+        ret = -1;
+    } else if (resource->compression != CNWN_COMPRESSION_NONE)
+        ret = cnwn_compression_decompress_file(input_f, resource->size, output_f);
+    else if (handler->callbacks.f_extract != NULL)
         ret = handler->callbacks.f_extract(resource, input_f, output_f);
     else
         ret = cnwn_file_copy(input_f, resource->size, output_f);
+    if (path_f != NULL)
+        cnwn_file_close(path_f);
     if (ret < 0) {
-        cnwn_set_error("%s (%s)", cnwn_get_error(), resource->name);
+        cnwn_set_error("%s (%s)", cnwn_get_error(), resource->name.s);
         return -1;
     }
     return ret;
@@ -172,7 +359,7 @@ int64_t cnwn_resource_archive(const cnwn_Resource * resource, cnwn_File * input_
     int64_t ret;
     const cnwn_ResourceHandler * handler = CNWN_RESOURCE_HANDLER(resource->type);
     if (handler == NULL) {
-        cnwn_set_error("invalid type when getting handler (%s)", resource->name);
+        cnwn_set_error("invalid type when getting handler (%s)", resource->name.s);
         return -1;
     }
     if (handler != NULL && handler->callbacks.f_archive != NULL)
@@ -180,7 +367,7 @@ int64_t cnwn_resource_archive(const cnwn_Resource * resource, cnwn_File * input_
     else
         ret = cnwn_file_copy(input_f, resource->size, output_f);
     if (ret < 0) {
-        cnwn_set_error("%s (%s)", cnwn_get_error(), resource->name);
+        cnwn_set_error("%s (%s)", cnwn_get_error(), resource->name.s);
         return -1;
     }
     return ret;
@@ -208,7 +395,7 @@ int64_t cnwn_resource_meta_file_extract(const cnwn_Resource * resource, int inde
 {
     const cnwn_ResourceHandler * handler = CNWN_RESOURCE_HANDLER(resource->type);
     if (handler == NULL) {
-        cnwn_set_error("invalid type when getting handler (%s)", resource->name);
+        cnwn_set_error("invalid type when getting handler (%s)", resource->name.s);
         return -1;
     }
     int num_meta_files = cnwn_resource_get_num_meta_files(resource);
@@ -220,7 +407,7 @@ int64_t cnwn_resource_meta_file_extract(const cnwn_Resource * resource, int inde
         if (handler->callbacks.f_meta_file_extract != NULL)
             ret = handler->callbacks.f_meta_file_extract(resource, use_index, input_f, output_f);
         if (ret < 0) 
-            cnwn_set_error("%s (%s)", cnwn_get_error(), resource->name);
+            cnwn_set_error("%s (%s)", cnwn_get_error(), resource->name.s);
         return ret;
     }
     cnwn_set_error("invalid meta file index (%d)", index);
@@ -250,14 +437,14 @@ int64_t cnwn_resource_meta_file_archive(const cnwn_Resource * resource, int inde
 {
     const cnwn_ResourceHandler * handler = CNWN_RESOURCE_HANDLER(resource->type);
     if (handler == NULL) {
-        cnwn_set_error("invalid type when getting handler (%s)", resource->name);
+        cnwn_set_error("invalid type when getting handler (%s)", resource->name.s);
         return -1;
     }
     int64_t ret = 0;
     if (handler->callbacks.f_meta_file_archive != NULL)
         ret = handler->callbacks.f_meta_file_archive(resource, index, input_f, output_f);
     if (ret < 0) 
-        cnwn_set_error("%s (%s)", cnwn_get_error(), resource->name);        
+        cnwn_set_error("%s (%s)", cnwn_get_error(), resource->name.s);        
     return ret;
 }
 
@@ -1,6 +1,6 @@
 #include "cnwn/resource_type.h"
 
-const cnwn_ResourceTypeInfo CNWN_RESOURCE_TYPE_INFOS[CNWN_MAX_RESOURCE_TYPE] = {
+const cnwn_ResourceTypeInfo CNWN_RESOURCE_TYPE_INFOS[CNWN_NUM_RESOURCE_TYPES] = {
     {0, "res", ""},
     {1, "bmp", "bitmap image"},
     {2, "mve", "infinity engine movie"},
@@ -12,14 +12,11 @@ const cnwn_ResourceTypeInfo CNWN_RESOURCE_TYPE_INFOS[CNWN_MAX_RESOURCE_TYPE] = {
     {8, "mp3", "mp3 audio"},
     {9, "mpg", "mpeg video"},
     {10, "txt", "text"},
-    [11 ... 1999] = {-1, NULL, NULL},
     {2000, "plh", ""},
     {2001, "tex", "texture"},
     {2002, "mdl", ""},
     {2003, "thg", ""},
-    {-1, NULL, NULL},
     {2005, "fnt", "font"},
-    {-1, NULL, NULL},
     {2007, "lua", "lua script"},
     {2008, "slt", ""},
     {2009, "nss", "nwscript source"},
@@ -32,14 +29,12 @@ const cnwn_ResourceTypeInfo CNWN_RESOURCE_TYPE_INFOS[CNWN_MAX_RESOURCE_TYPE] = {
     {2016, "wok", "asian cooking utensil"},
     {2017, "2da", "text based data"},
     {2018, "tlk", "talk table"},
-    [2019 ... 2021] = {-1, NULL, NULL},
     {2022, "txi", ""},
     {2023, "git", "area dynamic"},
     {2024, "bti", ""},
     {2025, "uti", "item"},
     {2026, "btc", ""},
     {2027, "utc", "creature"},
-    {-1, NULL, NULL},
     {2029, "dlg", "conversation"},
     {2030, "itp", ""},
     {2031, "btt", ""},
@@ -79,7 +74,6 @@ const cnwn_ResourceTypeInfo CNWN_RESOURCE_TYPE_INFOS[CNWN_MAX_RESOURCE_TYPE] = {
     {2065, "ptm", ""},
     {2066, "ptt", ""},
     {2067, "bak", ""},
-    [2068 ... 2999] = {-1, NULL, NULL},
     {3000, "osc", ""},
     {3001, "usc", ""},
     {3002, "trn", "uncompiled terrain"},
@@ -106,7 +100,6 @@ const cnwn_ResourceTypeInfo CNWN_RESOURCE_TYPE_INFOS[CNWN_MAX_RESOURCE_TYPE] = {
     {3033, "ptx", ""},
     {3034, "ltx", ""},
     {3035, "trx", "compiled terrain"},
-    [3036 ... 3999] = {-1, NULL, NULL},
     {4000, "mdb", ""},
     {4001, "mda", ""},
     {4002, "spt", ""},
@@ -115,36 +108,243 @@ const cnwn_ResourceTypeInfo CNWN_RESOURCE_TYPE_INFOS[CNWN_MAX_RESOURCE_TYPE] = {
     {4005, "fxe", "lip sync"},
     {4007, "jpg", "jpeg image"},
     {4008, "pwc", "persistant world"},
-    [4009 ... 9995] = {-1, NULL, NULL},
     {9996, "ids", ""},
     {9997, "erf", "erf container"},
     {9998, "bif", "bif container"},
-    {9999, "key", ""}
+    {9999, "key", ""},
+    {10000, "dir", "directory"}
+};
+
+// Generated from CNWN_RESOURCE_TYPE_INFOS, test-resource_type checks that every type maps to its info.
+const uint8_t CNWN_RESOURCE_TYPE_PAGES[CNWN_RESOURCE_TYPE_NUM_PAGES] = {
+    [0] = 1,
+    [31] = 2,
+    [32] = 3,
+    [46] = 4,
+    [47] = 5,
+    [62] = 6,
+    [156] = 7
+};
+
+const uint8_t CNWN_RESOURCE_TYPE_PAGE_INDICES[][CNWN_RESOURCE_TYPE_PAGE_SIZE] = {
+    {0},
+    {
+        1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        12, 13, 14, 15, 0, 16, 0, 17, 18, 19, 20, 21, 22, 23, 24, 25,
+        26, 27, 28, 0, 0, 0, 29, 30, 31, 32, 33, 34, 0, 35, 36, 37,
+        38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53
+    },
+    {
+        54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69,
+        70, 71, 72, 73, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 74, 75, 76, 77, 78, 79, 80, 81
+    },
+    {
+        82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95, 96, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 97, 98, 99, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        100, 101, 102, 103, 104, 105, 0, 106, 107, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 108, 109, 110, 111,
+        112, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    }
 };
 
 const cnwn_ResourceTypeInfo CNWN_RESOURCE_TYPE_INFO_INVALID = {-1, NULL, NULL};
 
+// Extensions are all three characters, packed into 24 bits they hash to unique slots with this multiplier
+// (found by search). Slots hold the type plus one so zero is empty, a hit is verified against the extension.
+#define CNWN_RESOURCE_TYPE_KEY(a, b, c) ((uint32_t)(uint8_t)(a) | ((uint32_t)(uint8_t)(b) << 8) | ((uint32_t)(uint8_t)(c) << 16))
+#define CNWN_RESOURCE_TYPE_HASH(key) ((uint32_t)((uint32_t)(key) * UINT32_C(0xb3cfb711)) >> 23)
+#define CNWN_RESOURCE_TYPE_NUM_EXTENSION_SLOTS 512
+#define CNWN_RESOURCE_TYPE_SLOT(a, b, c, t) [CNWN_RESOURCE_TYPE_HASH(CNWN_RESOURCE_TYPE_KEY(a, b, c))] = (t) + 1
+
+static const uint16_t CNWN_RESOURCE_TYPE_EXTENSION_SLOTS[CNWN_RESOURCE_TYPE_NUM_EXTENSION_SLOTS] = {
+    CNWN_RESOURCE_TYPE_SLOT('r', 'e', 's', CNWN_RESOURCE_TYPE_RES),
+    CNWN_RESOURCE_TYPE_SLOT('b', 'm', 'p', CNWN_RESOURCE_TYPE_BMP),
+    CNWN_RESOURCE_TYPE_SLOT('m', 'v', 'e', CNWN_RESOURCE_TYPE_MVE),
+    CNWN_RESOURCE_TYPE_SLOT('t', 'g', 'a', CNWN_RESOURCE_TYPE_TGA),
+    CNWN_RESOURCE_TYPE_SLOT('w', 'a', 'v', CNWN_RESOURCE_TYPE_WAV),
+    CNWN_RESOURCE_TYPE_SLOT('w', 'f', 'x', CNWN_RESOURCE_TYPE_WFX),
+    CNWN_RESOURCE_TYPE_SLOT('p', 'l', 't', CNWN_RESOURCE_TYPE_PLT),
+    CNWN_RESOURCE_TYPE_SLOT('i', 'n', 'i', CNWN_RESOURCE_TYPE_INI),
+    CNWN_RESOURCE_TYPE_SLOT('m', 'p', '3', CNWN_RESOURCE_TYPE_MP3),
+    CNWN_RESOURCE_TYPE_SLOT('m', 'p', 'g', CNWN_RESOURCE_TYPE_MPG),
+    CNWN_RESOURCE_TYPE_SLOT('t', 'x', 't', CNWN_RESOURCE_TYPE_TXT),
+    CNWN_RESOURCE_TYPE_SLOT('p', 'l', 'h', CNWN_RESOURCE_TYPE_PLH),
+    CNWN_RESOURCE_TYPE_SLOT('t', 'e', 'x', CNWN_RESOURCE_TYPE_TEX),
+    CNWN_RESOURCE_TYPE_SLOT('m', 'd', 'l', CNWN_RESOURCE_TYPE_MDL),
+    CNWN_RESOURCE_TYPE_SLOT('t', 'h', 'g', CNWN_RESOURCE_TYPE_THG),
+    CNWN_RESOURCE_TYPE_SLOT('f', 'n', 't', CNWN_RESOURCE_TYPE_FNT),
+    CNWN_RESOURCE_TYPE_SLOT('l', 'u', 'a', CNWN_RESOURCE_TYPE_LUA),
+    CNWN_RESOURCE_TYPE_SLOT('s', 'l', 't', CNWN_RESOURCE_TYPE_SLT),
+    CNWN_RESOURCE_TYPE_SLOT('n', 's', 's', CNWN_RESOURCE_TYPE_NSS),
+    CNWN_RESOURCE_TYPE_SLOT('n', 'c', 's', CNWN_RESOURCE_TYPE_NCS),
+    CNWN_RESOURCE_TYPE_SLOT('m', 'o', 'd', CNWN_RESOURCE_TYPE_MOD),
+    CNWN_RESOURCE_TYPE_SLOT('a', 'r', 'e', CNWN_RESOURCE_TYPE_ARE),
+    CNWN_RESOURCE_TYPE_SLOT('s', 'e', 't', CNWN_RESOURCE_TYPE_SET),
+    CNWN_RESOURCE_TYPE_SLOT('i', 'f', 'o', CNWN_RESOURCE_TYPE_IFO),
+    CNWN_RESOURCE_TYPE_SLOT('b', 'i', 'c', CNWN_RESOURCE_TYPE_BIC),
+    CNWN_RESOURCE_TYPE_SLOT('w', 'o', 'k', CNWN_RESOURCE_TYPE_WOK),
+    CNWN_RESOURCE_TYPE_SLOT('2', 'd', 'a', CNWN_RESOURCE_TYPE_2DA),
+    CNWN_RESOURCE_TYPE_SLOT('t', 'l', 'k', CNWN_RESOURCE_TYPE_TLK),
+    CNWN_RESOURCE_TYPE_SLOT('t', 'x', 'i', CNWN_RESOURCE_TYPE_TXI),
+    CNWN_RESOURCE_TYPE_SLOT('g', 'i', 't', CNWN_RESOURCE_TYPE_GIT),
+    CNWN_RESOURCE_TYPE_SLOT('b', 't', 'i', CNWN_RESOURCE_TYPE_BTI),
+    CNWN_RESOURCE_TYPE_SLOT('u', 't', 'i', CNWN_RESOURCE_TYPE_UTI),
+    CNWN_RESOURCE_TYPE_SLOT('b', 't', 'c', CNWN_RESOURCE_TYPE_BTC),
+    CNWN_RESOURCE_TYPE_SLOT('u', 't', 'c', CNWN_RESOURCE_TYPE_UTC),
+    CNWN_RESOURCE_TYPE_SLOT('d', 'l', 'g', CNWN_RESOURCE_TYPE_DLG),
+    CNWN_RESOURCE_TYPE_SLOT('i', 't', 'p', CNWN_RESOURCE_TYPE_ITP),
+    CNWN_RESOURCE_TYPE_SLOT('b', 't', 't', CNWN_RESOURCE_TYPE_BTT),
+    CNWN_RESOURCE_TYPE_SLOT('u', 't', 't', CNWN_RESOURCE_TYPE_UTT),
+    CNWN_RESOURCE_TYPE_SLOT('d', 'd', 's', CNWN_RESOURCE_TYPE_DDS),
+    CNWN_RESOURCE_TYPE_SLOT('b', 't', 's', CNWN_RESOURCE_TYPE_BTS),
+    CNWN_RESOURCE_TYPE_SLOT('u', 't', 's', CNWN_RESOURCE_TYPE_UTS),
+    CNWN_RESOURCE_TYPE_SLOT('l', 't', 'r', CNWN_RESOURCE_TYPE_LTR),
+    CNWN_RESOURCE_TYPE_SLOT('g', 'f', 'f', CNWN_RESOURCE_TYPE_GFF),
+    CNWN_RESOURCE_TYPE_SLOT('f', 'a', 'c', CNWN_RESOURCE_TYPE_FAC),
+    CNWN_RESOURCE_TYPE_SLOT('b', 't', 'e', CNWN_RESOURCE_TYPE_BTE),
+    CNWN_RESOURCE_TYPE_SLOT('u', 't', 'e', CNWN_RESOURCE_TYPE_UTE),
+    CNWN_RESOURCE_TYPE_SLOT('b', 't', 'd', CNWN_RESOURCE_TYPE_BTD),
+    CNWN_RESOURCE_TYPE_SLOT('u', 't', 'd', CNWN_RESOURCE_TYPE_UTD),
+    CNWN_RESOURCE_TYPE_SLOT('b', 't', 'p', CNWN_RESOURCE_TYPE_BTP),
+    CNWN_RESOURCE_TYPE_SLOT('u', 't', 'p', CNWN_RESOURCE_TYPE_UTP),
+    CNWN_RESOURCE_TYPE_SLOT('d', 'f', 't', CNWN_RESOURCE_TYPE_DFT),
+    CNWN_RESOURCE_TYPE_SLOT('g', 'i', 'c', CNWN_RESOURCE_TYPE_GIC),
+    CNWN_RESOURCE_TYPE_SLOT('g', 'u', 'i', CNWN_RESOURCE_TYPE_GUI),
+    CNWN_RESOURCE_TYPE_SLOT('c', 's', 's', CNWN_RESOURCE_TYPE_CSS),
+    CNWN_RESOURCE_TYPE_SLOT('c', 'c', 's', CNWN_RESOURCE_TYPE_CCS),
+    CNWN_RESOURCE_TYPE_SLOT('b', 't', 'm', CNWN_RESOURCE_TYPE_BTM),
+    CNWN_RESOURCE_TYPE_SLOT('u', 't', 'm', CNWN_RESOURCE_TYPE_UTM),
+    CNWN_RESOURCE_TYPE_SLOT('d', 'w', 'k', CNWN_RESOURCE_TYPE_DWK),
+    CNWN_RESOURCE_TYPE_SLOT('p', 'w', 'k', CNWN_RESOURCE_TYPE_PWK),
+    CNWN_RESOURCE_TYPE_SLOT('b', 't', 'g', CNWN_RESOURCE_TYPE_BTG),
+    CNWN_RESOURCE_TYPE_SLOT('u', 't', 'g', CNWN_RESOURCE_TYPE_UTG),
+    CNWN_RESOURCE_TYPE_SLOT('j', 'r', 'l', CNWN_RESOURCE_TYPE_JRL),
+    CNWN_RESOURCE_TYPE_SLOT('s', 'a', 'v', CNWN_RESOURCE_TYPE_SAV),
+    CNWN_RESOURCE_TYPE_SLOT('u', 't', 'w', CNWN_RESOURCE_TYPE_UTW),
+    CNWN_RESOURCE_TYPE_SLOT('4', 'p', 'c', CNWN_RESOURCE_TYPE_4PC),
+    CNWN_RESOURCE_TYPE_SLOT('s', 's', 'f', CNWN_RESOURCE_TYPE_SSF),
+    CNWN_RESOURCE_TYPE_SLOT('h', 'a', 'k', CNWN_RESOURCE_TYPE_HAK),
+    CNWN_RESOURCE_TYPE_SLOT('n', 'w', 'm', CNWN_RESOURCE_TYPE_NWM),
+    CNWN_RESOURCE_TYPE_SLOT('b', 'i', 'k', CNWN_RESOURCE_TYPE_BIK),
+    CNWN_RESOURCE_TYPE_SLOT('n', 'd', 'b', CNWN_RESOURCE_TYPE_NDB),
+    CNWN_RESOURCE_TYPE_SLOT('p', 't', 'm', CNWN_RESOURCE_TYPE_PTM),
+    CNWN_RESOURCE_TYPE_SLOT('p', 't', 't', CNWN_RESOURCE_TYPE_PTT),
+    CNWN_RESOURCE_TYPE_SLOT('b', 'a', 'k', CNWN_RESOURCE_TYPE_BAK),
+    CNWN_RESOURCE_TYPE_SLOT('o', 's', 'c', CNWN_RESOURCE_TYPE_OSC),
+    CNWN_RESOURCE_TYPE_SLOT('u', 's', 'c', CNWN_RESOURCE_TYPE_USC),
+    CNWN_RESOURCE_TYPE_SLOT('t', 'r', 'n', CNWN_RESOURCE_TYPE_TRN),
+    CNWN_RESOURCE_TYPE_SLOT('u', 't', 'r', CNWN_RESOURCE_TYPE_UTR),
+    CNWN_RESOURCE_TYPE_SLOT('u', 'e', 'n', CNWN_RESOURCE_TYPE_UEN),
+    CNWN_RESOURCE_TYPE_SLOT('u', 'l', 't', CNWN_RESOURCE_TYPE_ULT),
+    CNWN_RESOURCE_TYPE_SLOT('s', 'e', 'f', CNWN_RESOURCE_TYPE_SEF),
+    CNWN_RESOURCE_TYPE_SLOT('p', 'f', 'x', CNWN_RESOURCE_TYPE_PFX),
+    CNWN_RESOURCE_TYPE_SLOT('c', 'a', 'm', CNWN_RESOURCE_TYPE_CAM),
+    CNWN_RESOURCE_TYPE_SLOT('l', 'f', 'x', CNWN_RESOURCE_TYPE_LFX),
+    CNWN_RESOURCE_TYPE_SLOT('b', 'f', 'x', CNWN_RESOURCE_TYPE_BFX),
+    CNWN_RESOURCE_TYPE_SLOT('u', 'p', 'e', CNWN_RESOURCE_TYPE_UPE),
+    CNWN_RESOURCE_TYPE_SLOT('r', 'o', 's', CNWN_RESOURCE_TYPE_ROS),
+    CNWN_RESOURCE_TYPE_SLOT('r', 's', 't', CNWN_RESOURCE_TYPE_RST),
+    CNWN_RESOURCE_TYPE_SLOT('i', 'f', 'x', CNWN_RESOURCE_TYPE_IFX),
+    CNWN_RESOURCE_TYPE_SLOT('p', 'f', 'b', CNWN_RESOURCE_TYPE_PFB),
+    CNWN_RESOURCE_TYPE_SLOT('z', 'i', 'p', CNWN_RESOURCE_TYPE_ZIP),
+    CNWN_RESOURCE_TYPE_SLOT('w', 'm', 'p', CNWN_RESOURCE_TYPE_WMP),
+    CNWN_RESOURCE_TYPE_SLOT('b', 'b', 'x', CNWN_RESOURCE_TYPE_BBX),
+    CNWN_RESOURCE_TYPE_SLOT('t', 'f', 'x', CNWN_RESOURCE_TYPE_TFX),
+    CNWN_RESOURCE_TYPE_SLOT('w', 'l', 'k', CNWN_RESOURCE_TYPE_WLK),
+    CNWN_RESOURCE_TYPE_SLOT('x', 'm', 'l', CNWN_RESOURCE_TYPE_XML),
+    CNWN_RESOURCE_TYPE_SLOT('s', 'c', 'c', CNWN_RESOURCE_TYPE_SCC),
+    CNWN_RESOURCE_TYPE_SLOT('p', 't', 'x', CNWN_RESOURCE_TYPE_PTX),
+    CNWN_RESOURCE_TYPE_SLOT('l', 't', 'x', CNWN_RESOURCE_TYPE_LTX),
+    CNWN_RESOURCE_TYPE_SLOT('t', 'r', 'x', CNWN_RESOURCE_TYPE_TRX),
+    CNWN_RESOURCE_TYPE_SLOT('m', 'd', 'b', CNWN_RESOURCE_TYPE_MDB),
+    CNWN_RESOURCE_TYPE_SLOT('m', 'd', 'a', CNWN_RESOURCE_TYPE_MDA),
+    CNWN_RESOURCE_TYPE_SLOT('s', 'p', 't', CNWN_RESOURCE_TYPE_SPT),
+    CNWN_RESOURCE_TYPE_SLOT('g', 'r', '2', CNWN_RESOURCE_TYPE_GR2),
+    CNWN_RESOURCE_TYPE_SLOT('f', 'x', 'a', CNWN_RESOURCE_TYPE_FXA),
+    CNWN_RESOURCE_TYPE_SLOT('f', 'x', 'e', CNWN_RESOURCE_TYPE_FXE),
+    CNWN_RESOURCE_TYPE_SLOT('j', 'p', 'g', CNWN_RESOURCE_TYPE_JPG),
+    CNWN_RESOURCE_TYPE_SLOT('p', 'w', 'c', CNWN_RESOURCE_TYPE_PWC),
+    CNWN_RESOURCE_TYPE_SLOT('i', 'd', 's', CNWN_RESOURCE_TYPE_IDS),
+    CNWN_RESOURCE_TYPE_SLOT('e', 'r', 'f', CNWN_RESOURCE_TYPE_ERF),
+    CNWN_RESOURCE_TYPE_SLOT('b', 'i', 'f', CNWN_RESOURCE_TYPE_BIF),
+    CNWN_RESOURCE_TYPE_SLOT('k', 'e', 'y', CNWN_RESOURCE_TYPE_KEY),
+};
+
+static char cnwn_resource_type_lower(char c)
+{
+    return (c >= 'A' && c <= 'Z' ? c + 32 : c);
+}
+
 cnwn_ResourceType cnwn_resource_type_from_path(const char * path)
 {
-    char extension[CNWN_PATH_MAX_SIZE];
-    if (cnwn_path_extensionpart(extension, sizeof(extension), path) == 0)
-        cnwn_path_filenamepart(extension, sizeof(extension), path);
-    else
-        cnwn_path_filenamepart(extension, sizeof(extension), extension);
-    cnwn_strstrip(extension, sizeof(extension), extension);
-    cnwn_strlower(extension, sizeof(extension), extension);
-    for (int i = 0; i < CNWN_MAX_RESOURCE_TYPE; i++) {
-        if (!cnwn_strisblank(CNWN_RESOURCE_TYPE_INFOS[i].extension)
-            && cnwn_strcmp(CNWN_RESOURCE_TYPE_INFOS[i].extension, extension) == 0)
-            return i;
+    if (path == NULL)
+        return CNWN_RESOURCE_TYPE_INVALID;
+    // One pass for the start of the filename (after the last unescaped separator) and the first dot in it.
+    char separator = CNWN_PATH_SEPARATOR[0];
+    char escape = CNWN_PATH_ESCAPE[0];
+    int start = 0;
+    int dot = -1;
+    int num_escapes = 0;
+    int i = 0;
+    for (; path[i] != 0; i++) {
+        if (path[i] == separator && num_escapes % 2 == 0) {
+            start = i + 1;
+            dot = -1;
+        } else if (path[i] == '.' && dot < 0)
+            dot = i;
+        num_escapes = (path[i] == escape ? num_escapes + 1 : 0);
+    }
+    // The first extension, or the whole filename if there is no dot.
+    int end = i;
+    if (dot >= 0) {
+        start = dot + 1;
+        for (end = start; path[end] != 0 && path[end] != '.'; end++);
     }
-    return CNWN_RESOURCE_TYPE_INVALID;
+    while (start < end && (unsigned char)path[start] <= 32)
+        start++;
+    while (end > start && (unsigned char)path[end - 1] <= 32)
+        end--;
+    if (end - start != 3)
+        return CNWN_RESOURCE_TYPE_INVALID;
+    char a = cnwn_resource_type_lower(path[start]);
+    char b = cnwn_resource_type_lower(path[start + 1]);
+    char c = cnwn_resource_type_lower(path[start + 2]);
+    int slot = CNWN_RESOURCE_TYPE_EXTENSION_SLOTS[CNWN_RESOURCE_TYPE_HASH(CNWN_RESOURCE_TYPE_KEY(a, b, c))];
+    if (slot == 0)
+        return CNWN_RESOURCE_TYPE_INVALID;
+    const char * extension = CNWN_RESOURCE_TYPE_INFOS[CNWN_RESOURCE_TYPE_INDEX(slot - 1)].extension;
+    if (extension[0] != a || extension[1] != b || extension[2] != c || extension[3] != 0)
+        return CNWN_RESOURCE_TYPE_INVALID;
+    return slot - 1;
 }
 
 cnwn_ResourceTypeInfo cnwn_resource_type_info_from_path(const char * path)
 {
     cnwn_ResourceType t = cnwn_resource_type_from_path(path);
-    if (CNWN_RESOURCE_TYPE_VALID(t))
-        return CNWN_RESOURCE_TYPE_INFOS[t];
-    return CNWN_RESOURCE_TYPE_INFO_INVALID;
+    return CNWN_RESOURCE_TYPE_INFO(t);
 }
@@ -0,0 +1,199 @@
+#include "cnwn/resref.h"
+
+#ifdef CNWN_X86
+#include <immintrin.h>
+#endif
+
+static uint64_t cnwn_resref_word(const cnwn_ResRef * resref, int index)
+{
+    uint64_t ret;
+    memcpy(&ret, resref->s + index * 8, 8);
+    return ret;
+}
+
+int cnwn_resref_init(cnwn_ResRef * resref, const char * s)
+{
+    return cnwn_resref_init2(resref, s, INT_MAX);
+}
+
+// Reading CNWN_RESREF_MAX_LENGTH bytes from @p s can't fault if they are all on the same page.
+#define CNWN_RESREF_SAME_PAGE(s) (((uintptr_t)(s) & 4095) <= 4096 - CNWN_RESREF_MAX_LENGTH)
+
+static int cnwn_resref_init_scalar(cnwn_ResRef * resref, const char * s, int length)
+{
+    memset(resref, 0, sizeof(cnwn_ResRef));
+    int ret = 0;
+    for (; ret < length && ret < CNWN_RESREF_MAX_LENGTH && s[ret] != 0; ret++)
+        resref->s[ret] = s[ret] + ((unsigned char)(s[ret] - 'A') < 26 ? 32 : 0);
+    resref->length = (uint8_t)ret;
+    return ret;
+}
+
+static int cnwn_resref_find_scalar(const cnwn_ResRef * resrefs, int index, int length, const cnwn_ResRef * resref)
+{
+    for (int i = index; i < length; i++)
+        if (cnwn_resref_equal(resrefs + i, resref))
+            return i;
+    return -1;
+}
+
+#ifdef CNWN_X86
+
+// The whole key is loaded at once (see CNWN_RESREF_SAME_PAGE), bytes from the terminator on are cleared and
+// 'A'..'Z' get 32 added. Signed compares, bytes >= 128 are negative and never in 'A'..'Z'.
+__attribute__((target("sse2"), no_sanitize_address))
+static int cnwn_resref_init_sse2(cnwn_ResRef * resref, const char * s, int length)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v0 = _mm_loadu_si128((const __m128i *)s);
+    __m128i v1 = _mm_loadu_si128((const __m128i *)(s + 16));
+    uint32_t zeros = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v0, zero)) | ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v1, zero)) << 16);
+    int ret = CNWN_MIN((zeros != 0 ? __builtin_ctz(zeros) : CNWN_RESREF_MAX_LENGTH), length);
+    const __m128i count = _mm_set1_epi8((char)ret);
+    const __m128i before_a = _mm_set1_epi8('A' - 1);
+    const __m128i after_z = _mm_set1_epi8('Z' + 1);
+    const __m128i bit = _mm_set1_epi8(32);
+    __m128i index = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    v0 = _mm_and_si128(v0, _mm_cmplt_epi8(index, count));
+    v0 = _mm_add_epi8(v0, _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi8(v0, before_a), _mm_cmplt_epi8(v0, after_z)), bit));
+    index = _mm_add_epi8(index, _mm_set1_epi8(16));
+    v1 = _mm_and_si128(v1, _mm_cmplt_epi8(index, count));
+    v1 = _mm_add_epi8(v1, _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi8(v1, before_a), _mm_cmplt_epi8(v1, after_z)), bit));
+    _mm_storeu_si128((__m128i *)resref->s, v0);
+    _mm_storeu_si128((__m128i *)(resref->s + 16), v1);
+    resref->s[CNWN_RESREF_MAX_LENGTH] = 0;
+    resref->length = (uint8_t)ret;
+    return ret;
+}
+
+__attribute__((target("avx2"), no_sanitize_address))
+static int cnwn_resref_init_avx2(cnwn_ResRef * resref, const char * s, int length)
+{
+    __m256i v = _mm256_loadu_si256((const __m256i *)s);
+    uint32_t zeros = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+    int ret = CNWN_MIN((zeros != 0 ? __builtin_ctz(zeros) : CNWN_RESREF_MAX_LENGTH), length);
+    const __m256i index = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                           16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+    v = _mm256_and_si256(v, _mm256_cmpgt_epi8(_mm256_set1_epi8((char)ret), index));
+    __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+    _mm256_storeu_si256((__m256i *)resref->s, _mm256_add_epi8(v, _mm256_and_si256(upper, _mm256_set1_epi8(32))));
+    resref->s[CNWN_RESREF_MAX_LENGTH] = 0;
+    resref->length = (uint8_t)ret;
+    return ret;
+}
+
+__attribute__((target("sse2")))
+static int cnwn_resref_find_sse2(const cnwn_ResRef * resrefs, int index, int length, const cnwn_ResRef * resref)
+{
+    const __m128i n0 = _mm_loadu_si128((const __m128i *)resref->s);
+    const __m128i n1 = _mm_loadu_si128((const __m128i *)(resref->s + 16));
+    for (int i = index; i < length; i++) {
+        __m128i e = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)resrefs[i].s), n0),
+                                  _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(resrefs[i].s + 16)), n1));
+        if (_mm_movemask_epi8(e) == 0xffff)
+            return i;
+    }
+    return -1;
+}
+
+// Four candidates per iteration, the loads are independent so they overlap.
+__attribute__((target("avx2")))
+static int cnwn_resref_find_avx2(const cnwn_ResRef * resrefs, int index, int length, const cnwn_ResRef * resref)
+{
+    const __m256i n = _mm256_loadu_si256((const __m256i *)resref->s);
+    int i = index;
+    for (; i + 4 <= length; i += 4) {
+        int m0 = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)resrefs[i].s), n));
+        int m1 = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)resrefs[i + 1].s), n));
+        int m2 = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)resrefs[i + 2].s), n));
+        int m3 = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)resrefs[i + 3].s), n));
+        if ((m0 == -1) | (m1 == -1) | (m2 == -1) | (m3 == -1))
+            return (m0 == -1 ? i : (m1 == -1 ? i + 1 : (m2 == -1 ? i + 2 : i + 3)));
+    }
+    for (; i < length; i++)
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)resrefs[i].s), n)) == -1)
+            return i;
+    return -1;
+}
+
+#endif
+
+int cnwn_resref_init2(cnwn_ResRef * resref, const char * s, int length)
+{
+    if (s == NULL || length <= 0) {
+        memset(resref, 0, sizeof(cnwn_ResRef));
+        return 0;
+    }
+    int ret = -1;
+#ifdef CNWN_X86
+    if (CNWN_RESREF_SAME_PAGE(s)) {
+        int features = cnwn_cpu_features();
+        if (features & CNWN_CPU_FEATURE_AVX2)
+            ret = cnwn_resref_init_avx2(resref, s, length);
+        else if (features & CNWN_CPU_FEATURE_SSE2)
+            ret = cnwn_resref_init_sse2(resref, s, length);
+    }
+#endif
+    if (ret < 0)
+        ret = cnwn_resref_init_scalar(resref, s, length);
+    // Count the rest of a truncated string.
+    if (ret == CNWN_RESREF_MAX_LENGTH && length > CNWN_RESREF_MAX_LENGTH)
+        ret += cnwn_strnlen(s + CNWN_RESREF_MAX_LENGTH, length - CNWN_RESREF_MAX_LENGTH);
+    return ret;
+}
+
+bool cnwn_resref_equal(const cnwn_ResRef * resref, const cnwn_ResRef * other)
+{
+    uint64_t diff = 0;
+    for (int i = 0; i < CNWN_RESREF_NUM_WORDS; i++)
+        diff |= cnwn_resref_word(resref, i) ^ cnwn_resref_word(other, i);
+    return diff == 0;
+}
+
+int cnwn_resref_compare(const cnwn_ResRef * resref, const cnwn_ResRef * other)
+{
+    // Zero padding makes a shorter resref sort before a longer one with the same start.
+    for (int i = 0; i < CNWN_RESREF_NUM_WORDS; i++)
+        if (cnwn_resref_word(resref, i) != cnwn_resref_word(other, i))
+            return memcmp(resref->s + i * 8, other->s + i * 8, 8);
+    return 0;
+}
+
+uint32_t cnwn_resref_hash(const cnwn_ResRef * resref)
+{
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ resref->length;
+    for (int i = 0; i < CNWN_RESREF_NUM_WORDS; i++) {
+        h = (h ^ cnwn_resref_word(resref, i)) * 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 31;
+    }
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+int cnwn_resref_strcmpi(const char * s, const char * o)
+{
+    cnwn_ResRef rs, ro;
+    cnwn_resref_init(&rs, s);
+    cnwn_resref_init(&ro, o);
+    return cnwn_resref_compare(&rs, &ro);
+}
+
+uint32_t cnwn_resref_strhashi(const char * s)
+{
+    cnwn_ResRef resref;
+    cnwn_resref_init(&resref, s);
+    return cnwn_resref_hash(&resref);
+}
+
+int cnwn_resref_find(const cnwn_ResRef * resrefs, int index, int length, const cnwn_ResRef * resref)
+{
+    if (index < 0)
+        index = 0;
+#ifdef CNWN_X86
+    int features = cnwn_cpu_features();
+    if (features & CNWN_CPU_FEATURE_AVX2)
+        return cnwn_resref_find_avx2(resrefs, index, length, resref);
+    else if (features & CNWN_CPU_FEATURE_SSE2)
+        return cnwn_resref_find_sse2(resrefs, index, length, resref);
+#endif
+    return cnwn_resref_find_scalar(resrefs, index, length, resref);
+}
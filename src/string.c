@@ -1,5 +1,9 @@
 #include "cnwn/string.h"
 
+#ifdef CNWN_X86
+#include <immintrin.h>
+#endif
+
 static bool cnwn_str_detect_esc(const char * s, int index, const char * esc, int esclen)
 {
     bool escaped = false;
@@ -543,6 +547,38 @@ int cnwn_strnoctl(char * r, int max_size, const char * s)
     return soffset;
 }
 
+int cnwn_strformatint(char * r, int max_size, int64_t i)
+{
+    static const char digit_pairs[201] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    // Written backwards two digits at a time, the magnitude is unsigned so INT64_MIN works.
+    char tmps[20];
+    int offset = sizeof(tmps);
+    uint64_t u = (i < 0 ? 0 - (uint64_t)i : (uint64_t)i);
+    while (u >= 100) {
+        int pair = (int)(u % 100) * 2;
+        u /= 100;
+        tmps[--offset] = digit_pairs[pair + 1];
+        tmps[--offset] = digit_pairs[pair];
+    }
+    if (u >= 10) {
+        tmps[--offset] = digit_pairs[u * 2 + 1];
+        tmps[--offset] = digit_pairs[u * 2];
+    } else
+        tmps[--offset] = (char)('0' + u);
+    if (i < 0)
+        tmps[--offset] = '-';
+    int length = (int)sizeof(tmps) - offset;
+    if (r != NULL && max_size > 0) {
+        int copy_length = CNWN_MIN(length, max_size - 1);
+        memcpy(r, tmps + offset, copy_length);
+        r[copy_length] = 0;
+    }
+    return length;
+}
+
 
 int cnwn_strinsert_va(char * r, int max_size, const char * s, int index, const char * format, va_list args)
 {
@@ -1141,3 +1177,173 @@ bool cnwn_strtobool(const char * s, bool errvalue)
         return ret;
     return errvalue;
 }
+
+static void cnwn_string_tokenizer_block_scalar(const char * p, char separator, uint64_t * ret_ws, uint64_t * ret_nl, uint64_t * ret_quote)
+{
+    uint64_t ws = 0, nl = 0, quote = 0;
+    for (int i = 0; i < CNWN_STRING_TOKENIZER_BLOCK_SIZE; i++) {
+        char c = p[i];
+        uint64_t bit = (uint64_t)1 << i;
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f' || (c == separator && separator != 0))
+            ws |= bit;
+        else if (c == '\n')
+            nl |= bit;
+        else if (c == '"')
+            quote |= bit;
+    }
+    *ret_ws = ws;
+    *ret_nl = nl;
+    *ret_quote = quote;
+}
+
+#ifdef CNWN_X86
+
+__attribute__((target("sse2")))
+static void cnwn_string_tokenizer_block_sse2(const char * p, char separator, uint64_t * ret_ws, uint64_t * ret_nl, uint64_t * ret_quote)
+{
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i vt = _mm_set1_epi8('\v');
+    const __m128i ff = _mm_set1_epi8('\f');
+    const __m128i sep = _mm_set1_epi8(separator != 0 ? separator : ' ');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i dquote = _mm_set1_epi8('"');
+    uint64_t ws = 0, nl = 0, quote = 0;
+    for (int i = 0; i < CNWN_STRING_TOKENIZER_BLOCK_SIZE; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        __m128i w = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+                                 _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, vt)));
+        w = _mm_or_si128(w, _mm_or_si128(_mm_cmpeq_epi8(v, ff), _mm_cmpeq_epi8(v, sep)));
+        ws |= (uint64_t)(uint16_t)_mm_movemask_epi8(w) << i;
+        nl |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)) << i;
+        quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, dquote)) << i;
+    }
+    *ret_ws = ws;
+    *ret_nl = nl;
+    *ret_quote = quote;
+}
+
+__attribute__((target("avx2")))
+static void cnwn_string_tokenizer_block_avx2(const char * p, char separator, uint64_t * ret_ws, uint64_t * ret_nl, uint64_t * ret_quote)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i vt = _mm256_set1_epi8('\v');
+    const __m256i ff = _mm256_set1_epi8('\f');
+    const __m256i sep = _mm256_set1_epi8(separator != 0 ? separator : ' ');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i dquote = _mm256_set1_epi8('"');
+    uint64_t ws = 0, nl = 0, quote = 0;
+    for (int i = 0; i < CNWN_STRING_TOKENIZER_BLOCK_SIZE; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+        __m256i w = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+                                    _mm256_or_si256(_mm256_cmpeq_epi8(v, cr), _mm256_cmpeq_epi8(v, vt)));
+        w = _mm256_or_si256(w, _mm256_or_si256(_mm256_cmpeq_epi8(v, ff), _mm256_cmpeq_epi8(v, sep)));
+        ws |= (uint64_t)(uint32_t)_mm256_movemask_epi8(w) << i;
+        nl |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, newline)) << i;
+        quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, dquote)) << i;
+    }
+    *ret_ws = ws;
+    *ret_nl = nl;
+    *ret_quote = quote;
+}
+
+#endif
+
+void cnwn_string_tokenizer_init(cnwn_StringTokenizer * tokenizer, const char * data, int64_t size, int flags, char separator)
+{
+    memset(tokenizer, 0, sizeof(cnwn_StringTokenizer));
+    tokenizer->data = data;
+    tokenizer->size = CNWN_MAX(0, size);
+    tokenizer->flags = flags;
+    tokenizer->separator = separator;
+    tokenizer->block_function = &cnwn_string_tokenizer_block_scalar;
+#ifdef CNWN_X86
+    if (!(flags & CNWN_STRING_TOKENIZER_FLAG_SCALAR)) {
+        int features = cnwn_cpu_features();
+        if (features & CNWN_CPU_FEATURE_AVX2)
+            tokenizer->block_function = &cnwn_string_tokenizer_block_avx2;
+        else if (features & CNWN_CPU_FEATURE_SSE2)
+            tokenizer->block_function = &cnwn_string_tokenizer_block_sse2;
+    }
+#endif
+    tokenizer->block_offset = -CNWN_STRING_TOKENIZER_BLOCK_SIZE;
+}
+
+static void cnwn_string_tokenizer_load_block(cnwn_StringTokenizer * tokenizer, int64_t pos)
+{
+    tokenizer->block_offset = pos;
+    int64_t available = tokenizer->size - pos;
+    if (available >= CNWN_STRING_TOKENIZER_BLOCK_SIZE) {
+        tokenizer->block_function(tokenizer->data + pos, tokenizer->separator, &tokenizer->block_ws, &tokenizer->block_nl, &tokenizer->block_quote);
+        tokenizer->block_end = 0;
+    } else {
+        char tmp[CNWN_STRING_TOKENIZER_BLOCK_SIZE];
+        memset(tmp, 0, sizeof(tmp));
+        memcpy(tmp, tokenizer->data + pos, available);
+        tokenizer->block_function(tmp, tokenizer->separator, &tokenizer->block_ws, &tokenizer->block_nl, &tokenizer->block_quote);
+        tokenizer->block_end = ~(uint64_t)0 << available;
+        tokenizer->block_ws &= ~tokenizer->block_end;
+    }
+}
+
+// Find the first position >= pos that is not whitespace (mode 0), whitespace/newline (mode 1) or quote/newline (mode 2).
+static int64_t cnwn_string_tokenizer_find(cnwn_StringTokenizer * tokenizer, int64_t pos, int mode)
+{
+    while (pos < tokenizer->size) {
+        if (pos < tokenizer->block_offset || pos >= tokenizer->block_offset + CNWN_STRING_TOKENIZER_BLOCK_SIZE)
+            cnwn_string_tokenizer_load_block(tokenizer, pos);
+        uint64_t mask;
+        if (mode == 0)
+            mask = ~tokenizer->block_ws;
+        else if (mode == 1)
+            mask = tokenizer->block_ws | tokenizer->block_nl | tokenizer->block_end;
+        else
+            mask = tokenizer->block_quote | tokenizer->block_nl | tokenizer->block_end;
+        mask >>= (pos - tokenizer->block_offset);
+        if (mask != 0)
+            return CNWN_MIN(pos + __builtin_ctzll(mask), tokenizer->size);
+        pos = tokenizer->block_offset + CNWN_STRING_TOKENIZER_BLOCK_SIZE;
+    }
+    return tokenizer->size;
+}
+
+int cnwn_string_tokenizer_next(cnwn_StringTokenizer * tokenizer, int max_tokens, cnwn_StringToken * ret_tokens)
+{
+    int ret = 0;
+    const char * data = tokenizer->data;
+    while (ret < max_tokens) {
+        int64_t pos = cnwn_string_tokenizer_find(tokenizer, tokenizer->pos, 0);
+        if (pos >= tokenizer->size) {
+            tokenizer->pos = tokenizer->size;
+            break;
+        }
+        if (data[pos] == '\n') {
+            tokenizer->line++;
+            tokenizer->pos = pos + 1;
+            continue;
+        }
+        cnwn_StringToken * token = ret_tokens + ret++;
+        token->line = tokenizer->line;
+        int64_t end;
+        if (data[pos] == '"' && (tokenizer->flags & CNWN_STRING_TOKENIZER_FLAG_QUOTES)) {
+            end = cnwn_string_tokenizer_find(tokenizer, pos + 1, 2);
+            token->offset = pos + 1;
+            token->quoted = true;
+        } else {
+            end = cnwn_string_tokenizer_find(tokenizer, pos, 1);
+            token->offset = pos;
+            token->quoted = false;
+        }
+        token->length = (int)(end - token->offset);
+        if (end < tokenizer->size) {
+            if (data[end] == '\n')
+                tokenizer->line++;
+            tokenizer->pos = end + 1;
+        } else
+            tokenizer->pos = tokenizer->size;
+    }
+    return ret;
+}
@@ -0,0 +1,280 @@
+#include "cnwn/texture.h"
+#include "cnwn/endian.h"
+
+static const char * CNWN_TEXTURE_FORMAT_NAMES[] = {"unknown", "DXT1", "DXT3", "DXT5", "L8", "indexed8", "RGB16", "RGB24", "RGBA32", "PLT"};
+
+static uint32_t cnwn_texture_read_u32(const uint8_t * p)
+{
+    uint32_t ret;
+    memcpy(&ret, p, sizeof(ret));
+    return (uint32_t)cnwn_endian_ltoh32((int32_t)ret);
+}
+
+static uint16_t cnwn_texture_read_u16(const uint8_t * p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static int64_t cnwn_texture_level_size(cnwn_TextureFormat format, int width, int height)
+{
+    int64_t blocks = (int64_t)CNWN_MAX(1, (width + 3) / 4) * CNWN_MAX(1, (height + 3) / 4);
+    int64_t pixels = (int64_t)width * height;
+    switch (format) {
+        case CNWN_TEXTURE_FORMAT_DXT1:
+            return blocks * 8;
+        case CNWN_TEXTURE_FORMAT_DXT3:
+        case CNWN_TEXTURE_FORMAT_DXT5:
+            return blocks * 16;
+        case CNWN_TEXTURE_FORMAT_L8:
+        case CNWN_TEXTURE_FORMAT_INDEXED8:
+            return pixels;
+        case CNWN_TEXTURE_FORMAT_RGB16:
+        case CNWN_TEXTURE_FORMAT_PLT:
+            return pixels * 2;
+        case CNWN_TEXTURE_FORMAT_RGB24:
+            return pixels * 3;
+        case CNWN_TEXTURE_FORMAT_RGBA32:
+            return pixels * 4;
+        default:
+            return 0;
+    }
+}
+
+static void cnwn_texture_finish(cnwn_TextureInfo * info)
+{
+    bool block_compressed = (info->format == CNWN_TEXTURE_FORMAT_DXT1 || info->format == CNWN_TEXTURE_FORMAT_DXT3 || info->format == CNWN_TEXTURE_FORMAT_DXT5);
+    int width = info->width;
+    int height = info->height;
+    info->data_size = 0;
+    info->vram_size = 0;
+    for (int i = 0; i < info->num_mipmaps; i++) {
+        info->data_size += cnwn_texture_level_size(info->format, width, height);
+        width = CNWN_MAX(1, width / 2);
+        height = CNWN_MAX(1, height / 2);
+    }
+    if (block_compressed) {
+        info->vram_size = info->data_size;
+        return;
+    }
+    width = info->width;
+    height = info->height;
+    for (;;) {
+        info->vram_size += (int64_t)width * height * 4;
+        if (width == 1 && height == 1)
+            break;
+        width = CNWN_MAX(1, width / 2);
+        height = CNWN_MAX(1, height / 2);
+    }
+}
+
+static bool cnwn_texture_valid_size(uint32_t width, uint32_t height)
+{
+    return (width > 0 && height > 0 && width <= 65536 && height <= 65536);
+}
+
+static int cnwn_texture_probe_dds(const uint8_t * p, int64_t data_size, cnwn_TextureInfo * ret_info)
+{
+    if (data_size < CNWN_TEXTURE_DDS_HEADER_SIZE) {
+        cnwn_set_error("not enough data for DDS header (%"PRId64" bytes)", data_size);
+        return -1;
+    }
+    uint32_t flags = cnwn_texture_read_u32(p + 8);
+    uint32_t height = cnwn_texture_read_u32(p + 12);
+    uint32_t width = cnwn_texture_read_u32(p + 16);
+    uint32_t num_mipmaps = cnwn_texture_read_u32(p + 28);
+    uint32_t pf_flags = cnwn_texture_read_u32(p + 80);
+    uint32_t bits = cnwn_texture_read_u32(p + 88);
+    if (!cnwn_texture_valid_size(width, height)) {
+        cnwn_set_error("invalid DDS size (%ux%u)", width, height);
+        return -1;
+    }
+    ret_info->width = (int)width;
+    ret_info->height = (int)height;
+    ret_info->num_mipmaps = ((flags & 0x20000) && num_mipmaps > 0 ? (int)CNWN_MIN(num_mipmaps, 32) : 1);
+    if (pf_flags & 0x4) {
+        if (memcmp(p + 84, "DXT1", 4) == 0)
+            ret_info->format = CNWN_TEXTURE_FORMAT_DXT1;
+        else if (memcmp(p + 84, "DXT2", 4) == 0 || memcmp(p + 84, "DXT3", 4) == 0)
+            ret_info->format = CNWN_TEXTURE_FORMAT_DXT3;
+        else if (memcmp(p + 84, "DXT4", 4) == 0 || memcmp(p + 84, "DXT5", 4) == 0)
+            ret_info->format = CNWN_TEXTURE_FORMAT_DXT5;
+    } else if (pf_flags & 0x40) {
+        if (bits == 32)
+            ret_info->format = CNWN_TEXTURE_FORMAT_RGBA32;
+        else if (bits == 24)
+            ret_info->format = CNWN_TEXTURE_FORMAT_RGB24;
+        else if (bits == 16)
+            ret_info->format = CNWN_TEXTURE_FORMAT_RGB16;
+    } else if ((pf_flags & 0x20000) && bits == 8)
+        ret_info->format = CNWN_TEXTURE_FORMAT_L8;
+    cnwn_texture_finish(ret_info);
+    return 1;
+}
+
+static int cnwn_texture_probe_bioware_dds(const uint8_t * p, int64_t data_size, int64_t resource_size, cnwn_TextureInfo * ret_info)
+{
+    if (data_size < CNWN_TEXTURE_BIOWARE_DDS_HEADER_SIZE) {
+        cnwn_set_error("not enough data for DDS header (%"PRId64" bytes)", data_size);
+        return -1;
+    }
+    uint32_t width = cnwn_texture_read_u32(p);
+    uint32_t height = cnwn_texture_read_u32(p + 4);
+    uint32_t colors = cnwn_texture_read_u32(p + 8);
+    if (!cnwn_texture_valid_size(width, height)) {
+        cnwn_set_error("invalid DDS size (%ux%u)", width, height);
+        return -1;
+    }
+    if (colors != 3 && colors != 4) {
+        cnwn_set_error("invalid DDS color count (%u)", colors);
+        return -1;
+    }
+    ret_info->width = (int)width;
+    ret_info->height = (int)height;
+    ret_info->format = (colors == 3 ? CNWN_TEXTURE_FORMAT_DXT1 : CNWN_TEXTURE_FORMAT_DXT5);
+    int64_t remaining = resource_size - CNWN_TEXTURE_BIOWARE_DDS_HEADER_SIZE;
+    int w = (int)width;
+    int h = (int)height;
+    ret_info->num_mipmaps = 0;
+    for (;;) {
+        int64_t level_size = cnwn_texture_level_size(ret_info->format, w, h);
+        if (level_size > remaining)
+            break;
+        remaining -= level_size;
+        ret_info->num_mipmaps++;
+        if (w == 1 && h == 1)
+            break;
+        w = CNWN_MAX(1, w / 2);
+        h = CNWN_MAX(1, h / 2);
+    }
+    ret_info->num_mipmaps = CNWN_MAX(1, ret_info->num_mipmaps);
+    cnwn_texture_finish(ret_info);
+    return 1;
+}
+
+static int cnwn_texture_probe_tga(const uint8_t * p, int64_t data_size, cnwn_TextureInfo * ret_info)
+{
+    if (data_size < CNWN_TEXTURE_TGA_HEADER_SIZE) {
+        cnwn_set_error("not enough data for TGA header (%"PRId64" bytes)", data_size);
+        return -1;
+    }
+    int image_type = p[2];
+    int width = cnwn_texture_read_u16(p + 12);
+    int height = cnwn_texture_read_u16(p + 14);
+    int bits = p[16];
+    if (!cnwn_texture_valid_size(width, height)) {
+        cnwn_set_error("invalid TGA size (%dx%d)", width, height);
+        return -1;
+    }
+    switch (image_type & ~8) {
+        case 1:
+            ret_info->format = CNWN_TEXTURE_FORMAT_INDEXED8;
+            break;
+        case 2:
+            if (bits == 32)
+                ret_info->format = CNWN_TEXTURE_FORMAT_RGBA32;
+            else if (bits == 24)
+                ret_info->format = CNWN_TEXTURE_FORMAT_RGB24;
+            else if (bits == 15 || bits == 16)
+                ret_info->format = CNWN_TEXTURE_FORMAT_RGB16;
+            else {
+                cnwn_set_error("invalid TGA pixel depth (%d)", bits);
+                return -1;
+            }
+            break;
+        case 3:
+            ret_info->format = CNWN_TEXTURE_FORMAT_L8;
+            break;
+        default:
+            cnwn_set_error("invalid TGA image type (%d)", image_type);
+            return -1;
+    }
+    ret_info->width = width;
+    ret_info->height = height;
+    ret_info->num_mipmaps = 1;
+    ret_info->compressed = (image_type & 8) != 0;
+    cnwn_texture_finish(ret_info);
+    return 1;
+}
+
+static int cnwn_texture_probe_plt(const uint8_t * p, int64_t data_size, cnwn_TextureInfo * ret_info)
+{
+    if (data_size < CNWN_TEXTURE_PLT_HEADER_SIZE) {
+        cnwn_set_error("not enough data for PLT header (%"PRId64" bytes)", data_size);
+        return -1;
+    }
+    if (memcmp(p, "PLT V1  ", 8) != 0) {
+        cnwn_set_error("invalid PLT type and version (%.8s)", (const char *)p);
+        return -1;
+    }
+    uint32_t width = cnwn_texture_read_u32(p + 16);
+    uint32_t height = cnwn_texture_read_u32(p + 20);
+    if (!cnwn_texture_valid_size(width, height)) {
+        cnwn_set_error("invalid PLT size (%ux%u)", width, height);
+        return -1;
+    }
+    ret_info->width = (int)width;
+    ret_info->height = (int)height;
+    ret_info->num_mipmaps = 1;
+    ret_info->format = CNWN_TEXTURE_FORMAT_PLT;
+    cnwn_texture_finish(ret_info);
+    return 1;
+}
+
+const char * cnwn_texture_format_name(cnwn_TextureFormat format)
+{
+    if (format >= CNWN_TEXTURE_FORMAT_UNKNOWN && format <= CNWN_TEXTURE_FORMAT_PLT)
+        return CNWN_TEXTURE_FORMAT_NAMES[format];
+    return CNWN_TEXTURE_FORMAT_NAMES[0];
+}
+
+int cnwn_texture_probe(cnwn_ResourceType type, const void * data, int64_t data_size, int64_t resource_size, cnwn_TextureInfo * ret_info)
+{
+    const uint8_t * p = data;
+    memset(ret_info, 0, sizeof(cnwn_TextureInfo));
+    bool dds_magic = (data_size >= 4 && memcmp(p, "DDS ", 4) == 0);
+    switch (type) {
+        case CNWN_RESOURCE_TYPE_DDS:
+            if (dds_magic)
+                return cnwn_texture_probe_dds(p, data_size, ret_info);
+            return cnwn_texture_probe_bioware_dds(p, data_size, resource_size, ret_info);
+        case CNWN_RESOURCE_TYPE_TGA:
+            return cnwn_texture_probe_tga(p, data_size, ret_info);
+        case CNWN_RESOURCE_TYPE_PLT:
+            return cnwn_texture_probe_plt(p, data_size, ret_info);
+        case CNWN_RESOURCE_TYPE_TEX:
+            if (dds_magic)
+                return cnwn_texture_probe_dds(p, data_size, ret_info);
+            return cnwn_texture_probe_tga(p, data_size, ret_info);
+        default:
+            return 0;
+    }
+}
+
+int cnwn_texture_probe_file(cnwn_ResourceType type, cnwn_File * f, int64_t offset, int64_t size, cnwn_TextureInfo * ret_info)
+{
+    if (!CNWN_TEXTURE_IS_TEXTURE_TYPE(type)) {
+        memset(ret_info, 0, sizeof(cnwn_TextureInfo));
+        return 0;
+    }
+    uint8_t header[CNWN_TEXTURE_PROBE_SIZE];
+    int64_t header_size = CNWN_MIN(size, CNWN_TEXTURE_PROBE_SIZE);
+    if (cnwn_file_seek(f, offset) < 0 || cnwn_file_read_fixed(f, header_size, header) < 0) {
+        memset(ret_info, 0, sizeof(cnwn_TextureInfo));
+        return -1;
+    }
+    return cnwn_texture_probe(type, header, header_size, size, ret_info);
+}
+
+int cnwn_texture_info_to_string(const cnwn_TextureInfo * info, char * r, int max_size)
+{
+    char tmps[256];
+    snprintf(tmps, sizeof(tmps), "%dx%d %s%s, %d mipmap%s, %"PRId64" bytes VRAM",
+             info->width,
+             info->height,
+             cnwn_texture_format_name(info->format),
+             (info->compressed ? " RLE" : ""),
+             info->num_mipmaps,
+             (info->num_mipmaps != 1 ? "s" : ""),
+             info->vram_size);
+    return cnwn_strcpy(r, max_size, tmps, -1);
+}
@@ -0,0 +1,241 @@
+#include "cnwn/tlk.h"
+
+static uint32_t cnwn_tlk_read_u32(const uint8_t * p)
+{
+    uint32_t ret;
+    memcpy(&ret, p, sizeof(ret));
+    return (uint32_t)cnwn_endian_ltoh32((int32_t)ret);
+}
+
+int cnwn_tlk_init_from_buffer(cnwn_Tlk * tlk, const void * data, int64_t size)
+{
+    memset(tlk, 0, sizeof(cnwn_Tlk));
+    const uint8_t * p = data;
+    if (p == NULL || size < CNWN_TLK_HEADER_SIZE) {
+        cnwn_set_error("not enough data for TLK header (%"PRId64" bytes)", size);
+        return -1;
+    }
+    if (memcmp(p, "TLK ", 4) != 0) {
+        cnwn_set_error("invalid TLK type (%.4s)", (const char *)p);
+        return -1;
+    }
+    if (memcmp(p + 4, "V3.0", 4) != 0) {
+        cnwn_set_error("unsupported TLK version (%.4s)", (const char *)p + 4);
+        return -1;
+    }
+    uint32_t language_id = cnwn_tlk_read_u32(p + 8);
+    uint32_t num_entries = cnwn_tlk_read_u32(p + 12);
+    uint32_t strings_offset = cnwn_tlk_read_u32(p + 16);
+    if ((int64_t)CNWN_TLK_HEADER_SIZE + (int64_t)num_entries * CNWN_TLK_ENTRY_SIZE > size) {
+        cnwn_set_error("TLK string data table out of range (%u entries)", num_entries);
+        return -1;
+    }
+    if (strings_offset > size || strings_offset < CNWN_TLK_HEADER_SIZE + (int64_t)num_entries * CNWN_TLK_ENTRY_SIZE) {
+        cnwn_set_error("invalid TLK string entries offset (%u)", strings_offset);
+        return -1;
+    }
+    tlk->data = p;
+    tlk->size = size;
+    tlk->language_id = language_id;
+    tlk->num_entries = num_entries;
+    tlk->entries = p + CNWN_TLK_HEADER_SIZE;
+    tlk->strings = (const char *)p + strings_offset;
+    tlk->strings_size = size - strings_offset;
+    return 0;
+}
+
+int cnwn_tlk_init_from_path(cnwn_Tlk * tlk, const char * path)
+{
+    cnwn_FileMap map;
+    if (cnwn_file_map_path(path, &map) < 0) {
+        memset(tlk, 0, sizeof(cnwn_Tlk));
+        return -1;
+    }
+    if (cnwn_tlk_init_from_buffer(tlk, map.data, map.size) < 0) {
+        cnwn_set_error("%s (%s)", cnwn_get_error(), path);
+        cnwn_file_unmap(&map);
+        return -1;
+    }
+    tlk->map = map;
+    return 0;
+}
+
+void cnwn_tlk_deinit(cnwn_Tlk * tlk)
+{
+    cnwn_file_unmap(&tlk->map);
+    memset(tlk, 0, sizeof(cnwn_Tlk));
+}
+
+int cnwn_tlk_get_num_entries(const cnwn_Tlk * tlk)
+{
+    return (int)tlk->num_entries;
+}
+
+int cnwn_tlk_get_entry(const cnwn_Tlk * tlk, uint32_t index, cnwn_TlkEntry * ret_entry)
+{
+    index &= CNWN_TLK_STRREF_INDEX_MASK;
+    if (index >= tlk->num_entries)
+        return 0;
+    const uint8_t * p = tlk->entries + (int64_t)index * CNWN_TLK_ENTRY_SIZE;
+    uint32_t flags = cnwn_tlk_read_u32(p);
+    uint32_t offset = cnwn_tlk_read_u32(p + 28);
+    uint32_t length = cnwn_tlk_read_u32(p + 32);
+    if ((flags & CNWN_TLK_FLAG_TEXT_PRESENT) && (int64_t)offset + length > tlk->strings_size)
+        return 0;
+    if (ret_entry != NULL) {
+        ret_entry->flags = flags;
+        memcpy(ret_entry->sound_resref, p + 4, 16);
+        ret_entry->sound_resref[16] = 0;
+        ret_entry->volume_variance = cnwn_tlk_read_u32(p + 20);
+        ret_entry->pitch_variance = cnwn_tlk_read_u32(p + 24);
+        uint32_t sound_length = cnwn_tlk_read_u32(p + 36);
+        memcpy(&ret_entry->sound_length, &sound_length, sizeof(float));
+        if (flags & CNWN_TLK_FLAG_TEXT_PRESENT) {
+            ret_entry->text = tlk->strings + offset;
+            ret_entry->text_length = (int)length;
+        } else {
+            ret_entry->text = NULL;
+            ret_entry->text_length = 0;
+        }
+    }
+    return 1;
+}
+
+const char * cnwn_tlk_get_string(const cnwn_Tlk * tlk, uint32_t index, int * ret_length)
+{
+    index &= CNWN_TLK_STRREF_INDEX_MASK;
+    if (index < tlk->num_entries) {
+        const uint8_t * p = tlk->entries + (int64_t)index * CNWN_TLK_ENTRY_SIZE;
+        uint32_t offset = cnwn_tlk_read_u32(p + 28);
+        uint32_t length = cnwn_tlk_read_u32(p + 32);
+        if ((cnwn_tlk_read_u32(p) & CNWN_TLK_FLAG_TEXT_PRESENT) && (int64_t)offset + length <= tlk->strings_size) {
+            if (ret_length != NULL)
+                *ret_length = (int)length;
+            return tlk->strings + offset;
+        }
+    }
+    if (ret_length != NULL)
+        *ret_length = 0;
+    return NULL;
+}
+
+const char * cnwn_tlk_lookup(const cnwn_Tlk * tlk, const cnwn_Tlk * custom_tlk, uint32_t strref, int * ret_length)
+{
+    const cnwn_Tlk * use_tlk = ((strref & CNWN_TLK_STRREF_CUSTOM) ? custom_tlk : tlk);
+    if (use_tlk != NULL)
+        return cnwn_tlk_get_string(use_tlk, strref & CNWN_TLK_STRREF_INDEX_MASK, ret_length);
+    if (ret_length != NULL)
+        *ret_length = 0;
+    return NULL;
+}
+
+static void cnwn_tlk_write_u32(uint8_t * p, uint32_t u)
+{
+    u = (uint32_t)cnwn_endian_ltoh32((int32_t)u);
+    memcpy(p, &u, sizeof(u));
+}
+
+int64_t cnwn_tlk_write(cnwn_File * f, uint32_t language_id, int num_entries, const cnwn_TlkEntry * entries)
+{
+    if (num_entries < 0) {
+        cnwn_set_error("invalid number of entries (%d)", num_entries);
+        return -1;
+    }
+    int64_t table_size = (int64_t)num_entries * CNWN_TLK_ENTRY_SIZE;
+    uint8_t * table = malloc(CNWN_TLK_HEADER_SIZE + table_size);
+    uint32_t * offsets = malloc(sizeof(uint32_t) * (num_entries + 1));
+    int num_buckets = 16;
+    while (num_buckets < num_entries * 2)
+        num_buckets *= 2;
+    int * buckets = malloc(sizeof(int) * num_buckets);
+    for (int i = 0; i < num_buckets; i++)
+        buckets[i] = -1;
+    int64_t strings_size = 0;
+    for (int i = 0; i < num_entries; i++) {
+        const cnwn_TlkEntry * entry = entries + i;
+        offsets[i] = 0;
+        if (entry->text == NULL || entry->text_length <= 0)
+            continue;
+        uint32_t hash = cnwn_hash32_murmur3(entry->text, entry->text_length);
+        int bucket = hash & (num_buckets - 1);
+        while (buckets[bucket] >= 0) {
+            const cnwn_TlkEntry * other = entries + buckets[bucket];
+            if (other->text_length == entry->text_length && memcmp(other->text, entry->text, entry->text_length) == 0)
+                break;
+            bucket = (bucket + 1) & (num_buckets - 1);
+        }
+        if (buckets[bucket] >= 0)
+            offsets[i] = offsets[buckets[bucket]];
+        else {
+            if (strings_size + entry->text_length > UINT32_MAX) {
+                cnwn_set_error("TLK string entries too large");
+                free(buckets);
+                free(offsets);
+                free(table);
+                return -1;
+            }
+            buckets[bucket] = i;
+            offsets[i] = (uint32_t)strings_size;
+            strings_size += entry->text_length;
+        }
+    }
+    memcpy(table, "TLK V3.0", 8);
+    cnwn_tlk_write_u32(table + 8, language_id);
+    cnwn_tlk_write_u32(table + 12, (uint32_t)num_entries);
+    cnwn_tlk_write_u32(table + 16, (uint32_t)(CNWN_TLK_HEADER_SIZE + table_size));
+    char * strings = malloc(CNWN_MAX(1, strings_size));
+    for (int i = 0; i < num_entries; i++) {
+        const cnwn_TlkEntry * entry = entries + i;
+        uint8_t * p = table + CNWN_TLK_HEADER_SIZE + (int64_t)i * CNWN_TLK_ENTRY_SIZE;
+        bool has_text = (entry->text != NULL && entry->text_length > 0);
+        uint32_t flags = entry->flags & ~CNWN_TLK_FLAG_TEXT_PRESENT;
+        if (has_text)
+            flags |= CNWN_TLK_FLAG_TEXT_PRESENT;
+        cnwn_tlk_write_u32(p, flags);
+        memset(p + 4, 0, 16);
+        memcpy(p + 4, entry->sound_resref, cnwn_strnlen(entry->sound_resref, 16));
+        cnwn_tlk_write_u32(p + 20, entry->volume_variance);
+        cnwn_tlk_write_u32(p + 24, entry->pitch_variance);
+        cnwn_tlk_write_u32(p + 28, offsets[i]);
+        cnwn_tlk_write_u32(p + 32, (has_text ? (uint32_t)entry->text_length : 0));
+        uint32_t sound_length;
+        memcpy(&sound_length, &entry->sound_length, sizeof(float));
+        cnwn_tlk_write_u32(p + 36, sound_length);
+        if (has_text)
+            memcpy(strings + offsets[i], entry->text, entry->text_length);
+    }
+    free(buckets);
+    free(offsets);
+    int64_t ret = cnwn_file_write(f, CNWN_TLK_HEADER_SIZE + table_size, table);
+    free(table);
+    if (ret < 0) {
+        cnwn_set_error("%s (%s)", cnwn_get_error(), "writing string data table");
+        free(strings);
+        return -1;
+    }
+    int64_t sret = cnwn_file_write(f, strings_size, strings);
+    free(strings);
+    if (sret < 0) {
+        cnwn_set_error("%s (%s)", cnwn_get_error(), "writing string entries");
+        return -1;
+    }
+    return ret + sret;
+}
+
+int64_t cnwn_tlk_write_compact(const cnwn_Tlk * tlk, const bool * used, cnwn_File * f, int * ret_num_entries)
+{
+    int num_entries = cnwn_tlk_get_num_entries(tlk);
+    if (used != NULL)
+        while (num_entries > 0 && !used[num_entries - 1])
+            num_entries--;
+    cnwn_TlkEntry * entries = malloc(sizeof(cnwn_TlkEntry) * CNWN_MAX(1, num_entries));
+    memset(entries, 0, sizeof(cnwn_TlkEntry) * CNWN_MAX(1, num_entries));
+    for (int i = 0; i < num_entries; i++)
+        if (used == NULL || used[i])
+            cnwn_tlk_get_entry(tlk, i, entries + i);
+    int64_t ret = cnwn_tlk_write(f, tlk->language_id, num_entries, entries);
+    free(entries);
+    if (ret >= 0 && ret_num_entries != NULL)
+        *ret_num_entries = num_entries;
+    return ret;
+}
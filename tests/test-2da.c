@@ -0,0 +1,96 @@
+#include "cnwn/2da.h"
+
+// Write a 2DA text file, then report if cnwn_2da_init_from_path() used the cache and the label of row 0.
+static void check_cache(const char * path, const char * text, const char * cache_path, bool write_cache)
+{
+    // A cache left by an earlier run would be mapped while it is written again.
+    if (write_cache && cnwn_file_system_isfile(cache_path) > 0)
+        cnwn_file_system_rm(cache_path);
+    cnwn_File * f = cnwn_file_open(path, "t");
+    if (f != NULL) {
+        cnwn_file_write(f, cnwn_strlen(text), text);
+        cnwn_file_close(f);
+    }
+    cnwn_2DA tda;
+    if (cnwn_2da_init_from_path(&tda, path) < 0) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        return;
+    }
+    printf("%s: %s, row 0 label %s\n", path, (tda.map.size > 0 ? "from cache" : "parsed"), cnwn_2da_get_string2(&tda, 0, "Label"));
+    if (write_cache && (f = cnwn_file_open(cache_path, "t")) != NULL) {
+        cnwn_2da_write_cache(&tda, f);
+        cnwn_file_close(f);
+    }
+    cnwn_2da_deinit(&tda);
+}
+
+static const char TEST_2DA[] =
+    "2DA V2.0\r\n"
+    "\r\n"
+    "    Label        Name     Innate   Range  Speed\r\n"
+    "0   Acid_Fog     1        5        L      0.5\r\n"
+    "1   \"Magic Missile\" 2    1        ****   1.25\r\n"
+    "2   Hex          0x10     -3\r\n";
+
+int main(int argc, char * argv[])
+{
+    cnwn_2DA tda;
+    int ret = (argc > 1 ? cnwn_2da_init_from_path(&tda, argv[1]) : cnwn_2da_init_from_buffer(&tda, TEST_2DA, sizeof(TEST_2DA) - 1));
+    printf("Init returned: %d\n", ret);
+    if (ret < 0) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        return 1;
+    }
+    printf("Rows: %d\n", cnwn_2da_get_num_rows(&tda));
+    printf("Columns: %d\n", cnwn_2da_get_num_columns(&tda));
+    for (int row = 0; row < cnwn_2da_get_num_rows(&tda); row++) {
+        printf("  %s:", cnwn_2da_get_row_label(&tda, row));
+        for (int column = 0; column < cnwn_2da_get_num_columns(&tda); column++) {
+            const char * s = cnwn_2da_get_string(&tda, row, column);
+            int32_t i;
+            float f;
+            printf(" %s='%s'", cnwn_2da_get_column_name(&tda, column), s != NULL ? s : "(null)");
+            if (cnwn_2da_get_int(&tda, row, column, &i))
+                printf(" (int %d)", i);
+            else if (cnwn_2da_get_float(&tda, row, column, &f))
+                printf(" (float %g)", f);
+        }
+        printf("\n");
+    }
+    int32_t innate = 0;
+    bool found = cnwn_2da_get_int2(&tda, 1, "innate", &innate);
+    printf("Row 1 innate: %s %d\n", found ? "found" : "not found", innate);
+    printf("Column 'RANGE': %d\n", cnwn_2da_find_column(&tda, "RANGE"));
+    printf("Column 'missing': %d\n", cnwn_2da_find_column(&tda, "missing"));
+    cnwn_File * f = cnwn_file_open("test-2da.2dc", "wt");
+    if (f == NULL) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        cnwn_2da_deinit(&tda);
+        return 1;
+    }
+    int64_t wret = cnwn_2da_write_cache(&tda, f);
+    cnwn_file_close(f);
+    cnwn_2da_deinit(&tda);
+    printf("Write cache returned: %"PRId64"\n", wret);
+    if (cnwn_2da_init_from_cache(&tda, "test-2da.2dc") < 0) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        return 1;
+    }
+    for (int row = 0; row < cnwn_2da_get_num_rows(&tda); row++) {
+        int32_t innate;
+        const char * label = cnwn_2da_get_string2(&tda, row, "Label");
+        if (cnwn_2da_get_int2(&tda, row, "Innate", &innate))
+            printf("  Cached %s: innate %d\n", label != NULL ? label : "(null)", innate);
+        else
+            printf("  Cached %s: no innate\n", label != NULL ? label : "(null)");
+    }
+    cnwn_2da_deinit(&tda);
+    // An edit that keeps the size (within the same second) must not be served from the cache.
+    char edited[sizeof(TEST_2DA)];
+    memcpy(edited, TEST_2DA, sizeof(TEST_2DA));
+    edited[cnwn_strfind(edited, 0, "Acid_Fog", NULL) + 7] = 'x';
+    check_cache("test-2da-cached.2da", TEST_2DA, "test-2da-cached.2dc", true);
+    check_cache("test-2da-cached.2da", TEST_2DA, "test-2da-cached.2dc", false);
+    check_cache("test-2da-cached.2da", edited, "test-2da-cached.2dc", false);
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "cnwn/compression.h"
+#include "cnwn/erf.h"
+
+int main(int argc, char * argv[])
+{
+    char data[4096];
+    for (int i = 0; i < (int)sizeof(data); i++)
+        data[i] = 'a' + (i % 7);
+    for (int c = CNWN_COMPRESSION_ZLIB; c < CNWN_MAX_COMPRESSION; c++) {
+        printf("%s (%s):\n", cnwn_compression_name(c), (cnwn_compression_supported(c) ? "supported" : "not supported"));
+        if (!cnwn_compression_supported(c))
+            continue;
+        char compressed[sizeof(data)];
+        int64_t ret = cnwn_compression_compress(c, data, sizeof(data), compressed, sizeof(compressed));
+        printf("    Compressed %d => %"PRId64" bytes\n", (int)sizeof(data), ret);
+        if (ret <= 0)
+            continue;
+        cnwn_Compression compression;
+        int64_t uncompressed_size;
+        if (cnwn_compression_read_header(compressed, ret, &compression, &uncompressed_size) >= 0)
+            printf("    Header: %s %"PRId64" bytes\n", cnwn_compression_name(compression), uncompressed_size);
+        char decompressed[sizeof(data)];
+        int64_t dret = cnwn_compression_decompress(compressed, ret, decompressed, sizeof(decompressed));
+        printf("    Decompressed %"PRId64" bytes, %s\n", dret, (dret == sizeof(data) && memcmp(data, decompressed, sizeof(data)) == 0 ? "equal" : "NOT EQUAL"));
+        printf("    Too small: %"PRId64"\n", cnwn_compression_compress(c, data, sizeof(data), compressed, 24));
+        compressed[ret / 2] ^= 0x55;
+        if (cnwn_compression_decompress(compressed, ret, decompressed, sizeof(decompressed)) < 0)
+            printf("    Corrupted: %s\n", cnwn_get_error());
+    }
+    printf("From name \"ZLIB\": %d, \"lzma\": %d\n", cnwn_compression_from_name("ZLIB"), cnwn_compression_from_name("lzma"));
+    // Plain entries with junk (an unknown and a known codec) in the reserved field of their keys.
+    cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_ERF, &CNWN_RESOURCE_HANDLER_ERF);
+    char erf[4096];
+    int64_t erf_size = -1;
+    cnwn_File * f = cnwn_file_open("../tests/test.erf", "r");
+    if (f != NULL) {
+        erf_size = cnwn_file_read(f, sizeof(erf), erf);
+        cnwn_file_close(f);
+    }
+    if (erf_size < 160) {
+        printf("Reserved field: %s\n", cnwn_get_error());
+        return 0;
+    }
+    uint8_t * keys = (uint8_t *)erf + (erf[24] & 0xff) + ((erf[25] & 0xff) << 8);
+    keys[22] = 0x34;
+    keys[23] = 0x12;
+    keys[24 + 22] = CNWN_COMPRESSION_ZLIB;
+    keys[24 + 23] = 0;
+    f = cnwn_file_open("test-compression-reserved.erf", "t");
+    if (f != NULL) {
+        cnwn_file_write(f, erf_size, erf);
+        cnwn_file_close(f);
+    }
+    f = cnwn_file_open("test-compression-reserved.erf", "r");
+    cnwn_Resource resource;
+    if (f != NULL && cnwn_resource_init_from_file(&resource, CNWN_RESOURCE_TYPE_ERF, "test", 0, erf_size, NULL, f) >= 0) {
+        printf("Reserved field:\n");
+        for (int i = 0; i < cnwn_resource_get_num_resources(&resource); i++) {
+            cnwn_Resource view;
+            const cnwn_Resource * subresource = cnwn_resource_get_resource(&resource, i, &view);
+            cnwn_File * output_f = cnwn_file_open("test-compression-reserved.out", "t");
+            int64_t ret = cnwn_resource_extract(subresource, f, output_f);
+            cnwn_file_close(output_f);
+            printf("    %s.%s %s %"PRId64" bytes, extracted %"PRId64"\n", cnwn_resource_get_name(subresource), CNWN_RESOURCE_TYPE_EXTENSION(subresource->type), cnwn_compression_name(subresource->compression), subresource->size, ret);
+        }
+        cnwn_resource_deinit(&resource);
+    } else
+        printf("Reserved field: %s\n", cnwn_get_error());
+    if (f != NULL)
+        cnwn_file_close(f);
+    return 0;
+}
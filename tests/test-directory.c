@@ -0,0 +1,85 @@
+#include "cnwn/directory.h"
+#include "cnwn/erf.h"
+#include "cnwn/cnwna.h"
+
+void test_skipped_filenames(const char * path)
+{
+    const char * filenames[4] = {"Foo.2DA", "foo.2da", "foo.bak.2da", "bar.2da"};
+    cnwn_file_system_mkdir(path);
+    for (int i = 0; i < 4; i++) {
+        char tmps[CNWN_PATH_MAX_SIZE];
+        snprintf(tmps, sizeof(tmps), "%s%s%s", path, CNWN_PATH_SEPARATOR, filenames[i]);
+        cnwn_File * f = cnwn_file_open(tmps, "t");
+        if (f != NULL) {
+            cnwn_file_write(f, cnwn_strlen(filenames[i]), filenames[i]);
+            cnwn_file_close(f);
+        }
+    }
+    cnwn_Resource resource;
+    if (cnwn_resource_init_from_path(&resource, NULL, path) < 0) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        return;
+    }
+    printf("Directory '%s' (%d resources):", path, cnwn_resource_get_num_resources(&resource));
+    for (int i = 0; i < cnwn_resource_get_num_resources(&resource); i++) {
+        cnwn_Resource view;
+        const cnwn_Resource * subresource = cnwn_resource_get_resource(&resource, i, &view);
+        printf(" %s", subresource->path);
+    }
+    printf("\n");
+    cnwn_resource_deinit(&resource);
+}
+
+void test_extract_archives(const char * path, const char * output_path)
+{
+    if (cnwn_cnwna_execute_extract(path, true, -1, NULL, output_path) < 0) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        return;
+    }
+    const char * subpaths[2] = {"test.erf/ExportInfo.gff", "test.mod/area001.are"};
+    for (int i = 0; i < 2; i++) {
+        char tmps[CNWN_PATH_MAX_SIZE];
+        snprintf(tmps, sizeof(tmps), "%s%s%s", output_path, CNWN_PATH_SEPARATOR, subpaths[i]);
+        printf("Extracted %s: %s\n", subpaths[i], (cnwn_file_system_isfile(tmps) > 0 ? "yes" : "no"));
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_ERF, &CNWN_RESOURCE_HANDLER_ERF);
+    cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_MOD, &CNWN_RESOURCE_HANDLER_ERF);
+    cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_DIRECTORY, &CNWN_RESOURCE_HANDLER_DIRECTORY);
+    cnwn_Resource resource;
+    if (cnwn_resource_init_from_path(&resource, NULL, argc > 1 ? argv[1] : "../tests") < 0) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        return 1;
+    }
+    int num_resources = cnwn_resource_get_num_resources(&resource);
+    printf("Directory '%s' (%d resources):\n", cnwn_resource_get_name(&resource), num_resources);
+    for (int i = 0; i < num_resources; i++) {
+        cnwn_Resource view;
+        const cnwn_Resource * subresource = cnwn_resource_get_resource(&resource, i, &view);
+        printf("  %s.%s %"PRId64" bytes, %d resources (%s)\n", cnwn_resource_get_name(subresource), CNWN_RESOURCE_TYPE_EXTENSION(subresource->type),
+               subresource->size, cnwn_resource_get_num_resources(subresource), subresource->path);
+    }
+    // Children are looked up and extracted like the resources in an archive, they are read from their own files.
+    cnwn_ResRef name;
+    cnwn_resref_init(&name, "test");
+    int index = cnwn_resource_find_resource(&resource, CNWN_RESOURCE_TYPE_ERF, &name);
+    printf("Find test.erf: %d\n", index);
+    if (index >= 0) {
+        cnwn_Resource view;
+        cnwn_File * output_f = cnwn_file_open("test-directory.erf", "wt");
+        int64_t ret = (output_f != NULL ? cnwn_resource_extract(cnwn_resource_get_resource(&resource, index, &view), NULL, output_f) : -1);
+        if (ret < 0)
+            fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        else
+            printf("Extracted %"PRId64" bytes to test-directory.erf\n", ret);
+        if (output_f != NULL)
+            cnwn_file_close(output_f);
+    }
+    cnwn_resource_deinit(&resource);
+    test_skipped_filenames("./test-directory-skipped");
+    test_extract_archives(argc > 1 ? argv[1] : "../tests", "./test-directory-extract");
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "cnwn/filter.h"
+#include "cnwn/erf.h"
+
+int print_matches(const char * path, const char ** expressions)
+{
+    cnwn_File * f = cnwn_file_open(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        return -1;
+    }
+    cnwn_Resource resource;
+    int64_t size = cnwn_file_size(f);
+    if (size < 0 || cnwn_resource_init_from_file(&resource, CNWN_RESOURCE_TYPE_MOD, "test", 0, size, NULL, f) < 0) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        cnwn_file_close(f);
+        return -1;
+    }
+    int num_resources = cnwn_resource_get_num_resources(&resource);
+    for (int i = 0; expressions[i] != NULL; i++) {
+        cnwn_Filter filter;
+        if (cnwn_filter_init(&filter, expressions[i]) < 0) {
+            printf("'%s': ERROR: %s\n", expressions[i], cnwn_get_error());
+            continue;
+        }
+        int num_matches = 0;
+        printf("'%s':", expressions[i]);
+        for (int j = 0; j < num_resources; j++) {
+            int ret = cnwn_filter_match(&filter, &resource, j, f);
+            if (ret < 0) {
+                printf(" ERROR: %s", cnwn_get_error());
+                break;
+            }
+            if (ret > 0) {
+                cnwn_Resource view;
+                const cnwn_Resource * subresource = cnwn_resource_get_resource(&resource, j, &view);
+                if (num_matches < 8)
+                    printf(" %s.%s", cnwn_resource_get_name(subresource), CNWN_RESOURCE_TYPE_EXTENSION(subresource->type));
+                num_matches++;
+            }
+        }
+        printf(" (%d of %d)\n", num_matches, num_resources);
+        cnwn_filter_deinit(&filter);
+    }
+    cnwn_resource_deinit(&resource);
+    cnwn_file_close(f);
+    return 0;
+}
+
+// Write a copy of an ERF with every resource compressed.
+int write_compressed(const char * path, cnwn_Compression compression, const char * output_path)
+{
+    cnwn_File * f = cnwn_file_open(path, "r");
+    if (f == NULL)
+        return -1;
+    cnwn_Resource resource;
+    int64_t size = cnwn_file_size(f);
+    int64_t ret = -1;
+    if (size >= 0 && cnwn_resource_init_from_file(&resource, CNWN_RESOURCE_TYPE_MOD, "test", 0, size, NULL, f) >= 0) {
+        cnwn_File * output_f = cnwn_file_open(output_path, "t");
+        if (output_f != NULL) {
+            ret = cnwn_erf_write_subset2(&resource, f, NULL, compression, output_f);
+            cnwn_file_close(output_f);
+        }
+        cnwn_resource_deinit(&resource);
+    }
+    cnwn_file_close(f);
+    return (ret < 0 ? -1 : 0);
+}
+
+int main(int argc, char * argv[])
+{
+    const char * expressions[] = {
+        "", "type = nss", "type in (ncs, nss) and size < 1K", "type in (dds, tga) and size > 1K", "not type in (2da) or size <= 100", "size > 1M",
+        "(name = \"module\" or type = are) and archive = test.mod", "archive = other", "hash != 0",
+        "type = zzz", "size > 1X", "type in (2da", "name = a or", "color = red", NULL
+    };
+    // The SHA1 of area001.are in test.mod, the same for the content of a compressed copy.
+    const char * hash_expressions[] = {
+        "hash = f118919fd978858b1cd516f941e18b3a14bcf684", "hash = f118919", "hash in (f11, d62a049792c13450e01174806c8c59fb17d5649a)",
+        "hash = f118919fd978858b1cd516f941e18b3a14bcf685", NULL
+    };
+    const char * path = (argc > 1 ? argv[1] : "../tests/test.mod");
+    cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_MOD, &CNWN_RESOURCE_HANDLER_ERF);
+    if (print_matches(path, expressions) < 0 || print_matches(path, hash_expressions) < 0)
+        return 1;
+    if (cnwn_compression_supported(CNWN_COMPRESSION_ZLIB)) {
+        if (write_compressed(path, CNWN_COMPRESSION_ZLIB, "test-filter-zlib.mod") < 0) {
+            fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+            return 1;
+        }
+        printf("Compressed with zlib:\n");
+        if (print_matches("test-filter-zlib.mod", hash_expressions) < 0)
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "cnwn/hash.h"
+
+static void hash64(const char * name, const void * data, uint64_t length, int chunk_size)
+{
+    uint64_t hash = cnwn_hash64_xxh64(data, length);
+    cnwn_Hash64State state;
+    cnwn_hash64_xxh64_init(&state);
+    for (uint64_t offset = 0; offset < length; offset += chunk_size)
+        cnwn_hash64_xxh64_update(&state, (const uint8_t *)data + offset, CNWN_MIN(length - offset, (uint64_t)chunk_size));
+    uint64_t chunked_hash = cnwn_hash64_xxh64_final(&state);
+    printf("xxh64(%s) = %016"PRIx64" (%d byte chunks %s)\n", name, hash, chunk_size, (hash == chunked_hash ? "OK" : "MISMATCH"));
+}
+
+int main(int argc, char * argv[])
+{
+    uint8_t data[1000];
+    for (int i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i * 7);
+    hash64("\"\"", "", 0, 1);
+    printf("xxh64(\"\") %s reference ef46db3751d8e999\n", (cnwn_hash64_xxh64("", 0) == 0xef46db3751d8e999ULL ? "matches" : "DOES NOT MATCH"));
+    hash64("\"a\"", "a", 1, 1);
+    hash64("\"abc\"", "abc", 3, 2);
+    hash64("1000 bytes", data, sizeof(data), 1);
+    hash64("1000 bytes", data, sizeof(data), 31);
+    hash64("1000 bytes", data, sizeof(data), 64);
+    printf("wyhash(\"abc\") = %016"PRIx64"\n", cnwn_hash64_wyhash("abc", 3));
+    printf("fnv1a64(\"a\") = %016"PRIx64"\n", cnwn_hash64_fnv1a("a", 1));
+    cnwn_Hash128 h = cnwn_hash128_murmur3("hello", 5);
+    printf("murmur3-128(\"hello\") = %016"PRIx64"%016"PRIx64"\n", h.low, h.high);
+    printf("crc32(\"abc\") = %08"PRIx32"\n", cnwn_hash32_crc32("abc", 3));
+    uint32_t crc = cnwn_hash32_crc32(data, sizeof(data));
+    uint32_t chunked_crc = cnwn_hash32_crc32_update(cnwn_hash32_crc32_update(0, data, 77), data + 77, sizeof(data) - 77);
+    printf("crc32(1000 bytes) = %08"PRIx32" (chunked %s)\n", crc, (crc == chunked_crc ? "OK" : "MISMATCH"));
+    uint8_t digest[CNWN_SHA1_SIZE];
+    char digest_str[CNWN_SHA1_STRING_SIZE];
+    cnwn_hash_sha1("abc", 3, digest);
+    cnwn_hash_sha1_to_string(digest, digest_str, sizeof(digest_str));
+    printf("sha1(\"abc\") = %s\n", digest_str);
+    cnwn_Sha1State sha1_state;
+    cnwn_hash_sha1_init(&sha1_state);
+    for (int offset = 0; offset < sizeof(data); offset += 100)
+        cnwn_hash_sha1_update(&sha1_state, data + offset, 100);
+    cnwn_hash_sha1_final(&sha1_state, digest);
+    cnwn_hash_sha1_to_string(digest, digest_str, sizeof(digest_str));
+    printf("sha1(1000 bytes) = %s\n", digest_str);
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "cnwn/erf.h"
+#include "cnwn/ncs_vm.h"
+
+static void disassemble(const char * name, cnwn_Ncs * ncs)
+{
+    printf("%s: %d instructions, %d subroutines\n", name, ncs->num_instructions, ncs->num_subroutines);
+    for (int i = 0; i < ncs->num_instructions; i++) {
+        char tmps[256];
+        int subroutine = cnwn_ncs_find_subroutine(ncs, i);
+        if (ncs->subroutines[subroutine] == i)
+            printf("  sub_%d:\n", subroutine);
+        cnwn_ncs_instruction_to_string(ncs, i, tmps, sizeof(tmps));
+        printf("    %s\n", tmps);
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_MOD, &CNWN_RESOURCE_HANDLER_ERF);
+
+    cnwn_Resource resource;
+    cnwn_File * f = cnwn_file_open(argc > 1 ? argv[1] : "../tests/test.mod", "r");
+    if (f == NULL) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        return 1;
+    }
+    int64_t size = cnwn_file_size(f);
+    if (size < 0 || cnwn_resource_init_from_file(&resource, CNWN_RESOURCE_TYPE_MOD, "test", 0, size, NULL, f) < 0) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        cnwn_file_close(f);
+        return 1;
+    }
+    for (int i = 0; i < cnwn_resource_get_num_resources(&resource); i++) {
+        cnwn_Resource view;
+        const cnwn_Resource * child = cnwn_resource_get_resource(&resource, i, &view);
+        if (child->type != CNWN_RESOURCE_TYPE_NCS)
+            continue;
+        cnwn_Ncs ncs;
+        if (cnwn_ncs_init_from_file(&ncs, f, child->offset, child->size) < 0) {
+            fprintf(stderr, "ERROR: %s: %s\n", cnwn_resource_get_name(child), cnwn_get_error());
+            continue;
+        }
+        disassemble(cnwn_resource_get_name(child), &ncs);
+        cnwn_NcsVm vm;
+        if (cnwn_ncs_vm_init(&vm, &ncs, NULL, NULL, NULL) >= 0) {
+            int ret = cnwn_ncs_vm_run(&vm);
+            printf("  run: %s, %"PRId64" instructions, %d stack cells%s%s\n", cnwn_ncs_vm_status_name(vm.status), vm.num_instructions, vm.sp,
+                   (ret < 0 ? ", " : ""), (ret < 0 ? cnwn_get_error() : ""));
+            cnwn_ncs_vm_deinit(&vm);
+        } else
+            fprintf(stderr, "ERROR: %s: %s\n", cnwn_resource_get_name(child), cnwn_get_error());
+        cnwn_ncs_deinit(&ncs);
+    }
+    cnwn_resource_deinit(&resource);
+    cnwn_file_close(f);
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include "cnwn/nwsync.h"
+
+static void print_manifest(const char * name, const cnwn_NWSyncManifest * manifest)
+{
+    printf("%s:\n", name);
+    for (int i = 0; i < cnwn_nwsync_manifest_get_num_entries(manifest); i++) {
+        const cnwn_NWSyncEntry * entry = cnwn_nwsync_manifest_get_entry(manifest, i);
+        char sha1[CNWN_SHA1_STRING_SIZE];
+        cnwn_hash_sha1_to_string(entry->sha1, sha1, sizeof(sha1));
+        printf("    %s %s.%s %u\n", sha1, entry->resref.s, CNWN_RESOURCE_TYPE_EXTENSION(entry->type), entry->size);
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    const char * store_path = (argc > 1 ? argv[1] : "test-nwsync-store");
+    uint8_t a[CNWN_SHA1_SIZE], b[CNWN_SHA1_SIZE];
+    cnwn_hash_sha1("aaaa", 4, a);
+    cnwn_hash_sha1("bbbbbb", 6, b);
+    cnwn_NWSyncManifest manifest;
+    cnwn_nwsync_manifest_init(&manifest);
+    cnwn_nwsync_manifest_add(&manifest, a, 4, "Alpha", CNWN_RESOURCE_TYPE_TGA);
+    cnwn_nwsync_manifest_add(&manifest, b, 6, "beta", CNWN_RESOURCE_TYPE_2DA);
+    cnwn_nwsync_manifest_add(&manifest, a, 4, "alpha_copy", CNWN_RESOURCE_TYPE_TGA);
+    char path[CNWN_PATH_MAX_SIZE];
+    snprintf(path, sizeof(path), "%s.nsyc", store_path);
+    cnwn_File * f = cnwn_file_open(path, "t");
+    int64_t ret = cnwn_nwsync_manifest_write(&manifest, f, NULL);
+    cnwn_file_close(f);
+    printf("Wrote %"PRId64" bytes (expected %d)\n", ret, CNWN_NWSYNC_MANIFEST_HEADER_SIZE + 2 * CNWN_NWSYNC_MANIFEST_ENTRY_SIZE + CNWN_NWSYNC_MANIFEST_MAPPING_SIZE);
+    cnwn_NWSyncManifest read_manifest;
+    if (cnwn_nwsync_manifest_init_from_path(&read_manifest, path) < 0)
+        printf("ERROR: %s\n", cnwn_get_error());
+    cnwn_nwsync_manifest_sort(&read_manifest);
+    print_manifest("Read", &read_manifest);
+    cnwn_NWSyncManifest other, added, removed;
+    cnwn_nwsync_manifest_init(&other);
+    cnwn_nwsync_manifest_add(&other, b, 6, "alpha", CNWN_RESOURCE_TYPE_TGA);
+    cnwn_nwsync_manifest_add(&other, b, 6, "beta", CNWN_RESOURCE_TYPE_2DA);
+    cnwn_nwsync_manifest_add(&other, a, 4, "gamma", CNWN_RESOURCE_TYPE_TGA);
+    cnwn_nwsync_manifest_init(&added);
+    cnwn_nwsync_manifest_init(&removed);
+    printf("Diff: %d\n", cnwn_nwsync_manifest_diff(&read_manifest, &other, &added, &removed));
+    print_manifest("Added", &added);
+    print_manifest("Removed", &removed);
+    cnwn_file_system_rm(store_path);
+    f = cnwn_file_open(path, "t");
+    cnwn_file_write(f, 4, "aaaa");
+    cnwn_file_close(f);
+    f = cnwn_file_open(path, "r");
+    printf("Put: %d\n", cnwn_nwsync_store_put(store_path, a, f, 4));
+    printf("Put again: %d\n", cnwn_nwsync_store_put(store_path, a, f, 4));
+    printf("Put wrong hash: %d\n", cnwn_nwsync_store_put(store_path, b, f, 0));
+    cnwn_file_close(f);
+    for (int i = 0; i < cnwn_nwsync_manifest_get_num_entries(&read_manifest); i++) {
+        const cnwn_NWSyncEntry * entry = cnwn_nwsync_manifest_get_entry(&read_manifest, i);
+        printf("Verify %s: %d\n", entry->resref.s, cnwn_nwsync_store_verify(store_path, entry));
+    }
+    cnwn_file_system_rm(store_path);
+    cnwn_file_system_rm(path);
+    cnwn_nwsync_manifest_deinit(&removed);
+    cnwn_nwsync_manifest_deinit(&added);
+    cnwn_nwsync_manifest_deinit(&other);
+    cnwn_nwsync_manifest_deinit(&read_manifest);
+    cnwn_nwsync_manifest_deinit(&manifest);
+    return 0;
+}
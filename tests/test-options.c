@@ -21,5 +21,19 @@ int main(int argc, char * argv[])
         else
             index++;
     }    
+
+    // Longhands must not match a shorthand with the same first letter, values follow the '=' of the same argument.
+    const cnwn_Option list_options[] = {
+        {'f', "filter", "REGEXP", "Filter the resources.", 1},
+        {'F', "format", "FORMAT", "The output format.", 2},
+        {0}
+    };
+    char * list_argv[] = {"list", "-f", "x", "--format=json", "--filter=y", "--format", "-fx", NULL};
+    int list_argc = sizeof(list_argv) / sizeof(list_argv[0]) - 1;
+    for (index = 1; index < list_argc; ) {
+        ret = cnwn_options_parse_argument(list_options, index, list_argc, list_argv, &result);
+        printf("Argument '%s' %d option %s value '%s'\n", list_argv[index], ret, (result.option != NULL ? result.option->longhand : "(none)"), (result.optarg != NULL ? result.optarg : ""));
+        index += (ret > 0 ? ret : 1);
+    }
     return 0;
 }
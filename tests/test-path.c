@@ -29,6 +29,7 @@ int main(int argc, char * argv[])
     test_clean("filename.ext");
     test_clean("directory1");
     test_clean("tmp1/tmp2/tmp3");
+    test_clean("/a/b/c");
     test_clean("/directory1/directory2/filename.ext");
     test_clean("/directory1/directory2/");
     test_clean("////directory1///directory2///filename.ext");
@@ -0,0 +1,60 @@
+#include "cnwn/regexp.h"
+
+// cnwn_regexp_array_match_all() runs regexec() on every pattern, with one pattern it is what match any should return.
+static bool match_any_slow(int num_singles, cnwn_RegexpArray ** singles, const char * s)
+{
+    for (int i = 0; i < num_singles; i++)
+        if (cnwn_regexp_array_match_all(singles[i], s))
+            return true;
+    return false;
+}
+
+int main(int argc, char * argv[])
+{
+    const char * patterns[] = {
+        "^exact\\.2da$", "^PLC_", "\\.TGA$", "txt", "a*b", "^c.t$", "[xyz][0-9]\\.dds", "[^a-m]end$",
+        "\\(foo\\|bar\\)\\.nss", "^it_.*_[0-9][0-9]*\\.uti$", "ba\\{2\\}d", "q\\?uiet", "*star", "dot\\.dot", "[a-Z]x", "[b-Y]", NULL
+    };
+    const char * paths[] = {
+        "exact.2da", "EXACT.2DA", "exact.2da.bak", "plc_chair.utp", "xplc_chair.utp", "portrait.tga", "portrait.tga.bak",
+        "cat", "CUT", "coat", "abb", "b", "aaa", "x1.dds", "Y9.DDS", "w1.dds", "the_end", "amend", "foo.nss", "bar.nss",
+        "baz.nss", "it_sword_01.uti", "it_sword_.uti", "baad", "bad", "uiet", "quiet", "*star", "star", "dot.dot",
+        "dotxdot", "inner.hak/txt1.2da", "c", "Cx", "^", "", NULL
+    };
+    int num_patterns = 0;
+    while (patterns[num_patterns] != NULL)
+        num_patterns++;
+    cnwn_RegexpArray * singles[32];
+    for (int i = 0; i < num_patterns; i++) {
+        singles[i] = cnwn_regexp_array_new(1, patterns + i);
+        if (singles[i] == NULL) {
+            printf("ERROR: %s\n", cnwn_get_error());
+            return 1;
+        }
+    }
+    int num_failed = 0;
+    // Every pattern alone and then all of them together.
+    for (int i = 0; i <= num_patterns; i++) {
+        cnwn_RegexpArray * regexp_array = (i < num_patterns ? cnwn_regexp_array_new(1, patterns + i) : cnwn_regexp_array_new(num_patterns, patterns));
+        if (regexp_array == NULL) {
+            printf("ERROR: %s\n", cnwn_get_error());
+            return 1;
+        }
+        printf("%s:", (i < num_patterns ? patterns[i] : "all"));
+        for (int j = 0; paths[j] != NULL; j++) {
+            bool ret = cnwn_regexp_array_match_any(regexp_array, paths[j]);
+            if (ret)
+                printf(" '%s'", paths[j]);
+            if (ret != match_any_slow((i < num_patterns ? 1 : num_patterns), (i < num_patterns ? singles + i : singles), paths[j])) {
+                printf(" (FAILED '%s')", paths[j]);
+                num_failed++;
+            }
+        }
+        printf("\n");
+        cnwn_regexp_array_free(regexp_array);
+    }
+    for (int i = 0; i < num_patterns; i++)
+        cnwn_regexp_array_free(singles[i]);
+    printf("%d matches failed\n", num_failed);
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "cnwn/erf.h"
+#include "cnwn/cnwna.h"
 
 void dump_resource(const cnwn_Resource * resource, int indent)
 {
@@ -15,7 +16,8 @@ void dump_resource(const cnwn_Resource * resource, int indent)
     }
     int num_resources = cnwn_resource_get_num_resources(resource);
     for (int j = 0; j < num_resources; j++) {
-        cnwn_Resource * subresource = cnwn_resource_get_resource(resource, j);
+        cnwn_Resource view;
+        const cnwn_Resource * subresource = cnwn_resource_get_resource(resource, j, &view);
         dump_resource(subresource, indent + 4);
     }
 }
@@ -43,7 +45,8 @@ void extract_resource(const cnwn_Resource * resource, int depth, cnwn_File * inp
     int num_resources = cnwn_resource_get_num_resources(resource);
     if (depth != 0 && num_resources > 0) {
         for (int j = 0; j < num_resources; j++) {
-            cnwn_Resource * subresource = cnwn_resource_get_resource(resource, j);
+            cnwn_Resource view;
+            const cnwn_Resource * subresource = cnwn_resource_get_resource(resource, j, &view);
             extract_resource(subresource, (depth > 0 ? depth - 1 : -1), input_f, destination_path);
         }
     } else {
@@ -51,20 +54,151 @@ void extract_resource(const cnwn_Resource * resource, int depth, cnwn_File * inp
         cnwn_strcat(tmps, sizeof(tmps), CNWN_PATH_SEPARATOR, destination_path, resource_path, NULL);
         int64_t rs = cnwn_resource_extract_to_path(resource, input_f, tmps);
         if (rs >= 0) 
-            printf("Extracted %s => %s %"PRId64"\n", resource->name, tmps, rs);
+            printf("Extracted %s => %s %"PRId64"\n", cnwn_resource_get_name(resource), tmps, rs);
         else
             fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
     }
 }
 
 
+static void write_u32(uint8_t * p, uint32_t v)
+{
+    p[0] = v & 0xff; p[1] = (v >> 8) & 0xff; p[2] = (v >> 16) & 0xff; p[3] = (v >> 24) & 0xff;
+}
+
+// Writes an ERF with two nested containers (test.erf and test.mod) and checks that each one has its own children.
+void test_nested_containers(const char * path)
+{
+    const char * names[2] = {"first", "second"};
+    const char * paths[2] = {"../tests/test.erf", "../tests/test.mod"};
+    const cnwn_ResourceType types[2] = {CNWN_RESOURCE_TYPE_ERF, CNWN_RESOURCE_TYPE_MOD};
+    int64_t sizes[2];
+    uint8_t * datas[2] = {NULL, NULL};
+    for (int i = 0; i < 2; i++) {
+        cnwn_File * f = cnwn_file_open(paths[i], "r");
+        sizes[i] = (f != NULL ? cnwn_file_size(f) : -1);
+        if (sizes[i] >= 0) {
+            datas[i] = malloc(sizes[i]);
+            cnwn_file_read_fixed(f, sizes[i], datas[i]);
+        }
+        if (f != NULL)
+            cnwn_file_close(f);
+    }
+    if (datas[0] != NULL && datas[1] != NULL) {
+        uint8_t header[160 + 2 * 24 + 2 * 8] = {0};
+        memcpy(header, "ERF V1.0", 8);
+        write_u32(header + 16, 2);
+        write_u32(header + 20, 160);
+        write_u32(header + 24, 160);
+        write_u32(header + 28, 160 + 2 * 24);
+        uint32_t offset = sizeof(header);
+        for (int i = 0; i < 2; i++) {
+            uint8_t * key = header + 160 + i * 24;
+            memcpy(key, names[i], strlen(names[i]));
+            write_u32(key + 16, i);
+            key[20] = types[i] & 0xff;
+            key[21] = (types[i] >> 8) & 0xff;
+            write_u32(header + 160 + 2 * 24 + i * 8, offset);
+            write_u32(header + 160 + 2 * 24 + i * 8 + 4, sizes[i]);
+            offset += sizes[i];
+        }
+        cnwn_File * f = cnwn_file_open(path, "t");
+        if (f != NULL) {
+            cnwn_file_write(f, sizeof(header), header);
+            cnwn_file_write(f, sizes[0], datas[0]);
+            cnwn_file_write(f, sizes[1], datas[1]);
+            cnwn_file_close(f);
+        }
+        cnwn_Resource resource;
+        f = cnwn_file_open(path, "r");
+        if (f != NULL && cnwn_resource_init_from_file(&resource, CNWN_RESOURCE_TYPE_ERF, "nested", 0, offset, NULL, f) >= 0) {
+            for (int i = 0; i < cnwn_resource_get_num_resources(&resource); i++) {
+                cnwn_Resource view;
+                const cnwn_Resource * subresource = cnwn_resource_get_resource(&resource, i, &view);
+                cnwn_Resource subview;
+                const cnwn_Resource * first = cnwn_resource_get_resource(subresource, 0, &subview);
+                printf("Nested %s: %d resources, first %s\n", cnwn_resource_get_name(subresource), cnwn_resource_get_num_resources(subresource), (first != NULL ? cnwn_resource_get_name(first) : "(none)"));
+            }
+            cnwn_resource_deinit(&resource);
+        } else
+            fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        if (f != NULL)
+            cnwn_file_close(f);
+    } else
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+    free(datas[0]);
+    free(datas[1]);
+}
+
+// Names keep their case and length for display and rewriting, lookups ignore case.
+void test_names(const char * path, const char * output_path)
+{
+    cnwn_File * f = cnwn_file_open(path, "r");
+    cnwn_Resource resource;
+    if (f == NULL || cnwn_resource_init_from_file(&resource, CNWN_RESOURCE_TYPE_MOD, "a_module_name_longer_than_32_characters", 0, cnwn_file_size(f), NULL, f) < 0) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        if (f != NULL)
+            cnwn_file_close(f);
+        return;
+    }
+    char tmps[CNWN_PATH_MAX_SIZE];
+    cnwn_resource_get_path(&resource, sizeof(tmps), tmps);
+    printf("Top path: %s\n", tmps);
+    cnwn_ResRef name;
+    cnwn_resref_init(&name, "REPUTE");
+    int index = cnwn_resource_find_resource(&resource, CNWN_RESOURCE_TYPE_FAC, &name);
+    cnwn_Resource view;
+    const cnwn_Resource * subresource = (index >= 0 ? cnwn_resource_get_resource(&resource, index, &view) : NULL);
+    if (subresource != NULL) {
+        cnwn_resource_get_path(subresource, sizeof(tmps), tmps);
+        printf("Find REPUTE.fac: %d, name %s (resref %s), path %s\n", index, cnwn_resource_get_name(subresource), subresource->name.s, tmps);
+    }
+    // Rewriting an uncompressed ERF keeps its keys.
+    cnwn_File * output_f = cnwn_file_open(output_path, "t");
+    int64_t ret = (output_f != NULL ? cnwn_erf_write_subset2(&resource, f, NULL, CNWN_COMPRESSION_NONE, output_f) : -1);
+    if (output_f != NULL)
+        cnwn_file_close(output_f);
+    cnwn_Resource written;
+    output_f = (ret >= 0 ? cnwn_file_open(output_path, "r") : NULL);
+    if (output_f != NULL && cnwn_resource_init_from_file(&written, CNWN_RESOURCE_TYPE_MOD, "written", 0, ret, NULL, output_f) >= 0) {
+        int num_differing = 0;
+        for (int i = 0; i < cnwn_resource_get_num_resources(&resource); i++) {
+            cnwn_Resource a, b;
+            if (cnwn_strcmp(cnwn_resource_get_name(cnwn_resource_get_resource(&resource, i, &a)), cnwn_resource_get_name(cnwn_resource_get_resource(&written, i, &b))) != 0)
+                num_differing++;
+        }
+        printf("Rewritten %s: %d names differ\n", output_path, num_differing);
+        cnwn_resource_deinit(&written);
+    } else
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+    if (output_f != NULL)
+        cnwn_file_close(output_f);
+    cnwn_resource_deinit(&resource);
+    cnwn_file_close(f);
+}
+
+void test_extract_nested_containers(const char * path, const char * output_path)
+{
+    int ret = cnwn_cnwna_execute_extract(path, true, -1, NULL, output_path);
+    if (ret < 0) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        return;
+    }
+    const char * subpaths[3] = {"first.erf/ExportInfo.gff", "second.mod/area001.are", "second.mod/erf-header"};
+    for (int i = 0; i < 3; i++) {
+        char tmps[CNWN_PATH_MAX_SIZE];
+        snprintf(tmps, sizeof(tmps), "%s%s%s", output_path, CNWN_PATH_SEPARATOR, subpaths[i]);
+        printf("Extracted nested %s: %s\n", subpaths[i], (cnwn_file_system_isfile(tmps) > 0 ? "yes" : "no"));
+    }
+}
+
 int main(int argc, char * argv[])
 {
 
-    CNWN_RESOURCE_HANDLERS[CNWN_RESOURCE_TYPE_ERF] = CNWN_RESOURCE_HANDLER_ERF;
-    CNWN_RESOURCE_HANDLERS[CNWN_RESOURCE_TYPE_MOD] = CNWN_RESOURCE_HANDLER_ERF;
-    CNWN_RESOURCE_HANDLERS[CNWN_RESOURCE_TYPE_HAK] = CNWN_RESOURCE_HANDLER_ERF;
-    CNWN_RESOURCE_HANDLERS[CNWN_RESOURCE_TYPE_NWM] = CNWN_RESOURCE_HANDLER_ERF;
+    cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_ERF, &CNWN_RESOURCE_HANDLER_ERF);
+    cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_MOD, &CNWN_RESOURCE_HANDLER_ERF);
+    cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_HAK, &CNWN_RESOURCE_HANDLER_ERF);
+    cnwn_resource_set_handler(CNWN_RESOURCE_TYPE_NWM, &CNWN_RESOURCE_HANDLER_ERF);
     
     cnwn_Resource resource;
     cnwn_File * f = cnwn_file_open(argc > 1 ? argv[1] : "../tests/test.mod", "r");
@@ -84,6 +218,9 @@ int main(int argc, char * argv[])
         cnwn_file_close(f);
     } else
         fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
-    
+
+    test_names("../tests/test.mod", "./test-resource-names.mod");
+    test_nested_containers("./test-resource-nested.erf");
+    test_extract_nested_containers("./test-resource-nested.erf", "./test-resource-nested");
     return 0;
 }
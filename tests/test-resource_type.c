@@ -0,0 +1,34 @@
+#include "cnwn/resource_type.h"
+
+int main(int argc, char * argv[])
+{
+    int num_types = 0;
+    int num_failed = 0;
+    for (int t = -1; t <= CNWN_MAX_RESOURCE_TYPE; t++) {
+        int index = CNWN_RESOURCE_TYPE_INDEX(t);
+        int expected = -1;
+        for (int i = 0; i < CNWN_NUM_RESOURCE_TYPES; i++)
+            if (CNWN_RESOURCE_TYPE_INFOS[i].type == t)
+                expected = i;
+        if (index != expected) {
+            printf("Type %d has index %d (expected %d)\n", t, index, expected);
+            num_failed++;
+        }
+        // Directories have no extension to look up.
+        if (index < 0 || t == CNWN_RESOURCE_TYPE_DIRECTORY)
+            continue;
+        char path[64];
+        snprintf(path, sizeof(path), "some/dir/name.%s", CNWN_RESOURCE_TYPE_EXTENSION(t));
+        cnwn_ResourceType rtype = cnwn_resource_type_from_path(path);
+        if (rtype != t) {
+            printf("%s => %d (expected %d)\n", path, rtype, t);
+            num_failed++;
+        }
+        num_types++;
+    }
+    printf("%d types, %d failed\n", num_types, num_failed);
+    const char * paths[] = {"a.TGA", "tga", "dir.hak/file", "a/b.uti.xml.gz", "a. 2da ", "a.tgaa", "a.tg", "a.", ".mod", "a.zzz", "", NULL};
+    for (int i = 0; paths[i] != NULL; i++)
+        printf("'%s' => %d\n", paths[i], cnwn_resource_type_from_path(paths[i]));
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "cnwn/resref.h"
+
+#include <unistd.h>
+
+// Look up every name, misses and names of lengths around the 16 and 32 byte blocks only differing in the last
+// character, comparing with a plain loop over cnwn_resref_equal().
+static int test_find(void)
+{
+    cnwn_ResRef resrefs[40];
+    char name[CNWN_RESREF_MAX_LENGTH + 1];
+    for (int i = 0; i < 40; i++) {
+        int length = 1 + i % CNWN_RESREF_MAX_LENGTH;
+        memset(name, 'n', length);
+        name[length - 1] = 'a' + i / CNWN_RESREF_MAX_LENGTH;
+        name[length] = 0;
+        cnwn_resref_init(resrefs + i, name);
+    }
+    const char * others[] = {"NNNNNNNNNNNNNNNA", "nnnnnnnnnnnnnnnc", "nnnnnnnnnnnnnnnnc", "nnnnnnnnnnnnnnnnnnnnnnnnnnnnnnnc", "NNNNNNNNNNNNNNNNNNNNNNNNNNNNNNNA", "nnnnnnnnb", "", NULL};
+    int num_queries = 40;
+    cnwn_ResRef queries[48];
+    memcpy(queries, resrefs, sizeof(resrefs));
+    for (int i = 0; others[i] != NULL; i++)
+        cnwn_resref_init(queries + num_queries++, others[i]);
+    int num_failed = 0, num_found = 0;
+    for (int i = 0; i < num_queries; i++) {
+        for (int index = 0; index <= 40; index += 13) {
+            int expected = -1;
+            for (int j = index; j < 40 && expected < 0; j++)
+                if (cnwn_resref_equal(resrefs + j, queries + i))
+                    expected = j;
+            int ret = cnwn_resref_find(resrefs, index, 40, queries + i);
+            if ((ret < 0 ? -1 : ret) != expected) {
+                printf("find '%s' from %d => %d (expected %d)\n", queries[i].s, index, ret, expected);
+                num_failed++;
+            }
+            num_found += (index == 0 && ret >= 0);
+        }
+    }
+    printf("find with CPU features %d: %d of %d found, %d finds failed\n", cnwn_cpu_features(), num_found, num_queries, num_failed);
+    return num_failed;
+}
+
+int main(int argc, char * argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "find") == 0) {
+        test_find();
+        return 0;
+    }
+    const char * names[] = {"Alpha", "alpha", "ALPHA_2", "alpha_", "alph", "", "0123456789abcdef0123456789ABCDEF", "0123456789abcdef0123456789abcdefXYZ", NULL};
+    cnwn_ResRef resrefs[16];
+    int num_resrefs = 0;
+    for (int i = 0; names[i] != NULL; i++, num_resrefs++) {
+        int ret = cnwn_resref_init(resrefs + i, names[i]);
+        printf("'%s' => '%s' (%d, returned %d, hash %08x)\n", names[i], resrefs[i].s, resrefs[i].length, ret, cnwn_resref_hash(resrefs + i));
+    }
+    int num_failed = 0;
+    for (int i = 0; i < num_resrefs; i++) {
+        for (int j = 0; j < num_resrefs; j++) {
+            int expected = cnwn_strcmp(resrefs[i].s, resrefs[j].s);
+            int ret = cnwn_resref_compare(resrefs + i, resrefs + j);
+            bool equal = cnwn_resref_equal(resrefs + i, resrefs + j);
+            if ((ret < 0) != (expected < 0) || (ret > 0) != (expected > 0) || equal != (expected == 0)) {
+                printf("'%s' <=> '%s' => %d %d (expected %d)\n", resrefs[i].s, resrefs[j].s, ret, equal, expected);
+                num_failed++;
+            }
+            if (equal && cnwn_resref_hash(resrefs + i) != cnwn_resref_hash(resrefs + j)) {
+                printf("'%s' and '%s' hash differently\n", resrefs[i].s, resrefs[j].s);
+                num_failed++;
+            }
+        }
+    }
+    cnwn_ResRef raw;
+    cnwn_resref_init2(&raw, "KEY\0\0garbage", 16);
+    printf("Raw key => '%s' (%d, equal %d)\n", raw.s, raw.length, cnwn_resref_equal(&raw, &resrefs[0]));
+    printf("%d compares failed\n", num_failed);
+    test_find();
+    // The features are read once per process, run the finds again with SIMD disabled for the scalar path.
+    if (cnwn_cpu_features() != 0 && setenv("CNWN_CPU_FEATURES", "0", 1) == 0) {
+        fflush(stdout);
+        execl(argv[0], argv[0], "find", (char *)NULL);
+    }
+    return 0;
+}
@@ -24,6 +24,17 @@ void test_splitjoin(const char * s, int max_splits, const char * sep, const char
     cnwn_strings_free(ret);
 }
 
+void test_tokenize(const char * s, int flags, char separator)
+{
+    cnwn_StringTokenizer tokenizer;
+    cnwn_StringToken tokens[16];
+    int num_tokens;
+    printf("Tokenize: '%s'\n", s);
+    cnwn_string_tokenizer_init(&tokenizer, s, cnwn_strlen(s), flags, separator);
+    while ((num_tokens = cnwn_string_tokenizer_next(&tokenizer, 16, tokens)) > 0)
+        for (int i = 0; i < num_tokens; i++)
+            printf("    => %d:%"PRId64" '%.*s'%s\n", tokens[i].line, tokens[i].offset, tokens[i].length, s + tokens[i].offset, tokens[i].quoted ? " (quoted)" : "");
+}
 
 int main(int argc, char * argv[])
 {
@@ -38,5 +49,15 @@ int main(int argc, char * argv[])
     s = cnwn_strinsert_realloc(s, 2, "*");
     printf("'%s'\n", s);
     free(s);
+    test_tokenize("2DA V2.0\r\n\r\n   Label  Name\r\n0  \"Acid Fog\" ****\r\n", CNWN_STRING_TOKENIZER_FLAG_QUOTES, 0);
+    test_tokenize("[Game Options]\nKey=Value 2\n", 0, '=');
+    int64_t ints[] = {0, 7, -7, 10, 99, 100, 12345, -9876543210LL, INT64_MAX, INT64_MIN};
+    for (int i = 0; i < (int)(sizeof(ints) / sizeof(ints[0])); i++) {
+        char tmps[32];
+        char expected[32];
+        int length = cnwn_strformatint(tmps, sizeof(tmps), ints[i]);
+        snprintf(expected, sizeof(expected), "%"PRId64, ints[i]);
+        printf("Int: '%s' %d%s\n", tmps, length, (cnwn_strcmp(tmps, expected) == 0 ? "" : " (FAILED)"));
+    }
     return 0;
 }
@@ -0,0 +1,55 @@
+#include "cnwn/texture.h"
+
+static void probe(const char * name, cnwn_ResourceType type, const uint8_t * data, int64_t data_size, int64_t resource_size)
+{
+    cnwn_TextureInfo info;
+    int ret = cnwn_texture_probe(type, data, data_size, resource_size, &info);
+    if (ret > 0) {
+        char tmps[256];
+        cnwn_texture_info_to_string(&info, tmps, sizeof(tmps));
+        printf("%s: %s (%"PRId64" data bytes)\n", name, tmps, info.data_size);
+    } else if (ret == 0)
+        printf("%s: not a texture\n", name);
+    else
+        printf("%s: ERROR: %s\n", name, cnwn_get_error());
+}
+
+int main(int argc, char * argv[])
+{
+    uint8_t header[CNWN_TEXTURE_PROBE_SIZE];
+
+    memset(header, 0, sizeof(header));
+    header[0] = 64;
+    header[4] = 64;
+    header[8] = 4;
+    probe("bioware.dds", CNWN_RESOURCE_TYPE_DDS, header, sizeof(header), CNWN_TEXTURE_BIOWARE_DDS_HEADER_SIZE + 4096 + 1024 + 256 + 64 + 16 + 16 + 16);
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, "DDS ", 4);
+    header[4] = 124;
+    header[10] = 0x02;
+    header[13] = 1;
+    header[17] = 2;
+    header[28] = 10;
+    header[80] = 0x4;
+    memcpy(header + 84, "DXT1", 4);
+    probe("standard.dds", CNWN_RESOURCE_TYPE_DDS, header, sizeof(header), 100000);
+
+    memset(header, 0, sizeof(header));
+    header[2] = 2;
+    header[12] = 0;
+    header[13] = 1;
+    header[14] = 128;
+    header[16] = 24;
+    probe("image.tga", CNWN_RESOURCE_TYPE_TGA, header, CNWN_TEXTURE_TGA_HEADER_SIZE, 100000);
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, "PLT V1  ", 8);
+    header[16] = 64;
+    header[20] = 32;
+    probe("armor.plt", CNWN_RESOURCE_TYPE_PLT, header, CNWN_TEXTURE_PLT_HEADER_SIZE, 100000);
+
+    probe("short.tga", CNWN_RESOURCE_TYPE_TGA, header, 4, 4);
+    probe("script.ncs", CNWN_RESOURCE_TYPE_NCS, header, sizeof(header), 100000);
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "cnwn/tlk.h"
+
+static void print_tlk(const cnwn_Tlk * tlk)
+{
+    printf("Language: %u\n", tlk->language_id);
+    printf("Entries: %d\n", cnwn_tlk_get_num_entries(tlk));
+    printf("Size: %"PRId64" (%"PRId64" bytes of strings)\n", tlk->size, tlk->strings_size);
+    for (int i = 0; i < cnwn_tlk_get_num_entries(tlk); i++) {
+        cnwn_TlkEntry entry;
+        if (cnwn_tlk_get_entry(tlk, i, &entry)) 
+            printf("  %d: flags=%u sound='%s' text='%.*s'\n", i, entry.flags, entry.sound_resref, entry.text_length, entry.text != NULL ? entry.text : "");
+        else
+            printf("  %d: broken entry\n", i);
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    const char * path = (argc > 1 ? argv[1] : "test-tlk.tlk");
+    const char * compact_path = (argc > 2 ? argv[2] : "test-tlk-compact.tlk");
+    cnwn_TlkEntry entries[6];
+    memset(entries, 0, sizeof(entries));
+    const char * texts[6] = {"Hello", "World", "Hello", NULL, "Unused", "World"};
+    for (int i = 0; i < 6; i++) {
+        entries[i].text = texts[i];
+        entries[i].text_length = (texts[i] != NULL ? strlen(texts[i]) : 0);
+    }
+    entries[1].flags = CNWN_TLK_FLAG_SOUND_PRESENT;
+    snprintf(entries[1].sound_resref, sizeof(entries[1].sound_resref), "vs_world");
+    cnwn_File * f = cnwn_file_open(path, "wt");
+    if (f == NULL) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        return 1;
+    }
+    int64_t ret = cnwn_tlk_write(f, 0, 6, entries);
+    cnwn_file_close(f);
+    printf("Write returned: %"PRId64"\n", ret);
+    cnwn_Tlk tlk;
+    if (cnwn_tlk_init_from_path(&tlk, path) < 0) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        return 1;
+    }
+    print_tlk(&tlk);
+    int length;
+    const char * text = cnwn_tlk_lookup(NULL, &tlk, CNWN_TLK_STRREF_CUSTOM | 1, &length);
+    printf("Lookup custom strref 1: '%.*s'\n", length, text != NULL ? text : "");
+    bool used[6] = {true, false, true, false, false, false};
+    f = cnwn_file_open(compact_path, "wt");
+    if (f == NULL) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        cnwn_tlk_deinit(&tlk);
+        return 1;
+    }
+    int num_entries = 0;
+    ret = cnwn_tlk_write_compact(&tlk, used, f, &num_entries);
+    cnwn_file_close(f);
+    cnwn_tlk_deinit(&tlk);
+    printf("Compact returned: %"PRId64" (%d entries)\n", ret, num_entries);
+    if (cnwn_tlk_init_from_path(&tlk, compact_path) < 0) {
+        fprintf(stderr, "ERROR: %s\n", cnwn_get_error());
+        return 1;
+    }
+    print_tlk(&tlk);
+    cnwn_tlk_deinit(&tlk);
+    return 0;
+}